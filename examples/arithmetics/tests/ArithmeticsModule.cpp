@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iterator>
+#include <optional>
 #include <string>
 #include <type_traits>
 
@@ -47,24 +48,24 @@ constexpr std::string_view kDefaultCodeActionsKey = "pegiumDefaultCodeActions";
                      std::istreambuf_iterator<char>());
 }
 
-const pegium::Diagnostic *
+std::optional<pegium::Diagnostic>
 find_diagnostic(const pegium::workspace::Document &document,
                 std::string_view message) {
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(message) != std::string::npos) {
-      return &diagnostic;
+    if (diagnostic.message().find(message) != std::string::npos) {
+      return diagnostic.materialize();
     }
   }
-  return nullptr;
+  return std::nullopt;
 }
 
-std::vector<const pegium::Diagnostic *>
+std::vector<pegium::Diagnostic>
 find_diagnostics(const pegium::workspace::Document &document,
                  std::string_view message) {
-  std::vector<const pegium::Diagnostic *> diagnostics;
+  std::vector<pegium::Diagnostic> diagnostics;
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(message) != std::string::npos) {
-      diagnostics.push_back(&diagnostic);
+    if (diagnostic.message().find(message) != std::string::npos) {
+      diagnostics.push_back(diagnostic.materialize());
     }
   }
   return diagnostics;
@@ -251,8 +252,9 @@ TEST(ArithmeticsModuleTest, DoesNotWarnWhenDefinitionIsAlreadyAConstantLiteral)
   const auto hasNormalizationDiagnostic = std::ranges::any_of(
       document->diagnostics, [](const auto &diagnostic) {
         return diagnostic.code.has_value() &&
-               std::holds_alternative<std::string>(*diagnostic.code) &&
-               std::get<std::string>(*diagnostic.code) ==
+               std::holds_alternative<pegium::utils::InternedString>(
+                   *diagnostic.code) &&
+               std::get<pegium::utils::InternedString>(*diagnostic.code) ==
                    arithmetics::validation::IssueCodes::ExpressionNormalizable;
       });
   EXPECT_FALSE(hasNormalizationDiagnostic);
@@ -279,9 +281,9 @@ TEST(ArithmeticsModuleTest, DivisionByZeroTargetsRightOperand) {
   auto *binary = dynamic_cast<ast::BinaryExpression *>(evaluation->expression);
   ASSERT_NE(binary, nullptr);
 
-  const auto *diagnostic =
+  const auto diagnostic =
       find_diagnostic(*document, "Division by zero is detected.");
-  ASSERT_NE(diagnostic, nullptr);
+  ASSERT_TRUE(diagnostic.has_value());
   const auto [begin, end] =
       pegium::validation::range_for_feature<&ast::BinaryExpression::right>(*binary);
   EXPECT_EQ(diagnostic->begin, begin);
@@ -320,9 +322,9 @@ TEST(ArithmeticsModuleTest, ExpressionNormalizationUsesExpectedIssueCode) {
       "def test: 2 + 3;\n");
 
   ASSERT_NE(document, nullptr);
-  const auto *diagnostic =
+  const auto diagnostic =
       find_diagnostic(*document, "Expression could be normalized to constant 5");
-  ASSERT_NE(diagnostic, nullptr);
+  ASSERT_TRUE(diagnostic.has_value());
   ASSERT_TRUE(diagnostic->code.has_value());
   ASSERT_TRUE(std::holds_alternative<std::string>(*diagnostic->code));
   EXPECT_EQ(std::get<std::string>(*diagnostic->code),
@@ -364,10 +366,10 @@ TEST(ArithmeticsModuleTest, DuplicateDefinitionNamesAreDetectedOnNameRanges) {
       pegium::validation::range_for_feature<&ast::Definition::name>(*first);
   const auto [secondBegin, secondEnd] =
       pegium::validation::range_for_feature<&ast::Definition::name>(*second);
-  EXPECT_EQ(diagnostics[0]->begin, firstBegin);
-  EXPECT_EQ(diagnostics[0]->end, firstEnd);
-  EXPECT_EQ(diagnostics[1]->begin, secondBegin);
-  EXPECT_EQ(diagnostics[1]->end, secondEnd);
+  EXPECT_EQ(diagnostics[0].begin, firstBegin);
+  EXPECT_EQ(diagnostics[0].end, firstEnd);
+  EXPECT_EQ(diagnostics[1].begin, secondBegin);
+  EXPECT_EQ(diagnostics[1].end, secondEnd);
 }
 
 TEST(ArithmeticsModuleTest, DirectFunctionRecursionIsReportedOnFunctionReference) {
@@ -384,9 +386,9 @@ TEST(ArithmeticsModuleTest, DirectFunctionRecursionIsReportedOnFunctionReference
       "def factorial(n): factorial(n - 1);\n");
 
   ASSERT_NE(document, nullptr);
-  const auto *diagnostic =
+  const auto diagnostic =
       find_diagnostic(*document, "Recursion is not allowed [factorial()]");
-  ASSERT_NE(diagnostic, nullptr);
+  ASSERT_TRUE(diagnostic.has_value());
 
   auto *module = dynamic_cast<ast::Module *>(document->parseResult.value);
   ASSERT_NE(module, nullptr);
@@ -452,9 +454,9 @@ TEST(ArithmeticsModuleTest, FunctionCallArityMismatchTargetsArgumentsRange) {
       "add(1, 2, 3);\n");
 
   ASSERT_NE(document, nullptr);
-  const auto *diagnostic =
+  const auto diagnostic =
       find_diagnostic(*document, "Function add expects 2 parameters, but 3 were given.");
-  ASSERT_NE(diagnostic, nullptr);
+  ASSERT_TRUE(diagnostic.has_value());
 
   auto *module = dynamic_cast<ast::Module *>(document->parseResult.value);
   ASSERT_NE(module, nullptr);
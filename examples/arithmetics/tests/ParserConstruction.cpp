@@ -57,7 +57,7 @@ std::string dump_document_diagnostics(const pegium::workspace::Document &documen
       dump += " | ";
     }
     std::ostringstream current;
-    current << diagnostic.message << "@" << diagnostic.begin << "-"
+    current << diagnostic.message() << "@" << diagnostic.begin << "-"
             << diagnostic.end;
     dump += current.str();
   }
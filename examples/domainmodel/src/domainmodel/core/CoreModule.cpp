@@ -7,6 +7,8 @@
 #include <domainmodel/core/references/QualifiedNameProvider.hpp>
 #include <domainmodel/core/validation/DomainModelValidator.hpp>
 
+#include <pegium/core/references/DefaultScopeProvider.hpp>
+
 // This is the single translation unit that includes the grammar header
 // (DomainModelParser.hpp), so the heavy grammar template instantiation happens
 // here once; the lsp module reaches the wiring through the declaration only.
@@ -30,6 +32,12 @@ void installDomainModelCoreModule(pegium::CoreServices &core,
       std::make_shared<const references::QualifiedNameProvider>();
   core.references.scopeComputation =
       std::make_unique<references::DomainModelScopeComputation>(core, added);
+  // Scopes only depend on the containers declaring local symbols, so the
+  // many references repeating a type name resolve once per container.
+  auto scopeProvider =
+      std::make_unique<pegium::references::DefaultScopeProvider>(core);
+  scopeProvider->setSharedResolution(true);
+  core.references.scopeProvider = std::move(scopeProvider);
   added.validator = std::make_unique<validation::DomainModelValidator>();
   validation::registerValidationChecks(core, *added.validator);
 }
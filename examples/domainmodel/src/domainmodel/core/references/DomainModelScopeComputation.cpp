@@ -62,6 +62,7 @@ pegium::workspace::LocalSymbols DomainModelScopeComputation::collectLocalSymbols
 
   (void)processContainer(*model, model->elements, document, symbols,
                          cancelToken, languageServices.qualifiedNameProvider.get());
+  finalizeLocalSymbols(document, symbols);
   return symbols;
 }
 
@@ -125,7 +126,7 @@ DomainModelScopeComputation::createQualifiedDescription(
   description.name =
       qualifiedNameProvider != nullptr
           ? qualifiedNameProvider->getQualifiedName(package.name, description.name)
-          : package.name + "." + description.name;
+          : package.name + "." + description.name.str();
   return description;
 }
 
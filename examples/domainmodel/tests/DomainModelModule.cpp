@@ -92,7 +92,7 @@ collect_description_names(
   std::vector<std::string> names;
   names.reserve(descriptions.size());
   for (const auto &description : descriptions) {
-    names.push_back(description.name);
+    names.emplace_back(description.name);
   }
   std::ranges::sort(names);
   return names;
@@ -102,11 +102,9 @@ std::vector<std::string>
 collect_local_symbol_names(const pegium::workspace::LocalSymbols &symbols,
                            const pegium::AstNode *container) {
   std::vector<std::string> names;
-  if (const auto *entries = symbols.forContainer(container)) {
-    for (const auto &bucket : *entries) {
-      for (const auto &description : bucket.ownedEntries) {
-        names.push_back(description.name);
-      }
+  for (const auto &bucket : symbols.forContainer(container)) {
+    for (const auto &description : bucket.entries()) {
+      names.emplace_back(description.name);
     }
   }
   std::ranges::sort(names);
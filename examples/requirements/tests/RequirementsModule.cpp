@@ -141,11 +141,11 @@ FixtureDocuments open_fixture_set(pegium::SharedServices &shared,
   return documents;
 }
 
-const pegium::Diagnostic *
+const pegium::CompactDiagnostic *
 find_diagnostic_containing(const pegium::workspace::Document &document,
                            std::string_view needle) {
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(needle) != std::string::npos) {
+    if (diagnostic.message().find(needle) != std::string::npos) {
       return &diagnostic;
     }
   }
@@ -135,7 +135,7 @@ TEST(StatemachineModuleTest, ValidatorReportsDuplicateStatesAndEvents) {
   ASSERT_NE(document, nullptr);
   std::size_t duplicateCount = 0;
   for (const auto &diagnostic : document->diagnostics) {
-    if (diagnostic.message.find("Duplicate identifier name:") !=
+    if (diagnostic.message().find("Duplicate identifier name:") !=
         std::string::npos) {
       ++duplicateCount;
     }
@@ -161,7 +161,7 @@ void print_error_diagnostics(const workspace::Document &document,
         document.textDocument().positionAt(diagnostic.begin);
     // Positions are zero-based; report the conventional 1-based line and column.
     out << "line " << (position.line + 1) << ", column "
-        << (position.character + 1) << ": " << diagnostic.message;
+        << (position.character + 1) << ": " << diagnostic.message();
     if (diagnostic.end > diagnostic.begin &&
         diagnostic.end <= document.textDocument().getText().size()) {
       out << " ["
@@ -12,6 +12,7 @@
 #include <pegium/core/services/ServiceRegistry.hpp>
 #include <pegium/core/services/SharedCoreServices.hpp>
 #include <pegium/core/syntax-tree/AstUtils.hpp>
+#include <pegium/core/workspace/AstDescriptions.hpp>
 #include <pegium/core/workspace/Document.hpp>
 #include <pegium/core/workspace/Documents.hpp>
 #include <pegium/core/workspace/IndexManager.hpp>
@@ -128,6 +129,11 @@ DefaultDocumentationProvider::documentationLinkRenderer(
     }
     targetDocument = targetHolder.get();
   }
+  // Global scope descriptions come from the live index, which may already
+  // hold a newer revision of the target than the snapshot being read.
+  if (!workspace::describes_revision_of(*targetDocument, *description)) {
+    return std::nullopt;
+  }
 
   const auto *targetNode = targetDocument->findAstNode(description->symbolId);
   if (targetNode == nullptr) {
@@ -171,17 +177,15 @@ DefaultDocumentationProvider::findNameInLocalSymbols(const AstNode &node,
     return std::nullopt;
   }
 
-  const utils::HashedStringView nameKey{name};
+  const auto nameKey = utils::InternedString::find(name);
+  if (!nameKey.has_value()) {
+    return std::nullopt;
+  }
   for (const auto *current = &node; current != nullptr;
        current = current->getContainer()) {
-    const auto *entries = document.localSymbols.forContainer(current);
-    if (entries == nullptr) {
-      continue;
-    }
-    for (const auto &bucket : *entries) {
-      const auto it = bucket.entriesByName.find(nameKey);
-      if (it != bucket.entriesByName.end() && !it->second.empty()) {
-        return *it->second.first;
+    for (const auto &bucket : document.localSymbols.forContainer(current)) {
+      if (const auto *entry = bucket.find(*nameKey); entry != nullptr) {
+        return *entry;
       }
     }
   }
@@ -1,7 +1,10 @@
 #include <pegium/core/execution/TaskScheduler.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <exception>
+#include <numeric>
 #include <thread>
 
 #include <taskflow/taskflow.hpp>
@@ -14,6 +17,9 @@ namespace pegium::execution {
 struct TaskScheduler::Impl {
   explicit Impl(std::size_t workers) : executor(workers) {}
   tf::Executor executor;
+  // Elements of prioritized parallelFor calls that have not started yet, per
+  // TaskPriority, across every call in flight.
+  std::array<std::atomic<std::size_t>, kTaskPriorityCount> waitingByPriority{};
 };
 
 TaskScheduler::TaskScheduler(std::size_t workerCount) {
@@ -32,19 +38,24 @@ std::size_t TaskScheduler::defaultWorkerCount() noexcept {
   return static_cast<std::size_t>(concurrency - 1U);
 }
 
-void TaskScheduler::parallelForIndexed(
-    const utils::CancellationToken &cancelToken, std::size_t count,
-    const std::function<void(std::size_t)> &body) {
+namespace {
+
+// Runs body(index(position)) for every position in [0, count) on @p executor
+// with @p partitioner, capturing the first exception thrown and honouring
+// cooperative cancellation.
+template <typename Index, typename Partitioner>
+void run_for_each_index(tf::Executor &executor,
+                        const utils::CancellationToken &cancelToken,
+                        std::size_t count,
+                        const std::function<void(std::size_t)> &body,
+                        Index &&index, Partitioner partitioner) {
   std::atomic<bool> failed{false};
   std::exception_ptr firstException;
 
-  // for_each_index with the default (guided) partitioner: a sweep over
-  // partitioner types and chunk sizes confirmed the default is fastest here —
-  // guided's adaptive chunking balances best across heterogeneous cores, and
-  // larger fixed chunks / static / dynamic all regress.
   tf::Taskflow taskflow;
   taskflow.for_each_index(
-      std::size_t{0}, count, std::size_t{1}, [&](std::size_t index) {
+      std::size_t{0}, count, std::size_t{1},
+      [&](std::size_t position) {
         // Stop doing work once cancelled or once a sibling has failed; the
         // partition still iterates but every item short-circuits cheaply.
         if (cancelToken.stop_requested() ||
@@ -52,7 +63,7 @@ void TaskScheduler::parallelForIndexed(
           return;
         }
         try {
-          body(index);
+          body(index(position));
         } catch (...) {
           // failed.exchange selects the single thread that records the first
           // exception; it is read only by the caller after the executor join
@@ -61,14 +72,15 @@ void TaskScheduler::parallelForIndexed(
             firstException = std::current_exception();
           }
         }
-      });
+      },
+      partitioner);
 
   // corun (participate) when already on a worker — a worker may not block on
   // run().wait() without risking deadlock; from the main thread, block.
-  if (_impl->executor.this_worker_id() >= 0) {
-    _impl->executor.corun(taskflow);
+  if (executor.this_worker_id() >= 0) {
+    executor.corun(taskflow);
   } else {
-    _impl->executor.run(taskflow).wait();
+    executor.run(taskflow).wait();
   }
 
   if (firstException != nullptr) {
@@ -77,4 +89,94 @@ void TaskScheduler::parallelForIndexed(
   utils::throw_if_cancelled(cancelToken);
 }
 
+} // namespace
+
+void TaskScheduler::parallelForIndexed(
+    const utils::CancellationToken &cancelToken, std::size_t count,
+    const std::function<void(std::size_t)> &body) {
+  // for_each_index with the default (guided) partitioner: a sweep over
+  // partitioner types and chunk sizes confirmed the default is fastest here —
+  // guided's adaptive chunking balances best across heterogeneous cores, and
+  // larger fixed chunks / static / dynamic all regress.
+  run_for_each_index(
+      _impl->executor, cancelToken, count, body,
+      [](std::size_t position) { return position; },
+      tf::DefaultPartitioner{});
+}
+
+void TaskScheduler::parallelForPrioritized(
+    const utils::CancellationToken &cancelToken,
+    std::span<const std::uint64_t> costs,
+    std::span<const TaskPriority> priorities,
+    const std::function<void(std::size_t)> &body) {
+  std::vector<std::size_t> order(costs.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::ranges::stable_sort(
+      order, [&costs, &priorities](std::size_t lhs, std::size_t rhs) {
+        if (priorities[lhs] != priorities[rhs]) {
+          return priorities[lhs] < priorities[rhs];
+        }
+        return costs[lhs] > costs[rhs];
+      });
+
+  // Publish this call's elements as waiting to start, so that less urgent
+  // elements of any call yield to them.
+  auto &waiting = _impl->waitingByPriority;
+  std::array<std::size_t, kTaskPriorityCount> counts{};
+  for (const auto priority : priorities) {
+    ++counts[static_cast<std::size_t>(priority)];
+  }
+  for (std::size_t lane = 0; lane < kTaskPriorityCount; ++lane) {
+    waiting[lane].fetch_add(counts[lane], std::memory_order_relaxed);
+  }
+  std::array<std::atomic<std::size_t>, kTaskPriorityCount> started{};
+
+  auto &executor = _impl->executor;
+  const auto moreUrgentWaiting = [&waiting](std::size_t lane) {
+    for (std::size_t urgent = 0; urgent < lane; ++urgent) {
+      if (waiting[urgent].load(std::memory_order_relaxed) != 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  const std::function<void(std::size_t)> prioritizedBody =
+      [&](std::size_t index) {
+        const auto lane = static_cast<std::size_t>(priorities[index]);
+        waiting[lane].fetch_sub(1, std::memory_order_relaxed);
+        started[lane].fetch_add(1, std::memory_order_relaxed);
+        // Yield between items: rather than starting, help run the more urgent
+        // work until all of it has started. Only workers can do so; the items
+        // of this call are ordered by priority, so it never waits on itself.
+        if (moreUrgentWaiting(lane) && executor.this_worker_id() >= 0) {
+          executor.corun_until([&] {
+            return !moreUrgentWaiting(lane) || cancelToken.stop_requested();
+          });
+        }
+        body(index);
+      };
+
+  const auto release = [&] {
+    // Elements skipped after a failure or cancellation never started.
+    for (std::size_t lane = 0; lane < kTaskPriorityCount; ++lane) {
+      waiting[lane].fetch_sub(
+          counts[lane] - started[lane].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+  };
+  // Chunks of one, handed out in order: guided chunking would give the first
+  // worker the whole costly head of the order in one chunk, which is exactly
+  // the imbalance longest-first is meant to avoid.
+  try {
+    run_for_each_index(
+        executor, cancelToken, order.size(), prioritizedBody,
+        [&order](std::size_t position) { return order[position]; },
+        tf::DynamicPartitioner<>{1});
+  } catch (...) {
+    release();
+    throw;
+  }
+  release();
+}
+
 } // namespace pegium::execution
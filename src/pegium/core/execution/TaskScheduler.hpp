@@ -1,16 +1,36 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include <pegium/core/utils/Cancellation.hpp>
 
 namespace pegium::execution {
 
+/// Scheduling class of an element of a prioritized `TaskScheduler::parallelFor`.
+/// Elements of a more urgent class are dispatched first, and an element about
+/// to start yields its worker to more urgent elements still waiting to start,
+/// including those of other concurrent `parallelFor` calls.
+enum class TaskPriority : std::uint8_t {
+  /// Work someone is waiting on, such as rebuilding the document being edited.
+  Interactive,
+  /// Work on documents open in an editor that nobody is waiting on yet, such
+  /// as relinking an open dependant of the document being edited.
+  OpenDocument,
+  /// Workspace-wide work nobody is waiting on.
+  Background,
+};
+
+inline constexpr std::size_t kTaskPriorityCount =
+    static_cast<std::size_t>(TaskPriority::Background) + 1;
+
 /// Minimal parallel-for facade over a work-stealing executor, used by the
 /// document builder to run each build phase across the workspace. The executor
 /// type is kept out of this header (PIMPL) so it stays a private dependency.
@@ -37,6 +57,24 @@ public:
   void parallelFor(const utils::CancellationToken &cancelToken, Range &&range,
                    F &&task);
 
+  /// Same as the overload above, but dispatches the elements one at a time in
+  /// decreasing order of @p costOf (longest processing time first), so that a
+  /// few expensive elements start early instead of finishing last on a single
+  /// worker. @p costOf returns a relative `std::uint64_t` estimate and is called
+  /// once per element, on the calling thread. Every element is
+  /// `TaskPriority::Background`.
+  template <typename Range, typename F, typename Cost>
+  void parallelFor(const utils::CancellationToken &cancelToken, Range &&range,
+                   F &&task, Cost &&costOf);
+
+  /// Same as the overload above, but dispatches the elements by increasing
+  /// `TaskPriority` from @p priorityOf first, then longest first within one
+  /// priority. Before starting, an element waits for every more urgent element
+  /// of any prioritized call to have started, helping to run them meanwhile.
+  template <typename Range, typename F, typename Cost, typename Priority>
+  void parallelFor(const utils::CancellationToken &cancelToken, Range &&range,
+                   F &&task, Cost &&costOf, Priority &&priorityOf);
+
 private:
   struct Impl;
 
@@ -46,6 +84,12 @@ private:
   void parallelForIndexed(const utils::CancellationToken &cancelToken,
                           std::size_t count,
                           const std::function<void(std::size_t)> &body);
+  // Same contract as parallelForIndexed with count = costs.size(), but hands out
+  // indices one by one by priority, then from the most to the least costly.
+  void parallelForPrioritized(const utils::CancellationToken &cancelToken,
+                              std::span<const std::uint64_t> costs,
+                              std::span<const TaskPriority> priorities,
+                              const std::function<void(std::size_t)> &body);
 
   std::unique_ptr<Impl> _impl; // null when there are no workers
 };
@@ -80,4 +124,42 @@ void TaskScheduler::parallelFor(const utils::CancellationToken &cancelToken,
   }
 }
 
+template <typename Range, typename F, typename Cost>
+void TaskScheduler::parallelFor(const utils::CancellationToken &cancelToken,
+                                Range &&range, F &&task, Cost &&costOf) {
+  parallelFor(cancelToken, std::forward<Range>(range), std::forward<F>(task),
+              std::forward<Cost>(costOf),
+              [](const auto &) { return TaskPriority::Background; });
+}
+
+template <typename Range, typename F, typename Cost, typename Priority>
+void TaskScheduler::parallelFor(const utils::CancellationToken &cancelToken,
+                                Range &&range, F &&task, Cost &&costOf,
+                                Priority &&priorityOf) {
+  if constexpr (std::ranges::random_access_range<Range> &&
+                std::ranges::sized_range<Range>) {
+    const auto count = static_cast<std::size_t>(std::ranges::size(range));
+    // Ordering only matters when the elements are actually spread over workers.
+    if (_impl != nullptr && count > 1U) {
+      utils::throw_if_cancelled(cancelToken);
+      const auto begin = std::begin(range);
+      std::vector<std::uint64_t> costs;
+      std::vector<TaskPriority> priorities;
+      costs.reserve(count);
+      priorities.reserve(count);
+      for (std::size_t index = 0; index < count; ++index) {
+        const auto &element = *(begin + static_cast<std::ptrdiff_t>(index));
+        costs.push_back(static_cast<std::uint64_t>(costOf(element)));
+        priorities.push_back(priorityOf(element));
+      }
+      parallelForPrioritized(cancelToken, costs, priorities,
+                             [&](std::size_t index) {
+                               task(*(begin + static_cast<std::ptrdiff_t>(index)));
+                             });
+      return;
+    }
+  }
+  parallelFor(cancelToken, std::forward<Range>(range), std::forward<F>(task));
+}
+
 } // namespace pegium::execution
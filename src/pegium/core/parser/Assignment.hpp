@@ -140,6 +140,8 @@ private:
   void init_impl(AstReflectionInitContext &ctx) const {
     const auto &typeInfo = assignmentReflectionInfo();
     ctx.registerAssignment(typeInfo);
+    ctx.registerContainment<helpers::ClassType<feature>,
+                            helpers::AttrType<feature>>();
     if (typeInfo.assignedAstType != nullptr) {
       auto childContext = ctx.withExpectedType(typeInfo.assignedAstType->type);
       parser::init(_element, childContext);
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 #include <optional>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 #include <unordered_set>
+#include <variant>
 #include <vector>
 
 #include <pegium/core/grammar/AbstractElement.hpp>
@@ -91,6 +94,15 @@ template <typename T>
   return info;
 }
 
+/// Whether a member holding a `T` (or `T *`) may hold AST nodes that its type
+/// alone does not name: variants with AST node alternatives.
+template <typename T> struct HoldsUnnamedAstNodes : std::false_type {};
+
+template <typename... Ts>
+struct HoldsUnnamedAstNodes<std::variant<Ts...>>
+    : std::disjunction<
+          std::is_base_of<AstNode, std::remove_pointer_t<Ts>>...> {};
+
 struct VisitedKey {
   const grammar::AbstractElement *element = nullptr;
   std::type_index expectedType = invalid_type();
@@ -167,6 +179,21 @@ public:
     }
   }
 
+  /// Records that nodes of `container` may hold nodes of `child` as children;
+  /// a null `child` stands for any node.
+  void registerContainment(const AstNodeTypeInfo &container,
+                           const AstNodeTypeInfo *child) {
+    if (!is_valid_type(container.type)) {
+      return;
+    }
+    registerKnownType(container.type);
+    if (child != nullptr) {
+      registerKnownType(child->type);
+    }
+    _containments.push_back(
+        {.container = std::addressof(container), .child = child});
+  }
+
   void finalize() {
     if (_finalized) {
       return;
@@ -174,6 +201,7 @@ public:
     _finalized = true;
     finalizeReferenceInducedEdges();
     finalizeNamedMixinEdges();
+    finalizeContainment();
   }
 
 private:
@@ -220,6 +248,35 @@ private:
     }
   }
 
+  // Containers are the classes declaring the assigned members, often a C++
+  // base the grammar never produces: probe each produced type against them,
+  // as for reference targets, so that the containment of a base reaches the
+  // produced types deriving from it. Only the produced types that can be
+  // probed are sealed; the others may hold any node.
+  void finalizeContainment() {
+    static const std::type_index anyNode(typeid(AstNode));
+    for (const auto &containment : _containments) {
+      const auto *container = containment.container;
+      for (const auto &[producedType, typeInfo] : _producedTypesByType) {
+        if (typeInfo == nullptr || producedType == container->type ||
+            typeInfo->probe == nullptr || container->isInstance == nullptr) {
+          continue;
+        }
+        if (container->isInstance(typeInfo->probe())) {
+          addDirectSubtypeEdge(producedType, container->type);
+        }
+      }
+      _reflection->registerContainment(
+          container->type,
+          containment.child != nullptr ? containment.child->type : anyNode);
+    }
+    for (const auto &[producedType, typeInfo] : _producedTypesByType) {
+      if (typeInfo != nullptr && typeInfo->probe != nullptr) {
+        _reflection->sealContainment(producedType);
+      }
+    }
+  }
+
   void finalizeReferenceInducedEdges() {
     for (const auto *targetTypeInfo : _referenceAssignments) {
       if (targetTypeInfo == nullptr ||
@@ -245,6 +302,12 @@ private:
                      utils::FastTypeIndexHash, utils::FastTypeIndexEqual>
       _producedTypesByType;
   std::vector<const AstNodeTypeInfo *> _referenceAssignments;
+  struct Containment {
+    const AstNodeTypeInfo *container = nullptr;
+    // Null for any node.
+    const AstNodeTypeInfo *child = nullptr;
+  };
+  std::vector<Containment> _containments;
   std::unordered_set<std::type_index, utils::FastTypeIndexHash,
                      utils::FastTypeIndexEqual>
       _knownTypes;
@@ -289,6 +352,24 @@ struct AstReflectionInitContext {
     state->registerAssignment(metadata);
   }
 
+  /// Records that a member of `Container` holding a `Held` gives nodes of
+  /// `Container` children of that type. Members holding no AST node are
+  /// ignored.
+  template <typename Container, typename Held>
+  void registerContainment() const {
+    assert(state != nullptr);
+    if constexpr (std::derived_from<Container, AstNode>) {
+      if constexpr (std::derived_from<Held, AstNode>) {
+        state->registerContainment(detail::ast_node_type_info<Container>(),
+                                   std::addressof(
+                                       detail::ast_node_type_info<Held>()));
+      } else if constexpr (detail::HoldsUnnamedAstNodes<Held>::value) {
+        state->registerContainment(detail::ast_node_type_info<Container>(),
+                                   nullptr);
+      }
+    }
+  }
+
   [[nodiscard]] AstReflectionInitContext
   withExpectedType(std::type_index nextExpectedType) const noexcept {
     auto copy = *this;
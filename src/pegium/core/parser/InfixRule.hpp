@@ -306,6 +306,12 @@ private:
 
   void init_impl(AstReflectionInitContext &ctx) const {
     ctx.registerProducedType(detail::ast_node_type_info<T>());
+    using LeftPointee = std::remove_pointer_t<
+        std::remove_reference_t<decltype(std::declval<T &>().*Left)>>;
+    using RightPointee = std::remove_pointer_t<
+        std::remove_reference_t<decltype(std::declval<T &>().*Right)>>;
+    ctx.registerContainment<T, LeftPointee>();
+    ctx.registerContainment<T, RightPointee>();
     assert(_obj && _ops.init && "Missing infix init wrapper!");
     _ops.init(_obj, ctx);
   }
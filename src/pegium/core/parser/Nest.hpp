@@ -62,6 +62,8 @@ private:
 
   void init_impl(AstReflectionInitContext &ctx) const {
     ctx.registerProducedType(detail::ast_node_type_info<T>());
+    ctx.registerContainment<helpers::ClassType<feature>,
+                            helpers::AttrType<feature>>();
   }
 };
 
@@ -136,7 +136,8 @@ ParseResult PegiumParser::parse(text::TextSnapshot text,
       matchedNode = detail::findFirstMatchingNode(*result.cst, &entryRule);
     }
     if (matchedNode.has_value()) {
-      result.astArena = std::make_unique<AstArena>(*result.cst);
+      result.astArena = std::make_unique<AstArena>(
+          *result.cst, services.shared.astReflection.get());
       const ValueBuildContext context{
           .references = &result.references,
           .linker = services.references.linker.get(),
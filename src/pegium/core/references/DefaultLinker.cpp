@@ -1,18 +1,29 @@
 #include <pegium/core/references/DefaultLinker.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <pegium/core/observability/ObservabilitySink.hpp>
 #include <pegium/core/services/CoreServices.hpp>
 #include <pegium/core/services/SharedCoreServices.hpp>
 #include <pegium/core/syntax-tree/AstUtils.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
+#include <pegium/core/utils/TypeIndexHash.hpp>
 #include <pegium/core/workspace/AstDescriptions.hpp>
 #include <pegium/core/workspace/Document.hpp>
 
@@ -20,6 +31,29 @@ namespace pegium::references {
 
 namespace {
 
+// Documents with at least this many references are linked in chunks of
+// `kLinkChunkSize` references spread over the task scheduler.
+constexpr std::size_t kParallelLinkMinReferences = 4096;
+constexpr std::size_t kLinkChunkSize = 1024;
+
+// Observations raised by the chunk being linked on this thread. `link`
+// publishes them chunk by chunk once all chunks are done, so the sink sees the
+// same order as a sequential link.
+thread_local std::vector<observability::Observation> *t_deferredObservations =
+    nullptr;
+
+class DeferObservations {
+public:
+  explicit DeferObservations(std::vector<observability::Observation> &target)
+      : _previous(std::exchange(t_deferredObservations, &target)) {}
+  DeferObservations(const DeferObservations &) = delete;
+  DeferObservations &operator=(const DeferObservations &) = delete;
+  ~DeferObservations() { t_deferredObservations = _previous; }
+
+private:
+  std::vector<observability::Observation> *_previous;
+};
+
 void log_reference_resolution_problem(
     const pegium::SharedCoreServices &shared,
     const workspace::Document *document, std::string message,
@@ -37,9 +71,111 @@ void log_reference_resolution_problem(
       observation.state = document->state;
     }
   }
+  if (t_deferredObservations != nullptr) {
+    t_deferredObservations->push_back(std::move(observation));
+    return;
+  }
   shared.observabilitySink->publish(observation);
 }
 
+// References resolving to the same entries during `DefaultLinker::link`.
+struct ResolutionGroupKey {
+  const void *scope;
+  std::type_index referenceType;
+  std::string_view text;
+};
+
+struct ResolutionGroupKeyHash {
+  std::size_t operator()(const ResolutionGroupKey &key) const noexcept {
+    auto hash = std::hash<const void *>{}(key.scope);
+    hash ^= utils::FastTypeIndexHash{}(key.referenceType) + 0x9e3779b9U +
+            (hash << 6U) + (hash >> 2U);
+    hash ^= std::hash<std::string_view>{}(key.text) + 0x9e3779b9U +
+            (hash << 6U) + (hash >> 2U);
+    return hash;
+  }
+};
+
+struct ResolutionGroupKeyEqual {
+  bool operator()(const ResolutionGroupKey &lhs,
+                  const ResolutionGroupKey &rhs) const noexcept {
+    return lhs.scope == rhs.scope &&
+           utils::FastTypeIndexEqual{}(lhs.referenceType, rhs.referenceType) &&
+           lhs.text == rhs.text;
+  }
+};
+
+/// Resolves `reference` to the outcome of `leader` when that outcome holds for
+/// the whole group. Returns false when `reference` must resolve itself.
+bool share_resolution(const AbstractSingleReference &leader,
+                      const AbstractSingleReference &reference) {
+  // Only outcomes that depend on nothing but the group key are shared; a
+  // retryable, cyclic or failed resolution is redone for each reference.
+  switch (leader.state()) {
+  case ReferenceState::Resolved:
+    reference.forceResolveWith(workspace::ResolvedAstNodeDescription{
+        .node = leader.resolve(),
+        .description = std::addressof(leader.resolvedDescription())});
+    return true;
+  case ReferenceState::ErrorNotFound:
+    reference.forceResolveWith(
+        workspace::LinkingError{.info = makeReferenceInfo(reference),
+                                .kind = workspace::LinkingErrorKind::NotFound});
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Resolves `references` in order, resolving once the references of each
+/// group sharing a scope key, reference type and text. Returns false when some
+/// resolution was deferred by `DeferCyclicResolutions` and left `Unresolved`.
+bool link_references(std::span<const ReferenceHandle> references,
+                     const ScopeProvider &scopeProvider,
+                     const utils::CancellationToken &cancelToken) {
+  // Single references seeing the same scope, reference type and text resolve
+  // to the same entry: the first of each group (its leader) resolves through
+  // the linker, the others take over its result.
+  std::unordered_map<ResolutionGroupKey, const AbstractSingleReference *,
+                     ResolutionGroupKeyHash, ResolutionGroupKeyEqual>
+      leaders;
+  std::uint32_t cancelPollCounter = 0;
+  bool settled = true;
+  for (const auto &handle : references) {
+    if ((++cancelPollCounter & 0x3fU) == 0U) {
+      utils::throw_if_cancelled(cancelToken);
+    }
+    try {
+      const auto *reference = handle.get();
+      if (reference->isMultiReference() ||
+          reference->state() != ReferenceState::Unresolved) {
+        reference->forceResolve();
+        continue;
+      }
+      const auto &single =
+          static_cast<const AbstractSingleReference &>(*reference);
+      const auto info = makeReferenceInfo(single);
+      const auto *scope = scopeProvider.scopeKey(info);
+      if (scope == nullptr) {
+        single.forceResolve();
+        continue;
+      }
+      const auto [leader, inserted] = leaders.try_emplace(
+          ResolutionGroupKey{.scope = scope,
+                             .referenceType = info.getReferenceType(),
+                             .text = info.referenceText},
+          &single);
+      if (inserted || !share_resolution(*leader->second, single)) {
+        single.forceResolve();
+        leader->second = &single;
+      }
+    } catch (const CyclicReferenceResolution &) {
+      settled = false;
+    }
+  }
+  return settled;
+}
+
 } // namespace
 
 DefaultLinker::DefaultLinker(const pegium::CoreServices &services)
@@ -53,14 +189,56 @@ void DefaultLinker::link(workspace::Document &document,
     return;
   }
 
-  std::uint32_t cancelPollCounter = 0;
-  for (const auto &handle : document.parseResult.references) {
-    if ((++cancelPollCounter & 0x3fU) == 0U) {
-      utils::throw_if_cancelled(cancelToken);
-    }
-    handle.get()->forceResolve();
+  const auto *scopeProvider = services.references.scopeProvider.get();
+  const std::span<const ReferenceHandle> references =
+      document.parseResult.references;
+  auto *taskScheduler = services.shared.execution.taskScheduler.get();
+  if (taskScheduler == nullptr ||
+      references.size() < kParallelLinkMinReferences) {
+    link_references(references, *scopeProvider, cancelToken);
+    utils::throw_if_cancelled(cancelToken);
+    return;
   }
 
+  // Resolution only touches the per-reference state, which is safe to resolve
+  // concurrently; a reference needed by another chunk is resolved once and
+  // awaited by the others. Which reference of a cycle reports it would depend
+  // on which thread closes the cycle: cyclic resolutions are left unresolved,
+  // then settled by a sequential pass in reference order.
+  const auto chunkCount =
+      (references.size() + kLinkChunkSize - 1) / kLinkChunkSize;
+  std::vector<std::vector<observability::Observation>> observations(chunkCount);
+  std::atomic<bool> settled = true;
+  const auto publishObservations = [this, &observations] {
+    for (auto &chunk : observations) {
+      for (const auto &observation : chunk) {
+        services.shared.observabilitySink->publish(observation);
+      }
+      chunk.clear();
+    }
+  };
+  try {
+    taskScheduler->parallelFor(
+        cancelToken, std::views::iota(std::size_t{0}, chunkCount),
+        [&](std::size_t chunk) {
+          const DeferObservations defer(observations[chunk]);
+          const DeferCyclicResolutions deferCycles;
+          const auto begin = chunk * kLinkChunkSize;
+          if (!link_references(
+                  references.subspan(begin, std::min(kLinkChunkSize,
+                                                     references.size() - begin)),
+                  *scopeProvider, cancelToken)) {
+            settled.store(false, std::memory_order_relaxed);
+          }
+        });
+  } catch (...) {
+    publishObservations();
+    throw;
+  }
+  publishObservations();
+  if (!settled.load(std::memory_order_relaxed)) {
+    link_references(references, *scopeProvider, cancelToken);
+  }
   utils::throw_if_cancelled(cancelToken);
 }
 
@@ -185,6 +363,9 @@ auto DefaultLinker::withReferenceInfo(const AbstractReference &reference,
     const auto &currentDocument = getDocument(*reference.getContainer());
     return body(info, currentDocument);
   } catch (const CyclicReferenceResolution &cycle) {
+    if (DeferCyclicResolutions::active()) {
+      throw;
+    }
     return workspace::LinkingError{
         .info = makeReferenceInfo(cycle.reference()),
         .kind = workspace::LinkingErrorKind::Cycle};
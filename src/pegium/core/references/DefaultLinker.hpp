@@ -23,6 +23,19 @@ public:
   explicit DefaultLinker(const pegium::CoreServices &services);
 
   /// Resolves and caches every reference owned by `document`.
+  ///
+  /// Single references for which the scope provider reports the same
+  /// `scopeKey(...)`, with the same reference type and text, are resolved once
+  /// and share the result. The default scope provider only reports keys once
+  /// `DefaultScopeProvider::setSharedResolution(true)` was called; overrides of
+  /// `getCandidate(...)` that depend on more than the scope must come with a
+  /// scope provider returning no key.
+  ///
+  /// Documents with many references are linked in chunks spread over the
+  /// shared task scheduler; resolution problems are still reported to the
+  /// observability sink in reference order. Resolution cycles met by the
+  /// chunks are settled afterwards in reference order, so that the same
+  /// reference of each cycle reports it as in a sequential link.
   void link(workspace::Document &document,
             const utils::CancellationToken &cancelToken) const override;
 
@@ -1,5 +1,7 @@
 #include <pegium/core/references/DefaultNameProvider.hpp>
 
+#include <typeinfo>
+
 #include <pegium/core/syntax-tree/AstNode.hpp>
 #include <pegium/core/syntax-tree/CstUtils.hpp>
 
@@ -34,4 +36,12 @@ DefaultNameProvider::getNameNode(const AstNode &node) const {
   return find_node_for_feature(node.getCstNode(), "name");
 }
 
+std::optional<std::vector<std::type_index>>
+DefaultNameProvider::namedTypes() const {
+  if (typeid(*this) != typeid(DefaultNameProvider)) {
+    return std::nullopt;
+  }
+  return std::vector{std::type_index(typeid(NamedAstNode))};
+}
+
 } // namespace pegium::references
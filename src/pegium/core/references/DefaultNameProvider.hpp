@@ -18,6 +18,12 @@ public:
   /// node has no CST or no `name` feature.
   [[nodiscard]] std::optional<CstNodeView>
   getNameNode(const AstNode &node) const override;
+
+  /// Returns `pegium::NamedAstNode`, or `std::nullopt` in subclasses, which may
+  /// name other nodes through an overridden `getName`; they override this too
+  /// to keep the pruning.
+  [[nodiscard]] std::optional<std::vector<std::type_index>>
+  namedTypes() const override;
 };
 
 } // namespace pegium::references
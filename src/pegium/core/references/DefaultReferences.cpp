@@ -64,9 +64,13 @@ void append_reference_targets(const AbstractReference &reference,
         if (!seen.insert(workspace::NodeKey::of(description)).second) {
           return;
         }
-        results.push_back(std::addressof(
-            workspace::resolve_ast_node(documents, description,
-                                        currentDocument)));
+        // Skips targets rebound onto a newer revision of their document than
+        // the snapshot being read holds.
+        if (const auto *node = workspace::find_ast_node(documents, description,
+                                                        currentDocument);
+            node != nullptr) {
+          results.push_back(node);
+        }
       };
 
   if (reference.isMultiReference()) {
@@ -146,7 +150,8 @@ get_self_nodes(const AstNode &node, const pegium::CoreServices &services) {
       continue;
     }
     const auto sourceDocument = documents.getDocument(incoming.sourceDocumentId);
-    if (sourceDocument == nullptr) {
+    // The source document may have been evicted since it was indexed.
+    if (sourceDocument == nullptr || !sourceDocument->ensureResident()) {
       continue;
     }
     const auto *sourceReference =
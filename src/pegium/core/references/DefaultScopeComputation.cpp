@@ -1,9 +1,14 @@
 #include <pegium/core/references/DefaultScopeComputation.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <typeindex>
 #include <utility>
+#include <vector>
 
 #include <pegium/core/services/CoreServices.hpp>
+#include <pegium/core/services/SharedCoreServices.hpp>
+#include <pegium/core/utils/TypeIndexHash.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 
 namespace pegium::references {
@@ -31,9 +36,27 @@ DefaultScopeComputation::collectLocalSymbols(
 
   collectLocalSymbolsForNode(*document.parseResult.value, document, symbols,
                              cancelToken);
+  finalizeLocalSymbols(document, symbols);
   return symbols;
 }
 
+void DefaultScopeComputation::finalizeLocalSymbols(
+    const workspace::Document &document,
+    workspace::LocalSymbols &symbols) const {
+  // A document references few distinct types; a linear scan dedupes them.
+  std::vector<std::type_index> referenceTypes;
+  constexpr utils::FastTypeIndexEqual eq{};
+  for (const auto &handle : document.parseResult.references) {
+    const auto type = handle.getConst()->getReferenceType();
+    if (std::ranges::none_of(referenceTypes, [&eq, type](const auto known) {
+          return eq(known, type);
+        })) {
+      referenceTypes.push_back(type);
+    }
+  }
+  symbols.finalize(*services.shared.astReflection, referenceTypes);
+}
+
 std::vector<workspace::AstNodeDescription>
 DefaultScopeComputation::collectExportedSymbolsForNode(
     const AstNode &parentNode, const workspace::Document &document,
@@ -51,10 +74,25 @@ void DefaultScopeComputation::collectLocalSymbolsForNode(
     const AstNode &rootNode, const workspace::Document &document,
     workspace::LocalSymbols &symbols,
     const utils::CancellationToken &cancelToken) const {
-  for (const auto *node : rootNode.getAllContent()) {
-    utils::throw_if_cancelled(cancelToken);
-    addLocalSymbol(*node, document, symbols);
-  }
+  const auto &namedTypes = namedTypeFilter();
+  rootNode.visitDescendants([&](const AstNode &node) {
+    if (namedTypes.selects(node)) {
+      utils::throw_if_cancelled(cancelToken);
+      addLocalSymbol(node, document, symbols);
+    }
+    return namedTypes.mayContainSelected(node);
+  });
+}
+
+const AstTypeFilter &DefaultScopeComputation::namedTypeFilter() const {
+  std::call_once(_namedTypeFilterBuilt, [this] {
+    if (const auto namedTypes = services.references.nameProvider->namedTypes();
+        namedTypes.has_value()) {
+      _namedTypeFilter =
+          AstTypeFilter(*services.shared.astReflection, *namedTypes);
+    }
+  });
+  return _namedTypeFilter;
 }
 
 std::optional<workspace::AstNodeDescription>
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <mutex>
 #include <optional>
 
 #include <pegium/core/services/DefaultCoreService.hpp>
 #include <pegium/core/references/NameProvider.hpp>
 #include <pegium/core/references/ScopeComputation.hpp>
+#include <pegium/core/syntax-tree/AstTypeFilter.hpp>
 #include <pegium/core/workspace/AstNodeDescriptionProvider.hpp>
 
 namespace pegium {
@@ -36,7 +38,9 @@ protected:
       const AstNode &parentNode, const workspace::Document &document,
       const utils::CancellationToken &cancelToken) const;
 
-  /// Customizes how local symbols are gathered under `rootNode`.
+  /// Customizes how local symbols are gathered under `rootNode`. The default
+  /// calls `addLocalSymbol` on the descendants the `NameProvider` may name
+  /// (see `NameProvider::namedTypes()`), skipping the subtrees holding none.
   virtual void collectLocalSymbolsForNode(
       const AstNode &rootNode, const workspace::Document &document,
       workspace::LocalSymbols &symbols,
@@ -52,12 +56,24 @@ protected:
                               const workspace::Document &document,
                               workspace::LocalSymbols &symbols) const;
 
+  /// Lays `symbols` out for lookup, precomputing the bucket types accepted by
+  /// each reference type of `document`.
+  void finalizeLocalSymbols(const workspace::Document &document,
+                            workspace::LocalSymbols &symbols) const;
+
 private:
   /// Builds the indexable description of `node`, or `std::nullopt` when the
   /// node is unnamed or not describable. Shared by the exported/local paths.
   [[nodiscard]] std::optional<workspace::AstNodeDescription>
   make_description(const AstNode &node,
                    const workspace::Document &document) const;
+
+  /// Returns the filter selecting the nodes the `NameProvider` may name,
+  /// built on first use.
+  [[nodiscard]] const AstTypeFilter &namedTypeFilter() const;
+
+  mutable std::once_flag _namedTypeFilterBuilt;
+  mutable AstTypeFilter _namedTypeFilter;
 };
 
 } // namespace pegium::references
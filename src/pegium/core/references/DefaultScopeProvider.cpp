@@ -1,7 +1,10 @@
 #include <pegium/core/references/DefaultScopeProvider.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <typeindex>
 #include <typeinfo>
 
@@ -15,7 +18,7 @@ namespace pegium::references {
 namespace {
 
 using AstNodeDescription = workspace::AstNodeDescription;
-using ScopeEntryBucket = workspace::ScopeEntryBucket;
+using LocalScopeBucket = workspace::LocalScopeBucket;
 using DescriptionVisitor =
     utils::function_ref<bool(const AstNodeDescription &)>;
 
@@ -27,13 +30,6 @@ using DescriptionVisitor =
   });
 }
 
-[[nodiscard]] bool visit_owned_entries(
-    const std::deque<AstNodeDescription> &entries,
-    DescriptionVisitor visitor) {
-  return std::ranges::all_of(
-      entries, [&visitor](const auto &entry) { return visitor(entry); });
-}
-
 [[nodiscard]] bool visit_named_entries(
     const workspace::NamedScopeEntries &entries, DescriptionVisitor visitor) {
   if (entries.empty()) {
@@ -45,77 +41,82 @@ using DescriptionVisitor =
   return visit_entry_pointers(entries.duplicates, visitor);
 }
 
-[[nodiscard]] bool accepts_bucket(
-    const pegium::SharedCoreServices &shared, std::type_index referenceType,
-    const ScopeEntryBucket &bucket) {
-  return type_is_assignable(bucket.type, referenceType, *shared.astReflection);
-}
+// Bucket type filter of one reference type: the mask precomputed by the
+// scope computation when there is one, else a subtype bit test per bucket.
+class BucketFilter {
+public:
+  BucketFilter(const pegium::SharedCoreServices &shared,
+               const workspace::LocalSymbols &localSymbols,
+               std::type_index referenceType)
+      : _reflection(*shared.astReflection), _referenceType(referenceType),
+        _acceptedTypes(localSymbols.acceptedTypes(referenceType)) {
+    if (!_acceptedTypes.has_value()) {
+      _referenceTypeId = _reflection.typeId(referenceType);
+    }
+  }
+
+  [[nodiscard]] bool accepts(const LocalScopeBucket &bucket) const noexcept {
+    if (_acceptedTypes.has_value()) {
+      return bucket.acceptedBy(*_acceptedTypes);
+    }
+    return type_is_assignable(bucket.typeId(), bucket.type(), _referenceTypeId,
+                              _referenceType, _reflection);
+  }
+
+private:
+  const AstReflection &_reflection;
+  std::type_index _referenceType;
+  AstTypeId _referenceTypeId = kNoAstType;
+  std::optional<std::uint64_t> _acceptedTypes;
+};
 
 [[nodiscard]] const AstNodeDescription *
-find_scope_entry(const pegium::SharedCoreServices &shared,
-                 const workspace::BucketedScopeEntries &entries,
-                 std::type_index referenceType,
-                 const utils::HashedStringView &name) noexcept {
-  for (const auto &bucket : entries) {
-    // Probe the (O(1), hash-cached) name index first; only pay the bucket type
-    // check (isSubtype) for buckets that actually hold the name. Same
-    // conjunction and iteration order as before, so the selected entry is
-    // identical.
-    const auto it = bucket.entriesByName.find(name);
-    if (it == bucket.entriesByName.end()) {
+find_scope_entry(std::span<const LocalScopeBucket> buckets,
+                 const BucketFilter &filter,
+                 utils::InternedString name) noexcept {
+  for (const auto &bucket : buckets) {
+    // Search the bucket's (integer-keyed) name index first; only pay the bucket
+    // type check for buckets that actually hold the name. Same conjunction and
+    // iteration order as before, so the selected entry is identical.
+    const auto *entry = bucket.find(name);
+    if (entry == nullptr) {
       continue;
     }
-    if (!accepts_bucket(shared, referenceType, bucket)) {
+    if (!filter.accepts(bucket)) {
       continue;
     }
-    return it->second.firstEntry();
+    return entry;
   }
   return nullptr;
 }
 
-[[nodiscard]] bool visit_entries(const pegium::SharedCoreServices &shared,
-                                 const workspace::BucketedScopeEntries &entries,
-                                 std::type_index referenceType,
-                                 const utils::HashedStringView &name,
+[[nodiscard]] bool visit_entries(std::span<const LocalScopeBucket> buckets,
+                                 const BucketFilter &filter,
+                                 utils::InternedString name,
                                  DescriptionVisitor visitor) {
-  for (const auto &bucket : entries) {
-    if (name.value.empty()) {
+  for (const auto &bucket : buckets) {
+    if (name.empty()) {
       // Whole-bucket visit: the type check is the only filter.
-      if (!accepts_bucket(shared, referenceType, bucket)) {
+      if (!filter.accepts(bucket)) {
         continue;
       }
-      if (!visit_owned_entries(bucket.ownedEntries, visitor)) {
+      if (!std::ranges::all_of(bucket.entries(), [&visitor](const auto &entry) {
+            return visitor(entry);
+          })) {
         return false;
       }
       continue;
     }
 
-    // Named visit: probe the name index first; only type-check buckets that
+    // Named visit: search the name index first; only type-check buckets that
     // hold the name (same conjunction/order as before).
-    const auto it = bucket.entriesByName.find(name);
-    if (it == bucket.entriesByName.end()) {
-      continue;
-    }
-    if (!accepts_bucket(shared, referenceType, bucket)) {
+    if (bucket.find(name) == nullptr) {
       continue;
     }
-    if (!visit_named_entries(it->second, visitor)) {
-      return false;
-    }
-  }
-  return true;
-}
-
-template <typename Visitor>
-bool visit_local_scope_levels(const workspace::LocalSymbols &localSymbols,
-                              const AstNode *container, Visitor &&visitor) {
-  for (auto *current = container; current != nullptr;
-       current = current->getContainer()) {
-    const auto *entries = localSymbols.forContainer(current);
-    if (entries == nullptr) {
+    if (!filter.accepts(bucket)) {
       continue;
     }
-    if (!visitor(*entries)) {
+    if (!bucket.visitNamed(name, visitor)) {
       return false;
     }
   }
@@ -134,28 +135,28 @@ const workspace::AstNodeDescription *DefaultScopeProvider::getScopeEntry(
     return nullptr;
   }
 
+  // Look the reference text up once; the interned key is then compared as an
+  // integer across every bucket and ancestor scope level (and the global
+  // index). A name never interned is declared nowhere.
+  const auto nameKey = utils::InternedString::find(context.referenceText);
+  if (!nameKey.has_value()) {
+    return nullptr;
+  }
   const auto referenceType = context.getReferenceType();
-  // Hash the reference text once; the key is reused across every bucket and
-  // ancestor scope level (and the global index) without rehashing.
-  const utils::HashedStringView nameKey{context.referenceText};
   if (const auto *container = context.container; container != nullptr) {
     const auto &localSymbols = getDocument(*container).localSymbols;
-    const AstNodeDescription *entry = nullptr;
-    (void)visit_local_scope_levels(
-        localSymbols, container,
-        [this, referenceType, &nameKey,
-         &entry](const workspace::BucketedScopeEntries &entries) {
-          entry = find_scope_entry(services.shared, entries, referenceType,
-                                   nameKey);
-          return entry == nullptr;
-        });
-    if (entry != nullptr) {
-      return entry;
+    const BucketFilter filter(services.shared, localSymbols, referenceType);
+    // Only the containers that declare symbols are visited, nearest first.
+    for (const auto buckets : localSymbols.scopeChain(container)) {
+      if (const auto *entry = find_scope_entry(buckets, filter, *nameKey);
+          entry != nullptr) {
+        return entry;
+      }
     }
   }
 
   const auto globalEntries = getGlobalEntries(referenceType);
-  const auto globalIt = globalEntries->entriesByName.find(nameKey);
+  const auto globalIt = globalEntries->entriesByName.find(*nameKey);
   if (globalIt == globalEntries->entriesByName.end()) {
     return nullptr;
   }
@@ -166,18 +167,19 @@ bool DefaultScopeProvider::visitScopeEntries(
     const ReferenceInfo &context,
     utils::function_ref<bool(const workspace::AstNodeDescription &)> visitor)
     const {
+  // An empty key visits every entry.
+  const auto nameKey = utils::InternedString::find(context.referenceText);
+  if (!nameKey.has_value()) {
+    return true;
+  }
   const auto referenceType = context.getReferenceType();
-  const utils::HashedStringView nameKey{context.referenceText};
   if (const auto *container = context.container; container != nullptr) {
     const auto &localSymbols = getDocument(*container).localSymbols;
-    if (!visit_local_scope_levels(
-            localSymbols, container,
-            [this, referenceType, &nameKey,
-             visitor](const workspace::BucketedScopeEntries &entries) {
-              return visit_entries(services.shared, entries, referenceType,
-                                   nameKey, visitor);
-            })) {
-      return false;
+    const BucketFilter filter(services.shared, localSymbols, referenceType);
+    for (const auto buckets : localSymbols.scopeChain(container)) {
+      if (!visit_entries(buckets, filter, *nameKey, visitor)) {
+        return false;
+      }
     }
   }
 
@@ -186,13 +188,32 @@ bool DefaultScopeProvider::visitScopeEntries(
     return visit_entry_pointers(globalEntries->allEntries, visitor);
   }
 
-  const auto globalIt = globalEntries->entriesByName.find(nameKey);
+  const auto globalIt = globalEntries->entriesByName.find(*nameKey);
   if (globalIt == globalEntries->entriesByName.end()) {
     return true;
   }
   return visit_named_entries(globalIt->second, visitor);
 }
 
+const void *
+DefaultScopeProvider::scopeKey(const ReferenceInfo &context) const {
+  if (!_sharedResolution || context.container == nullptr) {
+    return nullptr;
+  }
+  return getDocument(*context.container).localSymbols.scopeKey(
+      context.container);
+}
+
+bool DefaultScopeProvider::visitLookupNames(
+    const ReferenceInfo &context,
+    utils::function_ref<void(std::string_view name)> visitor) const {
+  if (typeid(*this) != typeid(DefaultScopeProvider)) {
+    return false;
+  }
+  visitor(std::string_view(context.referenceText));
+  return true;
+}
+
 std::shared_ptr<const DefaultScopeProvider::CompiledGlobalEntries>
 DefaultScopeProvider::getGlobalEntries(std::type_index referenceType) const {
   return _globalScopeCache.get(referenceType, [this, referenceType] {
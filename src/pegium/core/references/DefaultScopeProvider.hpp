@@ -36,6 +36,26 @@ public:
       utils::function_ref<bool(const workspace::AstNodeDescription &)> visitor)
       const override;
 
+  /// Lets `scopeKey(...)` key references by the nearest container declaring
+  /// local symbols, so that the linker resolves the references sharing that
+  /// container, their reference type and text once. Off by default: only
+  /// enable it when neither this provider nor the linker's `getCandidate(...)`
+  /// and `getLinkedNode(...)` depend on more than that container.
+  void setSharedResolution(bool enabled) noexcept {
+    _sharedResolution = enabled;
+  }
+
+  /// Returns nullptr unless shared resolution was enabled.
+  [[nodiscard]] const void *
+  scopeKey(const ReferenceInfo &context) const override;
+
+  /// Visits `context.referenceText`, the only name global entries are looked
+  /// up by. Subclasses, which may look entries up otherwise, return `false`
+  /// unless they override this too.
+  [[nodiscard]] bool visitLookupNames(
+      const ReferenceInfo &context,
+      utils::function_ref<void(std::string_view name)> visitor) const override;
+
 protected:
   /// Cached view of all globally exported entries accepted by one reference type.
   struct CompiledGlobalEntries {
@@ -50,9 +70,13 @@ protected:
   [[nodiscard]] virtual std::shared_ptr<const CompiledGlobalEntries>
   getGlobalEntries(std::type_index referenceType) const;
 
-  mutable utils::WorkspaceCache<std::type_index,
-                                std::shared_ptr<const CompiledGlobalEntries>>
+  /// Kept across edits that leave the workspace exports unchanged.
+  mutable utils::ExportsCache<std::type_index,
+                              std::shared_ptr<const CompiledGlobalEntries>>
       _globalScopeCache;
+
+private:
+  bool _sharedResolution = false;
 };
 
 } // namespace pegium::references
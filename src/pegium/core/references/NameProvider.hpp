@@ -3,7 +3,9 @@
 #include <cassert>
 #include <optional>
 #include <string>
+#include <typeindex>
 #include <utility>
+#include <vector>
 
 #include <pegium/core/syntax-tree/AstNode.hpp>
 #include <pegium/core/syntax-tree/CstNodeView.hpp>
@@ -31,6 +33,14 @@ public:
   /// `node.getCstNode()` in the latter case (see `declaration_site_node`).
   [[nodiscard]] virtual std::optional<CstNodeView>
   getNameNode(const AstNode &node) const = 0;
+
+  /// Returns the types whose instances `getName` may name, or `std::nullopt`
+  /// when it may name a node of any type. Lets traversals looking for named
+  /// nodes skip the subtrees holding none. Defaults to `std::nullopt`.
+  [[nodiscard]] virtual std::optional<std::vector<std::type_index>>
+  namedTypes() const {
+    return std::nullopt;
+  }
 };
 
 /// Reusable naming data for editor-facing features.
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #include <pegium/core/utils/FunctionRef.hpp>
 #include <pegium/core/syntax-tree/ReferenceInfo.hpp>
 #include <pegium/core/workspace/AstDescriptions.hpp>
@@ -26,6 +28,35 @@ public:
       const ReferenceInfo &context,
       utils::function_ref<bool(const workspace::AstNodeDescription &)> visitor)
       const = 0;
+
+  /// Returns an identity shared by every reference site that sees the same
+  /// scope as `context`, or nullptr when the visible entries depend on the
+  /// site itself. References with the same key, reference type and text see
+  /// the same entries, which lets the linker resolve them once.
+  [[nodiscard]] virtual const void *
+  scopeKey(const ReferenceInfo &context) const {
+    (void)context;
+    return nullptr;
+  }
+
+  /// Visits the exported names `context` may resolve to. The index manager
+  /// records them for the document of `context` and relinks that document
+  /// when exported symbols under one of these names change; changes under
+  /// other names are assumed not to affect it.
+  ///
+  /// Returns `false` without visiting anything when the provider does not
+  /// tell, the default: a document with an unresolved reference is then
+  /// relinked after every export change. Providers looking exported symbols up
+  /// by the reference text as written visit `context.referenceText`; those
+  /// with imports, aliases or case-insensitive lookups visit the names they
+  /// actually look up.
+  [[nodiscard]] virtual bool visitLookupNames(
+      const ReferenceInfo &context,
+      utils::function_ref<void(std::string_view name)> visitor) const {
+    (void)context;
+    (void)visitor;
+    return false;
+  }
 };
 
 } // namespace pegium::references
@@ -0,0 +1,77 @@
+#include <pegium/core/services/CompactDiagnostic.hpp>
+
+#include <utility>
+
+namespace pegium {
+
+CompactDiagnostic::CompactDiagnostic(Diagnostic diagnostic)
+    : severity(diagnostic.severity), begin(diagnostic.begin),
+      end(diagnostic.end), source(diagnostic.source),
+      text(std::move(diagnostic.message)) {
+  if (diagnostic.code.has_value()) {
+    if (const auto *number = std::get_if<std::int64_t>(&*diagnostic.code)) {
+      code = *number;
+    } else {
+      code = utils::InternedString(std::get<std::string>(*diagnostic.code));
+    }
+  }
+  if (diagnostic.codeDescription.has_value() || !diagnostic.tags.empty() ||
+      !diagnostic.relatedInformation.empty() || diagnostic.data.has_value()) {
+    details = std::make_shared<const Details>(Details{
+        .codeDescription = std::move(diagnostic.codeDescription),
+        .tags = std::move(diagnostic.tags),
+        .relatedInformation = std::move(diagnostic.relatedInformation),
+        .data = std::move(diagnostic.data)});
+  }
+}
+
+std::string CompactDiagnostic::message() const {
+  return messageTemplate != nullptr && messageTemplate->message != nullptr
+             ? messageTemplate->message({.interned = arguments, .text = text})
+             : text;
+}
+
+std::optional<JsonValue> CompactDiagnostic::data() const {
+  if (details != nullptr && details->data.has_value()) {
+    return details->data;
+  }
+  if (messageTemplate != nullptr && messageTemplate->data != nullptr) {
+    return messageTemplate->data({.interned = arguments, .text = text});
+  }
+  return std::nullopt;
+}
+
+Diagnostic CompactDiagnostic::materialize() const {
+  Diagnostic diagnostic{.severity = severity,
+                        .message = message(),
+                        .source = source.str(),
+                        .data = data(),
+                        .begin = begin,
+                        .end = end};
+  if (code.has_value()) {
+    if (const auto *number = std::get_if<std::int64_t>(&*code)) {
+      diagnostic.code = DiagnosticCode(*number);
+    } else {
+      diagnostic.code =
+          DiagnosticCode(std::get<utils::InternedString>(*code).str());
+    }
+  }
+  if (details != nullptr) {
+    diagnostic.codeDescription = details->codeDescription;
+    diagnostic.tags = details->tags;
+    diagnostic.relatedInformation = details->relatedInformation;
+  }
+  return diagnostic;
+}
+
+std::vector<Diagnostic>
+materialize(std::span<const CompactDiagnostic> diagnostics) {
+  std::vector<Diagnostic> materialized;
+  materialized.reserve(diagnostics.size());
+  for (const auto &diagnostic : diagnostics) {
+    materialized.push_back(diagnostic.materialize());
+  }
+  return materialized;
+}
+
+} // namespace pegium
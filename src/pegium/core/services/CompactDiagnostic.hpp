@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <pegium/core/services/Diagnostic.hpp>
+#include <pegium/core/services/JsonValue.hpp>
+#include <pegium/core/utils/StringInterner.hpp>
+
+namespace pegium {
+
+/// Renders the message, and optionally the `data`, of diagnostics from their
+/// arguments. Its address identifies the message kind: templates are static
+/// objects outliving every diagnostic that uses them.
+struct DiagnosticTemplate {
+  /// Arguments of one diagnostic: interned ones, drawn from small sets such as
+  /// type or property names, and `text`, an owned one for anything else, such
+  /// as source text.
+  struct Arguments {
+    std::span<const utils::InternedString> interned;
+    std::string_view text;
+  };
+
+  std::string (*message)(Arguments arguments) = nullptr;
+  std::optional<JsonValue> (*data)(Arguments arguments) = nullptr;
+};
+
+/// `DiagnosticCode` whose string form is interned.
+using CompactDiagnosticCode = std::variant<std::int64_t, utils::InternedString>;
+
+/// Document-held form of a `Diagnostic`.
+///
+/// Source and code are interned. A diagnostic built from a
+/// `DiagnosticTemplate` keeps only its arguments, inline, and renders its
+/// message and `data` when materialised, typically when it is published. The
+/// rarely set fields of a compacted `Diagnostic` live in one shared block.
+struct CompactDiagnostic {
+  /// Number of interned template arguments a diagnostic can hold.
+  static constexpr std::size_t kMaxArguments = 3;
+
+  /// Fields of a compacted `Diagnostic` without a compact form.
+  struct Details {
+    std::optional<std::string> codeDescription;
+    std::vector<DiagnosticTag> tags;
+    std::vector<DiagnosticRelatedInformation> relatedInformation;
+    std::optional<JsonValue> data;
+  };
+
+  DiagnosticSeverity severity = DiagnosticSeverity::Error;
+  TextOffset begin = 0;
+  TextOffset end = 0;
+  utils::InternedString source;
+  std::optional<CompactDiagnosticCode> code;
+  /// Renders the message and data from `arguments` and `text` when not null;
+  /// `text` is the message otherwise.
+  const DiagnosticTemplate *messageTemplate = nullptr;
+  std::array<utils::InternedString, kMaxArguments> arguments{};
+  std::string text;
+  /// Null when the diagnostic has none of these fields.
+  std::shared_ptr<const Details> details;
+
+  CompactDiagnostic() = default;
+
+  /// Compacts an already rendered diagnostic.
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  CompactDiagnostic(Diagnostic diagnostic);
+
+  /// Returns the rendered message.
+  [[nodiscard]] std::string message() const;
+
+  /// Returns the rendered `Diagnostic::data`.
+  [[nodiscard]] std::optional<JsonValue> data() const;
+
+  /// Returns the full `Diagnostic`, rendering the message and data.
+  [[nodiscard]] Diagnostic materialize() const;
+};
+
+/// Materialises every diagnostic of `diagnostics`.
+[[nodiscard]] std::vector<Diagnostic>
+materialize(std::span<const CompactDiagnostic> diagnostics);
+
+} // namespace pegium
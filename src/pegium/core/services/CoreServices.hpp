@@ -17,6 +17,7 @@
 #include <pegium/core/references/ScopeComputation.hpp>
 #include <pegium/core/references/ScopeProvider.hpp>
 #include <pegium/core/validation/DocumentValidator.hpp>
+#include <pegium/core/validation/ValidationCache.hpp>
 #include <pegium/core/validation/ValidationRegistry.hpp>
 #include <pegium/core/workspace/AstNodeDescriptionProvider.hpp>
 #include <pegium/core/workspace/ReferenceDescriptionProvider.hpp>
@@ -60,6 +61,9 @@ struct ValidationServices {
   std::unique_ptr<validation::ValidationRegistry> validationRegistry;
   // Required for a complete language service; installed by default.
   std::unique_ptr<validation::DocumentValidator> documentValidator;
+  // Optional; when provided, subtree-local check results are shared across
+  // the documents of the language.
+  std::unique_ptr<validation::ValidationCache> validationCache;
 };
 
 /// Workspace-facing services owned by one language.
@@ -97,6 +101,11 @@ struct CoreServices {
 
   [[nodiscard]] virtual bool isComplete() const noexcept;
 
+  /// Called by the service registry when a new registration of the same
+  /// language replaces these services. Detaches them from the shared events
+  /// they observe; callers that still hold the container can keep using it.
+  virtual void retire() noexcept {}
+
   LanguageMetaData languageMetaData;
   const SharedCoreServices &shared;
 
@@ -8,10 +8,25 @@
 #include <pegium/core/services/CoreServices.hpp>
 #include <pegium/core/utils/Errors.hpp>
 #include <pegium/core/utils/UriUtils.hpp>
+#include <pegium/core/workspace/Document.hpp>
 
 namespace pegium {
 namespace {
 
+// Document bindings pack the mappings generation above the registration slot,
+// so one atomic word identifies both; `0` is never a valid binding.
+constexpr unsigned kBindingSlotBits = 16;
+constexpr std::uint64_t kBindingSlotMask =
+    (std::uint64_t{1} << kBindingSlotBits) - 1;
+
+std::uint64_t encode_binding(std::uint64_t generation, std::size_t slot) {
+  const auto encodedSlot = static_cast<std::uint64_t>(slot) + 1;
+  if (encodedSlot > kBindingSlotMask) {
+    return 0;
+  }
+  return (generation << kBindingSlotBits) | encodedSlot;
+}
+
 const CoreServices *lookup_by_language_id_locked(
     const utils::TransparentStringMap<std::unique_ptr<CoreServices>>
         &servicesByLanguageId,
@@ -20,6 +35,13 @@ const CoreServices *lookup_by_language_id_locked(
   return it == servicesByLanguageId.end() ? nullptr : it->second.get();
 }
 
+template <typename Map>
+std::optional<std::size_t> find_slot(const Map &slots, std::string_view key) {
+  const auto it = slots.find(key);
+  return it == slots.end() ? std::nullopt
+                           : std::optional<std::size_t>(it->second);
+}
+
 std::string language_error_message(std::string_view extension,
                                    std::string_view languageId) {
   if (languageId.empty()) {
@@ -43,6 +65,26 @@ void publish_language_mapping_collision(
 
 } // namespace
 
+// Marks a lookup as reading `_mappings` for its lifetime. Paired with the
+// sequentially consistent publish in `publishMappingsLocked`: a registration
+// that reads no active lookup after swapping the snapshot knows every later
+// lookup sees the new one.
+class DefaultServiceRegistry::LookupGuard {
+public:
+  explicit LookupGuard(const DefaultServiceRegistry &registry) noexcept
+      : _activeLookups(registry._activeLookups) {
+    _activeLookups.fetch_add(1, std::memory_order_seq_cst);
+  }
+  ~LookupGuard() noexcept {
+    _activeLookups.fetch_sub(1, std::memory_order_release);
+  }
+  LookupGuard(const LookupGuard &) = delete;
+  LookupGuard &operator=(const LookupGuard &) = delete;
+
+private:
+  std::atomic<std::size_t> &_activeLookups;
+};
+
 void DefaultServiceRegistry::registerServices(
     std::unique_ptr<CoreServices> services) {
   if (!services) {
@@ -75,16 +117,58 @@ void DefaultServiceRegistry::registerServices(
     _registrationOrder.push_back(languageId);
   } else if (it->second != nullptr) {
     removeLanguageMappingsLocked(languageId, *it->second);
+    // Callers may still hold the previous services: detach them from the
+    // shared events but keep them alive.
+    it->second->retire();
+    _replacedServices.push_back(std::move(it->second));
   }
 
   it->second = std::move(services);
   addLanguageMappingsLocked(languageId, *it->second);
+  publishMappingsLocked();
+}
+
+void DefaultServiceRegistry::publishMappingsLocked() {
+  const auto *previous = _mappings.load(std::memory_order_relaxed);
+  auto mappings = std::make_unique<Mappings>();
+  mappings->generation = previous == nullptr ? 1 : previous->generation + 1;
+  mappings->services.reserve(_registrationOrder.size());
+  for (const auto &languageId : _registrationOrder) {
+    mappings->slotByLanguageId.emplace(languageId, mappings->services.size());
+    mappings->services.push_back(
+        lookup_by_language_id_locked(_servicesByLanguageId, languageId));
+  }
+  for (const auto &[extension, languageId] : _languageIdByExtension) {
+    if (const auto slot = find_slot(mappings->slotByLanguageId, languageId)) {
+      mappings->slotByExtension.emplace(extension, *slot);
+    }
+  }
+  for (const auto &[fileName, languageId] : _languageIdByFileName) {
+    if (const auto slot = find_slot(mappings->slotByLanguageId, languageId)) {
+      mappings->slotByFileName.emplace(fileName, *slot);
+    }
+  }
+
+  _mappings.store(mappings.get(), std::memory_order_seq_cst);
+  if (_currentMappings != nullptr) {
+    _retiredMappings.push_back(std::move(_currentMappings));
+  }
+  _currentMappings = std::move(mappings);
+  if (_activeLookups.load(std::memory_order_seq_cst) == 0) {
+    _retiredMappings.clear();
+  }
+}
+
+std::size_t DefaultServiceRegistry::retiredServicesCount() const {
+  std::scoped_lock lock(_mutex);
+  return _replacedServices.size();
 }
 
 const CoreServices &
 DefaultServiceRegistry::getServices(std::string_view uri) const {
-  std::scoped_lock lock(_mutex);
-  if (_servicesByLanguageId.empty()) {
+  const LookupGuard guard(*this);
+  const auto *mappings = _mappings.load(std::memory_order_seq_cst);
+  if (mappings == nullptr) {
     throw utils::ServiceRegistryError(
         "The service registry is empty. Use `registerServices` to register "
         "the services of a language.");
@@ -92,13 +176,13 @@ DefaultServiceRegistry::getServices(std::string_view uri) const {
 
   const auto normalizedUri = utils::normalize_uri(uri);
   std::string languageId;
-  if (const auto *services = findServicesLocked(normalizedUri, &languageId)) {
-    return *services;
+  if (const auto slot = findSlot(*mappings, normalizedUri, &languageId)) {
+    return *mappings->services[*slot];
   }
 
-  // findServicesLocked already queried the file-name and extension maps under
-  // the same held lock with identical inputs and missed; only the extension is
-  // still needed to build the error message below.
+  // findSlot already queried the file-name and extension maps of the same
+  // snapshot with identical inputs and missed; only the extension is still
+  // needed to build the error message below.
   const auto path = utils::file_uri_to_path(normalizedUri);
   const auto extension = path.has_value()
                              ? std::filesystem::path(*path).extension().string()
@@ -109,31 +193,57 @@ DefaultServiceRegistry::getServices(std::string_view uri) const {
       language_error_message(extension, languageId));
 }
 
+const CoreServices &
+DefaultServiceRegistry::getServices(const workspace::Document &document) const {
+  const LookupGuard guard(*this);
+  const auto *mappings = _mappings.load(std::memory_order_seq_cst);
+  if (mappings == nullptr) {
+    return getServices(document.uri);
+  }
+
+  if (const auto binding = document.servicesBinding();
+      binding != 0 && (binding >> kBindingSlotBits) == mappings->generation) {
+    return *mappings->services[(binding & kBindingSlotMask) - 1];
+  }
+
+  // Bind to the language the document was analyzed with, which may differ
+  // from what the URI resolves to while a newer text document is pending.
+  auto slot = find_slot(mappings->slotByLanguageId,
+                        document.textDocument().languageId());
+  if (!slot.has_value()) {
+    slot = findSlot(*mappings, utils::normalize_uri(document.uri));
+  }
+  if (!slot.has_value()) {
+    return getServices(document.uri);
+  }
+  document.cacheServicesBinding(encode_binding(mappings->generation, *slot));
+  return *mappings->services[*slot];
+}
+
 const CoreServices *
 DefaultServiceRegistry::findServices(std::string_view uri) const {
-  std::scoped_lock lock(_mutex);
-  if (_servicesByLanguageId.empty()) {
+  const LookupGuard guard(*this);
+  const auto *mappings = _mappings.load(std::memory_order_seq_cst);
+  if (mappings == nullptr) {
     return nullptr;
   }
-  return findServicesLocked(utils::normalize_uri(uri));
+  const auto slot = findSlot(*mappings, utils::normalize_uri(uri));
+  return slot.has_value() ? mappings->services[*slot] : nullptr;
 }
 
 std::vector<const CoreServices *> DefaultServiceRegistry::all() const {
-  std::scoped_lock lock(_mutex);
-  std::vector<const CoreServices *> services;
-  services.reserve(_registrationOrder.size());
-  for (const auto &languageId : _registrationOrder) {
-    if (const auto *service =
-            lookup_by_language_id_locked(_servicesByLanguageId, languageId);
-        service != nullptr) {
-      services.push_back(service);
-    }
+  const LookupGuard guard(*this);
+  const auto *mappings = _mappings.load(std::memory_order_seq_cst);
+  if (mappings == nullptr) {
+    return {};
   }
-  return services;
+  return mappings->services;
 }
 
-const CoreServices *DefaultServiceRegistry::findServicesLocked(
-    std::string_view normalizedUri, std::string *languageId) const {
+std::optional<std::size_t>
+DefaultServiceRegistry::findSlot(const Mappings &mappings,
+                                 std::string_view normalizedUri,
+                                 std::string *languageId) const {
   if (const auto provider = shared.workspace.textDocuments;
       provider != nullptr) {
     if (auto textDocument = provider->getNormalized(normalizedUri);
@@ -141,10 +251,9 @@ const CoreServices *DefaultServiceRegistry::findServicesLocked(
       if (languageId != nullptr) {
         *languageId = textDocument->languageId();
       }
-      if (const auto *services =
-              lookup_by_language_id_locked(_servicesByLanguageId,
-                                           textDocument->languageId())) {
-        return services;
+      if (const auto slot = find_slot(mappings.slotByLanguageId,
+                                      textDocument->languageId())) {
+        return slot;
       }
     }
   }
@@ -156,8 +265,8 @@ const CoreServices *DefaultServiceRegistry::findServicesLocked(
                                       .filename()
                                       .string();
       !fileName.empty()) {
-    if (const auto *services = lookupByFileName(fileName)) {
-      return services;
+    if (const auto slot = find_slot(mappings.slotByFileName, fileName)) {
+      return slot;
     }
   }
 
@@ -166,26 +275,8 @@ const CoreServices *DefaultServiceRegistry::findServicesLocked(
                              : std::filesystem::path(std::string(normalizedUri))
                                    .extension()
                                    .string();
-  return lookupByExtension(extension);
-}
-
-const CoreServices *
-DefaultServiceRegistry::lookupByExtension(std::string_view extension) const {
-  const auto languageIt =
-      _languageIdByExtension.find(utils::normalize_extension(extension));
-  if (languageIt == _languageIdByExtension.end()) {
-    return nullptr;
-  }
-  return lookup_by_language_id_locked(_servicesByLanguageId, languageIt->second);
-}
-
-const CoreServices *
-DefaultServiceRegistry::lookupByFileName(std::string_view fileName) const {
-  const auto languageIt = _languageIdByFileName.find(fileName);
-  if (languageIt == _languageIdByFileName.end()) {
-    return nullptr;
-  }
-  return lookup_by_language_id_locked(_servicesByLanguageId, languageIt->second);
+  return find_slot(mappings.slotByExtension,
+                   utils::normalize_extension(extension));
 }
 
 void DefaultServiceRegistry::removeLanguageMappingsLocked(
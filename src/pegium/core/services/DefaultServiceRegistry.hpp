@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -14,6 +18,17 @@
 namespace pegium {
 
 /// Default registry mapping URIs to their language service container.
+///
+/// Registrations are serialized and publish an immutable snapshot of the
+/// language mappings; lookups read the current snapshot without locking.
+/// A superseded snapshot is freed by the first later registration that sees
+/// no lookup in flight, so at most the snapshots published while lookups
+/// overlapped registrations are held.
+///
+/// Replaced services are retired (see `CoreServices::retire`) and kept until
+/// the registry is destroyed, because a returned reference may be held for as
+/// long as the caller needs it: memory grows by one container per
+/// re-registration of a language, which `retiredServicesCount` reports.
 class DefaultServiceRegistry : public ServiceRegistry,
                                protected DefaultSharedCoreService {
 public:
@@ -25,24 +40,44 @@ public:
 
   [[nodiscard]] const CoreServices &
   getServices(std::string_view uri) const override;
+  [[nodiscard]] const CoreServices &
+  getServices(const workspace::Document &document) const override;
   [[nodiscard]] const CoreServices *
   findServices(std::string_view uri) const override;
   [[nodiscard]] std::vector<const CoreServices *> all() const override;
 
+  /// Returns how many replaced service containers the registry still holds.
+  [[nodiscard]] std::size_t retiredServicesCount() const;
+
 private:
-  [[nodiscard]] const CoreServices *
-  findServicesLocked(std::string_view normalizedUri,
-                     std::string *languageId = nullptr) const;
-  [[nodiscard]] const CoreServices *
-  lookupByExtension(std::string_view extension) const;
-  [[nodiscard]] const CoreServices *
-  lookupByFileName(std::string_view fileName) const;
+  // Immutable view of the registrations, indexed by registration slot.
+  struct Mappings {
+    std::uint64_t generation = 0;
+    std::vector<const CoreServices *> services;
+    utils::TransparentStringMap<std::size_t> slotByLanguageId;
+    utils::TransparentStringMap<std::size_t> slotByExtension;
+    utils::TransparentStringMap<std::size_t> slotByFileName;
+  };
+
+  [[nodiscard]] std::optional<std::size_t>
+  findSlot(const Mappings &mappings, std::string_view normalizedUri,
+           std::string *languageId = nullptr) const;
+  void publishMappingsLocked();
   void removeLanguageMappingsLocked(std::string_view languageId,
                                    const CoreServices &services);
   void addLanguageMappingsLocked(std::string_view languageId,
                                  const CoreServices &services);
 
+  class LookupGuard;
+
   mutable std::mutex _mutex;
+  std::atomic<const Mappings *> _mappings = nullptr;
+  // Lookups currently reading `_mappings`; retired snapshots are only freed
+  // by a registration that observes none.
+  mutable std::atomic<std::size_t> _activeLookups = 0;
+  std::unique_ptr<const Mappings> _currentMappings;
+  std::vector<std::unique_ptr<const Mappings>> _retiredMappings;
+  std::vector<std::unique_ptr<CoreServices>> _replacedServices;
   utils::TransparentStringMap<std::unique_ptr<CoreServices>> _servicesByLanguageId;
   std::vector<std::string> _registrationOrder;
   utils::TransparentStringMap<std::string> _languageIdByExtension;
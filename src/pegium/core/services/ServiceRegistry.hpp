@@ -6,6 +6,10 @@
 
 #include <pegium/core/services/CoreServices.hpp>
 
+namespace pegium::workspace {
+struct Document;
+} // namespace pegium::workspace
+
 namespace pegium {
 
 /// Resolves the language service container associated with a document URI.
@@ -31,6 +35,18 @@ public:
   [[nodiscard]] virtual const CoreServices &
   getServices(std::string_view uri) const = 0;
 
+  /// Resolves the services bound to a managed document.
+  ///
+  /// The first call resolves the language of the attached text document (or,
+  /// failing that, `document.uri` as above) and caches the result on the
+  /// document; later calls reuse it until a registration changes the language
+  /// mappings or a text document of another language is attached. Safe to call
+  /// concurrently, including for the same document.
+  ///
+  /// Throws when no language can be resolved for the document.
+  [[nodiscard]] virtual const CoreServices &
+  getServices(const workspace::Document &document) const = 0;
+
   /// Resolves the services for a document URI.
   ///
   /// Returns `nullptr` when no registered language matches `uri`. May throw on
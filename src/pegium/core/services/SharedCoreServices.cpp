@@ -7,6 +7,7 @@
 #include <pegium/core/workspace/DefaultConfigurationProvider.hpp>
 #include <pegium/core/workspace/DefaultDocumentBuilder.hpp>
 #include <pegium/core/workspace/DefaultDocumentFactory.hpp>
+#include <pegium/core/workspace/DefaultDocumentResidency.hpp>
 #include <pegium/core/workspace/DefaultDocuments.hpp>
 #include <pegium/core/workspace/DefaultIndexManager.hpp>
 #include <pegium/core/workspace/DefaultWorkspaceLock.hpp>
@@ -64,6 +65,10 @@ void installDefaultSharedCoreServices(SharedCoreServices &sharedServices) {
     sharedServices.workspace.documentBuilder =
         std::make_unique<workspace::DefaultDocumentBuilder>(sharedServices);
   }
+  if (!sharedServices.workspace.documentResidency) {
+    sharedServices.workspace.documentResidency =
+        std::make_unique<workspace::DefaultDocumentResidency>(sharedServices);
+  }
   if (!sharedServices.workspace.workspaceLock) {
     sharedServices.workspace.workspaceLock =
         std::make_unique<workspace::DefaultWorkspaceLock>();
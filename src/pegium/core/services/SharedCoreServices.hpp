@@ -9,6 +9,7 @@
 #include <pegium/core/workspace/Configuration.hpp>
 #include <pegium/core/workspace/DocumentBuilder.hpp>
 #include <pegium/core/workspace/DocumentFactory.hpp>
+#include <pegium/core/workspace/DocumentResidency.hpp>
 #include <pegium/core/workspace/Documents.hpp>
 #include <pegium/core/workspace/IndexManager.hpp>
 #include <pegium/core/workspace/TextDocumentProvider.hpp>
@@ -37,6 +38,8 @@ struct SharedCoreWorkspaceServices {
   std::unique_ptr<workspace::IndexManager> indexManager;
   // Shared core service; installed by default for standard Pegium setups.
   std::unique_ptr<workspace::DocumentBuilder> documentBuilder;
+  // Optional shared core service; installed by default, with no memory budget.
+  std::unique_ptr<workspace::DocumentResidency> documentResidency;
   // Optional shared core provider; published by the shared LSP text manager.
   std::shared_ptr<workspace::TextDocumentProvider> textDocuments;
   // Shared core service; installed by default for standard Pegium setups.
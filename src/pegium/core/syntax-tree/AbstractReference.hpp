@@ -11,6 +11,7 @@
 #include <pegium/core/references/Linker.hpp>
 #include <pegium/core/syntax-tree/CstNodeView.hpp>
 #include <pegium/core/syntax-tree/ReferenceInfo.hpp>
+#include <pegium/core/utils/FunctionRef.hpp>
 #include <pegium/core/workspace/Symbol.hpp>
 
 namespace pegium {
@@ -42,6 +43,27 @@ private:
   const AbstractReference *_reference = nullptr;
 };
 
+/// Defers the resolution cycles the calling thread meets while alive, for the
+/// caller to settle them afterwards in a sequential pass: instead of publishing
+/// `ErrorCycle` on the reference whose resolution closed the cycle, which
+/// depends on thread timing, every reference the thread is resolving goes back
+/// to `Unresolved` and `CyclicReferenceResolution` reaches the caller. Waiting
+/// on a reference whose resolver went back to `Unresolved` unwinds the same
+/// way.
+class DeferCyclicResolutions {
+public:
+  DeferCyclicResolutions() noexcept;
+  DeferCyclicResolutions(const DeferCyclicResolutions &) = delete;
+  DeferCyclicResolutions &operator=(const DeferCyclicResolutions &) = delete;
+  ~DeferCyclicResolutions();
+
+  /// Whether the calling thread defers the cycles it meets.
+  [[nodiscard]] static bool active() noexcept;
+
+private:
+  bool _previous;
+};
+
 /// Non-owning handle to a concrete reference stored inside an AST object.
 ///
 /// `ReferenceHandle` lets generic services enumerate references without knowing
@@ -233,6 +255,12 @@ public:
   /// Returns an empty string when the reference is not in an error state.
   [[nodiscard]] std::string getErrorMessage() const;
 
+  /// Formats the message `getErrorMessage()` returns for a reference in
+  /// `state`; `typeName` is empty when the reference type is unknown.
+  [[nodiscard]] static std::string
+  formatErrorMessage(ReferenceState state, std::string_view typeName,
+                     std::string_view feature, std::string_view refText);
+
   virtual void clearLinkState() const noexcept = 0;
 
   /// Forces resolution to run for its side effects (populating the cached
@@ -240,6 +268,20 @@ public:
   /// linker's warm-up pass to resolve every reference up front.
   virtual void forceResolve() const = 0;
 
+  /// Re-points a resolved reference at the nodes now registered under its
+  /// resolved descriptions, e.g. after the target document was reparsed with
+  /// unchanged exports. `reload` returns the node for a description, with the
+  /// description now exporting that node when it replaces the resolved one
+  /// (e.g. its symbol id moved), or a null node when it no longer exists.
+  /// Returns `false`, leaving the reference untouched, when some target cannot
+  /// be reloaded; references that are not resolved have nothing to rebind and
+  /// return `true`. Caller must guarantee no concurrent reader (typically the
+  /// builder, during a workspace write).
+  virtual bool rebindTargets(
+      utils::function_ref<workspace::ResolvedAstNodeDescription(
+          const workspace::AstNodeDescription &)>
+          reload) const = 0;
+
   [[nodiscard]] bool isMultiReference() const noexcept { return _isMulti; }
 
   void initialize(AstNode &container, std::string refText,
@@ -314,7 +356,9 @@ protected:
   /// Throws `CyclicReferenceResolution` when the same thread re-enters this
   /// method while still owning the resolver role for the same reference,
   /// indicating that resolving the target recursively requires the target
-  /// itself.
+  /// itself, or when waiting would close a cycle of threads each waiting on a
+  /// reference another one resolves. Under `DeferCyclicResolutions`, also
+  /// throws when the awaited resolver went back to `Unresolved`.
   bool acquireResolverRole() const {
     using enum ReferenceState;
     auto state = _state.load(std::memory_order_acquire);
@@ -327,10 +371,11 @@ protected:
             std::this_thread::get_id()) {
           throw CyclicReferenceResolution(*this);
         }
-        _waiterCount.fetch_add(1, std::memory_order_acq_rel);
-        _state.wait(state, std::memory_order_acquire);
-        _waiterCount.fetch_sub(1, std::memory_order_acq_rel);
+        waitForResolver(state);
         state = _state.load(std::memory_order_acquire);
+        if (state == Unresolved && DeferCyclicResolutions::active()) {
+          throw CyclicReferenceResolution(*this);
+        }
         continue;
       }
       if (_state.compare_exchange_weak(state, Resolving,
@@ -343,13 +388,19 @@ protected:
     }
   }
 
+  /// Blocks until the thread resolving this reference publishes a state other
+  /// than `state`. Throws `CyclicReferenceResolution` instead when that thread
+  /// waits, directly or through other threads, on the calling thread.
+  void waitForResolver(ReferenceState state) const;
+
   /// Runs the one-shot resolution protocol shared by every concrete reference,
   /// keeping the resolver-liveness invariant in a single place. Acquires the
   /// resolver role (returning early when another thread already published a
   /// terminal state), guards against a missing linker, then runs `doResolve`,
   /// which performs the linker call and publishes either an error (via
   /// `applyLinkingError`) or `Resolved`. A cyclic resolution publishes
-  /// `ErrorCycle`; any other exception runs `onFail` (caller-specific cleanup),
+  /// `ErrorCycle`, or `Unresolved` and rethrows under `DeferCyclicResolutions`;
+  /// any other exception runs `onFail` (caller-specific cleanup),
   /// publishes `ErrorException` so waiters never strand at `Resolving`, then
   /// rethrows.
   template <typename DoResolve, typename OnFail>
@@ -364,6 +415,11 @@ protected:
     try {
       doResolve();
     } catch (const CyclicReferenceResolution &) {
+      if (DeferCyclicResolutions::active()) {
+        onFail();
+        publishState(ReferenceState::Unresolved);
+        throw;
+      }
       applyLinkingError(workspace::LinkingErrorKind::Cycle);
     } catch (...) {
       onFail();
@@ -392,6 +448,14 @@ public:
   /// Callers must only use this after the reference reached `Resolved`.
   [[nodiscard]] virtual const workspace::AstNodeDescription &
   resolvedDescription() const = 0;
+
+  /// Resolves this reference to `resolution` instead of asking the linker, for
+  /// a resolution computed for another reference that sees the same scope,
+  /// reference type and text. Follows the same protocol as a regular
+  /// resolution: does nothing once a terminal state is published, and a
+  /// re-entrant call publishes `ErrorCycle`.
+  virtual void forceResolveWith(
+      const workspace::ResolvedAstNodeDescriptionOrError &resolution) const = 0;
 };
 
 class AbstractMultiReference : public AbstractReference {
@@ -5,6 +5,8 @@
 #include <concepts>
 #include <cstdint>
 #include <memory_resource>
+#include <typeindex>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -36,8 +38,13 @@ public:
 
   /// Constructs an arena bound to `cstRoot`. AST node memory is taken from
   /// the CST root's pool to avoid a second monotonic buffer chain.
-  explicit AstArena(RootCstNode &cstRoot) noexcept
-      : _pool(cstRoot.memoryResource()), _cstRoot(std::addressof(cstRoot)) {}
+  ///
+  /// Nodes get their dense type id (`AstNode::typeId()`) from `reflection`
+  /// when it is given.
+  explicit AstArena(RootCstNode &cstRoot,
+                    const AstReflection *reflection = nullptr) noexcept
+      : _pool(cstRoot.memoryResource()), _cstRoot(std::addressof(cstRoot)),
+        _reflection(reflection) {}
 
   ~AstArena() noexcept { destroyAll(); }
 
@@ -51,10 +58,19 @@ public:
 
   /// Attaches the workspace document that owns this arena and the reflection
   /// registry used by `pegium::ast_cast` / `pegium::is_a`.
+  ///
+  /// Switching to another reflection re-assigns the type id of every node.
   void attachDocument(const workspace::Document &document,
                       const AstReflection *reflection = nullptr) noexcept {
     _document = std::addressof(document);
-    _reflection = reflection;
+    if (reflection != _reflection) {
+      _reflection = reflection;
+      for (NodeId id = 0; id < _count; ++id) {
+        const auto *node = _chunks[id >> chunk_shift][id & chunk_mask];
+        _typeIdChunks[id >> chunk_shift][id & chunk_mask] =
+            typeIdOf(std::type_index(typeid(*node)));
+      }
+    }
   }
 
   /// Returns the attached workspace document, or nullptr when standalone.
@@ -85,7 +101,7 @@ public:
     auto *obj = ::new (mem) T(std::forward<Args>(args)...);
     obj->_symbolId = id;
     obj->_arena = this;
-    storeNode(obj);
+    storeNode(obj, typeIdOf(std::type_index(typeid(T))));
     return obj;
   }
 
@@ -98,6 +114,15 @@ public:
     return _chunks[id >> chunk_shift][id & chunk_mask];
   }
 
+  /// Returns the dense type id (see `AstNode::typeId()`) of the node owning
+  /// `id`, or `kNoAstType` if the id is out of range.
+  [[nodiscard]] AstTypeId typeId(NodeId id) const noexcept {
+    if (id >= _count) {
+      return kNoAstType;
+    }
+    return _typeIdChunks[id >> chunk_shift][id & chunk_mask];
+  }
+
   /// Returns the number of nodes currently owned by this arena.
   [[nodiscard]] NodeId size() const noexcept { return _count; }
 
@@ -118,18 +143,31 @@ private:
   void ensureChunkCapacity() {
     if (static_cast<std::size_t>(_count >> chunk_shift) == _chunks.size())
         [[unlikely]] {
-      _chunks.push_back(static_cast<AstNode **>(_pool->allocate(
-          sizeof(AstNode *) * chunk_size, alignof(AstNode *))));
+      // Everything that can throw runs before either vector grows, so the two
+      // stay the same length.
+      _chunks.reserve(_chunks.size() + 1U);
+      _typeIdChunks.reserve(_typeIdChunks.size() + 1U);
+      auto *nodes = static_cast<AstNode **>(
+          _pool->allocate(sizeof(AstNode *) * chunk_size, alignof(AstNode *)));
+      auto *typeIds = static_cast<AstTypeId *>(
+          _pool->allocate(sizeof(AstTypeId) * chunk_size, alignof(AstTypeId)));
+      _chunks.push_back(nodes);
+      _typeIdChunks.push_back(typeIds);
     }
   }
 
   // Records an already-constructed node. noexcept: ensureChunkCapacity() has
   // guaranteed the slot exists.
-  void storeNode(AstNode *node) noexcept {
+  void storeNode(AstNode *node, AstTypeId typeId) noexcept {
     _chunks[_count >> chunk_shift][_count & chunk_mask] = node;
+    _typeIdChunks[_count >> chunk_shift][_count & chunk_mask] = typeId;
     ++_count;
   }
 
+  [[nodiscard]] AstTypeId typeIdOf(std::type_index type) const noexcept {
+    return _reflection != nullptr ? _reflection->typeId(type) : kNoAstType;
+  }
+
   void destroyAll() noexcept {
     // LIFO destruction. The CST root owns the underlying pool buffers.
     for (NodeId i = _count; i > 0; --i) {
@@ -143,6 +181,8 @@ private:
 
   std::pmr::memory_resource *_pool;
   std::vector<AstNode **> _chunks;
+  // Dense type id of each node, in slots parallel to `_chunks`.
+  std::vector<AstTypeId *> _typeIdChunks;
   NodeId _count = 0;
   RootCstNode *_cstRoot;
   const workspace::Document *_document = nullptr;
@@ -9,4 +9,8 @@ const AstReflection *ast_reflection_of(const AstNode &node) noexcept {
   return arena != nullptr ? arena->reflection() : nullptr;
 }
 
+AstTypeId AstNode::typeId() const noexcept {
+  return _arena != nullptr ? _arena->typeId(_symbolId) : kNoAstType;
+}
+
 } // namespace pegium
@@ -135,6 +135,28 @@ struct AstNode {
     return of_type<T>(getAllContent());
   }
 
+  /// Visits the descendants of this node in the order of `getAllContent()`,
+  /// skipping the descendants of every node for which `visitor` returns
+  /// false. Walks the sibling and container links, without allocating.
+  template <typename Visitor>
+    requires std::predicate<Visitor &, const AstNode &>
+  void visitDescendants(Visitor &&visitor) const {
+    const AstNode *current = _firstChild;
+    while (current != nullptr) {
+      if (visitor(*current) && current->_firstChild != nullptr) {
+        current = current->_firstChild;
+        continue;
+      }
+      while (current->_nextSibling == nullptr) {
+        current = current->_container;
+        if (current == this) {
+          return;
+        }
+      }
+      current = current->_nextSibling;
+    }
+  }
+
   /// Returns `true` when this AST node is associated with a CST node.
   [[nodiscard]] bool hasCstNode() const noexcept {
     return _cstNodeId != kNoNode;
@@ -218,6 +240,14 @@ struct AstNode {
   /// constructed node not yet placed in an arena.
   [[nodiscard]] AstArena *arena() const noexcept { return _arena; }
 
+  /// Returns the dense id of this node's dynamic type in the reflection
+  /// registry of its arena (`AstArena::reflection()`), or `kNoAstType` when
+  /// the node has no arena, the arena no reflection, or the type is unknown.
+  ///
+  /// The id lives in the arena, next to the node's slot, so that `AstNode`
+  /// stays compact.
+  [[nodiscard]] AstTypeId typeId() const noexcept;
+
 private:
   friend class AstArena;
 
@@ -372,14 +402,18 @@ concept DefaultConstructibleAstNode =
 template <typename T>
   requires std::derived_from<T, AstNode>
 [[nodiscard]] bool is_a(const AstNode &node) noexcept {
-  if (const auto *reflection = ast_reflection_of(node);
-      reflection != nullptr &&
-      reflection->isKnown(std::type_index(typeid(T)))) {
-    // Call isSubtype directly (rather than the out-of-line isInstance) so the
-    // whole type check inlines on this hot path; typeid(node) is resolved here,
-    // where AstNode is a complete type.
-    return reflection->isSubtype(std::type_index(typeid(node)),
-                                 std::type_index(typeid(T)));
+  if (const auto *reflection = ast_reflection_of(node); reflection != nullptr) {
+    if (const auto expected = reflection->typeId(std::type_index(typeid(T)));
+        expected != kNoAstType) {
+      // The node carries its own type id, so the check is one bit test; call
+      // isSubtype directly (rather than the out-of-line isInstance) so it
+      // inlines on this hot path.
+      if (const auto actual = node.typeId(); actual != kNoAstType) {
+        return reflection->isSubtype(actual, expected);
+      }
+      return reflection->isSubtype(std::type_index(typeid(node)),
+                                   std::type_index(typeid(T)));
+    }
   }
   // No reflection, or `T` is an abstract base the grammar never names: fall back
   // to C++ RTTI, which can answer where the grammar-derived table cannot.
@@ -402,13 +436,17 @@ template <typename T, typename U>
   if (ptr == nullptr) {
     return nullptr;
   }
-  if (const auto *reflection = ast_reflection_of(*ptr);
-      reflection != nullptr &&
-      reflection->isKnown(std::type_index(typeid(T)))) {
-    return reflection->isSubtype(std::type_index(typeid(*ptr)),
-                                 std::type_index(typeid(T)))
-               ? static_cast<T *>(ptr)
-               : nullptr;
+  if (const auto *reflection = ast_reflection_of(*ptr); reflection != nullptr) {
+    if (const auto expected = reflection->typeId(std::type_index(typeid(T)));
+        expected != kNoAstType) {
+      const auto actual = ptr->typeId();
+      const bool matches =
+          actual != kNoAstType
+              ? reflection->isSubtype(actual, expected)
+              : reflection->isSubtype(std::type_index(typeid(*ptr)),
+                                      std::type_index(typeid(T)));
+      return matches ? static_cast<T *>(ptr) : nullptr;
+    }
   }
   // No reflection, or `T` is an abstract base the grammar never names (so the
   // reflection cannot answer): C++ RTTI always can.
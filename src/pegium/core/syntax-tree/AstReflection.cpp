@@ -1,6 +1,8 @@
 #include <pegium/core/syntax-tree/AstReflection.hpp>
 
+#include <algorithm>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
 #include <pegium/core/syntax-tree/AstNode.hpp>
@@ -66,18 +68,75 @@ void AstReflection::registerSubtype(std::type_index subtype,
       }
       if (supertypes.insert(knownSupertype).second) {
         _subtypesByType[knownSupertype].insert(knownSubtype);
+        setSupertypeBit(knownSubtype, knownSupertype);
       }
     }
   }
 }
 
+void AstReflection::registerContainment(std::type_index container,
+                                        std::type_index child) {
+  if (!is_valid_type(container) || !is_valid_type(child)) {
+    return;
+  }
+  registerType(container);
+  registerType(child);
+  const std::pair edge{_idsByType.at(container), _idsByType.at(child)};
+  if (std::ranges::find(_containments, edge) == _containments.end()) {
+    _containments.push_back(edge);
+  }
+}
+
+void AstReflection::sealContainment(std::type_index type) {
+  if (!is_valid_type(type)) {
+    return;
+  }
+  registerType(type);
+  const auto id = _idsByType.at(type);
+  if (_sealed.size() <= id) {
+    _sealed.resize(id + 1U, false);
+  }
+  _sealed[id] = true;
+}
+
 void AstReflection::registerTypeInternal(std::type_index type) {
   if (!is_valid_type(type)) {
     return;
   }
-  _types.insert(type);
+  if (!_types.insert(type).second) {
+    return;
+  }
   // Reflexive self-edge: idempotent, always present after registration.
   _subtypesByType[type].insert(type);
+
+  const auto id = static_cast<AstTypeId>(_typesById.size());
+  _idsByType.emplace(type, id);
+  _typesById.push_back(type);
+  if (_typesById.size() > _bitsStride * 64U) {
+    // Widen every row; registration is a bootstrap concern, so the copy is
+    // paid once per 64 types.
+    const auto stride = _bitsStride + 1U;
+    std::vector<std::uint64_t> widened(stride * _typesById.size(), 0U);
+    for (std::size_t row = 0; row + 1U < _typesById.size(); ++row) {
+      std::copy_n(_supertypeBits.begin() +
+                      static_cast<std::ptrdiff_t>(row * _bitsStride),
+                  _bitsStride,
+                  widened.begin() + static_cast<std::ptrdiff_t>(row * stride));
+    }
+    _supertypeBits = std::move(widened);
+    _bitsStride = stride;
+  } else {
+    _supertypeBits.resize(_bitsStride * _typesById.size(), 0U);
+  }
+  setSupertypeBit(type, type);
+}
+
+void AstReflection::setSupertypeBit(std::type_index subtype,
+                                    std::type_index supertype) {
+  const auto subtypeId = _idsByType.at(subtype);
+  const auto supertypeId = _idsByType.at(supertype);
+  _supertypeBits[subtypeId * _bitsStride + supertypeId / 64U] |=
+      std::uint64_t{1} << (supertypeId % 64U);
 }
 
 } // namespace pegium
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <pegium/core/utils/TypeIndexHash.hpp>
 
@@ -11,6 +16,13 @@ namespace pegium {
 
 class AstNode;
 
+/// Dense id of a type registered in an `AstReflection`, assigned in
+/// registration order from 0.
+using AstTypeId = std::uint32_t;
+
+/// Id of a type unknown to the reflection registry.
+inline constexpr AstTypeId kNoAstType = ~AstTypeId{0};
+
 /// Set of `std::type_index`es using fast pointer-based hash and equality.
 using TypeIndexSet =
     std::unordered_set<std::type_index, utils::FastTypeIndexHash,
@@ -25,6 +37,11 @@ using TypeIndexSet =
 /// concrete `final` class, keeping the queries on the hot linking / cast path
 /// direct (non-virtual) and inlinable.
 ///
+/// Every registered type also gets a dense `AstTypeId`, and the transitive
+/// subtype relation is kept as a bit matrix over those ids, so hot paths that
+/// already hold ids (AST nodes store theirs, see `AstNode::typeId()`) answer
+/// `isSubtype` with a bit test and dispatch through arrays indexed by id.
+///
 /// Mutation is a bootstrap concern: Pegium populates the registry during
 /// single-threaded language registration before documents are processed
 /// concurrently. After bootstrap the queries are read-only and safe for
@@ -47,6 +64,34 @@ public:
   /// Registers one direct subtype edge in the reflection registry.
   void registerSubtype(std::type_index subtype, std::type_index supertype);
 
+  /// Returns the dense id of `type`, or `kNoAstType` when it is not
+  /// registered. Ids are stable: registering more types never changes them.
+  [[nodiscard]] AstTypeId typeId(std::type_index type) const noexcept {
+    const auto it = _idsByType.find(type);
+    return it != _idsByType.end() ? it->second : kNoAstType;
+  }
+
+  /// Returns the number of registered types; ids range over `[0, typeCount())`.
+  [[nodiscard]] std::size_t typeCount() const noexcept {
+    return _typesById.size();
+  }
+
+  /// Returns the type registered under `id`. Precondition: `id < typeCount()`.
+  [[nodiscard]] std::type_index typeOf(AstTypeId id) const noexcept {
+    return _typesById[id];
+  }
+
+  /// Returns whether the type with id `subtype` is the type with id
+  /// `supertype` or one of its known subtypes. Unknown ids are never subtypes.
+  [[nodiscard]] bool isSubtype(AstTypeId subtype,
+                               AstTypeId supertype) const noexcept {
+    if (subtype >= _typesById.size() || supertype >= _typesById.size()) {
+      return false;
+    }
+    const auto word = _supertypeBits[subtype * _bitsStride + supertype / 64U];
+    return ((word >> (supertype % 64U)) & 1U) != 0U;
+  }
+
   /// Returns whether `node` is an instance of `type`.
   [[nodiscard]] bool isInstance(const AstNode &node,
                                 std::type_index type) const noexcept;
@@ -77,6 +122,27 @@ public:
     return _types.contains(type);
   }
 
+  /// Records that nodes of `container`, or of its subtypes, may hold nodes of
+  /// `child`, or of its subtypes, as direct children. `pegium::AstNode` as
+  /// `child` stands for any node.
+  void registerContainment(std::type_index container, std::type_index child);
+
+  /// Declares the children nodes of `type` may hold fully described by
+  /// `registerContainment`. Nodes of undeclared types may hold any node.
+  void sealContainment(std::type_index type);
+
+  /// Returns whether the children of nodes of the type with id `id` are fully
+  /// described by the registered containments.
+  [[nodiscard]] bool isContainmentSealed(AstTypeId id) const noexcept {
+    return id < _sealed.size() && _sealed[id];
+  }
+
+  /// Returns the registered containments, as (container, child) id pairs.
+  [[nodiscard]] std::span<const std::pair<AstTypeId, AstTypeId>>
+  containments() const noexcept {
+    return _containments;
+  }
+
   /// Returns `type` and every currently known subtype of `type`.
   ///
   /// Asking for `pegium::AstNode` returns the registered AST root type plus all
@@ -101,14 +167,26 @@ private:
   }
 
   void registerTypeInternal(std::type_index type);
+  void setSupertypeBit(std::type_index subtype, std::type_index supertype);
 
   TypeIndexSet _types;
+  std::unordered_map<std::type_index, AstTypeId, utils::FastTypeIndexHash,
+                     utils::FastTypeIndexEqual>
+      _idsByType;
+  std::vector<std::type_index> _typesById;
+  // Row `id` (`_bitsStride` words) holds the bits of the supertypes of `id`,
+  // itself included.
+  std::vector<std::uint64_t> _supertypeBits;
+  std::size_t _bitsStride = 0;
   std::unordered_map<std::type_index, TypeIndexSet, utils::FastTypeIndexHash,
                      utils::FastTypeIndexEqual>
       _supertypesByType;
   std::unordered_map<std::type_index, TypeIndexSet, utils::FastTypeIndexHash,
                      utils::FastTypeIndexEqual>
       _subtypesByType;
+  std::vector<std::pair<AstTypeId, AstTypeId>> _containments;
+  // By type id.
+  std::vector<bool> _sealed;
 };
 
 /// True iff a value of type `candidate` may stand where `expected` is required:
@@ -134,4 +212,17 @@ type_is_assignable(std::type_index candidate, std::type_index expected,
   return reflection.isSubtype(candidate, expected);
 }
 
+/// `type_is_assignable` for callers holding dense ids of `reflection` (or
+/// `kNoAstType`) next to the type indexes: a bit test when both ids are known,
+/// the type index check otherwise.
+[[nodiscard]] inline bool
+type_is_assignable(AstTypeId candidateId, std::type_index candidate,
+                   AstTypeId expectedId, std::type_index expected,
+                   const AstReflection &reflection) noexcept {
+  if (candidateId != kNoAstType && expectedId != kNoAstType) {
+    return reflection.isSubtype(candidateId, expectedId);
+  }
+  return type_is_assignable(candidate, expected, reflection);
+}
+
 } // namespace pegium
@@ -0,0 +1,70 @@
+#include <pegium/core/syntax-tree/AstTypeFilter.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <typeinfo>
+
+namespace pegium {
+
+AstTypeFilter::AstTypeFilter(const AstReflection &reflection,
+                             std::span<const std::type_index> targets) {
+  std::vector<AstTypeId> targetIds;
+  targetIds.reserve(targets.size());
+  for (const auto target : targets) {
+    const auto id = reflection.typeId(target);
+    if (id == kNoAstType) {
+      return;
+    }
+    targetIds.push_back(id);
+  }
+
+  const auto typeCount = static_cast<AstTypeId>(reflection.typeCount());
+  _reflection = &reflection;
+  _flags.assign(typeCount, 0U);
+  if (targetIds.empty()) {
+    return;
+  }
+  for (AstTypeId type = 0; type < typeCount; ++type) {
+    if (std::ranges::any_of(targetIds, [&reflection, type](AstTypeId target) {
+          return reflection.isSubtype(type, target);
+        })) {
+      _flags[type] = kSelects;
+    }
+  }
+
+  // Flags are only ever set, so propagating them up the containment relation
+  // until nothing changes reaches a fixed point.
+  const auto anyNode = reflection.typeId(std::type_index(typeid(AstNode)));
+  std::vector<bool> mayBeOrHoldSelected(typeCount, false);
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (AstTypeId held = 0; held < typeCount; ++held) {
+      mayBeOrHoldSelected[held] =
+          held == anyNode ||
+          std::ranges::any_of(std::views::iota(AstTypeId{0}, typeCount),
+                              [this, &reflection, held](AstTypeId type) {
+                                return _flags[type] != 0U &&
+                                       reflection.isSubtype(type, held);
+                              });
+    }
+    for (AstTypeId type = 0; type < typeCount; ++type) {
+      if ((_flags[type] & kMayContainSelected) != 0U) {
+        continue;
+      }
+      const auto mayContain =
+          !reflection.isContainmentSealed(type) ||
+          std::ranges::any_of(
+              reflection.containments(),
+              [&reflection, &mayBeOrHoldSelected, type](const auto &edge) {
+                return reflection.isSubtype(type, edge.first) &&
+                       mayBeOrHoldSelected[edge.second];
+              });
+      if (mayContain) {
+        _flags[type] |= kMayContainSelected;
+        changed = true;
+      }
+    }
+  }
+}
+
+} // namespace pegium
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <typeindex>
+#include <vector>
+
+#include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/syntax-tree/AstNode.hpp>
+#include <pegium/core/syntax-tree/AstReflection.hpp>
+
+namespace pegium {
+
+/// Tells a traversal which AST nodes may be instances of some target types and
+/// which subtrees may hold such instances, so that it can skip the others (see
+/// `AstNode::visitDescendants(...)`).
+///
+/// Built once from the containment the grammar describes
+/// (`AstReflection::registerContainment`): a node type whose children were not
+/// fully described, or that is unknown to the reflection registry, may hold
+/// anything. Answers are conservative: a node may be reported as possibly
+/// selected, or as possibly holding selected nodes, when it is not.
+class AstTypeFilter {
+public:
+  /// A filter selecting every node and pruning nothing.
+  AstTypeFilter() = default;
+
+  /// Selects the instances of `targets` in ASTs whose arena uses
+  /// `reflection`. Selects every node when a target is unknown to
+  /// `reflection`.
+  AstTypeFilter(const AstReflection &reflection,
+                std::span<const std::type_index> targets);
+
+  /// Returns whether `node` may be an instance of a target type.
+  [[nodiscard]] bool selects(const AstNode &node) const noexcept {
+    return (flags(node) & kSelects) != 0U;
+  }
+
+  /// Returns whether a descendant of `node` may be an instance of a target
+  /// type.
+  [[nodiscard]] bool mayContainSelected(const AstNode &node) const noexcept {
+    return (flags(node) & kMayContainSelected) != 0U;
+  }
+
+private:
+  static constexpr std::uint8_t kSelects = 1U;
+  static constexpr std::uint8_t kMayContainSelected = 2U;
+  static constexpr std::uint8_t kAll = kSelects | kMayContainSelected;
+
+  [[nodiscard]] std::uint8_t flags(const AstNode &node) const noexcept {
+    const auto *arena = node.arena();
+    if (_reflection == nullptr || arena == nullptr ||
+        arena->reflection() != _reflection) {
+      return kAll;
+    }
+    const auto id = arena->typeId(node.symbolId());
+    return id < _flags.size() ? _flags[id] : kAll;
+  }
+
+  // Null when every node is selected.
+  const AstReflection *_reflection = nullptr;
+  // By type id of `_reflection`; types registered later are not covered.
+  std::vector<std::uint8_t> _flags;
+};
+
+} // namespace pegium
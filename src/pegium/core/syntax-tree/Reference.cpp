@@ -1,8 +1,12 @@
 #include <pegium/core/syntax-tree/Reference.hpp>
 
 #include <cassert>
+#include <cstddef>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <typeindex>
+#include <unordered_map>
 #include <utility>
 
 #include <pegium/core/grammar/Assignment.hpp>
@@ -10,6 +14,35 @@
 
 namespace pegium {
 
+namespace {
+
+// Reference each thread waits on while another thread resolves it, to detect
+// resolution cycles that span several threads.
+struct ResolutionWaits {
+  std::mutex mutex;
+  std::unordered_map<std::thread::id, const AbstractReference *> awaitedBy;
+};
+
+ResolutionWaits &resolution_waits() {
+  static ResolutionWaits waits;
+  return waits;
+}
+
+thread_local bool t_deferCyclicResolutions = false;
+
+} // namespace
+
+DeferCyclicResolutions::DeferCyclicResolutions() noexcept
+    : _previous(std::exchange(t_deferCyclicResolutions, true)) {}
+
+DeferCyclicResolutions::~DeferCyclicResolutions() {
+  t_deferCyclicResolutions = _previous;
+}
+
+bool DeferCyclicResolutions::active() noexcept {
+  return t_deferCyclicResolutions;
+}
+
 std::type_index AbstractReference::getReferenceType() const noexcept {
   return getAssignment().getType();
 }
@@ -18,32 +51,75 @@ std::string_view AbstractReference::getFeature() const noexcept {
   return getAssignment().getFeature();
 }
 
+void AbstractReference::waitForResolver(ReferenceState state) const {
+  auto &waits = resolution_waits();
+  const auto self = std::this_thread::get_id();
+  {
+    const std::scoped_lock lock(waits.mutex);
+    // Follow the resolver of each awaited reference to the reference it awaits
+    // in turn; reaching the calling thread closes a cycle. The walk is bounded
+    // because owners read here may already have moved on.
+    const AbstractReference *awaited = this;
+    for (std::size_t step = 0;
+         awaited != nullptr && step <= waits.awaitedBy.size(); ++step) {
+      const auto owner =
+          awaited->_resolvingOwner.load(std::memory_order_acquire);
+      if (owner == self) {
+        throw CyclicReferenceResolution(*this);
+      }
+      const auto next = waits.awaitedBy.find(owner);
+      awaited = next == waits.awaitedBy.end() ? nullptr : next->second;
+    }
+    waits.awaitedBy[self] = this;
+  }
+  _waiterCount.fetch_add(1, std::memory_order_acq_rel);
+  _state.wait(state, std::memory_order_acquire);
+  _waiterCount.fetch_sub(1, std::memory_order_acq_rel);
+  const std::scoped_lock lock(waits.mutex);
+  waits.awaitedBy.erase(self);
+}
+
 std::string AbstractReference::getErrorMessage() const {
+  const auto state = _state.load(std::memory_order_acquire);
+  if (state < kFirstErrorState) {
+    return {};
+  }
+  std::string typeName;
+  if (const auto type = getReferenceType();
+      state == ReferenceState::ErrorNotFound &&
+      type != std::type_index(typeid(void))) {
+    typeName = parser::detail::runtime_type_name(type);
+    assert(!typeName.empty());
+  }
+  return formatErrorMessage(state, typeName, getFeature(), _refText);
+}
+
+std::string AbstractReference::formatErrorMessage(ReferenceState state,
+                                                  std::string_view typeName,
+                                                  std::string_view feature,
+                                                  std::string_view refText) {
   using enum ReferenceState;
-  switch (_state.load(std::memory_order_acquire)) {
+  switch (state) {
   case ErrorNoLinker:
     return "No linker is available for this reference.";
   case ErrorNotFound: {
     std::string message = "Could not resolve reference";
-    if (const auto type = getReferenceType();
-        type != std::type_index(typeid(void))) {
-      auto typeName = parser::detail::runtime_type_name(type);
-      assert(!typeName.empty());
-      message += " to " + std::move(typeName);
+    if (!typeName.empty()) {
+      message += " to ";
+      message += typeName;
     }
-    message += " named '" + _refText + "'.";
+    message += " named '";
+    message += refText;
+    message += "'.";
     return message;
   }
-  case ErrorCycle: {
-    std::string feature(getFeature());
-    if (feature.empty()) {
-      feature = "<unknown>";
-    }
-    return "Cyclic reference resolution detected for feature '" + feature +
-           "' (symbol '" + _refText + "').";
-  }
+  case ErrorCycle:
+    return "Cyclic reference resolution detected for feature '" +
+           std::string(feature.empty() ? "<unknown>" : feature) +
+           "' (symbol '" + std::string(refText) + "').";
   case ErrorException:
-    return "An error occurred while resolving reference to '" + _refText + "'.";
+    return "An error occurred while resolving reference to '" +
+           std::string(refText) + "'.";
   case Unresolved:
   case Resolving:
   case Resolved:
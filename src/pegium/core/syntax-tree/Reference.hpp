@@ -24,6 +24,32 @@ public:
 
   void forceResolve() const override { ensureResolved(); }
 
+  void forceResolveWith(const workspace::ResolvedAstNodeDescriptionOrError
+                            &resolution) const override {
+    runResolution([this, &resolution] { applyResolution(resolution); },
+                  [] { /* unresolved: nothing to publish */ });
+  }
+
+  bool rebindTargets(
+      utils::function_ref<workspace::ResolvedAstNodeDescription(
+          const workspace::AstNodeDescription &)>
+          reload) const override {
+    if (!isResolved()) {
+      return true;
+    }
+    assert(_description.has_value());
+    const auto reloaded = reload(*_description);
+    if (reloaded.node == nullptr) {
+      return false;
+    }
+    assert(dynamic_cast<const T *>(reloaded.node) != nullptr);
+    _target = static_cast<const T *>(reloaded.node);
+    if (reloaded.description != nullptr) {
+      _description = *reloaded.description;
+    }
+    return true;
+  }
+
   [[nodiscard]] const AstNode *resolve() const override { return get(); }
 
   [[nodiscard]] const T *get() const {
@@ -49,41 +75,40 @@ protected:
 
 private:
   void ensureResolved() const {
-    runResolution(
-        [this] {
-          const auto resolution = _linker->resolve(*this);
-          if (const auto *error =
-                  std::get_if<workspace::LinkingError>(&resolution);
-              error != nullptr) {
-            applyLinkingError(error->kind);
-            return;
-          }
+    runResolution([this] { applyResolution(_linker->resolve(*this)); },
+                  [] { /* unresolved: nothing to publish */ });
+  }
 
-          const auto &resolved =
-              std::get<workspace::ResolvedAstNodeDescription>(resolution);
-          // The scope provider already type-checked candidates against the
-          // reference's expected type via `AstReflection::isSubtype` (see
-          // `DefaultScopeProvider::find_scope_entry`). A correct linker
-          // therefore hands us a node that IS-A `T`, making the cast a static
-          // downcast.
-          assert(dynamic_cast<const T *>(resolved.node) != nullptr);
-          assert(resolved.description != nullptr);
-          // Own the description by value: for cross-document (global) targets
-          // the resolved pointer aims into the scope provider's global cache,
-          // which is freed when a later build invalidates it. A copy keeps
-          // go-to-definition / find-references valid for documents that are not
-          // relinked by that build.
-          //
-          // Copy the description (the only throwing step) BEFORE storing the
-          // never-throwing `_target` pointer and publishing, so a bad_alloc here
-          // leaves the reference fully unresolved rather than with `_target` set
-          // and `_description` empty (which would make operator bool() lie and
-          // resolvedDescription() dereference an empty optional).
-          _description = *resolved.description;
-          _target = static_cast<const T *>(resolved.node);
-          publishState(ReferenceState::Resolved);
-        },
-        [] { /* unresolved: nothing to publish */ });
+  // Publishes `resolution`. Runs while holding the resolver role.
+  void applyResolution(
+      const workspace::ResolvedAstNodeDescriptionOrError &resolution) const {
+    if (const auto *error = std::get_if<workspace::LinkingError>(&resolution);
+        error != nullptr) {
+      applyLinkingError(error->kind);
+      return;
+    }
+
+    const auto &resolved =
+        std::get<workspace::ResolvedAstNodeDescription>(resolution);
+    // The scope provider already type-checked candidates against the
+    // reference's expected type via `AstReflection::isSubtype` (see
+    // `DefaultScopeProvider::find_scope_entry`). A correct linker therefore
+    // hands us a node that IS-A `T`, making the cast a static downcast.
+    assert(dynamic_cast<const T *>(resolved.node) != nullptr);
+    assert(resolved.description != nullptr);
+    // Own the description by value: for cross-document (global) targets the
+    // resolved pointer aims into the scope provider's global cache, which is
+    // freed when a later build invalidates it. A copy keeps go-to-definition /
+    // find-references valid for documents that are not relinked by that build.
+    //
+    // Copy the description (the only throwing step) BEFORE storing the
+    // never-throwing `_target` pointer and publishing, so a bad_alloc here
+    // leaves the reference fully unresolved rather than with `_target` set and
+    // `_description` empty (which would make operator bool() lie and
+    // resolvedDescription() dereference an empty optional).
+    _description = *resolved.description;
+    _target = static_cast<const T *>(resolved.node);
+    publishState(ReferenceState::Resolved);
   }
 
   mutable const T *_target = nullptr;
@@ -115,6 +140,34 @@ public:
 
   void forceResolve() const override { ensureResolved(); }
 
+  bool rebindTargets(
+      utils::function_ref<workspace::ResolvedAstNodeDescription(
+          const workspace::AstNodeDescription &)>
+          reload) const override {
+    if (!isResolved()) {
+      return true;
+    }
+    // Load every target before touching any item, so a failure leaves the
+    // reference consistent.
+    std::vector<workspace::ResolvedAstNodeDescription> targets;
+    targets.reserve(_items.size());
+    for (const auto &item : _items) {
+      const auto reloaded = reload(item.description);
+      if (reloaded.node == nullptr) {
+        return false;
+      }
+      assert(dynamic_cast<const T *>(reloaded.node) != nullptr);
+      targets.push_back(reloaded);
+    }
+    for (std::size_t index = 0; index < _items.size(); ++index) {
+      _items[index].ref = static_cast<const T *>(targets[index].node);
+      if (targets[index].description != nullptr) {
+        _items[index].description = *targets[index].description;
+      }
+    }
+    return true;
+  }
+
   [[nodiscard]] std::span<const Item> items() const {
     ensureResolved();
     return std::span<const Item>(_items.data(), _items.size());
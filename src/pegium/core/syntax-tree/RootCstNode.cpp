@@ -8,7 +8,7 @@ namespace pegium {
 
 RootCstNode::RootCstNode(text::TextSnapshot text,
                          std::pmr::memory_resource *upstream)
-    : _text(std::move(text)), _pool(upstream) {
+    : _text(std::move(text)), _upstream(upstream), _pool(std::addressof(_upstream)) {
   const auto view = getText();
   if (view.size() >
       static_cast<std::size_t>(std::numeric_limits<TextOffset>::max())) {
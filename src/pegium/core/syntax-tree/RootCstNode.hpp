@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <memory_resource>
@@ -56,6 +57,12 @@ public:
     return std::addressof(_pool);
   }
 
+  /// Returns the bytes the pool obtained from its upstream resource, i.e. the
+  /// memory held by the CST nodes and by the AST nodes sharing the pool.
+  [[nodiscard]] std::size_t allocatedBytes() const noexcept {
+    return _upstream.allocatedBytes();
+  }
+
   /// Attaches the workspace document that owns this CST in document pipelines.
   void attachDocument(const workspace::Document &document) noexcept {
     _document = std::addressof(document);
@@ -83,6 +90,8 @@ public:
 
   /// Returns a view over node `id`, or an invalid view when out of bounds.
   [[nodiscard]] CstNodeView get(NodeId id) const noexcept;
+  /// Returns the number of nodes; their ids are the ones below it.
+  [[nodiscard]] NodeCount nodeCount() const noexcept { return _nodeCount; }
 
   /// Returns an iterator over top-level CST nodes.
   ChildIterator begin() const noexcept;
@@ -96,8 +105,40 @@ private:
   static_assert(std::has_single_bit(chunk_size),
                 "chunk_size must be power of two");
 
+  // Forwards to the upstream resource while counting the bytes it holds.
+  class CountingResource final : public std::pmr::memory_resource {
+  public:
+    explicit CountingResource(std::pmr::memory_resource *upstream) noexcept
+        : _upstream(upstream) {}
+
+    [[nodiscard]] std::size_t allocatedBytes() const noexcept {
+      return _allocatedBytes;
+    }
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+      auto *memory = _upstream->allocate(bytes, alignment);
+      _allocatedBytes += bytes;
+      return memory;
+    }
+    void do_deallocate(void *memory, std::size_t bytes,
+                       std::size_t alignment) override {
+      _upstream->deallocate(memory, bytes, alignment);
+      _allocatedBytes -= bytes;
+    }
+    [[nodiscard]] bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+      return this == std::addressof(other);
+    }
+
+    std::pmr::memory_resource *_upstream;
+    std::size_t _allocatedBytes = 0;
+  };
+
   text::TextSnapshot _text;
 
+  // Declared before `_pool`, which releases its buffers into it.
+  CountingResource _upstream;
   std::pmr::monotonic_buffer_resource _pool;
   std::vector<CstNode *> _chunks;
 
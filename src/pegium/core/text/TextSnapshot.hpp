@@ -1,23 +1,29 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 
+#include <pegium/core/utils/ContentHash.hpp>
+
 namespace pegium::text {
 
 /// Shared immutable text buffer used by parser and CST snapshots.
 ///
 /// `TextSnapshot` gives Pegium one stable owner for source text while keeping
 /// copies cheap. Workspace documents can share their current snapshot with the
-/// parser, and standalone parses can materialize one on demand.
+/// parser, and standalone parses can materialize one on demand. The content
+/// hash is computed once, when the snapshot is created, and shared by copies.
 class TextSnapshot {
 public:
-  TextSnapshot() noexcept : _text(empty_text()) {}
+  TextSnapshot() noexcept
+      : _text(empty_text()), _hash(utils::content_hash({})) {}
 
   explicit TextSnapshot(std::shared_ptr<const std::string> text) noexcept
-      : _text(text == nullptr ? empty_text() : std::move(text)) {}
+      : _text(text == nullptr ? empty_text() : std::move(text)),
+        _hash(utils::content_hash(*_text)) {}
 
   [[nodiscard]] static TextSnapshot copy(std::string_view text) {
     return TextSnapshot(std::make_shared<const std::string>(text));
@@ -32,6 +38,8 @@ public:
   [[nodiscard]] const std::string &str() const noexcept { return *_text; }
   [[nodiscard]] bool empty() const noexcept { return _text->empty(); }
   [[nodiscard]] std::size_t size() const noexcept { return _text->size(); }
+  /// Returns `utils::content_hash(view())`.
+  [[nodiscard]] std::uint64_t hash() const noexcept { return _hash; }
 
 private:
   [[nodiscard]] static std::shared_ptr<const std::string> empty_text() noexcept {
@@ -40,6 +48,7 @@ private:
   }
 
   std::shared_ptr<const std::string> _text;
+  std::uint64_t _hash;
 };
 
 } // namespace pegium::text
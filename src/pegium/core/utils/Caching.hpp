@@ -488,4 +488,112 @@ public:
   }
 };
 
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+/// Cache invalidated lazily whenever the workspace's exported symbols change.
+///
+/// Unlike `WorkspaceCache`, edits that leave every document's exports intact
+/// (tracked by `IndexManager::exportsFingerprint`) keep the cached values, so
+/// only use it for values derived from the global scope alone.
+class ExportsCache final : public DisposableCache {
+public:
+  explicit ExportsCache(const pegium::SharedCoreServices &sharedServices)
+      : _sharedServices(std::addressof(sharedServices)) {}
+
+  ~ExportsCache() noexcept override {
+    try {
+      this->dispose();
+    } catch (...) {
+    }
+  }
+
+  [[nodiscard]] bool has(const K &key) const {
+    this->throwIfDisposed();
+    const auto fingerprint = currentFingerprint();
+    std::scoped_lock lock(_mutex);
+    syncLocked(fingerprint);
+    return _cache.contains(key);
+  }
+
+  void set(K key, V value) {
+    this->throwIfDisposed();
+    const auto fingerprint = currentFingerprint();
+    std::scoped_lock lock(_mutex);
+    syncLocked(fingerprint);
+    _cache.insert_or_assign(std::move(key), std::move(value));
+  }
+
+  [[nodiscard]] std::optional<V> get(const K &key) const {
+    this->throwIfDisposed();
+    const auto fingerprint = currentFingerprint();
+    std::scoped_lock lock(_mutex);
+    syncLocked(fingerprint);
+    const auto it = _cache.find(key);
+    if (it == _cache.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  template <typename Provider> V get(const K &key, Provider &&provider) const {
+    this->throwIfDisposed();
+    // Read before computing, so a value is never older than the fingerprint
+    // it is stored under.
+    const auto fingerprint = currentFingerprint();
+    {
+      std::scoped_lock lock(_mutex);
+      syncLocked(fingerprint);
+      const auto it = _cache.find(key);
+      if (it != _cache.end()) {
+        return it->second;
+      }
+    }
+
+    auto value = provider();
+    {
+      std::scoped_lock lock(_mutex);
+      if (_fingerprint != fingerprint) {
+        // The exports moved on while computing; do not cache.
+        return value;
+      }
+      const auto [it, inserted] = _cache.try_emplace(key, std::move(value));
+      (void)inserted;
+      return it->second;
+    }
+  }
+
+  [[nodiscard]] bool erase(const K &key) {
+    this->throwIfDisposed();
+    std::scoped_lock lock(_mutex);
+    return _cache.erase(key) > 0;
+  }
+
+  void clear() override {
+    this->throwIfDisposed();
+    std::scoped_lock lock(_mutex);
+    _cache.clear();
+    _fingerprint.reset();
+  }
+
+private:
+  [[nodiscard]] std::uint64_t currentFingerprint() const {
+    const auto *indexManager = _sharedServices->workspace.indexManager.get();
+    assert(indexManager != nullptr &&
+           "ExportsCache requires shared.workspace.indexManager");
+    return indexManager->exportsFingerprint();
+  }
+
+  void syncLocked(std::uint64_t fingerprint) const {
+    if (_fingerprint != fingerprint) {
+      _cache.clear();
+      _fingerprint = fingerprint;
+    }
+  }
+
+  const pegium::SharedCoreServices *_sharedServices;
+  mutable std::mutex _mutex;
+  mutable std::optional<std::uint64_t> _fingerprint;
+  mutable std::unordered_map<K, V, Hash, KeyEqual> _cache;
+};
+
 } // namespace pegium::utils
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace pegium::utils {
+
+namespace detail {
+
+inline constexpr std::uint64_t kContentHashPrime1 = 0x9E3779B185EBCA87ULL;
+inline constexpr std::uint64_t kContentHashPrime2 = 0xC2B2AE3D27D4EB4FULL;
+inline constexpr std::uint64_t kContentHashPrime3 = 0x165667B19E3779F9ULL;
+inline constexpr std::uint64_t kContentHashPrime4 = 0x85EBCA77C2B2AE63ULL;
+inline constexpr std::uint64_t kContentHashPrime5 = 0x27D4EB2F165667C5ULL;
+
+[[nodiscard]] inline std::uint64_t rotl64(std::uint64_t value,
+                                          int bits) noexcept {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+[[nodiscard]] inline std::uint64_t read64(const char *data) noexcept {
+  std::uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+[[nodiscard]] inline std::uint32_t read32(const char *data) noexcept {
+  std::uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+[[nodiscard]] inline std::uint64_t hash_round(std::uint64_t accumulator,
+                                              std::uint64_t lane) noexcept {
+  accumulator += lane * kContentHashPrime2;
+  return rotl64(accumulator, 31) * kContentHashPrime1;
+}
+
+[[nodiscard]] inline std::uint64_t hash_merge(std::uint64_t accumulator,
+                                              std::uint64_t lane) noexcept {
+  accumulator ^= hash_round(0, lane);
+  return accumulator * kContentHashPrime1 + kContentHashPrime4;
+}
+
+} // namespace detail
+
+/// Fast non-cryptographic 64-bit hash of `text` (XXH64, seed 0, native byte
+/// order).
+///
+/// Used to recognize unchanged content without comparing it byte by byte; the
+/// value is stable across runs on the same platform, so it may key on-disk
+/// caches as well.
+[[nodiscard]] inline std::uint64_t content_hash(std::string_view text) noexcept {
+  using namespace detail;
+  const char *data = text.data();
+  const char *const end = data + text.size();
+  std::uint64_t hash;
+
+  if (text.size() >= 32) {
+    std::uint64_t v1 = kContentHashPrime1 + kContentHashPrime2;
+    std::uint64_t v2 = kContentHashPrime2;
+    std::uint64_t v3 = 0;
+    std::uint64_t v4 = 0 - kContentHashPrime1;
+    const char *const limit = end - 32;
+    do {
+      v1 = hash_round(v1, read64(data));
+      v2 = hash_round(v2, read64(data + 8));
+      v3 = hash_round(v3, read64(data + 16));
+      v4 = hash_round(v4, read64(data + 24));
+      data += 32;
+    } while (data <= limit);
+    hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    hash = hash_merge(hash, v1);
+    hash = hash_merge(hash, v2);
+    hash = hash_merge(hash, v3);
+    hash = hash_merge(hash, v4);
+  } else {
+    hash = kContentHashPrime5;
+  }
+
+  hash += static_cast<std::uint64_t>(text.size());
+  for (; data + 8 <= end; data += 8) {
+    hash ^= hash_round(0, read64(data));
+    hash = rotl64(hash, 27) * kContentHashPrime1 + kContentHashPrime4;
+  }
+  if (data + 4 <= end) {
+    hash ^= static_cast<std::uint64_t>(read32(data)) * kContentHashPrime1;
+    hash = rotl64(hash, 23) * kContentHashPrime2 + kContentHashPrime3;
+    data += 4;
+  }
+  for (; data < end; ++data) {
+    hash ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*data)) *
+            kContentHashPrime5;
+    hash = rotl64(hash, 11) * kContentHashPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kContentHashPrime2;
+  hash ^= hash >> 29;
+  hash *= kContentHashPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+} // namespace pegium::utils
@@ -0,0 +1,118 @@
+#include <pegium/core/utils/StringInterner.hpp>
+
+#include <bit>
+#include <cassert>
+#include <memory>
+#include <mutex>
+
+namespace pegium::utils {
+
+namespace {
+
+struct SegmentPosition {
+  std::size_t segment;
+  std::size_t offset;
+  std::size_t size;
+};
+
+template <std::size_t FirstSegmentBits>
+[[nodiscard]] SegmentPosition segment_position(InternedId id) noexcept {
+  const auto biased =
+      static_cast<std::uint64_t>(id) + (std::uint64_t{1} << FirstSegmentBits);
+  const auto segment = static_cast<std::size_t>(std::bit_width(biased)) - 1 -
+                       FirstSegmentBits;
+  const auto size = std::size_t{1} << (segment + FirstSegmentBits);
+  return {.segment = segment,
+          .offset = static_cast<std::size_t>(biased - size),
+          .size = size};
+}
+
+} // namespace
+
+StringInterner::StringInterner() { *ensureSlot(0) = std::string_view{}; }
+
+StringInterner::~StringInterner() noexcept {
+  for (auto &segment : _segments) {
+    delete[] segment.load(std::memory_order_relaxed);
+  }
+}
+
+StringInterner &StringInterner::global() noexcept {
+  // Never destroyed: interned strings may be read by static objects destroyed
+  // after any function-local static.
+  static auto *const interner = new StringInterner();
+  return *interner;
+}
+
+InternedId StringInterner::intern(std::string_view value) {
+  if (value.empty()) {
+    return 0;
+  }
+  auto &shard = _shards[std::hash<std::string_view>{}(value) % kShardCount];
+  {
+    std::shared_lock lock(shard.mutex);
+    if (const auto it = shard.ids.find(value); it != shard.ids.end()) {
+      return it->second;
+    }
+  }
+  std::unique_lock lock(shard.mutex);
+  if (const auto it = shard.ids.find(value); it != shard.ids.end()) {
+    return it->second;
+  }
+  const std::string_view stored = shard.strings.emplace_back(value);
+  _storedBytes.fetch_add(stored.size(), std::memory_order_relaxed);
+  const auto id = _next.fetch_add(1, std::memory_order_relaxed);
+  *ensureSlot(id) = stored;
+  shard.ids.emplace(stored, id);
+  return id;
+}
+
+std::optional<InternedId> StringInterner::find(std::string_view value) const {
+  if (value.empty()) {
+    return InternedId{0};
+  }
+  const auto &shard =
+      _shards[std::hash<std::string_view>{}(value) % kShardCount];
+  std::shared_lock lock(shard.mutex);
+  if (const auto it = shard.ids.find(value); it != shard.ids.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::string_view StringInterner::view(InternedId id) const noexcept {
+  const auto *entry = slot(id);
+  assert(entry != nullptr);
+  return *entry;
+}
+
+std::size_t StringInterner::size() const noexcept {
+  return _next.load(std::memory_order_relaxed);
+}
+
+std::size_t StringInterner::storedBytes() const noexcept {
+  return _storedBytes.load(std::memory_order_relaxed);
+}
+
+std::string_view *StringInterner::slot(InternedId id) const noexcept {
+  const auto position = segment_position<kFirstSegmentBits>(id);
+  auto *segment = _segments[position.segment].load(std::memory_order_acquire);
+  return segment == nullptr ? nullptr : segment + position.offset;
+}
+
+std::string_view *StringInterner::ensureSlot(InternedId id) {
+  const auto position = segment_position<kFirstSegmentBits>(id);
+  auto &segment = _segments[position.segment];
+  auto *entries = segment.load(std::memory_order_acquire);
+  if (entries == nullptr) {
+    // Shards allocate concurrently: the first segment published wins.
+    auto allocated = std::make_unique<std::string_view[]>(position.size);
+    if (segment.compare_exchange_strong(entries, allocated.get(),
+                                        std::memory_order_acq_rel)) {
+      entries = allocated.release();
+    }
+  }
+  return entries + position.offset;
+}
+
+} // namespace pegium::utils
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace pegium::utils {
+
+/// Identifier of a string interned by `StringInterner`. `0` is the empty
+/// string.
+using InternedId = std::uint32_t;
+
+/// Process-wide concurrent string table mapping each distinct string to a
+/// stable 32-bit identifier.
+///
+/// Interned strings are never released: their characters are stored once and
+/// stay valid, at the same address, for the lifetime of the process. Lookups
+/// by identifier are lock-free; interning locks one of a few shards, shared
+/// when the string is already known.
+///
+/// The table therefore grows with every distinct string a session interns,
+/// including names that only existed transiently, such as the successive
+/// prefixes of an exported name being typed. The growth is bounded by the
+/// edits made in the session, not by the workspace; `size()` and
+/// `storedBytes()` report it.
+class StringInterner {
+public:
+  StringInterner();
+  StringInterner(const StringInterner &) = delete;
+  StringInterner &operator=(const StringInterner &) = delete;
+  ~StringInterner() noexcept;
+
+  /// Returns the interner shared by the whole process.
+  [[nodiscard]] static StringInterner &global() noexcept;
+
+  /// Returns the identifier of `value`, interning it on first use.
+  [[nodiscard]] InternedId intern(std::string_view value);
+  /// Returns the identifier of `value` when it was already interned.
+  [[nodiscard]] std::optional<InternedId> find(std::string_view value) const;
+  /// Returns the string interned as `id`.
+  [[nodiscard]] std::string_view view(InternedId id) const noexcept;
+  /// Returns the number of interned strings, the empty one included.
+  [[nodiscard]] std::size_t size() const noexcept;
+  /// Returns the number of characters held by the interned strings, not
+  /// counting the per-string overhead of the table.
+  [[nodiscard]] std::size_t storedBytes() const noexcept;
+
+private:
+  static constexpr std::size_t kShardCount = 16;
+  // Identifiers are stored in segments doubling in size, so that a segment,
+  // once allocated, never moves.
+  static constexpr std::size_t kFirstSegmentBits = 10;
+  static constexpr std::size_t kSegmentCount = 33 - kFirstSegmentBits;
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    // Owns the characters; a deque never moves its elements.
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, InternedId> ids;
+  };
+
+  [[nodiscard]] std::string_view *slot(InternedId id) const noexcept;
+  [[nodiscard]] std::string_view *ensureSlot(InternedId id);
+
+  std::array<Shard, kShardCount> _shards;
+  std::array<std::atomic<std::string_view *>, kSegmentCount> _segments{};
+  std::atomic<InternedId> _next = 1;
+  std::atomic<std::size_t> _storedBytes = 0;
+};
+
+/// Interned string: a 32-bit handle comparing and hashing as an integer, that
+/// reads as the `std::string_view` it interns.
+///
+/// Constructing one from text interns it in `StringInterner::global()`.
+class InternedString {
+public:
+  InternedString() noexcept = default;
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  InternedString(std::string_view value)
+      : _id(StringInterner::global().intern(value)) {}
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  InternedString(const std::string &value)
+      : InternedString(std::string_view(value)) {}
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  InternedString(const char *value) : InternedString(std::string_view(value)) {}
+
+  /// Returns the interned string for `value` without interning it: no index
+  /// keyed by interned strings can hold a string that was never interned.
+  [[nodiscard]] static std::optional<InternedString>
+  find(std::string_view value) {
+    const auto id = StringInterner::global().find(value);
+    if (!id.has_value()) {
+      return std::nullopt;
+    }
+    InternedString result;
+    result._id = *id;
+    return result;
+  }
+
+  [[nodiscard]] InternedId id() const noexcept { return _id; }
+  [[nodiscard]] std::string_view view() const noexcept {
+    return StringInterner::global().view(_id);
+  }
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  operator std::string_view() const noexcept { return view(); }
+  [[nodiscard]] std::string str() const { return std::string(view()); }
+
+  [[nodiscard]] bool empty() const noexcept { return _id == 0; }
+  [[nodiscard]] std::size_t size() const noexcept { return view().size(); }
+  [[nodiscard]] const char *data() const noexcept { return view().data(); }
+
+  [[nodiscard]] friend bool operator==(InternedString lhs,
+                                       InternedString rhs) noexcept {
+    return lhs._id == rhs._id;
+  }
+  [[nodiscard]] friend bool operator==(InternedString lhs,
+                                       std::string_view rhs) noexcept {
+    return lhs.view() == rhs;
+  }
+  [[nodiscard]] friend bool operator==(InternedString lhs,
+                                       const std::string &rhs) noexcept {
+    return lhs.view() == rhs;
+  }
+  [[nodiscard]] friend bool operator==(InternedString lhs,
+                                       const char *rhs) noexcept {
+    return lhs.view() == rhs;
+  }
+
+  friend std::ostream &operator<<(std::ostream &stream, InternedString value) {
+    return stream << value.view();
+  }
+
+private:
+  InternedId _id = 0;
+};
+
+} // namespace pegium::utils
+
+template <> struct std::hash<pegium::utils::InternedString> {
+  [[nodiscard]] std::size_t
+  operator()(pegium::utils::InternedString value) const noexcept {
+    return std::hash<pegium::utils::InternedId>{}(value.id());
+  }
+};
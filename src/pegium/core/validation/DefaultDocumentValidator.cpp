@@ -8,18 +8,26 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <typeindex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include <pegium/core/execution/TaskScheduler.hpp>
 #include <pegium/core/grammar/AbstractRule.hpp>
 #include <pegium/core/grammar/Assignment.hpp>
 #include <pegium/core/grammar/Literal.hpp>
 #include <pegium/core/parser/ContextShared.hpp>
 #include <pegium/core/parser/Introspection.hpp>
+#include <pegium/core/services/CompactDiagnostic.hpp>
 #include <pegium/core/services/CoreServices.hpp>
+#include <pegium/core/services/SharedCoreServices.hpp>
+#include <pegium/core/syntax-tree/AstArena.hpp>
 #include <pegium/core/syntax-tree/CstNodeView.hpp>
 #include <pegium/core/syntax-tree/CstUtils.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/validation/ValidationRegistry.hpp>
+#include <pegium/core/workspace/Document.hpp>
 
 namespace pegium::validation {
 
@@ -27,28 +35,73 @@ namespace {
 
 constexpr std::string_view kDefaultCodeActionsKey = "pegiumDefaultCodeActions";
 
+// ASTs with more nodes than this have their per-node checks run concurrently
+// when `ValidationOptions::concurrentNodeChecks` allows it. Documents are
+// already validated concurrently: only huge ones gain from more tasks.
+constexpr std::size_t kConcurrentValidationNodeCount = 16384;
+// Number of nodes checked by each task of a concurrent run.
+constexpr std::size_t kValidationSliceSize = 1024;
+
 struct FoundToken {
   TextOffset begin = 0;
   TextOffset end = 0;
   std::string_view image;
 };
 
-[[nodiscard]] std::optional<CstNodeView>
-next_visible_leaf_at_or_after(const workspace::Document &document,
-                              TextOffset offset) {
-  if (document.parseResult.cst == nullptr) {
-    return std::nullopt;
+// The CST leaves of a document, gathered in one pass so that every parse
+// diagnostic can look up its neighbouring tokens by binary search. Leaves are
+// disjoint and in text order, so both their begins and their ends ascend.
+class ParseLeafIndex {
+public:
+  explicit ParseLeafIndex(const workspace::Document &document)
+      : _text(document.textDocument().getText()) {
+    if (document.parseResult.cst == nullptr) {
+      return;
+    }
+    for (auto leaf = find_first_leaf(*document.parseResult.cst);
+         leaf.has_value(); leaf = find_next_leaf(*leaf)) {
+      if (!leaf->isHidden()) {
+        _visible.push_back(_leaves.size());
+      }
+      _leaves.push_back(*leaf);
+    }
   }
-  for (auto leaf = find_first_leaf(*document.parseResult.cst); leaf.has_value();
-       leaf = find_next_leaf(*leaf)) {
-    if (leaf->isHidden() || leaf->getEnd() <= offset) {
-      continue;
+
+  // The first visible leaf ending after `offset`.
+  [[nodiscard]] std::optional<CstNodeView>
+  nextVisibleAtOrAfter(TextOffset offset) const {
+    const auto next = std::ranges::partition_point(
+        _visible, [this, offset](std::size_t index) {
+          return _leaves[index].getEnd() <= offset;
+        });
+    return next == _visible.end() ? std::nullopt
+                                  : std::optional{_leaves[*next]};
+  }
+
+  // The end of the last visible leaf beginning before `offset` when it ends
+  // before `offset`, `offset` otherwise.
+  [[nodiscard]] TextOffset previousVisibleEnd(TextOffset offset) const {
+    const auto next = std::ranges::partition_point(
+        _visible, [this, offset](std::size_t index) {
+          return _leaves[index].getBegin() < offset;
+        });
+    if (next == _visible.begin()) {
+      return offset;
     }
-    return leaf;
+    const auto end = _leaves[*std::prev(next)].getEnd();
+    return end >= offset ? offset : end;
   }
-  return std::nullopt;
-}
 
+  // Whether [begin, end) only holds hidden leaves and whitespace.
+  [[nodiscard]] bool gapIsHiddenOrWhitespace(TextOffset begin,
+                                             TextOffset end) const;
+
+private:
+  std::string_view _text;
+  std::vector<CstNodeView> _leaves;
+  // Indices into `_leaves`.
+  std::vector<std::size_t> _visible;
+};
 
 [[nodiscard]] std::string quote_keyword(std::string_view value) {
   return "'" + std::string(value) + "'";
@@ -211,8 +264,8 @@ format_expect_frontier(std::span<const parser::ExpectPath> frontier) {
 }
 
 [[nodiscard]] TextOffset diagnostic_expect_offset(
-    const workspace::Document &document,
-    const parser::ParseDiagnostic &parseDiagnostic) noexcept {
+    const workspace::Document &document, const ParseLeafIndex &leaves,
+    const parser::ParseDiagnostic &parseDiagnostic) {
   const auto textSize =
       static_cast<TextOffset>(document.textDocument().getText().size());
   auto offset = std::min(parseDiagnostic.offset, textSize);
@@ -224,7 +277,7 @@ format_expect_frontier(std::span<const parser::ExpectPath> frontier) {
 
   const auto failureOffset =
       std::min(document.parseResult.failureVisibleCursorOffset, textSize);
-  if (const auto leaf = next_visible_leaf_at_or_after(document, failureOffset);
+  if (const auto leaf = leaves.nextVisibleAtOrAfter(failureOffset);
       leaf.has_value()) {
     return leaf->getBegin() > failureOffset ? failureOffset : offset;
   }
@@ -232,8 +285,9 @@ format_expect_frontier(std::span<const parser::ExpectPath> frontier) {
 }
 
 [[nodiscard]] FoundToken find_found_token(const workspace::Document &document,
+                                          const ParseLeafIndex &leaves,
                                           TextOffset offset) {
-  if (const auto leaf = next_visible_leaf_at_or_after(document, offset);
+  if (const auto leaf = leaves.nextVisibleAtOrAfter(offset);
       leaf.has_value()) {
     return {.begin = leaf->getBegin(), .end = leaf->getEnd(), .image = leaf->getText()};
   }
@@ -248,37 +302,31 @@ format_expect_frontier(std::span<const parser::ExpectPath> frontier) {
                           .image = text.substr(static_cast<std::size_t>(begin))};
 }
 
-[[nodiscard]] std::string expect_text(
-    const workspace::Document &document, const parser::Parser &parserImpl,
-    TextOffset offset, const utils::CancellationToken &cancelToken) {
-  const auto expect =
-      parserImpl.expect(document.textDocument().getText(), offset, cancelToken);
-  return format_expect_frontier(expect.frontier);
-}
-
-[[nodiscard]] TextOffset
-previous_visible_leaf_end(const workspace::Document &document,
-                          TextOffset offset) {
-  if (document.parseResult.cst == nullptr) {
-    return offset;
-  }
-
-  std::optional<CstNodeView> previousVisible;
-  for (auto leaf = find_first_leaf(*document.parseResult.cst); leaf.has_value();
-       leaf = find_next_leaf(*leaf)) {
-    if (leaf->getBegin() >= offset) {
-      break;
-    }
-    if (!leaf->isHidden()) {
-      previousVisible = leaf;
+// Formatted parser expectations by offset: diagnostics of one recovery site
+// share their offset, so `Parser::expect` runs at most once per site.
+class ExpectationCache {
+public:
+  ExpectationCache(const workspace::Document &document,
+                   const parser::Parser &parserImpl,
+                   const utils::CancellationToken &cancelToken) noexcept
+      : _document(document), _parser(parserImpl), _cancelToken(cancelToken) {}
+
+  [[nodiscard]] const std::string &at(TextOffset offset) {
+    const auto [entry, inserted] = _expected.try_emplace(offset);
+    if (inserted) {
+      const auto expect = _parser.expect(_document.textDocument().getText(),
+                                         offset, _cancelToken);
+      entry->second = format_expect_frontier(expect.frontier);
     }
+    return entry->second;
   }
 
-  if (!previousVisible.has_value() || previousVisible->getEnd() >= offset) {
-    return offset;
-  }
-  return previousVisible->getEnd();
-}
+private:
+  const workspace::Document &_document;
+  const parser::Parser &_parser;
+  const utils::CancellationToken &_cancelToken;
+  std::unordered_map<TextOffset, std::string> _expected;
+};
 
 [[nodiscard]] constexpr bool is_ascii_whitespace(char c) noexcept {
   switch (c) {
@@ -294,13 +342,12 @@ previous_visible_leaf_end(const workspace::Document &document,
   }
 }
 
-[[nodiscard]] bool raw_text_gap_is_whitespace(const workspace::Document &document,
+[[nodiscard]] bool raw_text_gap_is_whitespace(std::string_view text,
                                               TextOffset begin,
                                               TextOffset end) {
   if (begin >= end) {
     return true;
   }
-  const auto text = std::string_view{document.textDocument().getText()};
   const auto safeBegin = std::min(begin, static_cast<TextOffset>(text.size()));
   const auto safeEnd = std::min(std::max(safeBegin, end),
                                 static_cast<TextOffset>(text.size()));
@@ -310,19 +357,16 @@ previous_visible_leaf_end(const workspace::Document &document,
       [](char c) { return is_ascii_whitespace(c); });
 }
 
-[[nodiscard]] bool gap_is_hidden_or_whitespace(const workspace::Document &document,
-                                               TextOffset begin,
-                                               TextOffset end) {
+bool ParseLeafIndex::gapIsHiddenOrWhitespace(TextOffset begin,
+                                             TextOffset end) const {
   if (begin >= end) {
     return true;
   }
-  if (document.parseResult.cst == nullptr) {
-    return raw_text_gap_is_whitespace(document, begin, end);
-  }
-
   TextOffset coveredUntil = begin;
-  for (auto leaf = find_first_leaf(*document.parseResult.cst); leaf.has_value();
-       leaf = find_next_leaf(*leaf)) {
+  for (auto leaf = std::ranges::partition_point(
+           _leaves,
+           [begin](const CstNodeView &leaf) { return leaf.getEnd() <= begin; });
+       leaf != _leaves.end(); ++leaf) {
     if (leaf->getEnd() <= coveredUntil) {
       continue;
     }
@@ -330,7 +374,7 @@ previous_visible_leaf_end(const workspace::Document &document,
       break;
     }
     if (leaf->getBegin() > coveredUntil &&
-        !raw_text_gap_is_whitespace(document, coveredUntil, leaf->getBegin())) {
+        !raw_text_gap_is_whitespace(_text, coveredUntil, leaf->getBegin())) {
       return false;
     }
     if (!leaf->isHidden()) {
@@ -341,12 +385,12 @@ previous_visible_leaf_end(const workspace::Document &document,
       return true;
     }
   }
-  return raw_text_gap_is_whitespace(document, coveredUntil, end);
+  return raw_text_gap_is_whitespace(_text, coveredUntil, end);
 }
 
 [[nodiscard]] TextOffset zero_width_diagnostic_offset(
-    const workspace::Document &document, TextOffset offset,
-    const FoundToken &foundToken) {
+    const workspace::Document &document, const ParseLeafIndex &leaves,
+    TextOffset offset, const FoundToken &foundToken) {
   const auto textSize =
       static_cast<TextOffset>(document.textDocument().getText().size());
   const auto safeOffset = std::min(offset, textSize);
@@ -354,8 +398,8 @@ previous_visible_leaf_end(const workspace::Document &document,
     return foundToken.image.empty() ? safeOffset
                                     : std::min(foundToken.begin, safeOffset);
   }
-  const auto previousVisibleEnd = previous_visible_leaf_end(document, safeOffset);
-  return gap_is_hidden_or_whitespace(document, previousVisibleEnd, safeOffset)
+  const auto previousVisibleEnd = leaves.previousVisibleEnd(safeOffset);
+  return leaves.gapIsHiddenOrWhitespace(previousVisibleEnd, safeOffset)
              ? previousVisibleEnd
              : safeOffset;
 }
@@ -417,9 +461,9 @@ parse_expectation_message(std::string_view message, const std::string &expected,
 }
 
 [[nodiscard]] pegium::Diagnostic from_parse_diagnostic(
-    const workspace::Document &document, const parser::Parser &parserImpl,
-    const parser::ParseDiagnostic &parseDiagnostic,
-    const utils::CancellationToken &cancelToken) {
+    const workspace::Document &document, const ParseLeafIndex &leaves,
+    ExpectationCache &expectations,
+    const parser::ParseDiagnostic &parseDiagnostic) {
   if (parseDiagnostic.kind == parser::ParseDiagnosticKind::ConversionError) {
     const auto [begin, end] =
         clamp_span(document.textDocument().getText(),
@@ -431,11 +475,19 @@ parse_expectation_message(std::string_view message, const std::string &expected,
     return diagnostic;
   }
 
-  const auto expectOffset = diagnostic_expect_offset(document, parseDiagnostic);
-  const auto foundToken = find_found_token(document, expectOffset);
-  auto expected = format_expect_element(parseDiagnostic.element);
-  if (expected.empty()) {
-    expected = expect_text(document, parserImpl, expectOffset, cancelToken);
+  using enum parser::ParseDiagnosticKind;
+  const auto expectOffset =
+      diagnostic_expect_offset(document, leaves, parseDiagnostic);
+  const auto foundToken = find_found_token(document, leaves, expectOffset);
+  // Only the messages built below mention what was expected: the element the
+  // recovery recorded, or else the parser expectations at the offset.
+  std::string expected;
+  if (parseDiagnostic.message.empty() && parseDiagnostic.kind != Deleted &&
+      parseDiagnostic.kind != Recovered) {
+    expected = format_expect_element(parseDiagnostic.element);
+    if (expected.empty()) {
+      expected = expectations.at(expectOffset);
+    }
   }
   const auto unexpectedMessage =
       foundToken.image.empty()
@@ -443,16 +495,15 @@ parse_expectation_message(std::string_view message, const std::string &expected,
           : "Unexpected token `" + std::string(foundToken.image) + "`.";
 
   auto zeroWidth =
-      (parseDiagnostic.kind == parser::ParseDiagnosticKind::Inserted ||
-       parseDiagnostic.kind == parser::ParseDiagnosticKind::Incomplete)
-          ? zero_width_diagnostic_offset(document, expectOffset, foundToken)
+      (parseDiagnostic.kind == Inserted || parseDiagnostic.kind == Incomplete)
+          ? zero_width_diagnostic_offset(document, leaves, expectOffset,
+                                         foundToken)
           : std::min<TextOffset>(
                 expectOffset,
                 static_cast<TextOffset>(document.textDocument().getText().size()));
   auto diagnostic =
       make_base_diagnostic(zeroWidth, zeroWidth, "parse.incomplete");
 
-  using enum parser::ParseDiagnosticKind;
   switch (parseDiagnostic.kind) {
   case Inserted:
     diagnostic.code = pegium::DiagnosticCode(std::string("parse.inserted"));
@@ -550,14 +601,70 @@ parse_expectation_message(std::string_view message, const std::string &expected,
   std::vector<pegium::Diagnostic> diagnostics;
   diagnostics.reserve(document.parseResult.parseDiagnostics.size());
 
+  const ParseLeafIndex leaves(document);
+  ExpectationCache expectations(document, parserImpl, cancelToken);
   for (const auto &parseDiagnostic : document.parseResult.parseDiagnostics) {
-    diagnostics.push_back(from_parse_diagnostic(document, parserImpl,
-                                                parseDiagnostic, cancelToken));
+    diagnostics.push_back(
+        from_parse_diagnostic(document, leaves, expectations, parseDiagnostic));
   }
 
   return diagnostics;
 }
 
+// Interned arguments of the linking-error templates, the reference text being
+// their owned one; the reference type is empty when unknown or irrelevant to
+// the error, the container type when there is none.
+enum : std::size_t {
+  kReferenceTypeArgument,
+  kPropertyArgument,
+  kContainerTypeArgument,
+  kLinkingErrorArgumentCount,
+};
+static_assert(kLinkingErrorArgumentCount <=
+              pegium::CompactDiagnostic::kMaxArguments);
+
+template <ReferenceState State>
+[[nodiscard]] std::string
+linking_error_message(pegium::DiagnosticTemplate::Arguments arguments) {
+  return AbstractReference::formatErrorMessage(
+      State, arguments.interned[kReferenceTypeArgument],
+      arguments.interned[kPropertyArgument], arguments.text);
+}
+
+// Structured linking-error data, so that clients (e.g. quick-fixes) can act on
+// the failing reference without re-parsing the message.
+[[nodiscard]] std::optional<pegium::JsonValue>
+linking_error_data(pegium::DiagnosticTemplate::Arguments arguments) {
+  pegium::JsonValue::Object data;
+  data.try_emplace("code", std::string("linking-error"));
+  if (const auto containerType = arguments.interned[kContainerTypeArgument];
+      !containerType.empty()) {
+    data.try_emplace("containerType", containerType.str());
+  }
+  data.try_emplace("property", arguments.interned[kPropertyArgument].str());
+  data.try_emplace("refText", std::string(arguments.text));
+  return pegium::JsonValue(std::move(data));
+}
+
+template <ReferenceState State>
+constexpr pegium::DiagnosticTemplate kLinkingErrorTemplate{
+    .message = &linking_error_message<State>, .data = &linking_error_data};
+
+[[nodiscard]] const pegium::DiagnosticTemplate &
+linking_error_template(ReferenceState state) noexcept {
+  using enum ReferenceState;
+  switch (state) {
+  case ErrorNoLinker:
+    return kLinkingErrorTemplate<ErrorNoLinker>;
+  case ErrorCycle:
+    return kLinkingErrorTemplate<ErrorCycle>;
+  case ErrorException:
+    return kLinkingErrorTemplate<ErrorException>;
+  default:
+    return kLinkingErrorTemplate<ErrorNotFound>;
+  }
+}
+
 } // namespace
 
 bool DefaultDocumentValidator::run_builtin_validation(
@@ -580,7 +687,7 @@ bool DefaultDocumentValidator::run_custom_validation(
 
 void DefaultDocumentValidator::processParsingErrors(
     const workspace::Document &document,
-    std::vector<pegium::Diagnostic> &diagnostics,
+    std::vector<pegium::CompactDiagnostic> &diagnostics,
     const utils::CancellationToken &cancelToken) const {
   if (document.parseResult.parseDiagnostics.empty()) {
     return;
@@ -588,19 +695,30 @@ void DefaultDocumentValidator::processParsingErrors(
   assert(services.parser != nullptr);
   auto parseDiagnostics =
       extract_parse_diagnostics(document, *services.parser, cancelToken);
-  const auto& source = services.languageMetaData.languageId;
+  const utils::InternedString source(services.languageMetaData.languageId);
+  diagnostics.reserve(diagnostics.size() + parseDiagnostics.size());
   for (auto &diagnostic : parseDiagnostics) {
-    diagnostic.source = source;
+    diagnostics.emplace_back(std::move(diagnostic)).source = source;
   }
-  diagnostics.insert(diagnostics.end(),
-                     std::make_move_iterator(parseDiagnostics.begin()),
-                     std::make_move_iterator(parseDiagnostics.end()));
 }
 
 void DefaultDocumentValidator::processLinkingErrors(
     const workspace::Document &document,
-    std::vector<pegium::Diagnostic> &diagnostics, const std::string &source,
+    std::vector<pegium::CompactDiagnostic> &diagnostics,
+    const std::string &source,
     const utils::CancellationToken &cancelToken) const {
+  static const utils::InternedString code("linking.unresolved-reference");
+  const utils::InternedString internedSource(source);
+  // Demangling is costly and a document only references a few types.
+  std::unordered_map<std::type_index, utils::InternedString> typeNames;
+  const auto type_name = [&typeNames](std::type_index type) {
+    const auto [entry, inserted] = typeNames.try_emplace(type);
+    if (inserted) {
+      entry->second = parser::detail::runtime_type_name(type);
+    }
+    return entry->second;
+  };
+
   std::uint32_t cancelPollCounter = 0;
   for (const auto &handle : document.parseResult.references) {
     if ((++cancelPollCounter & 0x3fU) == 0U) {
@@ -623,33 +741,35 @@ void DefaultDocumentValidator::processLinkingErrors(
       end = refNode.getEnd();
     }
 
-    // Carry the structured linking-error data so clients (e.g. quick-fixes) can
-    // act on the failing reference without re-parsing the message.
-    pegium::JsonValue::Object data;
-    data.try_emplace("code", std::string("linking-error"));
+    const auto state = reference.state();
+    auto &diagnostic = diagnostics.emplace_back();
+    diagnostic.severity = pegium::DiagnosticSeverity::Error;
+    diagnostic.begin = begin;
+    diagnostic.end = end;
+    diagnostic.source = internedSource;
+    diagnostic.code = code;
+    diagnostic.messageTemplate = &linking_error_template(state);
+    if (const auto type = reference.getReferenceType();
+        state == ReferenceState::ErrorNotFound &&
+        type != std::type_index(typeid(void))) {
+      diagnostic.arguments[kReferenceTypeArgument] = type_name(type);
+    }
+    diagnostic.arguments[kPropertyArgument] = reference.getFeature();
     if (const auto *container = reference.getContainer(); container != nullptr) {
-      data.try_emplace("containerType",
-                       parser::detail::runtime_type_name(typeid(*container)));
+      diagnostic.arguments[kContainerTypeArgument] =
+          type_name(typeid(*container));
     }
-    data.try_emplace("property", std::string(reference.getFeature()));
-    data.try_emplace("refText", refText);
-
-    diagnostics.push_back(pegium::Diagnostic{
-        .severity = pegium::DiagnosticSeverity::Error,
-        .message = reference.getErrorMessage(),
-        .source = source,
-        .code = pegium::DiagnosticCode(
-            std::string("linking.unresolved-reference")),
-        .data = pegium::JsonValue(std::move(data)),
-        .begin = begin,
-        .end = end});
+    // Reference texts are unbounded: they stay owned rather than interned.
+    diagnostic.text = refText;
   }
 }
 
 void DefaultDocumentValidator::validateAst(
-    const AstNode &rootNode, std::vector<pegium::Diagnostic> &diagnostics,
+    const workspace::Document &document,
+    std::vector<pegium::CompactDiagnostic> &diagnostics,
     const ValidationOptions &options, const std::string &source,
     const utils::CancellationToken &cancelToken) const {
+  const auto &rootNode = *document.parseResult.value;
   // Inline collector lambda: kept on this stack frame so the function_ref
   // inside `acceptor` stays valid for every callee below.
   const auto collect = [&diagnostics, &source](pegium::Diagnostic diagnostic) {
@@ -667,14 +787,42 @@ void DefaultDocumentValidator::validateAst(
     checkBefore(rootNode, acceptor, categories, cancelToken);
   }
 
-  registry.runChecks(rootNode, acceptor, categories, cancelToken);
-  std::uint32_t cancelPollCounter = 0;
-  for (const auto *node : rootNode.getAllContent()) {
-    if ((++cancelPollCounter & 0x3fU) == 0U) {
-      utils::throw_if_cancelled(cancelToken);
-    }
-    registry.runChecks(*node, acceptor, categories, cancelToken);
+  // Subtree-local checks replay what they raised in the previous validation
+  // of the document on every subtree left unchanged since, or, with a
+  // language-wide validation cache, on any identical subtree validated
+  // before, and only run on the others.
+  const SubtreeFingerprints fingerprints(document);
+  const auto previous = document.validationMemo->results();
+  auto *shared = services.validation.validationCache.get();
+  MemoizedCheckResults results(fingerprints, *previous, document.uri, shared);
+  registry.runChecks(rootNode, acceptor, categories, cancelToken, results);
+  auto recorded = results.takeRecorded();
+  auto *taskScheduler = services.shared.execution.taskScheduler.get();
+  if (const auto *arena = rootNode.arena();
+      taskScheduler != nullptr && arena != nullptr &&
+      options.concurrentNodeChecks.value_or(false) &&
+      arena->size() > kConcurrentValidationNodeCount) {
+    validateDescendantsInParallel(*taskScheduler, document, diagnostics,
+                                  categories, source, fingerprints, *previous,
+                                  recorded, cancelToken);
+  } else {
+    MemoizedCheckResults descendantResults(fingerprints, *previous,
+                                           document.uri, shared);
+    const auto &checkedTypes = registry.checkedTypes();
+    std::uint32_t cancelPollCounter = 0;
+    rootNode.visitDescendants([&](const AstNode &node) {
+      if (checkedTypes.selects(node)) {
+        if ((++cancelPollCounter & 0x3fU) == 0U) {
+          utils::throw_if_cancelled(cancelToken);
+        }
+        registry.runChecks(node, acceptor, categories, cancelToken,
+                           descendantResults);
+      }
+      return checkedTypes.mayContainSelected(node);
+    });
+    recorded.merge(descendantResults.takeRecorded());
   }
+  document.validationMemo->retain(std::move(recorded));
 
   for (const auto &checkAfter : registry.checksAfter()) {
     utils::throw_if_cancelled(cancelToken);
@@ -682,13 +830,96 @@ void DefaultDocumentValidator::validateAst(
   }
 }
 
+void DefaultDocumentValidator::validateDescendantsInParallel(
+    execution::TaskScheduler &taskScheduler,
+    const workspace::Document &document,
+    std::vector<pegium::CompactDiagnostic> &diagnostics,
+    std::span<const std::string> categories, const std::string &source,
+    const SubtreeFingerprints &fingerprints,
+    const ValidationMemo::Table &previous, ValidationMemo::Table &recorded,
+    const utils::CancellationToken &cancelToken) const {
+  const auto &rootNode = *document.parseResult.value;
+  const auto &registry = *services.validation.validationRegistry;
+  const auto &checkedTypes = registry.checkedTypes();
+  auto *shared = services.validation.validationCache.get();
+  std::vector<const AstNode *> nodes;
+  nodes.reserve(rootNode.arena()->size());
+  rootNode.visitDescendants([&nodes, &checkedTypes](const AstNode &node) {
+    if (checkedTypes.selects(node)) {
+      nodes.push_back(&node);
+    }
+    return checkedTypes.mayContainSelected(node);
+  });
+
+  // Contiguous slices of the document-order traversal, each collecting into
+  // its own buffers; appending the buffers in slice order yields exactly the
+  // diagnostics of a serial run.
+  const auto sliceCount =
+      (nodes.size() + kValidationSliceSize - 1) / kValidationSliceSize;
+  std::vector<std::vector<pegium::CompactDiagnostic>> sliceDiagnostics(
+      sliceCount);
+  std::vector<ValidationMemo::Table> sliceResults(sliceCount);
+  taskScheduler.parallelFor(
+      cancelToken, std::views::iota(std::size_t{0}, sliceCount),
+      [&](std::size_t slice) {
+        auto &buffer = sliceDiagnostics[slice];
+        const auto collect = [&buffer, &source](pegium::Diagnostic diagnostic) {
+          if (diagnostic.source.empty()) {
+            diagnostic.source = source;
+          }
+          buffer.push_back(std::move(diagnostic));
+        };
+        const ValidationAcceptor acceptor{ValidationAcceptor::Callback(collect)};
+        MemoizedCheckResults results(fingerprints, previous, document.uri,
+                                     shared);
+        const auto begin = slice * kValidationSliceSize;
+        const auto end = std::min(begin + kValidationSliceSize, nodes.size());
+        for (auto index = begin; index < end; ++index) {
+          if (((index - begin) & 0x3fU) == 0x3fU) {
+            utils::throw_if_cancelled(cancelToken);
+          }
+          registry.runChecks(*nodes[index], acceptor, categories, cancelToken,
+                             results);
+        }
+        sliceResults[slice] = results.takeRecorded();
+      });
+
+  for (auto &buffer : sliceDiagnostics) {
+    std::ranges::move(buffer, std::back_inserter(diagnostics));
+  }
+  for (auto &results : sliceResults) {
+    recorded.merge(std::move(results));
+  }
+}
+
 std::vector<pegium::Diagnostic> DefaultDocumentValidator::validateDocument(
     const workspace::Document &document, const ValidationOptions &options,
     const utils::CancellationToken &cancelToken) const {
+  return pegium::materialize(
+      validateDocumentCompact(document, options, cancelToken));
+}
+
+std::vector<pegium::CompactDiagnostic>
+DefaultDocumentValidator::validateDocumentCompact(
+    const workspace::Document &document, const ValidationOptions &options,
+    const utils::CancellationToken &cancelToken,
+    const Progress &progress) const {
   utils::throw_if_cancelled(cancelToken);
 
-  std::vector<pegium::Diagnostic> diagnostics;
+  std::vector<pegium::CompactDiagnostic> diagnostics;
   const auto& source = services.languageMetaData.languageId;
+  // Progress is only reported at the stage boundaries of the built-in
+  // validation, for prefixes that grew and never once cancelled: the caller
+  // publishes what it receives, and the end of the checks is the result.
+  std::size_t reportedCount = 0;
+  const auto reportProgress = [&]() {
+    if (!progress || diagnostics.size() == reportedCount) {
+      return;
+    }
+    utils::throw_if_cancelled(cancelToken);
+    reportedCount = diagnostics.size();
+    progress(diagnostics);
+  };
 
   if (run_builtin_validation(options)) {
     const auto parsingDiagnosticCount = diagnostics.size();
@@ -697,6 +928,7 @@ std::vector<pegium::Diagnostic> DefaultDocumentValidator::validateDocument(
         diagnostics.size() > parsingDiagnosticCount) {
       return diagnostics;
     }
+    reportProgress();
 
     const auto linkingDiagnosticCount = diagnostics.size();
     processLinkingErrors(document, diagnostics, source, cancelToken);
@@ -704,14 +936,14 @@ std::vector<pegium::Diagnostic> DefaultDocumentValidator::validateDocument(
         diagnostics.size() > linkingDiagnosticCount) {
       return diagnostics;
     }
+    reportProgress();
   }
 
   if (!document.hasAst() || !run_custom_validation(options)) {
     return diagnostics;
   }
 
-  validateAst(*document.parseResult.value, diagnostics, options, source,
-              cancelToken);
+  validateAst(document, diagnostics, options, source, cancelToken);
 
   utils::throw_if_cancelled(cancelToken);
   return diagnostics;
@@ -1,17 +1,44 @@
 #pragma once
 
+#include <span>
+#include <string>
 #include <vector>
 
 #include <pegium/core/services/DefaultCoreService.hpp>
 #include <pegium/core/validation/DocumentValidator.hpp>
+#include <pegium/core/validation/ValidationMemo.hpp>
 
 namespace pegium {
 struct CoreServices;
 }
 
+namespace pegium::execution {
+class TaskScheduler;
+}
+
 namespace pegium::validation {
 
 /// Default validator combining parser, linker, and custom validation checks.
+///
+/// Per-node checks only visit the nodes `ValidationRegistry::checkedTypes()`
+/// selects, skipping the subtrees that cannot hold one.
+///
+/// With `ValidationOptions::concurrentNodeChecks`, the per-node checks of huge
+/// ASTs run concurrently on the shared task scheduler, over slices of the
+/// document-order traversal; diagnostics come out in the same order as a
+/// serial run. `checksBefore()` and `checksAfter()` always run serially.
+///
+/// Checks registered with a `ValidationCheckLocality` other than `Global` only
+/// run on subtrees that changed since the previous validation of the
+/// document; elsewhere their diagnostics are taken from
+/// `Document::validationMemo`.
+///
+/// Linking errors are produced in compact form: their messages and `data` are
+/// only rendered when the diagnostics are materialised.
+///
+/// Progress is only reported at stage boundaries, after parse errors and after
+/// linking errors, whenever new diagnostics were raised; the end of the checks
+/// is the result itself.
 class DefaultDocumentValidator : public DocumentValidator,
                                  protected pegium::DefaultCoreService {
 public:
@@ -22,22 +49,35 @@ public:
                    const ValidationOptions &options,
                    const utils::CancellationToken &cancelToken) const override;
 
+  [[nodiscard]] std::vector<pegium::CompactDiagnostic> validateDocumentCompact(
+      const workspace::Document &document, const ValidationOptions &options,
+      const utils::CancellationToken &cancelToken,
+      const Progress &progress = {}) const override;
+
 private:
   [[nodiscard]] bool run_builtin_validation(
       const ValidationOptions &options) const noexcept;
   [[nodiscard]] bool run_custom_validation(
       const ValidationOptions &options) const noexcept;
   void processParsingErrors(const workspace::Document &document,
-                            std::vector<pegium::Diagnostic> &diagnostics,
+                            std::vector<pegium::CompactDiagnostic> &diagnostics,
                             const utils::CancellationToken &cancelToken) const;
   void processLinkingErrors(const workspace::Document &document,
-                            std::vector<pegium::Diagnostic> &diagnostics,
+                            std::vector<pegium::CompactDiagnostic> &diagnostics,
                             const std::string &source,
                             const utils::CancellationToken &cancelToken) const;
-  void validateAst(const AstNode &rootNode,
-                   std::vector<pegium::Diagnostic> &diagnostics,
+  void validateAst(const workspace::Document &document,
+                   std::vector<pegium::CompactDiagnostic> &diagnostics,
                    const ValidationOptions &options, const std::string &source,
                    const utils::CancellationToken &cancelToken) const;
+  void validateDescendantsInParallel(
+      execution::TaskScheduler &taskScheduler,
+      const workspace::Document &document,
+      std::vector<pegium::CompactDiagnostic> &diagnostics,
+      std::span<const std::string> categories, const std::string &source,
+      const SubtreeFingerprints &fingerprints,
+      const ValidationMemo::Table &previous, ValidationMemo::Table &recorded,
+      const utils::CancellationToken &cancelToken) const;
 };
 
 } // namespace pegium::validation
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <string>
@@ -12,6 +14,7 @@
 
 #include <pegium/core/observability/ObservabilitySink.hpp>
 #include <pegium/core/services/SharedCoreServices.hpp>
+#include <pegium/core/syntax-tree/AstArena.hpp>
 #include <pegium/core/syntax-tree/AstUtils.hpp>
 #include <pegium/core/utils/Errors.hpp>
 #include <pegium/core/utils/TypeIndexHash.hpp>
@@ -25,6 +28,9 @@ struct CompiledValidationCheckEntry {
   std::type_index targetType = std::type_index(typeid(AstNode));
   ValidationCheck check; // unwrapped: try/catch is hoisted to runChecks
   std::string category;
+  ValidationCheckLocality locality = ValidationCheckLocality::Global;
+  // Registration index: stable, since registration only appends.
+  std::uint32_t id = 0;
 };
 
 using CompiledValidationCheckList =
@@ -37,6 +43,12 @@ struct CompiledValidationRegistry {
   std::vector<std::string> knownCategories;
   std::vector<CompiledValidationCheckEntry> checks;
   CompiledValidationCheckIndex checksByType;
+  // `checksByType`, indexed by the dense type ids of `reflection`. Nodes whose
+  // arena uses another reflection, or whose type was registered later, go
+  // through `checksByType`.
+  const AstReflection *reflection = nullptr;
+  std::vector<CompiledValidationCheckList> checksById;
+  AstTypeFilter checkedTypes;
   std::shared_ptr<observability::ObservabilitySink> sink;
 };
 
@@ -117,7 +129,9 @@ DefaultValidationRegistry::compiledRegistry() const {
     compiled->checks.push_back(detail::CompiledValidationCheckEntry{
         .targetType = entry.targetType,
         .check = entry.check,
-        .category = entry.category});
+        .category = entry.category,
+        .locality = entry.locality,
+        .id = static_cast<std::uint32_t>(compiled->checks.size())});
   }
 
   const auto &reflection = *services.shared.astReflection;
@@ -130,6 +144,20 @@ DefaultValidationRegistry::compiledRegistry() const {
       compiled->checksByType[subtype].push_back(&entry);
     }
   }
+  compiled->reflection = &reflection;
+  compiled->checksById.resize(reflection.typeCount());
+  for (const auto &[type, checks] : compiled->checksByType) {
+    if (const auto id = reflection.typeId(type); id != kNoAstType) {
+      compiled->checksById[id] = checks;
+    }
+  }
+  std::vector<std::type_index> targetTypes;
+  for (const auto &entry : compiled->checks) {
+    if (std::ranges::find(targetTypes, entry.targetType) == targetTypes.end()) {
+      targetTypes.push_back(entry.targetType);
+    }
+  }
+  compiled->checkedTypes = AstTypeFilter(reflection, targetTypes);
 
   compiled->sink = services.shared.observabilitySink;
 
@@ -151,7 +179,8 @@ void DefaultValidationRegistry::registerTypedCheck(
   _registeredChecks.push_back(RegisteredValidationCheckEntry{
       .targetType = registration.targetType,
       .check = std::move(registration.check),
-      .category = storedCategory});
+      .category = storedCategory,
+      .locality = registration.locality});
   if (std::ranges::find(_knownCategories, storedCategory) ==
       _knownCategories.end()) {
     _knownCategories.push_back(storedCategory);
@@ -163,6 +192,27 @@ void DefaultValidationRegistry::runChecks(
     const AstNode &node, const ValidationAcceptor &acceptor,
     std::span<const std::string> categories,
     const utils::CancellationToken &cancelToken) const {
+  runChecksWith(node, acceptor, categories, cancelToken, nullptr);
+}
+
+void DefaultValidationRegistry::runChecks(
+    const AstNode &node, const ValidationAcceptor &acceptor,
+    std::span<const std::string> categories,
+    const utils::CancellationToken &cancelToken,
+    LocalCheckResults &results) const {
+  runChecksWith(node, acceptor, categories, cancelToken,
+                std::addressof(results));
+}
+
+const AstTypeFilter &DefaultValidationRegistry::checkedTypes() const {
+  return compiledRegistry()->checkedTypes;
+}
+
+void DefaultValidationRegistry::runChecksWith(
+    const AstNode &node, const ValidationAcceptor &acceptor,
+    std::span<const std::string> categories,
+    const utils::CancellationToken &cancelToken,
+    LocalCheckResults *results) const {
   // Publish the compiled snapshot exactly once (compiledRegistry() is
   // thread-safe), then read it lock-free. Registration — the only mutation — is
   // done before any build, so `_compiled` is stable across the parallel
@@ -171,9 +221,23 @@ void DefaultValidationRegistry::runChecks(
     (void)compiledRegistry();
   }
   const auto &compiled = *_compiled;
-  const auto checksIt =
-      compiled.checksByType.find(std::type_index(typeid(node)));
-  if (checksIt == compiled.checksByType.end()) {
+  const detail::CompiledValidationCheckList *checks = nullptr;
+  if (const auto *arena = node.arena();
+      arena != nullptr && arena->reflection() == compiled.reflection) {
+    if (const auto typeId = arena->typeId(node.symbolId());
+        typeId < compiled.checksById.size()) {
+      checks = &compiled.checksById[typeId];
+    }
+  }
+  if (checks == nullptr) {
+    const auto checksIt =
+        compiled.checksByType.find(std::type_index(typeid(node)));
+    if (checksIt == compiled.checksByType.end()) {
+      return;
+    }
+    checks = &checksIt->second;
+  }
+  if (checks->empty()) {
     return;
   }
 
@@ -183,14 +247,39 @@ void DefaultValidationRegistry::runChecks(
   // so it is safe to share across documents validated in parallel.
   const bool allCategories = categories.empty();
 
-  for (const auto *entry : checksIt->second) {
+  for (const auto *entry : *checks) {
     utils::throw_if_cancelled(cancelToken);
     if (!allCategories &&
         std::ranges::find(categories, entry->category) == categories.end()) {
       continue;
     }
     try {
-      entry->check(node, acceptor, cancelToken);
+      if (results == nullptr ||
+          entry->locality == ValidationCheckLocality::Global) {
+        entry->check(node, acceptor, cancelToken);
+      } else if (!results->replay(node, entry->id, entry->locality,
+                                  acceptor)) {
+        std::vector<pegium::Diagnostic> raised;
+        const auto capture = [&raised](pegium::Diagnostic diagnostic) {
+          raised.push_back(std::move(diagnostic));
+        };
+        const auto forward = [&raised, &acceptor] {
+          for (auto &diagnostic : raised) {
+            acceptor(std::move(diagnostic));
+          }
+        };
+        try {
+          entry->check(node,
+                       ValidationAcceptor{ValidationAcceptor::Callback(capture)},
+                       cancelToken);
+        } catch (...) {
+          // Not recorded: a check that throws runs again next time.
+          forward();
+          throw;
+        }
+        results->record(node, entry->id, entry->locality, raised);
+        forward();
+      }
     } catch (const std::exception &error) {
       if (dynamic_cast<const utils::OperationCancelled *>(&error) != nullptr) {
         throw;
@@ -47,14 +47,26 @@ public:
   void runChecks(const AstNode &node, const ValidationAcceptor &acceptor,
                  std::span<const std::string> categories,
                  const utils::CancellationToken &cancelToken) const override;
+  void runChecks(const AstNode &node, const ValidationAcceptor &acceptor,
+                 std::span<const std::string> categories,
+                 const utils::CancellationToken &cancelToken,
+                 LocalCheckResults &results) const override;
+  [[nodiscard]] const AstTypeFilter &checkedTypes() const override;
 
 private:
   struct RegisteredValidationCheckEntry {
     std::type_index targetType = std::type_index(typeid(AstNode));
     ValidationCheck check;
     std::string category;
+    ValidationCheckLocality locality = ValidationCheckLocality::Global;
   };
 
+  // Shared by both `runChecks` overloads; `results` may be null.
+  void runChecksWith(const AstNode &node, const ValidationAcceptor &acceptor,
+                     std::span<const std::string> categories,
+                     const utils::CancellationToken &cancelToken,
+                     LocalCheckResults *results) const;
+
   static void validate_category(std::string_view category);
 
   /// Returns the compiled snapshot, building it on first use. Thread-safe: the
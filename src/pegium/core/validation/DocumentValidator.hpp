@@ -1,10 +1,14 @@
 #pragma once
 
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include <pegium/core/services/CompactDiagnostic.hpp>
 #include <pegium/core/services/Diagnostic.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/validation/ValidationOptions.hpp>
@@ -23,6 +27,29 @@ public:
   validateDocument(const workspace::Document &document,
                    const ValidationOptions &options,
                    const utils::CancellationToken &cancelToken) const = 0;
+
+  /// Receives the diagnostics a running validation has produced so far.
+  using Progress =
+      std::function<void(std::span<const pegium::CompactDiagnostic> diagnostics)>;
+
+  /// Returns the diagnostics of `validateDocument(...)` in the form
+  /// `Document::diagnostics` holds them. The default compacts the result of
+  /// `validateDocument(...)`; validators that can defer rendering messages
+  /// override it.
+  ///
+  /// `progress`, when set, may be invoked on the calling thread with growing
+  /// prefixes of the result while the validation runs, so that callers can
+  /// show early results. The default never invokes it.
+  [[nodiscard]] virtual std::vector<pegium::CompactDiagnostic>
+  validateDocumentCompact(const workspace::Document &document,
+                          const ValidationOptions &options,
+                          const utils::CancellationToken &cancelToken,
+                          const Progress &progress = {}) const {
+    (void)progress;
+    auto diagnostics = validateDocument(document, options, cancelToken);
+    return {std::make_move_iterator(diagnostics.begin()),
+            std::make_move_iterator(diagnostics.end())};
+  }
 };
 
 } // namespace pegium::validation
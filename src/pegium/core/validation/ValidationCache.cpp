@@ -0,0 +1,108 @@
+#include <pegium/core/validation/ValidationCache.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace pegium::validation {
+
+namespace {
+
+const ValidationMemo::Diagnostics &no_diagnostics() {
+  static const ValidationMemo::Diagnostics empty =
+      std::make_shared<const std::vector<pegium::Diagnostic>>();
+  return empty;
+}
+
+} // namespace
+
+ValidationCache::ValidationCache(std::size_t capacity)
+    : _capacity(capacity),
+      _shardCount(std::clamp<std::size_t>(capacity / kMinShardCapacity, 1,
+                                          kMaxShardCount)),
+      _shardCapacity((capacity + _shardCount - 1) / _shardCount),
+      _shards(std::make_unique<Shard[]>(_shardCount)) {}
+
+ValidationCache::Shard &
+ValidationCache::shardOf(const ValidationMemo::Key &key) const noexcept {
+  return _shards[ValidationMemo::KeyHash{}(key) % _shardCount];
+}
+
+std::size_t ValidationCache::size() const {
+  std::size_t size = 0;
+  for (std::size_t index = 0; index < _shardCount; ++index) {
+    const auto &shard = _shards[index];
+    const std::scoped_lock lock(shard.mutex);
+    size += shard.entries.size() + shard.clean.size() +
+            shard.previousClean.size();
+  }
+  return size;
+}
+
+ValidationMemo::Diagnostics
+ValidationCache::find(const ValidationMemo::Key &key) const {
+  auto &shard = shardOf(key);
+  const std::scoped_lock lock(shard.mutex);
+  if (shard.clean.contains(key) || shard.previousClean.contains(key)) {
+    return no_diagnostics();
+  }
+  const auto entry = shard.entries.find(key);
+  if (entry == shard.entries.end()) {
+    return nullptr;
+  }
+  shard.uses.splice(shard.uses.begin(), shard.uses, entry->second.use);
+  return entry->second.diagnostics;
+}
+
+void ValidationCache::insert(const ValidationMemo::Key &key,
+                             ValidationMemo::Diagnostics diagnostics) {
+  if (_capacity == 0) {
+    return;
+  }
+  auto &shard = shardOf(key);
+  const std::scoped_lock lock(shard.mutex);
+  if (diagnostics == nullptr || diagnostics->empty()) {
+    if (const auto entry = shard.entries.find(key);
+        entry != shard.entries.end()) {
+      shard.uses.erase(entry->second.use);
+      shard.entries.erase(entry);
+    }
+    if (shard.previousClean.contains(key)) {
+      return;
+    }
+    if (shard.clean.size() >= _shardCapacity) {
+      shard.previousClean = std::move(shard.clean);
+      shard.clean.clear();
+    }
+    shard.clean.insert(key);
+    return;
+  }
+  shard.clean.erase(key);
+  shard.previousClean.erase(key);
+  if (const auto entry = shard.entries.find(key);
+      entry != shard.entries.end()) {
+    entry->second.diagnostics = std::move(diagnostics);
+    shard.uses.splice(shard.uses.begin(), shard.uses, entry->second.use);
+    return;
+  }
+  if (shard.entries.size() >= _shardCapacity) {
+    shard.entries.erase(shard.uses.back());
+    shard.uses.pop_back();
+  }
+  shard.uses.push_front(key);
+  shard.entries.emplace(key, Entry{.diagnostics = std::move(diagnostics),
+                                   .use = shard.uses.begin()});
+}
+
+void ValidationCache::clear() {
+  for (std::size_t index = 0; index < _shardCount; ++index) {
+    auto &shard = _shards[index];
+    const std::scoped_lock lock(shard.mutex);
+    shard.entries.clear();
+    shard.uses.clear();
+    shard.clean.clear();
+    shard.previousClean.clear();
+  }
+}
+
+} // namespace pegium::validation
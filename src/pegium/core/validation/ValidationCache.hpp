@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <pegium/core/validation/ValidationMemo.hpp>
+
+namespace pegium::validation {
+
+/// Diagnostics of the non-`Global` checks of a language, by subtree
+/// fingerprint and check, shared by all its documents: a subtree identical to
+/// one already validated, in any document, replays its results instead of
+/// running those checks again.
+///
+/// Entries are content-addressed, so workspace updates never invalidate them;
+/// the least recently used ones are evicted beyond `capacity()` entries.
+/// Results without diagnostics only keep their key, outside of that order, in
+/// two generations of up to `capacity()` keys: the older one is dropped at
+/// once when the latest one is full.
+/// Results with related information in the document that raised them are not
+/// shared.
+///
+/// Thread-safe. Keys are spread over independently locked shards, so that
+/// concurrent validations seldom contend.
+class ValidationCache {
+public:
+  static constexpr std::size_t kDefaultCapacity = std::size_t{1} << 16U;
+
+  explicit ValidationCache(std::size_t capacity = kDefaultCapacity);
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return _capacity; }
+  [[nodiscard]] std::size_t size() const;
+
+  /// Returns the results stored under `key`, empty when the checks raised
+  /// nothing, or null.
+  [[nodiscard]] ValidationMemo::Diagnostics
+  find(const ValidationMemo::Key &key) const;
+  /// Stores `diagnostics` under `key`, evicting the least recently used
+  /// results when the cache is full. Null or empty `diagnostics` record that
+  /// the checks raised nothing.
+  void insert(const ValidationMemo::Key &key,
+              ValidationMemo::Diagnostics diagnostics);
+  void clear();
+
+private:
+  static constexpr std::size_t kMaxShardCount = 16;
+  static constexpr std::size_t kMinShardCapacity = 1024;
+
+  using UseList = std::list<ValidationMemo::Key>;
+  using KeySet = std::unordered_set<ValidationMemo::Key, ValidationMemo::KeyHash>;
+  struct Entry {
+    ValidationMemo::Diagnostics diagnostics;
+    UseList::iterator use;
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    // Keys from the most to the least recently used.
+    mutable UseList uses;
+    std::unordered_map<ValidationMemo::Key, Entry, ValidationMemo::KeyHash>
+        entries;
+    // Keys of the results without diagnostics, the latest ones first.
+    KeySet clean;
+    KeySet previousClean;
+  };
+
+  [[nodiscard]] Shard &shardOf(const ValidationMemo::Key &key) const noexcept;
+
+  std::size_t _capacity;
+  std::size_t _shardCount;
+  std::size_t _shardCapacity;
+  std::unique_ptr<Shard[]> _shards;
+};
+
+} // namespace pegium::validation
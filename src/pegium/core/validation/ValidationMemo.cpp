@@ -0,0 +1,347 @@
+#include <pegium/core/validation/ValidationMemo.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include <pegium/core/syntax-tree/AbstractReference.hpp>
+#include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/utils/ContentHash.hpp>
+#include <pegium/core/utils/TypeIndexHash.hpp>
+#include <pegium/core/validation/ValidationCache.hpp>
+#include <pegium/core/workspace/Document.hpp>
+
+namespace pegium::validation {
+
+namespace {
+
+// splitmix64 finalizer: sums of mixed values stay collision-resistant, so that
+// the hashes of the references of a subtree can be added up in any order.
+constexpr std::uint64_t mix(std::uint64_t value) noexcept {
+  value ^= value >> 30U;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27U;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31U;
+  return value;
+}
+
+// Grammar elements are static objects of the language, so their addresses
+// identify them in every document of a process.
+std::uint64_t node_hash(const AstNode &node) noexcept {
+  const auto cstNode = node.getCstNode();
+  const auto text = cstNode.valid() ? cstNode.getText() : std::string_view{};
+  const auto element = reinterpret_cast<std::uintptr_t>(
+      cstNode.valid() ? cstNode.getGrammarElement() : nullptr);
+  return mix(utils::content_hash(text) ^
+             mix(utils::FastTypeIndexHash{}(std::type_index(typeid(node))) ^
+                 mix(static_cast<std::uint64_t>(element))));
+}
+
+std::uint64_t description_hash(const workspace::AstNodeDescription &description) {
+  auto hash = mix(std::hash<utils::InternedString>{}(description.name) ^
+                  utils::FastTypeIndexHash{}(description.type));
+  return mix(hash ^ description.documentId);
+}
+
+std::uint64_t reference_hash(
+    const AbstractReference &reference,
+    std::unordered_map<const AstNode *, std::uint64_t> &targetHashes) {
+  auto hash = mix(utils::content_hash(reference.getRefText()) ^
+                  static_cast<std::uint64_t>(reference.state()));
+  if (reference.state() != ReferenceState::Resolved) {
+    return hash;
+  }
+  if (!reference.isMultiReference()) {
+    const auto &single = static_cast<const AbstractSingleReference &>(reference);
+    hash = mix(hash ^ description_hash(single.resolvedDescription()));
+    if (const auto *target = single.resolve(); target != nullptr) {
+      const auto [entry, inserted] = targetHashes.try_emplace(target, 0);
+      if (inserted) {
+        entry->second = node_hash(*target);
+      }
+      hash = mix(hash ^ entry->second);
+    }
+    return hash;
+  }
+  // Targets of multi-references are only known by description: a change of
+  // their document changes the symbol id, and with it the hash.
+  const auto &multi = static_cast<const AbstractMultiReference &>(reference);
+  for (std::size_t index = 0; index < multi.resolvedDescriptionCount();
+       ++index) {
+    const auto &description = multi.resolvedDescriptionAt(index);
+    hash = mix(hash ^ description_hash(description) ^
+               (static_cast<std::uint64_t>(description.symbolId) << 32U));
+  }
+  return hash;
+}
+
+// Moves `offset` from the frame of `from` to the frame of `to`; unsigned
+// wrap-around makes relative offsets before the node round-trip exactly.
+constexpr TextOffset rebase(TextOffset offset, TextOffset from,
+                            TextOffset to) noexcept {
+  return offset - from + to;
+}
+
+// Whether `diagnostics` may be replayed in other documents: related
+// information in their own document is relative to their node.
+bool shareable(const std::vector<pegium::Diagnostic> &diagnostics,
+               std::string_view uri) noexcept {
+  for (const auto &diagnostic : diagnostics) {
+    for (const auto &related : diagnostic.relatedInformation) {
+      if (related.uri.empty() || related.uri == uri) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+const ValidationMemo::Diagnostics &no_diagnostics() {
+  static const ValidationMemo::Diagnostics empty =
+      std::make_shared<const std::vector<pegium::Diagnostic>>();
+  return empty;
+}
+
+} // namespace
+
+std::optional<std::uint64_t>
+SubtreeFingerprints::of(const AstNode &node,
+                        ValidationCheckLocality locality) const {
+  const auto cstNode = node.getCstNode();
+  if (locality == ValidationCheckLocality::Global || !cstNode.valid()) {
+    return std::nullopt;
+  }
+  std::uint64_t hash = 0;
+  if (&cstNode.root() == _document->parseResult.cst.get()) {
+    std::call_once(_cstHashed, [this] { hashCst(); });
+    hash = mix(_cstHashes[cstNode.id()] ^
+               utils::FastTypeIndexHash{}(std::type_index(typeid(node))));
+  } else {
+    hash = node_hash(node);
+  }
+  if (locality == ValidationCheckLocality::Subtree) {
+    return hash;
+  }
+
+  std::call_once(_referencesHashed, [this] { hashReferences(); });
+  std::uint64_t references = 0;
+  if (node.arena() == _document->parseResult.astArena.get() &&
+      node.symbolId() < _referenceHashes.size()) {
+    references = _referenceHashes[node.symbolId()];
+  }
+  return mix(hash ^ mix(references + 1U));
+}
+
+void SubtreeFingerprints::hashCst() const {
+  const auto *cst = _document->parseResult.cst.get();
+  if (cst == nullptr) {
+    return;
+  }
+  const auto text = cst->getText();
+  const auto hashText = [&text](TextOffset begin, TextOffset end) {
+    return utils::content_hash(text.substr(begin, end - begin));
+  };
+  // Children are stored after their parent: hashing the nodes from the last
+  // one combines each parent with the hashes of its children. Each parent also
+  // hashes the text between its children, so that every character is hashed
+  // once, along with the offsets of the children within their parent.
+  _cstHashes.assign(cst->nodeCount(), 0);
+  for (auto id = cst->nodeCount(); id-- > 0;) {
+    const auto node = cst->get(id);
+    const auto element = mix(reinterpret_cast<std::uintptr_t>(
+        node.getGrammarElement()));
+    const auto begin = node.getBegin();
+    if (node.isLeaf()) {
+      _cstHashes[id] = mix(hashText(begin, node.getEnd()) ^ element);
+      continue;
+    }
+    auto hash = element;
+    auto covered = begin;
+    for (const auto child : node) {
+      hash = mix(hash ^ hashText(covered, child.getBegin()));
+      hash = mix(hash ^ mix(child.getBegin() - begin) ^ _cstHashes[child.id()]);
+      covered = child.getEnd();
+    }
+    hash = mix(hash ^ hashText(covered, node.getEnd()));
+    _cstHashes[id] = mix(hash ^ (node.getEnd() - begin));
+  }
+}
+
+void SubtreeFingerprints::hashReferences() const {
+  const auto *arena = _document->parseResult.astArena.get();
+  const auto *root = _document->parseResult.value;
+  if (arena == nullptr || root == nullptr) {
+    return;
+  }
+  _referenceHashes.assign(arena->size(), 0);
+  std::unordered_map<const AstNode *, std::uint64_t> targetHashes;
+  for (const auto &handle : _document->parseResult.references) {
+    const auto *reference = handle.getConst();
+    const auto *container = reference->getContainer();
+    if (container == nullptr || container->arena() != arena) {
+      continue;
+    }
+    _referenceHashes[container->symbolId()] +=
+        reference_hash(*reference, targetHashes);
+  }
+
+  // Adds the sums of the subtrees up into their containers, children first.
+  std::vector<const AstNode *> nodes;
+  nodes.reserve(arena->size());
+  root->visitDescendants([&nodes](const AstNode &node) {
+    nodes.push_back(&node);
+    return true;
+  });
+  for (const auto *node : std::views::reverse(nodes)) {
+    const auto *container = node->getContainer();
+    if (container != nullptr && container->arena() == arena) {
+      _referenceHashes[container->symbolId()] +=
+          _referenceHashes[node->symbolId()];
+    }
+  }
+}
+
+std::size_t
+ValidationMemo::KeyHash::operator()(const Key &key) const noexcept {
+  return static_cast<std::size_t>(mix(key.fingerprint ^ key.checkId));
+}
+
+const ValidationMemo::Diagnostics *
+ValidationMemo::Table::find(const Key &key) const {
+  if (std::ranges::binary_search(_clean, key)) {
+    return &no_diagnostics();
+  }
+  const auto entry = _diagnostics.find(key);
+  return entry != _diagnostics.end() ? &entry->second : nullptr;
+}
+
+void ValidationMemo::Table::insert(const Key &key, Diagnostics diagnostics) {
+  if (diagnostics == nullptr || diagnostics->empty()) {
+    _clean.push_back(key);
+  } else {
+    _diagnostics.insert_or_assign(key, std::move(diagnostics));
+  }
+}
+
+void ValidationMemo::Table::merge(Table &&other) {
+  _diagnostics.merge(other._diagnostics);
+  _clean.insert(_clean.end(), other._clean.begin(), other._clean.end());
+}
+
+void ValidationMemo::Table::seal() {
+  std::ranges::sort(_clean);
+  const auto duplicates = std::ranges::unique(_clean);
+  _clean.erase(duplicates.begin(), duplicates.end());
+}
+
+std::shared_ptr<const ValidationMemo::Table> ValidationMemo::results() const {
+  static const auto empty = std::make_shared<const Table>();
+  const std::scoped_lock lock(_mutex);
+  return _results != nullptr ? _results : empty;
+}
+
+void ValidationMemo::retain(Table results) {
+  results.seal();
+  auto retained = std::make_shared<const Table>(std::move(results));
+  const std::scoped_lock lock(_mutex);
+  _results = std::move(retained);
+}
+
+std::optional<std::uint64_t>
+MemoizedCheckResults::fingerprint(const AstNode &node,
+                                  ValidationCheckLocality locality) {
+  if (&node != _lastNode) {
+    _lastNode = &node;
+    _lastFingerprints = {};
+  }
+  auto &known = _lastFingerprints[static_cast<std::size_t>(locality)];
+  if (!known.has_value()) {
+    known = _fingerprints->of(node, locality);
+  }
+  return *known;
+}
+
+bool MemoizedCheckResults::replay(const AstNode &node, std::uint32_t checkId,
+                                  ValidationCheckLocality locality,
+                                  const ValidationAcceptor &acceptor) {
+  const auto fingerprint = this->fingerprint(node, locality);
+  if (!fingerprint.has_value()) {
+    return false;
+  }
+  const ValidationMemo::Key key{.fingerprint = *fingerprint, .checkId = checkId};
+  ValidationMemo::Diagnostics retained;
+  if (const auto *previous = _previous->find(key); previous != nullptr) {
+    if ((*previous)->empty()) {
+      _recorded.insert(key, nullptr);
+      return true;
+    }
+    retained = *previous;
+  } else if (_shared != nullptr) {
+    retained = _shared->find(key);
+  }
+  if (retained == nullptr) {
+    return false;
+  }
+
+  const auto begin = node.getCstNode().getBegin();
+  for (const auto &diagnostic : *retained) {
+    auto shifted = diagnostic;
+    shifted.begin = rebase(shifted.begin, 0, begin);
+    shifted.end = rebase(shifted.end, 0, begin);
+    for (auto &related : shifted.relatedInformation) {
+      if (related.uri.empty() || related.uri == _uri) {
+        related.begin = rebase(related.begin, 0, begin);
+        related.end = rebase(related.end, 0, begin);
+      }
+    }
+    acceptor(std::move(shifted));
+  }
+  _recorded.insert(key, std::move(retained));
+  return true;
+}
+
+void MemoizedCheckResults::record(
+    const AstNode &node, std::uint32_t checkId,
+    ValidationCheckLocality locality,
+    std::span<const pegium::Diagnostic> diagnostics) {
+  const auto fingerprint = this->fingerprint(node, locality);
+  if (!fingerprint.has_value()) {
+    return;
+  }
+  const ValidationMemo::Key key{.fingerprint = *fingerprint, .checkId = checkId};
+  if (diagnostics.empty()) {
+    _recorded.insert(key, nullptr);
+    if (_shared != nullptr) {
+      _shared->insert(key, no_diagnostics());
+    }
+    return;
+  }
+
+  const auto begin = node.getCstNode().getBegin();
+  std::vector<pegium::Diagnostic> relative(diagnostics.begin(),
+                                           diagnostics.end());
+  for (auto &diagnostic : relative) {
+    diagnostic.begin = rebase(diagnostic.begin, begin, 0);
+    diagnostic.end = rebase(diagnostic.end, begin, 0);
+    for (auto &related : diagnostic.relatedInformation) {
+      if (related.uri.empty() || related.uri == _uri) {
+        related.begin = rebase(related.begin, begin, 0);
+        related.end = rebase(related.end, begin, 0);
+      }
+    }
+  }
+  const bool share = _shared != nullptr && shareable(relative, _uri);
+  auto results = std::make_shared<const std::vector<pegium::Diagnostic>>(
+      std::move(relative));
+  if (share) {
+    _shared->insert(key, results);
+  }
+  _recorded.insert(key, std::move(results));
+}
+
+} // namespace pegium::validation
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <pegium/core/services/Diagnostic.hpp>
+#include <pegium/core/validation/ValidationRegistry.hpp>
+
+namespace pegium::workspace {
+struct Document;
+} // namespace pegium::workspace
+
+namespace pegium::validation {
+
+class ValidationCache;
+
+/// Fingerprints of the AST subtrees of one document, equal for subtrees on
+/// which the checks of a given `ValidationCheckLocality` raise the same
+/// diagnostics, up to a shift of their offsets.
+///
+/// A `Subtree` fingerprint hashes the node type and the CST subtree of the
+/// node: the text it spans and the grammar element of each of its CST nodes.
+/// A `SubtreeAndLinkedTargets` fingerprint also hashes, for every reference
+/// held in the subtree, its text, its state and the description, type and text
+/// of each target it resolves to.
+///
+/// Both are computed bottom-up, once per document, in a single pass over its
+/// CST and its AST respectively.
+///
+/// Thread-safe; the document must stay unchanged while it is in use.
+class SubtreeFingerprints {
+public:
+  explicit SubtreeFingerprints(const workspace::Document &document) noexcept
+      : _document(&document) {}
+
+  /// Returns the fingerprint of the subtree of `node` for checks of
+  /// `locality`, or nothing when `node` has no text to fingerprint or
+  /// `locality` is `Global`.
+  [[nodiscard]] std::optional<std::uint64_t>
+  of(const AstNode &node, ValidationCheckLocality locality) const;
+
+private:
+  void hashCst() const;
+  void hashReferences() const;
+
+  const workspace::Document *_document;
+  mutable std::once_flag _cstHashed;
+  // Hash of the text, layout and grammar elements of each CST subtree, by
+  // node id.
+  mutable std::vector<std::uint64_t> _cstHashes;
+  mutable std::once_flag _referencesHashed;
+  // Sum of the hashes of the references held in each AST subtree, by arena
+  // id.
+  mutable std::vector<std::uint64_t> _referenceHashes;
+};
+
+/// Diagnostics of the non-`Global` checks of the last validation of a
+/// document, by subtree fingerprint and check. `Document::validationMemo`
+/// keeps one across reparses of the document and hands it to its successors,
+/// so that a validation only runs those checks on subtrees that changed.
+class ValidationMemo {
+public:
+  struct Key {
+    std::uint64_t fingerprint = 0;
+    std::uint32_t checkId = 0;
+
+    friend auto operator<=>(const Key &, const Key &) = default;
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const noexcept;
+  };
+  /// Diagnostics with offsets relative to the begin of their node; related
+  /// information in other documents keeps absolute offsets.
+  using Diagnostics = std::shared_ptr<const std::vector<pegium::Diagnostic>>;
+
+  /// Results by key. Most checks raise nothing: their keys are only kept in a
+  /// flat list, without an entry of their own.
+  class Table {
+  public:
+    /// Returns the results recorded under `key`, empty when the checks raised
+    /// nothing, or null. Only valid once the table is sealed.
+    [[nodiscard]] const Diagnostics *find(const Key &key) const;
+    /// Records `diagnostics` under `key`.
+    void insert(const Key &key, Diagnostics diagnostics);
+    /// Moves the results of `other` into this table.
+    void merge(Table &&other);
+    /// Readies the table for `find`, once everything is recorded.
+    void seal();
+
+  private:
+    std::unordered_map<Key, Diagnostics, KeyHash> _diagnostics;
+    // Keys of the results without diagnostics, sorted once sealed.
+    std::vector<Key> _clean;
+  };
+
+  /// Returns the retained results, never null.
+  [[nodiscard]] std::shared_ptr<const Table> results() const;
+  /// Seals `results` and retains them in place of the previous ones.
+  void retain(Table results);
+
+private:
+  mutable std::mutex _mutex;
+  std::shared_ptr<const Table> _results;
+};
+
+/// `LocalCheckResults` replaying the results retained by a `ValidationMemo`,
+/// or else those of a `ValidationCache` when one is given, and recording, into
+/// a new table and the cache, those of the subtrees it is asked about.
+/// One instance serves one thread.
+class MemoizedCheckResults final : public LocalCheckResults {
+public:
+  MemoizedCheckResults(const SubtreeFingerprints &fingerprints,
+                       const ValidationMemo::Table &previous,
+                       std::string_view uri,
+                       ValidationCache *shared = nullptr) noexcept
+      : _fingerprints(&fingerprints), _previous(&previous), _uri(uri),
+        _shared(shared) {}
+
+  bool replay(const AstNode &node, std::uint32_t checkId,
+              ValidationCheckLocality locality,
+              const ValidationAcceptor &acceptor) override;
+  void record(const AstNode &node, std::uint32_t checkId,
+              ValidationCheckLocality locality,
+              std::span<const pegium::Diagnostic> diagnostics) override;
+
+  /// Moves out the results replayed or recorded so far.
+  [[nodiscard]] ValidationMemo::Table takeRecorded() noexcept {
+    return std::move(_recorded);
+  }
+
+private:
+  [[nodiscard]] std::optional<std::uint64_t>
+  fingerprint(const AstNode &node, ValidationCheckLocality locality);
+
+  const SubtreeFingerprints *_fingerprints;
+  const ValidationMemo::Table *_previous;
+  std::string_view _uri;
+  ValidationCache *_shared;
+  ValidationMemo::Table _recorded;
+  // Fingerprints of `_lastNode` computed so far, by locality.
+  const AstNode *_lastNode = nullptr;
+  std::array<std::optional<std::optional<std::uint64_t>>, 3> _lastFingerprints;
+};
+
+} // namespace pegium::validation
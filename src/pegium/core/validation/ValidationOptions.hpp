@@ -12,6 +12,11 @@ struct ValidationOptions {
   std::vector<std::string> categories;
   std::optional<bool> stopAfterParsingErrors;
   std::optional<bool> stopAfterLinkingErrors;
+  /// Lets the per-node checks of huge documents run concurrently. Only enable
+  /// it when every per-node check may run concurrently with the others on one
+  /// document: checks sharing state across nodes, e.g. state prepared by a
+  /// `ValidationRegistry::registerBeforeDocument` hook, may not.
+  std::optional<bool> concurrentNodeChecks;
 };
 
 /// Build-time validation setting: disabled, enabled, or detailed options.
@@ -16,6 +16,7 @@
 #include <pegium/core/services/JsonValue.hpp>
 #include <pegium/core/services/Diagnostic.hpp>
 #include <pegium/core/syntax-tree/AstNode.hpp>
+#include <pegium/core/syntax-tree/AstTypeFilter.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/validation/ValidationAcceptor.hpp>
 
@@ -118,6 +119,20 @@ inline constexpr std::string_view kSlowValidationCategory = "slow";
 /// Built-in category for parser/linker diagnostics emitted by the runtime.
 inline constexpr std::string_view kBuiltInValidationCategory = "built-in";
 
+/// What the diagnostics of a validation check depend on, which decides whether
+/// a later validation may reuse them instead of running the check again.
+///
+/// Reused diagnostics are shifted along with their node: checks that are not
+/// `Global` must not encode text offsets in `Diagnostic::data`.
+enum class ValidationCheckLocality : std::uint8_t {
+  /// Anything, e.g. siblings or other documents: the check runs every time.
+  Global,
+  /// Only the node's own subtree: its text and its descendants.
+  Subtree,
+  /// The node's subtree and the targets its references resolve to.
+  SubtreeAndLinkedTargets,
+};
+
 /// Type-erased validation check runnable on any AST node.
 using ValidationCheck =
     std::function<void(const AstNode &, const ValidationAcceptor &,
@@ -128,6 +143,27 @@ using ValidationPreparation =
                        std::span<const std::string>,
                        const utils::CancellationToken &)>;
 
+/// Diagnostics of non-`Global` checks kept from earlier validations, offered to
+/// `ValidationRegistry::runChecks(...)` so that it only runs those checks on
+/// subtrees it has not seen yet.
+class LocalCheckResults {
+public:
+  virtual ~LocalCheckResults() noexcept = default;
+
+  /// Reports through `acceptor` the diagnostics that check `checkId` raised
+  /// on a subtree identical to the one of `node`, shifted to `node`, and
+  /// returns true; returns false when there are none to reuse.
+  virtual bool replay(const AstNode &node, std::uint32_t checkId,
+                      ValidationCheckLocality locality,
+                      const ValidationAcceptor &acceptor) = 0;
+
+  /// Keeps `diagnostics`, raised by check `checkId` on `node`, for later
+  /// validations.
+  virtual void record(const AstNode &node, std::uint32_t checkId,
+                      ValidationCheckLocality locality,
+                      std::span<const pegium::Diagnostic> diagnostics) = 0;
+};
+
 /// Registry of validation checks grouped by target type and category.
 class ValidationRegistry {
 public:
@@ -135,6 +171,7 @@ public:
   struct ValidationCheckRegistration {
     std::type_index targetType = std::type_index(typeid(AstNode));
     ValidationCheck check;
+    ValidationCheckLocality locality = ValidationCheckLocality::Global;
   };
 
   virtual ~ValidationRegistry() noexcept = default;
@@ -149,6 +186,19 @@ public:
         category);
   }
 
+  /// Same as above, for a check whose diagnostics depend on no more than
+  /// `locality` describes.
+  template <typename Node, typename Check>
+    requires detail::TypedValidationCheckCallable<std::remove_cvref_t<Node>,
+                                                  std::remove_cvref_t<Check>>
+  void registerCheck(Check &&check, std::string_view category,
+                     ValidationCheckLocality locality) {
+    auto registration = makeValidationCheck<std::remove_cvref_t<Node>>(
+        std::forward<Check>(check));
+    registration.locality = locality;
+    registerTypedCheck(std::move(registration), category);
+  }
+
   template <typename Node, typename Check>
     requires detail::TypedValidationCheckCallable<std::remove_cvref_t<Node>,
                                                   std::remove_cvref_t<Check>>
@@ -236,6 +286,26 @@ public:
                          std::span<const std::string> categories,
                          const utils::CancellationToken &cancelToken) const = 0;
 
+  /// Same as above, but reuses through `results` the diagnostics of checks
+  /// that are not `ValidationCheckLocality::Global`, and records those it
+  /// runs. The default implementation ignores `results`.
+  virtual void runChecks(const AstNode &node,
+                         const ValidationAcceptor &acceptor,
+                         std::span<const std::string> categories,
+                         const utils::CancellationToken &cancelToken,
+                         LocalCheckResults &results) const {
+    (void)results;
+    runChecks(node, acceptor, categories, cancelToken);
+  }
+
+  /// Returns a filter selecting the nodes some registered check may apply
+  /// to, so that validation can skip the subtrees holding none. The default
+  /// implementation selects every node.
+  [[nodiscard]] virtual const AstTypeFilter &checkedTypes() const {
+    static const AstTypeFilter everyNode;
+    return everyNode;
+  }
+
 private:
   virtual void registerTypedCheck(ValidationCheckRegistration registration,
                                   std::string_view category) = 0;
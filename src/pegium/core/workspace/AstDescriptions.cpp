@@ -4,10 +4,32 @@
 #include <string>
 
 #include <pegium/core/utils/Errors.hpp>
+#include <pegium/core/workspace/Document.hpp>
 #include <pegium/core/workspace/Documents.hpp>
 
 namespace pegium::workspace {
 
+namespace {
+
+const AstNode &resolve_in(const Document &document,
+                          const AstNodeDescription &description) {
+  if (!describes_revision_of(document, description)) {
+    throw utils::MissingAstDocumentError(
+        "resolve_ast_node: symbol " + std::to_string(description.symbolId) +
+        " of document " + std::to_string(description.documentId) +
+        " was indexed from another revision of it (stale description?)");
+  }
+  return document.getAstNode(description.symbolId);
+}
+
+} // namespace
+
+bool describes_revision_of(const Document &document,
+                           const AstNodeDescription &description) noexcept {
+  return description.documentRevision == 0 ||
+         description.documentRevision == document.revision();
+}
+
 const AstNode &resolve_ast_node(const Documents &documents,
                                 const AstNodeDescription &description) {
   assert(description.symbolId != InvalidSymbolId);
@@ -23,7 +45,7 @@ const AstNode &resolve_ast_node(const Documents &documents,
         std::to_string(description.documentId) +
         " no longer exists (stale reference?)");
   }
-  return document->getAstNode(description.symbolId);
+  return resolve_in(*document, description);
 }
 
 const AstNode &resolve_ast_node(const Documents &documents,
@@ -33,10 +55,30 @@ const AstNode &resolve_ast_node(const Documents &documents,
   assert(description.symbolId != InvalidSymbolId);
 
   if (currentDocument.id == description.documentId) {
-    return currentDocument.getAstNode(description.symbolId);
+    return resolve_in(currentDocument, description);
   }
 
   return resolve_ast_node(documents, description);
 }
 
+const AstNode *find_ast_node(const Documents &documents,
+                             const AstNodeDescription &description) {
+  const auto document = documents.getDocument(description.documentId);
+  if (document == nullptr || !describes_revision_of(*document, description)) {
+    return nullptr;
+  }
+  return document->findAstNode(description.symbolId);
+}
+
+const AstNode *find_ast_node(const Documents &documents,
+                             const AstNodeDescription &description,
+                             const Document &currentDocument) {
+  if (currentDocument.id != description.documentId) {
+    return find_ast_node(documents, description);
+  }
+  return describes_revision_of(currentDocument, description)
+             ? currentDocument.findAstNode(description.symbolId)
+             : nullptr;
+}
+
 } // namespace pegium::workspace
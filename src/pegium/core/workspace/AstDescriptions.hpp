@@ -8,11 +8,20 @@ namespace workspace {
 class Documents;
 struct Document;
 
+/// Returns whether `description` points into the parse `document` holds.
+///
+/// A description indexed from another revision of the document, e.g. read
+/// from the live index while reading an older `WorkspaceSnapshot`, may name
+/// another node of it. Descriptions of unknown revision are assumed current.
+[[nodiscard]] bool describes_revision_of(const Document &document,
+                                         const AstNodeDescription &description)
+    noexcept;
+
 /// Resolves a symbol description to the current in-memory AST node.
 ///
 /// `documents` is required by design. `description` must be complete, with
 /// valid `documentId` and `symbolId`, and it must still resolve to a live AST
-/// node in a managed workspace document.
+/// node in a managed workspace document, of the revision it was taken from.
 [[nodiscard]] const AstNode &
 resolve_ast_node(const Documents &documents,
                  const AstNodeDescription &description);
@@ -24,5 +33,18 @@ resolve_ast_node(const Documents &documents,
                  const AstNodeDescription &description,
                  const Document &currentDocument);
 
+/// Like `resolve_ast_node(...)`, but returns `nullptr` instead of throwing when
+/// the document is gone, holds another revision, or no longer has the node.
+[[nodiscard]] const AstNode *
+find_ast_node(const Documents &documents,
+              const AstNodeDescription &description);
+
+/// Like `resolve_ast_node(...)` with `currentDocument`, but returns `nullptr`
+/// instead of throwing.
+[[nodiscard]] const AstNode *
+find_ast_node(const Documents &documents,
+              const AstNodeDescription &description,
+              const Document &currentDocument);
+
 } // namespace workspace
 } // namespace pegium
@@ -1,5 +1,8 @@
 #include <pegium/core/workspace/Configuration.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <utility>
 
 namespace pegium::workspace {
@@ -15,6 +18,20 @@ read_optional_boolean(const pegium::JsonValue::Object &configuration,
   return it->second.boolean();
 }
 
+[[nodiscard]] std::optional<double>
+read_optional_number(const pegium::JsonValue::Object &configuration,
+                     std::string_view key) {
+  const auto it = configuration.find(std::string(key));
+  if (it == configuration.end() || !it->second.isNumber()) {
+    return std::nullopt;
+  }
+  const auto value = it->second.number();
+  if (!std::isfinite(value) || value < 0.0) {
+    return std::nullopt;
+  }
+  return value;
+}
+
 } // namespace
 
 bool readValidationOptions(const pegium::JsonValue &configuration,
@@ -47,6 +64,11 @@ bool readValidationOptions(const pegium::JsonValue &configuration,
       stopAfterLinkingErrors.has_value()) {
     target.stopAfterLinkingErrors = *stopAfterLinkingErrors;
   }
+  if (const auto concurrentNodeChecks =
+          read_optional_boolean(validationObject, "concurrentNodeChecks");
+      concurrentNodeChecks.has_value()) {
+    target.concurrentNodeChecks = *concurrentNodeChecks;
+  }
 
   return true;
 }
@@ -76,6 +98,33 @@ bool readValidationOption(const pegium::JsonValue &configuration,
   return true;
 }
 
+bool readUpdateDebounceOptions(const pegium::JsonValue &configuration,
+                               UpdateDebounceOptions &target) {
+  if (!configuration.isObject()) {
+    return false;
+  }
+
+  const auto &debounceObject = configuration.object();
+  const auto to_milliseconds = [](double value) {
+    return std::chrono::milliseconds(static_cast<std::int64_t>(value));
+  };
+  if (const auto minDelay = read_optional_number(debounceObject, "minDelay");
+      minDelay.has_value()) {
+    target.minDelay = to_milliseconds(*minDelay);
+  }
+  if (const auto maxDelay = read_optional_number(debounceObject, "maxDelay");
+      maxDelay.has_value()) {
+    target.maxDelay = to_milliseconds(*maxDelay);
+  }
+  if (const auto costFactor =
+          read_optional_number(debounceObject, "costFactor");
+      costFactor.has_value()) {
+    target.costFactor = *costFactor;
+  }
+  target.maxDelay = std::max(target.maxDelay, target.minDelay);
+  return true;
+}
+
 StaticConfigurationProvider::StaticConfigurationProvider(
     const WorkspaceConfiguration &configuration)
     : _configuration{configuration} {}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <future>
 #include <memory>
@@ -20,9 +21,22 @@ class ServiceRegistry;
 
 namespace pegium::workspace {
 
+/// How long document updates wait for more edits before starting a build.
+///
+/// The delay is `costFactor` times the measured duration of the last build of
+/// the changed documents, clamped to `[minDelay, maxDelay]`: cheap documents
+/// rebuild at once, expensive ones wait for a pause in typing instead of
+/// starting builds the next keystroke cancels.
+struct UpdateDebounceOptions {
+  std::chrono::milliseconds minDelay{0};
+  std::chrono::milliseconds maxDelay{300};
+  double costFactor = 0.5;
+};
+
 /// Effective workspace-level options consumed by core services.
 struct WorkspaceConfiguration {
   validation::BuildValidationOption validation;
+  UpdateDebounceOptions updateDebounce;
 };
 
 /// Reads full validation options from one configuration object.
@@ -34,6 +48,12 @@ readValidationOptions(const pegium::JsonValue &configuration,
 readValidationOption(const pegium::JsonValue &configuration,
                      validation::BuildValidationOption &target);
 
+/// Reads update debounce options (`minDelay` and `maxDelay` in milliseconds,
+/// `costFactor`) from one configuration object. Missing keys keep their value.
+[[nodiscard]] bool
+readUpdateDebounceOptions(const pegium::JsonValue &configuration,
+                          UpdateDebounceOptions &target);
+
 /// Provides language and workspace configuration to core services.
 class ConfigurationProvider {
 public:
@@ -19,6 +19,7 @@ DefaultAstNodeDescriptionProvider::createDescription(
 
   return AstNodeDescription{
       .name = std::move(name),
+      .typeId = node.typeId(),
       .type = std::type_index(typeid(node)),
       .documentId = document.id,
       .symbolId = document.makeSymbolId(node),
@@ -172,6 +172,11 @@ WorkspaceConfiguration DefaultConfigurationProvider::apply_section_overrides(
       validationIt != section.end()) {
     (void)readValidationOption(validationIt->second, configuration.validation);
   }
+  if (const auto debounceIt = section.find("updateDebounce");
+      debounceIt != section.end()) {
+    (void)readUpdateDebounceOptions(debounceIt->second,
+                                    configuration.updateDebounce);
+  }
   return configuration;
 }
 
@@ -1,20 +1,29 @@
 #include <pegium/core/workspace/DefaultDocumentBuilder.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <ranges>
 #include <stop_token>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
+#include <typeindex>
+#include <typeinfo>
 #include <utility>
 
 #include <pegium/core/services/CoreServices.hpp>
 #include <pegium/core/services/ServiceRegistry.hpp>
 #include <pegium/core/services/SharedCoreServices.hpp>
+#include <pegium/core/syntax-tree/AstReflection.hpp>
 #include <pegium/core/utils/Errors.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/validation/ValidationRegistry.hpp>
@@ -90,19 +99,30 @@ void DefaultDocumentBuilder::build(
     const BuildOptions &options, utils::CancellationToken cancelToken,
     const std::function<void()> &downgradeLock) const {
   auto &documentStore = *shared.workspace.documents;
+  if (!isolatesSnapshots()) {
+    withdrawSnapshot();
+  }
+  enforceResidencyBudget();
+  std::vector<std::shared_ptr<Document>> documentsToBuild(documents.begin(),
+                                                          documents.end());
   std::vector<DocumentId> changedDocumentIds;
-  changedDocumentIds.reserve(documents.size());
-  for (const auto &document : documents) {
+  changedDocumentIds.reserve(documentsToBuild.size());
+  for (auto &document : documentsToBuild) {
     const auto documentId = ensure_document_id(documentStore, *document);
     changedDocumentIds.push_back(documentId);
     if (document->state == DocumentState::Validated) {
       if (const auto *enabled = std::get_if<bool>(&options.validation);
           enabled != nullptr && *enabled) {
-        resetToState(*document, DocumentState::IndexedReferences);
+        document = resetForRebuild(document, DocumentState::IndexedReferences);
       } else if (std::holds_alternative<validation::ValidationOptions>(
                      options.validation)) {
         auto categories = findMissingValidationCategories(*document, options);
-        if (!categories.empty()) {
+        if (!categories.empty() && isolatesSnapshots()) {
+          // Validating the missing categories would append diagnostics to a
+          // published document: validate a new version from scratch instead.
+          document =
+              resetForRebuild(document, DocumentState::IndexedReferences);
+        } else if (!categories.empty()) {
           DocumentBuildState nextState;
           nextState.completed = false;
           nextState.options.validation = validation::ValidationOptions{
@@ -128,10 +148,18 @@ void DefaultDocumentBuilder::build(
   {
     std::scoped_lock lock(_stateMutex);
     _currentState = DocumentState::Changed;
+    _requestedDocumentIds = {changedDocumentIds.begin(),
+                             changedDocumentIds.end()};
   }
 
   emitUpdate(changedDocumentIds, {});
-  buildDocuments(documents, options, cancelToken, downgradeLock);
+  buildDocuments(documentsToBuild, options, cancelToken, downgradeLock);
+  if (!downgradeLock) {
+    enforceResidencyBudget();
+  }
+  if (isolatesSnapshots()) {
+    publishSnapshot();
+  }
 }
 
 void DefaultDocumentBuilder::update(
@@ -141,6 +169,11 @@ void DefaultDocumentBuilder::update(
     const std::function<void()> &downgradeLock) const {
   auto &documentStore = *shared.workspace.documents;
   utils::throw_if_cancelled(cancelToken);
+  const auto isolate = isolatesSnapshots();
+  if (!isolate) {
+    withdrawSnapshot();
+  }
+  enforceResidencyBudget();
   {
     std::scoped_lock lock(_stateMutex);
     _currentState = DocumentState::Changed;
@@ -177,14 +210,92 @@ void DefaultDocumentBuilder::update(
     // does not close the window for a reader holding a pre-deletion index
     // snapshot, so index-derived getDocument() lookups still null-check.
     cleanUpDeleted(documentId);
+    {
+      std::scoped_lock lock(_stateMutex);
+      _documentsWithExportChanges.insert(documentId);
+    }
     if (auto deletedDocument = documentStore.deleteDocument(documentId);
         deletedDocument != nullptr) {
       deletedDocument->state = DocumentState::Changed;
+      if (isolate) {
+        retire(std::move(deletedDocument));
+      }
     }
   }
 
-  for (const auto documentId : orderedChangedDocumentIds) {
+  // A change notification for a file that still holds the analyzed text (e.g.
+  // a branch switch rewriting files it does not modify) is dropped before
+  // anything is reset. Files are checked concurrently: most of the cost is
+  // stat/read I/O. Under snapshot isolation the check runs on the next version
+  // of the document, so that the text it may keep for the rebuild never lands
+  // in a published one.
+  //
+  // So is a notification for an open document that a cancelled build left
+  // partially built from the text it still holds (e.g. a change carried over
+  // into the write that superseded that build): it resumes from the phase it
+  // reached instead of starting over. Nothing of it is reset, so it needs no
+  // next version either.
+  std::vector<std::uint8_t> unchanged(orderedChangedDocumentIds.size(), 0);
+  std::vector<std::shared_ptr<Document>> successors(
+      orderedChangedDocumentIds.size());
+  const auto checkUnchanged = [&](std::size_t index) {
+    auto changedDocument =
+        documentStore.getDocument(orderedChangedDocumentIds[index]);
+    if (changedDocument == nullptr) {
+      return;
+    }
+    if (changedDocument->state < DocumentState::Validated &&
+        shared.workspace.documentFactory->isParsedFromCurrentText(
+            *changedDocument)) {
+      unchanged[index] = 1;
+      return;
+    }
+    if (isolate && changedDocument->state > DocumentState::Changed) {
+      changedDocument =
+          shared.workspace.documentFactory->createSuccessor(*changedDocument);
+      successors[index] = changedDocument;
+    }
+    if (shared.workspace.documentFactory->isUnchangedOnDisk(*changedDocument,
+                                                            cancelToken)) {
+      unchanged[index] = 1;
+    }
+  };
+  if (auto *taskScheduler = shared.execution.taskScheduler.get();
+      taskScheduler != nullptr) {
+    taskScheduler->parallelFor(
+        cancelToken,
+        std::views::iota(std::size_t{0}, orderedChangedDocumentIds.size()),
+        checkUnchanged);
+  } else {
+    for (std::size_t index = 0; index < orderedChangedDocumentIds.size();
+         ++index) {
+      utils::throw_if_cancelled(cancelToken);
+      checkUnchanged(index);
+    }
+  }
+  {
+    std::size_t kept = 0;
+    for (std::size_t index = 0; index < orderedChangedDocumentIds.size();
+         ++index) {
+      if (unchanged[index] != 0) {
+        changedDocumentIdSet.erase(orderedChangedDocumentIds[index]);
+      } else {
+        successors[kept] = std::move(successors[index]);
+        orderedChangedDocumentIds[kept++] = orderedChangedDocumentIds[index];
+      }
+    }
+    orderedChangedDocumentIds.resize(kept);
+    successors.resize(kept);
+  }
+
+  for (std::size_t index = 0; index < orderedChangedDocumentIds.size();
+       ++index) {
     utils::throw_if_cancelled(cancelToken);
+    if (successors[index] != nullptr) {
+      installSuccessor(successors[index], DocumentState::Changed);
+      continue;
+    }
+    const auto documentId = orderedChangedDocumentIds[index];
     auto changedDocument = documentStore.getDocument(documentId);
     if (changedDocument == nullptr) {
       const auto uri = documentStore.getDocumentUri(documentId);
@@ -205,22 +316,23 @@ void DefaultDocumentBuilder::update(
     resetToState(*changedDocument, DocumentState::Changed);
   }
 
-  std::unordered_set<DocumentId> allChangedDocumentIds;
-  allChangedDocumentIds.reserve(orderedChangedDocumentIds.size() +
-                                orderedDeletedDocumentIds.size());
-  allChangedDocumentIds.insert(orderedChangedDocumentIds.begin(),
-                               orderedChangedDocumentIds.end());
-  allChangedDocumentIds.insert(orderedDeletedDocumentIds.begin(),
-                               orderedDeletedDocumentIds.end());
-
-  for (const auto &document : documentStore.all()) {
-    utils::throw_if_cancelled(cancelToken);
-    if (!allChangedDocumentIds.contains(document->id) &&
-        shouldRelink(*document, allChangedDocumentIds)) {
-      resetToState(*document, DocumentState::ComputedScopes);
+  // Dependants of deleted documents are reset right away. Dependants of
+  // changed documents wait until those are re-indexed: only then is it known
+  // whether their exports changed (relinkAffectedDocuments).
+  if (!deletedDocumentIdSet.empty()) {
+    for (const auto &document : documentStore.all()) {
+      utils::throw_if_cancelled(cancelToken);
+      if (!changedDocumentIdSet.contains(document->id) &&
+          shouldRelink(*document, deletedDocumentIdSet)) {
+        (void)resetForRebuild(document, DocumentState::ComputedScopes);
+      }
     }
   }
 
+  {
+    std::scoped_lock lock(_stateMutex);
+    _requestedDocumentIds = changedDocumentIdSet;
+  }
   emitUpdate(orderedChangedDocumentIds, orderedDeletedDocumentIds);
   utils::throw_if_cancelled(cancelToken);
 
@@ -245,6 +357,12 @@ void DefaultDocumentBuilder::update(
 
   buildDocuments(documentsToBuild, _updateBuildOptions, cancelToken,
                  downgradeLock);
+  if (!downgradeLock) {
+    enforceResidencyBudget();
+  }
+  if (isolate) {
+    publishSnapshot();
+  }
 }
 
 BuildOptions
@@ -273,7 +391,7 @@ std::vector<std::string>
 DefaultDocumentBuilder::findMissingValidationCategories(
     const Document &document, const BuildOptions &options) const {
   const auto &services =
-      shared.serviceRegistry->getServices(document.uri);
+      shared.serviceRegistry->getServices(document);
   const auto allCategories =
       services.validation.validationRegistry->getAllValidationCategories();
 
@@ -329,12 +447,9 @@ bool DefaultDocumentBuilder::resultsAreIncomplete(
 bool DefaultDocumentBuilder::shouldRelink(
     const Document &document,
     const std::unordered_set<DocumentId> &changedDocumentIds) const {
-  if (std::ranges::any_of(document.parseResult.references,
-                          [](const ReferenceHandle &handle) {
-                            return handle.getConst()->hasError();
-                          })) {
-    return true;
-  }
+  // Unresolved references are not relinked blindly: they only can resolve
+  // differently once some document exports a matching name, which the index
+  // reports through isAffected after the changed documents are re-indexed.
   return shared.workspace.indexManager->isAffected(
       document, changedDocumentIds);
 }
@@ -349,6 +464,17 @@ bool DefaultDocumentBuilder::hasTextDocument(
          textDocumentProvider->getNormalized(document->uri) != nullptr;
 }
 
+execution::TaskPriority DefaultDocumentBuilder::documentPriority(
+    const std::shared_ptr<Document> &document) const {
+  if (!hasTextDocument(document)) {
+    return execution::TaskPriority::Background;
+  }
+  std::scoped_lock lock(_stateMutex);
+  return _requestedDocumentIds.contains(document->id)
+             ? execution::TaskPriority::Interactive
+             : execution::TaskPriority::OpenDocument;
+}
+
 void DefaultDocumentBuilder::emitUpdate(
     std::span<const DocumentId> changedDocumentIds,
     std::span<const DocumentId> deletedDocumentIds) const {
@@ -381,6 +507,15 @@ void DefaultDocumentBuilder::prepareBuild(
     std::span<const std::shared_ptr<Document>> documents,
     const BuildOptions &options) const {
   auto &documentStore = *shared.workspace.documents;
+  if (const auto &residency = shared.workspace.documentResidency;
+      residency != nullptr) {
+    // Documents resuming past their parse need their evicted AST back.
+    for (const auto &document : documents) {
+      if (document->state > DocumentState::Changed) {
+        residency->restore(*document);
+      }
+    }
+  }
   std::scoped_lock lock(_stateMutex);
   for (const auto &document : documents) {
     const auto documentId = ensure_document_id(documentStore, *document);
@@ -460,6 +595,48 @@ void DefaultDocumentBuilder::publishWorkspaceState(
   _stateCv.notify_all();
 }
 
+std::vector<std::uint64_t> DefaultDocumentBuilder::phaseCostHints(
+    const std::vector<std::shared_ptr<Document>> &documents,
+    const std::vector<std::size_t> &pendingIndexes,
+    DocumentState phaseEnd) const {
+  std::vector<std::uint64_t> costs;
+  costs.reserve(pendingIndexes.size());
+  {
+    std::scoped_lock lock(_stateMutex);
+    for (const auto index : pendingIndexes) {
+      const auto it = _phaseCostsByDocumentId.find(documents[index]->id);
+      if (it == _phaseCostsByDocumentId.end() ||
+          it->second[listener_index(phaseEnd)] == 0) {
+        break;
+      }
+      costs.push_back(it->second[listener_index(phaseEnd)]);
+    }
+  }
+  if (costs.size() == pendingIndexes.size()) {
+    return costs;
+  }
+  // Durations and sizes are not comparable, so a single unmeasured document
+  // makes the whole phase fall back to text sizes.
+  costs.clear();
+  for (const auto index : pendingIndexes) {
+    costs.push_back(documents[index]->textDocument().getText().size());
+  }
+  return costs;
+}
+
+void DefaultDocumentBuilder::recordPhaseCosts(
+    const std::vector<std::shared_ptr<Document>> &documents,
+    const std::vector<std::size_t> &pendingIndexes, DocumentState phaseEnd,
+    const std::vector<std::uint64_t> &durations) const {
+  std::scoped_lock lock(_stateMutex);
+  for (std::size_t pos = 0; pos < pendingIndexes.size(); ++pos) {
+    if (durations[pos] != 0) {
+      _phaseCostsByDocumentId[documents[pendingIndexes[pos]]->id]
+                             [listener_index(phaseEnd)] = durations[pos];
+    }
+  }
+}
+
 void DefaultDocumentBuilder::advance(const std::shared_ptr<Document> &document,
                                      DocumentState targetState,
                                      utils::CancellationToken /*cancelToken*/) const {
@@ -477,14 +654,31 @@ void DefaultDocumentBuilder::buildDocuments(
   std::vector<std::shared_ptr<Document>> documentsToBuild(documents.begin(),
                                                           documents.end());
 
+  // Also run for `build`: the documents it reparses may be targets of linked
+  // documents outside of it, and the export changes it records must not be
+  // left for a later `update` to misread as its own.
+  const auto reconcileDependants = [&] {
+    relinkAffectedDocuments(documentsToBuild, options);
+  };
+
   // Phase A: parse + index this document's exported content. Both are
   // per-document local; each document advances through Parsed then
   // IndexedContent on the same worker, notifying its phase listeners inline.
-  runMergedPhase(
-      documentsToBuild, DocumentState::IndexedContent,
-      {DocumentState::Parsed, DocumentState::IndexedContent}, cancelToken,
-      [this](const std::shared_ptr<Document> &document, DocumentState entry,
-             const utils::CancellationToken &phaseToken) {
+  // Pipelined builds compute local scopes here too (also per-document local),
+  // so that after the barrier each document only needs to link and validate.
+  // So do builds isolating snapshots: a new document version is complete up to
+  // its local scopes before published documents are rebound onto it.
+  const auto scopesInPhaseA = options.pipelined || isolatesSnapshots();
+  const auto parseAndIndex =
+      [this, pipelined = scopesInPhaseA](
+          const std::shared_ptr<Document> &document, DocumentState entry,
+          const utils::CancellationToken &phaseToken) {
+        if (entry < DocumentState::IndexedContent) {
+          // Recorded before reparsing: from here on, dependants may hold
+          // pointers into the AST being replaced.
+          std::scoped_lock lock(_stateMutex);
+          _documentsWithExportChanges.insert(document->id);
+        }
         if (entry < DocumentState::Parsed) {
           shared.workspace.documentFactory->update(*document, phaseToken);
           advance(document, DocumentState::Parsed, phaseToken);
@@ -493,11 +687,56 @@ void DefaultDocumentBuilder::buildDocuments(
           shared.workspace.indexManager->updateContent(*document, phaseToken);
           advance(document, DocumentState::IndexedContent, phaseToken);
         }
-      });
+        if (pipelined && entry < DocumentState::ComputedScopes) {
+          document->localSymbols =
+              shared.serviceRegistry->getServices(*document)
+                  .references.scopeComputation->collectLocalSymbols(
+                      *document, phaseToken);
+          advance(document, DocumentState::ComputedScopes, phaseToken);
+        }
+      };
+  const auto phaseAEnd = scopesInPhaseA ? DocumentState::ComputedScopes
+                                        : DocumentState::IndexedContent;
+  const auto runPhaseA = [&] {
+    try {
+      if (scopesInPhaseA) {
+        runMergedPhase(documentsToBuild, DocumentState::ComputedScopes,
+                       {DocumentState::Parsed, DocumentState::IndexedContent,
+                        DocumentState::ComputedScopes},
+                       cancelToken, parseAndIndex);
+      } else {
+        runMergedPhase(documentsToBuild, DocumentState::IndexedContent,
+                       {DocumentState::Parsed, DocumentState::IndexedContent},
+                       cancelToken, parseAndIndex);
+      }
+    } catch (...) {
+      // Dependants may still point into ASTs replaced before the failure;
+      // reconcile them before any reader can observe those pointers.
+      reconcileDependants();
+      throw;
+    }
 
-  // Barrier between Phase A and Phase B is mandatory: linking resolves
-  // cross-document references against the global content index, which is only
-  // complete once every document has finished Phase A.
+    // Barrier between Phase A and Phase B is mandatory: linking resolves
+    // cross-document references against the global content index, which is
+    // only complete once every document has finished Phase A. It is also the
+    // point where the exported-symbol delta is known, so dependants whose
+    // lookups it touches join this build.
+    reconcileDependants();
+  };
+  runPhaseA();
+  // Dependants joining as new document versions start over from Changed, and
+  // their re-indexing in turn requires their own dependants to be rebound.
+  while (std::ranges::any_of(documentsToBuild,
+                             [phaseAEnd](const auto &document) {
+                               return document->state < phaseAEnd;
+                             })) {
+    runPhaseA();
+  }
+
+  if (options.pipelined) {
+    linkAndValidatePipelined(documentsToBuild, cancelToken, downgradeLock);
+    return;
+  }
 
   // Phase B: compute local scopes for every document, then link and index this
   // document's references — but only for documents that should be linked.
@@ -509,7 +748,7 @@ void DefaultDocumentBuilder::buildDocuments(
       cancelToken,
       [this](const std::shared_ptr<Document> &document, DocumentState entry,
              const utils::CancellationToken &phaseToken) {
-        const auto &services = shared.serviceRegistry->getServices(document->uri);
+        const auto &services = shared.serviceRegistry->getServices(*document);
         if (entry < DocumentState::ComputedScopes) {
           document->localSymbols =
               services.references.scopeComputation->collectLocalSymbols(
@@ -553,26 +792,420 @@ void DefaultDocumentBuilder::buildDocuments(
       [this](const std::shared_ptr<Document> &document, DocumentState entry,
              const utils::CancellationToken &phaseToken) {
         if (entry < DocumentState::Validated) {
-          validate(*document, phaseToken);
+          validate(document, phaseToken);
           markAsCompleted(*document);
           advance(document, DocumentState::Validated, phaseToken);
         }
       });
 }
 
-void DefaultDocumentBuilder::markAsCompleted(const Document &document) const {
+void DefaultDocumentBuilder::relinkAffectedDocuments(
+    std::vector<std::shared_ptr<Document>> &documents,
+    const BuildOptions &options) const {
+  std::vector<DocumentId> reindexedDocumentIds;
+  {
+    std::scoped_lock lock(_stateMutex);
+    reindexedDocumentIds.assign(_documentsWithExportChanges.begin(),
+                                _documentsWithExportChanges.end());
+  }
+  if (reindexedDocumentIds.empty()) {
+    return;
+  }
+  auto &documentStore = *shared.workspace.documents;
+  auto &indexManager = *shared.workspace.indexManager;
+
+  // Split the re-indexed documents by whether their exports changed. Nothing
+  // resolved against a document whose exports kept their fingerprint can
+  // resolve differently, so its dependants only need their node pointers
+  // moved onto the new AST instead of a relink.
+  std::unordered_set<DocumentId> reindexedDocumentIdSet;
+  std::unordered_set<DocumentId> changedExportIds;
+  std::unordered_set<DocumentId> stableExportIds;
+  for (const auto documentId : reindexedDocumentIds) {
+    reindexedDocumentIdSet.insert(documentId);
+    const auto document = documentStore.getDocument(documentId);
+    if (document == nullptr || document->state < DocumentState::IndexedContent ||
+        indexManager.hasExportChanges(documentId)) {
+      changedExportIds.insert(documentId);
+    } else {
+      stableExportIds.insert(documentId);
+    }
+  }
+
+  // Exports kept their names, types and order, but not necessarily their
+  // symbol ids: rebind each target by name and type against the re-indexed
+  // exports. Like global scope lookups, the first export wins when several
+  // share a name and type.
+  const auto &reflection = *shared.astReflection;
+  std::unordered_map<DocumentId, std::vector<AstNodeDescription>>
+      exportsByDocument;
+  bool symbolIdsMoved = false;
+  const auto reload =
+      [&documentStore, &indexManager, &reflection, &exportsByDocument,
+       &symbolIdsMoved](const AstNodeDescription &description)
+      -> ResolvedAstNodeDescription {
+    auto exports = exportsByDocument.find(description.documentId);
+    if (exports == exportsByDocument.end()) {
+      const std::array documentIds{description.documentId};
+      exports = exportsByDocument
+                    .emplace(description.documentId,
+                             indexManager.allElements(std::nullopt,
+                                                      documentIds))
+                    .first;
+    }
+    const auto current = std::ranges::find_if(
+        exports->second, [&description](const AstNodeDescription &candidate) {
+          return candidate.name == description.name &&
+                 candidate.type == description.type;
+        });
+    if (current == exports->second.end()) {
+      return {};
+    }
+    const auto target = documentStore.getDocument(description.documentId);
+    const auto *node =
+        target != nullptr ? target->findAstNode(current->symbolId) : nullptr;
+    if (node == nullptr ||
+        !type_is_assignable(std::type_index(typeid(*node)), description.type,
+                            reflection)) {
+      return {};
+    }
+    // The re-indexed description also carries the new document revision.
+    symbolIdsMoved = symbolIdsMoved || current->symbolId != description.symbolId;
+    return {.node = node, .description = std::addressof(*current)};
+  };
+  const auto rebind = [&reload, &indexManager,
+                       &symbolIdsMoved](Document &document) {
+    symbolIdsMoved = false;
+    const bool rebound = std::ranges::all_of(
+        document.parseResult.references, [&reload](const auto &handle) {
+          return handle.getConst()->rebindTargets(
+              utils::function_ref<ResolvedAstNodeDescription(
+                  const AstNodeDescription &)>(reload));
+        });
+    if (rebound && symbolIdsMoved) {
+      // The indexed references still point at the old symbol ids.
+      indexManager.updateReferences(document, {});
+    }
+    return rebound;
+  };
+
+  std::unordered_set<const Document *> scheduled;
+  scheduled.reserve(documents.size());
+  for (const auto &document : documents) {
+    scheduled.insert(document.get());
+  }
+
+  // Rebinding moves references of published documents: keep snapshot readers
+  // out meanwhile.
+  std::unique_lock<std::shared_mutex> snapshotGate;
+  if (isolatesSnapshots()) {
+    snapshotGate = std::unique_lock(*_snapshotGate);
+  }
+
+  std::vector<std::shared_ptr<Document>> affectedDocuments;
+  for (const auto &document : documentStore.all()) {
+    // Not cancellable: dependants must not keep pointers into replaced ASTs.
+    // Documents not linked yet pick up the new exports on their own.
+    if (document->state <= DocumentState::ComputedScopes ||
+        reindexedDocumentIdSet.contains(document->id)) {
+      continue;
+    }
+    if (!indexManager.isAffected(*document, changedExportIds) &&
+        (stableExportIds.empty() ||
+         !indexManager.isAffected(*document, stableExportIds) ||
+         rebind(*document))) {
+      continue;
+    }
+    const auto rebuilt =
+        resetForRebuild(document, DocumentState::ComputedScopes);
+    if (scheduled.contains(document.get())) {
+      std::ranges::replace(documents, document, rebuilt);
+    } else {
+      affectedDocuments.push_back(rebuilt);
+    }
+  }
+
+  if (!affectedDocuments.empty()) {
+    prepareBuild(affectedDocuments, options);
+    documents.insert(documents.end(), affectedDocuments.begin(),
+                     affectedDocuments.end());
+    documents = sortDocuments(std::move(documents));
+  }
+
+  indexManager.clearExportChanges(reindexedDocumentIds);
   std::scoped_lock lock(_stateMutex);
-  if (const auto state = _buildStateByDocumentId.find(document.id);
-      state != _buildStateByDocumentId.end()) {
-    state->second.completed = true;
+  for (const auto documentId : reindexedDocumentIds) {
+    _documentsWithExportChanges.erase(documentId);
+  }
+}
+
+void DefaultDocumentBuilder::linkAndValidatePipelined(
+    std::vector<std::shared_ptr<Document>> &documents,
+    utils::CancellationToken cancelToken,
+    const std::function<void()> &downgradeLock) const {
+  std::vector<std::size_t> pendingIndexes;
+  std::vector<DocumentState> entryStates;
+  pendingIndexes.reserve(documents.size());
+  entryStates.reserve(documents.size());
+  for (std::size_t index = 0; index < documents.size(); ++index) {
+    const auto &document = documents[index];
+    if (document->state < DocumentState::Validated) {
+      pendingIndexes.push_back(index);
+      entryStates.push_back(document->state);
+    } else if (!shouldValidate(*document)) {
+      markAsCompleted(*document);
+    }
+  }
+
+  const auto publishMilestones =
+      [&](std::initializer_list<DocumentState> states) {
+        for (const auto state : states) {
+          std::vector<std::shared_ptr<Document>> reached;
+          reached.reserve(documents.size());
+          for (const auto &document : documents) {
+            if (document->state >= state) {
+              reached.push_back(document);
+            }
+          }
+          notifyBuildPhase(reached, state, cancelToken);
+          publishWorkspaceState(state);
+        }
+      };
+  // Runs on whichever worker links the last document: the model is complete,
+  // so the link milestones can be published and readers let in while the
+  // remaining validations proceed.
+  const auto onAllLinked = [&] {
+    publishMilestones({DocumentState::Linked, DocumentState::IndexedReferences});
+    if (downgradeLock) {
+      downgradeLock();
+    }
+  };
+  std::atomic<std::size_t> linksRemaining = pendingIndexes.size();
+  if (pendingIndexes.empty()) {
+    onAllLinked();
+  }
+
+  // Per-document listeners run one at a time, in the order documents reach
+  // their states, so a small document is not held back behind a large one
+  // listed before it. A worker queues its document's states in phase order and
+  // drains the queue unless another worker already is, in which case that one
+  // picks them up before leaving.
+  std::mutex notifyMutex;
+  std::deque<std::pair<std::size_t, DocumentState>> pendingNotifications;
+  bool notifying = false;
+  std::exception_ptr notifyError;
+  const auto notify = [&](std::size_t pos,
+                          std::initializer_list<DocumentState> states) {
+    std::unique_lock lock(notifyMutex);
+    for (const auto state : states) {
+      if (entryStates[pos] < state &&
+          state <= documents[pendingIndexes[pos]]->state) {
+        pendingNotifications.emplace_back(pos, state);
+      }
+    }
+    while (!notifying && notifyError == nullptr &&
+           !pendingNotifications.empty()) {
+      const auto [next, state] = pendingNotifications.front();
+      pendingNotifications.pop_front();
+      notifying = true;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        notifyDocumentPhase(documents[pendingIndexes[next]], state, cancelToken);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      notifying = false;
+      if (error != nullptr) {
+        notifyError = error;
+      }
+    }
+  };
+
+  std::vector<std::uint64_t> durations(pendingIndexes.size(), 0);
+  const auto runOne = [&](std::size_t pos) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto &document = documents[pendingIndexes[pos]];
+    const auto entry = entryStates[pos];
+    if (shouldLink(*document)) {
+      if (entry < DocumentState::Linked) {
+        shared.serviceRegistry->getServices(*document)
+            .references.linker->link(*document, cancelToken);
+        advance(document, DocumentState::Linked, cancelToken);
+      }
+      if (entry < DocumentState::IndexedReferences) {
+        shared.workspace.indexManager->updateReferences(*document, cancelToken);
+        advance(document, DocumentState::IndexedReferences, cancelToken);
+      }
+      notify(pos, {DocumentState::Linked, DocumentState::IndexedReferences});
+    }
+    if (linksRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      onAllLinked();
+    }
+    if (shouldValidate(*document)) {
+      validate(document, cancelToken);
+      markAsCompleted(*document);
+      advance(document, DocumentState::Validated, cancelToken);
+      notify(pos, {DocumentState::Validated});
+    } else {
+      markAsCompleted(*document);
+    }
+    durations[pos] = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  };
+
+  auto *taskScheduler = shared.execution.taskScheduler.get();
+  try {
+    if (taskScheduler == nullptr || pendingIndexes.size() <= 1) {
+      for (std::size_t pos = 0; pos < pendingIndexes.size(); ++pos) {
+        utils::throw_if_cancelled(cancelToken);
+        runOne(pos);
+      }
+    } else {
+      const auto costs = phaseCostHints(documents, pendingIndexes,
+                                        DocumentState::Validated);
+      taskScheduler->parallelFor(
+          cancelToken, std::views::iota(std::size_t{0}, pendingIndexes.size()),
+          [&runOne](std::size_t pos) { runOne(pos); },
+          [&costs](std::size_t pos) { return costs[pos]; },
+          [this, &documents, &pendingIndexes](std::size_t pos) {
+            return documentPriority(documents[pendingIndexes[pos]]);
+          });
+    }
+  } catch (...) {
+    recordPhaseCosts(documents, pendingIndexes, DocumentState::Validated,
+                     durations);
+    throw;
+  }
+  recordPhaseCosts(documents, pendingIndexes, DocumentState::Validated,
+                   durations);
+
+  // Every queued notification was drained by the worker that queued it or by
+  // the one notifying at the time, unless a listener failed.
+  if (notifyError != nullptr) {
+    std::rethrow_exception(notifyError);
   }
+  publishMilestones({DocumentState::Validated});
+}
+
+bool DefaultDocumentBuilder::isolatesSnapshots() const noexcept {
+  return _updateBuildOptions.isolateSnapshots;
+}
+
+std::shared_ptr<Document> DefaultDocumentBuilder::resetForRebuild(
+    const std::shared_ptr<Document> &document, DocumentState state) const {
+  if (!isolatesSnapshots() || document->state <= state ||
+      shared.workspace.documents->getDocument(document->id) != document) {
+    resetToState(*document, state);
+    return document;
+  }
+  auto successor = shared.workspace.documentFactory->createSuccessor(*document);
+  installSuccessor(successor, state);
+  return successor;
+}
+
+void DefaultDocumentBuilder::installSuccessor(
+    const std::shared_ptr<Document> &successor, DocumentState state) const {
+  assert(successor->id != InvalidDocumentId);
+  resetToState(*successor, state);
+  if (auto replaced = shared.workspace.documents->replaceDocument(successor);
+      replaced != nullptr) {
+    retire(std::move(replaced));
+  }
+}
+
+void DefaultDocumentBuilder::retire(std::shared_ptr<Document> document) const {
+  std::scoped_lock lock(_stateMutex);
+  _retirement->documents.push_back(std::move(document));
+}
+
+void DefaultDocumentBuilder::publishSnapshot() const {
+  const auto documents = shared.workspace.documents->all();
+  std::scoped_lock lock(_stateMutex);
+  std::unordered_map<DocumentId, std::shared_ptr<Document>> previousVersions;
+  if (_snapshot != nullptr) {
+    for (const auto &document : _snapshot->documents()) {
+      previousVersions.try_emplace(document->id, document);
+    }
+  }
+  std::vector<std::shared_ptr<Document>> published;
+  published.reserve(documents.size());
+  for (const auto &document : documents) {
+    const auto state = _buildStateByDocumentId.find(document->id);
+    if (state != _buildStateByDocumentId.end() && state->second.completed) {
+      published.push_back(document);
+    } else if (const auto previous = previousVersions.find(document->id);
+               previous != previousVersions.end()) {
+      published.push_back(previous->second);
+    }
+  }
+
+  // Documents of the new snapshot only point into documents of the store, but
+  // those of older ones may point into any version replaced from now on.
+  auto retirement = std::make_shared<WorkspaceSnapshot::Retirement>();
+  _retirement->next = retirement;
+  _retirement = retirement;
+  _snapshot = std::make_shared<const WorkspaceSnapshot>(
+      ++_snapshotVersion, std::move(published), _snapshotGate,
+      std::move(retirement));
+}
+
+void DefaultDocumentBuilder::withdrawSnapshot() const {
+  {
+    std::scoped_lock lock(_stateMutex);
+    if (_snapshot == nullptr) {
+      return;
+    }
+  }
+  std::unique_lock gate(*_snapshotGate);
+  std::scoped_lock lock(_stateMutex);
+  _snapshot.reset();
+  _retirement = std::make_shared<WorkspaceSnapshot::Retirement>();
+}
+
+std::shared_ptr<const WorkspaceSnapshot>
+DefaultDocumentBuilder::snapshot() const {
+  std::scoped_lock lock(_stateMutex);
+  return _snapshot;
+}
+
+void DefaultDocumentBuilder::markAsCompleted(const Document &document) const {
+  {
+    std::scoped_lock lock(_stateMutex);
+    if (const auto state = _buildStateByDocumentId.find(document.id);
+        state != _buildStateByDocumentId.end()) {
+      state->second.completed = true;
+    }
+  }
+  if (const auto &residency = shared.workspace.documentResidency;
+      residency != nullptr) {
+    residency->touch(document);
+  }
+}
+
+void DefaultDocumentBuilder::enforceResidencyBudget() const {
+  const auto &residency = shared.workspace.documentResidency;
+  if (residency == nullptr || residency->memoryBudget() == 0) {
+    return;
+  }
+  // Evicting mutates published documents: wait for their readers.
+  std::unique_lock<std::shared_mutex> snapshotGate;
+  if (isolatesSnapshots()) {
+    snapshotGate = std::unique_lock(*_snapshotGate);
+  }
+  residency->enforceBudget();
 }
 
 void DefaultDocumentBuilder::validate(
-    Document &document, utils::CancellationToken cancelToken) const {
+    const std::shared_ptr<Document> &managedDocument,
+    utils::CancellationToken cancelToken) const {
+  auto &document = *managedDocument;
   const auto validator =
       shared.serviceRegistry
-          ->getServices(document.uri)
+          ->getServices(document)
           .validation.documentValidator.get();
   const auto options = getBuildOptions(document);
   validation::ValidationOptions validationOptions;
@@ -583,8 +1216,20 @@ void DefaultDocumentBuilder::validate(
   }
   validationOptions.categories =
       findMissingValidationCategories(document, options);
+  const auto progressListeners =
+      snapshotListeners(_validationProgressListeners);
+  validation::DocumentValidator::Progress progress;
+  if (!progressListeners.empty()) {
+    progress = [&progressListeners, &managedDocument, &cancelToken](
+                   std::span<const pegium::CompactDiagnostic> pending) {
+      for (const auto &entry : progressListeners) {
+        entry.listener(managedDocument, pending, cancelToken);
+      }
+    };
+  }
   auto diagnostics =
-      validator->validateDocument(document, validationOptions, cancelToken);
+      validator->validateDocumentCompact(document, validationOptions,
+                                         cancelToken, progress);
   if (!document.diagnostics.empty()) {
     document.diagnostics.insert(
         document.diagnostics.end(),
@@ -744,6 +1389,7 @@ void DefaultDocumentBuilder::cleanUpDeleted(DocumentId documentId) const {
   {
     std::scoped_lock lock(_stateMutex);
     _buildStateByDocumentId.erase(documentId);
+    _phaseCostsByDocumentId.erase(documentId);
   }
   shared.workspace.indexManager->remove(documentId);
 }
@@ -774,10 +1420,22 @@ utils::ScopedDisposable DefaultDocumentBuilder::onDocumentPhase(
                      std::move(listener));
 }
 
+utils::ScopedDisposable DefaultDocumentBuilder::onValidationProgress(
+    std::function<void(const std::shared_ptr<Document> &,
+                       std::span<const pegium::CompactDiagnostic> pending,
+                       utils::CancellationToken cancelToken)>
+        listener) const {
+  return addListener(_validationProgressListeners, std::move(listener));
+}
+
 void DefaultDocumentBuilder::resetToState(Document &document,
                                           DocumentState state) const {
   const auto documentId =
       ensure_document_id(*shared.workspace.documents, document);
+  if (const auto &residency = shared.workspace.documentResidency;
+      residency != nullptr && state > DocumentState::Changed) {
+    residency->restore(document);
+  }
 
   using enum DocumentState;
   switch (state) {
@@ -790,7 +1448,7 @@ void DefaultDocumentBuilder::resetToState(Document &document,
     [[fallthrough]];
   case ComputedScopes:
     shared.serviceRegistry
-        ->getServices(document.uri)
+        ->getServices(document)
         .references.linker->unlink(document);
     [[fallthrough]];
   case Linked:
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <ranges>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -53,6 +56,11 @@ public:
                   std::function<void(const std::shared_ptr<Document> &,
                                      utils::CancellationToken cancelToken)>
                       listener) const override;
+  utils::ScopedDisposable onValidationProgress(
+      std::function<void(const std::shared_ptr<Document> &,
+                         std::span<const pegium::CompactDiagnostic> pending,
+                         utils::CancellationToken cancelToken)>
+          listener) const override;
 
   void waitUntil(DocumentState state,
                  utils::CancellationToken cancelToken = {}) const override;
@@ -60,6 +68,9 @@ public:
   waitUntil(DocumentState state, DocumentId documentId,
             utils::CancellationToken cancelToken = {}) const override;
 
+  [[nodiscard]] std::shared_ptr<const WorkspaceSnapshot>
+  snapshot() const override;
+
   void resetToState(Document &document, DocumentState state) const override;
 
 private:
@@ -75,6 +86,10 @@ private:
   using DocumentPhaseListener =
       std::function<void(const std::shared_ptr<Document> &document,
                          utils::CancellationToken cancelToken)>;
+  using ValidationProgressListener =
+      std::function<void(const std::shared_ptr<Document> &document,
+                         std::span<const pegium::CompactDiagnostic> pending,
+                         utils::CancellationToken cancelToken)>;
 
   template <typename Listener> struct ListenerEntry {
     std::size_t id = 0;
@@ -99,6 +114,12 @@ private:
                const std::unordered_set<DocumentId> &changedDocumentIds) const;
   [[nodiscard]] bool
   hasTextDocument(const std::shared_ptr<Document> &document) const;
+  // Scheduler lane of @p document: interactive when it has a text document
+  // (the same condition sortDocuments uses) and the current build was asked
+  // for it, open-document when it only has a text document, background
+  // otherwise.
+  [[nodiscard]] execution::TaskPriority
+  documentPriority(const std::shared_ptr<Document> &document) const;
 
   void emitUpdate(std::span<const DocumentId> changedDocumentIds,
                   std::span<const DocumentId> deletedDocumentIds) const;
@@ -113,6 +134,20 @@ private:
                            DocumentState targetState,
                            utils::CancellationToken cancelToken) const;
   void publishWorkspaceState(DocumentState targetState) const;
+  // Cost estimates used to start the most expensive documents of a phase
+  // first: the time each document took in the phase ending at @p phaseEnd
+  // during the previous build when every one of them has such a measurement,
+  // otherwise their text size.
+  [[nodiscard]] std::vector<std::uint64_t>
+  phaseCostHints(const std::vector<std::shared_ptr<Document>> &documents,
+                 const std::vector<std::size_t> &pendingIndexes,
+                 DocumentState phaseEnd) const;
+  // Remembers the measured phase durations (nanoseconds, 0 when the document
+  // did not finish the phase) for the next build's cost hints.
+  void recordPhaseCosts(const std::vector<std::shared_ptr<Document>> &documents,
+                        const std::vector<std::size_t> &pendingIndexes,
+                        DocumentState phaseEnd,
+                        const std::vector<std::uint64_t> &durations) const;
   // Records one document's progress by setting its state to @p targetState.
   // Per-document phase listeners are NOT notified here: runMergedPhase fires them
   // serially and in document order once the phase has drained.
@@ -132,8 +167,47 @@ private:
                       const BuildOptions &options,
                       utils::CancellationToken cancelToken,
                       const std::function<void()> &downgradeLock) const;
+  // Reconciles linked documents with the documents re-indexed since the last
+  // call, whether by `build` or `update`: dependants of changed exports are reset (and scheduled into
+  // @p documents), references into documents whose exports kept their
+  // fingerprint are rebound onto the new ASTs. Then forgets those changes.
+  void relinkAffectedDocuments(std::vector<std::shared_ptr<Document>> &documents,
+                               const BuildOptions &options) const;
+  // Pipelined replacement of the link and validate phases: each document is
+  // validated right after being linked, with per-document phase listeners
+  // fired serially as documents reach each state (each document's states in
+  // phase order) rather than after a phase-wide barrier.
+  void linkAndValidatePipelined(
+      std::vector<std::shared_ptr<Document>> &documents,
+      utils::CancellationToken cancelToken,
+      const std::function<void()> &downgradeLock) const;
+  // Whether documents are rebuilt as new versions (BuildOptions::
+  // isolateSnapshots).
+  [[nodiscard]] bool isolatesSnapshots() const noexcept;
+  // Invalidates @p document back to @p state. Under snapshot isolation a
+  // document past @p state that is in the store is not touched: a new version
+  // replaces it there, reset to @p state. Returns the document to build.
+  [[nodiscard]] std::shared_ptr<Document>
+  resetForRebuild(const std::shared_ptr<Document> &document,
+                  DocumentState state) const;
+  // Resets @p successor to @p state and stores it in place of the document
+  // version it succeeds, which is retired.
+  void installSuccessor(const std::shared_ptr<Document> &successor,
+                        DocumentState state) const;
+  // Keeps @p document alive for the readers of published snapshots.
+  void retire(std::shared_ptr<Document> document) const;
+  // Publishes the store as the next snapshot: completed documents, and the
+  // previously published version of the others.
+  void publishSnapshot() const;
+  // Drops the published snapshot once its readers are done, for builds that
+  // no longer isolate them.
+  void withdrawSnapshot() const;
   void markAsCompleted(const Document &document) const;
-  void validate(Document &document, utils::CancellationToken cancelToken) const;
+  // Evicts documents over the residency budget. Only called while the builder
+  // holds exclusive access to the workspace documents.
+  void enforceResidencyBudget() const;
+  void validate(const std::shared_ptr<Document> &document,
+                utils::CancellationToken cancelToken) const;
   void awaitBuilderState(DocumentState state,
                          utils::CancellationToken cancelToken) const;
   [[nodiscard]] DocumentId
@@ -162,6 +236,27 @@ private:
       _publishedWorkspaceStates{};
   mutable std::unordered_map<DocumentId, DocumentBuildState>
       _buildStateByDocumentId;
+  // Documents reparsed, re-indexed or removed since dependants were last
+  // reconciled against them by relinkAffectedDocuments.
+  mutable std::unordered_set<DocumentId> _documentsWithExportChanges;
+  // Documents the current build was asked for: changed by update or passed to
+  // build. Builds are serialised, so one set serves the running build.
+  mutable std::unordered_set<DocumentId> _requestedDocumentIds;
+  // Last measured duration (nanoseconds) of each merged phase per document,
+  // indexed by the phase's end state; 0 when never measured.
+  mutable std::unordered_map<DocumentId,
+                             std::array<std::uint64_t, kDocumentStateCount>>
+      _phaseCostsByDocumentId;
+  mutable std::shared_ptr<const WorkspaceSnapshot> _snapshot;
+  mutable std::uint64_t _snapshotVersion = 0;
+  // Collects the document versions replaced since the last publication; the
+  // published snapshot and every older one keep it alive.
+  mutable std::shared_ptr<WorkspaceSnapshot::Retirement> _retirement =
+      std::make_shared<WorkspaceSnapshot::Retirement>();
+  // Held shared by snapshot readers, exclusively while references of published
+  // documents are moved onto new versions of their targets.
+  std::shared_ptr<std::shared_mutex> _snapshotGate =
+      std::make_shared<std::shared_mutex>();
 
   std::shared_ptr<ListenerState<UpdateListener>> _updateListeners =
       std::make_shared<ListenerState<UpdateListener>>();
@@ -171,6 +266,9 @@ private:
   std::array<std::shared_ptr<ListenerState<DocumentPhaseListener>>,
              kDocumentStateCount>
       _documentPhaseListeners = makeListenerStates<DocumentPhaseListener>();
+  std::shared_ptr<ListenerState<ValidationProgressListener>>
+      _validationProgressListeners =
+          std::make_shared<ListenerState<ValidationProgressListener>>();
 };
 
 template <typename Body>
@@ -194,20 +292,40 @@ void DefaultDocumentBuilder::runMergedPhase(
 
   // Run the per-document work in parallel; each document is touched by exactly
   // one task (single writer), so advancing document->state inside body is safe.
+  // Each task also times its document for the next build's cost hints.
+  std::vector<std::uint64_t> durations(pendingIndexes.size(), 0);
   const auto runOne = [&](std::size_t pos) {
+    const auto start = std::chrono::steady_clock::now();
     bodyFn(documents[pendingIndexes[pos]], entryStates[pos], cancelToken);
+    durations[pos] = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
   };
 
-  if (taskScheduler == nullptr || pendingIndexes.size() <= 1) {
-    for (std::size_t pos = 0; pos < pendingIndexes.size(); ++pos) {
-      utils::throw_if_cancelled(cancelToken);
-      runOne(pos);
+  try {
+    if (taskScheduler == nullptr || pendingIndexes.size() <= 1) {
+      for (std::size_t pos = 0; pos < pendingIndexes.size(); ++pos) {
+        utils::throw_if_cancelled(cancelToken);
+        runOne(pos);
+      }
+    } else {
+      // Documents open in an editor first, then longest first, so a few large
+      // documents do not start last and dominate the phase's wall time.
+      const auto costs = phaseCostHints(documents, pendingIndexes, phaseEnd);
+      taskScheduler->parallelFor(
+          cancelToken, std::views::iota(std::size_t{0}, pendingIndexes.size()),
+          [&runOne](std::size_t pos) { runOne(pos); },
+          [&costs](std::size_t pos) { return costs[pos]; },
+          [this, &documents, &pendingIndexes](std::size_t pos) {
+            return documentPriority(documents[pendingIndexes[pos]]);
+          });
     }
-  } else {
-    taskScheduler->parallelFor(
-        cancelToken, std::views::iota(std::size_t{0}, pendingIndexes.size()),
-        [&runOne](std::size_t pos) { runOne(pos); });
+  } catch (...) {
+    recordPhaseCosts(documents, pendingIndexes, phaseEnd, durations);
+    throw;
   }
+  recordPhaseCosts(documents, pendingIndexes, phaseEnd, durations);
 
   // Notify per-document phase listeners serially and in document order (which
   // prioritizes open documents), for every state each document newly reached
@@ -1,6 +1,7 @@
 #include <pegium/core/workspace/DefaultDocumentFactory.hpp>
 
 #include <cassert>
+#include <optional>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
@@ -9,6 +10,7 @@
 #include <pegium/core/services/ServiceRegistry.hpp>
 #include <pegium/core/services/SharedCoreServices.hpp>
 #include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/utils/ContentHash.hpp>
 #include <pegium/core/utils/Errors.hpp>
 #include <pegium/core/utils/UriUtils.hpp>
 
@@ -61,31 +63,89 @@ std::shared_ptr<Document> DefaultDocumentFactory::fromUri(
     }
   }
 
+  const auto file = statSourceFile(normalizedUri);
   const auto content =
       shared.workspace.fileSystemProvider->readFile(normalizedUri);
   const auto &services = shared.serviceRegistry->getServices(normalizedUri);
   auto textDocument = createTextDocument(
       content, normalizedUri, services.languageMetaData.languageId, 0);
-  return createDocument(std::move(textDocument), services, cancelToken);
+  auto document =
+      createDocument(std::move(textDocument), services, cancelToken);
+  recordSourceFile(*document, file);
+  return document;
+}
+
+std::shared_ptr<Document> DefaultDocumentFactory::fromUriUnparsed(
+    std::string_view uri, const utils::CancellationToken &cancelToken) const {
+  utils::throw_if_cancelled(cancelToken);
+  const auto normalizedUri = utils::normalize_uri(uri);
+  const auto &services = shared.serviceRegistry->getServices(normalizedUri);
+  std::shared_ptr<TextDocument> textDocument;
+  if (const auto provider = shared.workspace.textDocuments;
+      provider != nullptr) {
+    textDocument = provider->getNormalized(normalizedUri);
+  }
+  // Text owned by the text document provider is looked up again on update
+  // anyway; only file content is worth keeping for the first parse.
+  const auto loadedFromFile = textDocument == nullptr;
+  FileSystemNode file;
+  if (loadedFromFile) {
+    file = statSourceFile(normalizedUri);
+    textDocument = createTextDocument(
+        shared.workspace.fileSystemProvider->readFile(normalizedUri),
+        normalizedUri, services.languageMetaData.languageId, 0);
+  }
+  textDocument = normalizeTextDocument(std::move(textDocument),
+                                       services.languageMetaData.languageId);
+
+  auto document =
+      std::make_shared<Document>(textDocument, textDocument->uri());
+  (void)shared.serviceRegistry->getServices(*document);
+  if (loadedFromFile) {
+    recordSourceFile(*document, file);
+    markLoadedTextPending(*document);
+  }
+  return document;
 }
 
 Document &DefaultDocumentFactory::update(
     Document &document, const utils::CancellationToken &cancelToken) const {
   utils::throw_if_cancelled(cancelToken);
+  const auto loadedTextPending = takeLoadedTextPending(document);
 
   const auto previousParsedText = previous_analyzed_text(document);
   if (document.uri.empty()) {
     throw utils::DocumentFactoryError("Cannot update a document without URI.");
   }
 
-  const auto &services = shared.serviceRegistry->getServices(document.uri);
   std::shared_ptr<TextDocument> latestTextDocument;
   if (const auto provider = shared.workspace.textDocuments;
       provider != nullptr) {
     latestTextDocument = provider->getNormalized(document.uri);
   }
+  // The cached binding follows the language of the attached text document;
+  // resolve the URI again only when the new text may carry another language.
+  const auto keepsLanguage =
+      latestTextDocument != nullptr
+          ? latestTextDocument->languageId() ==
+                document.textDocument().languageId()
+          : loadedTextPending;
+  const auto &services = keepsLanguage
+                             ? shared.serviceRegistry->getServices(document)
+                             : shared.serviceRegistry->getServices(document.uri);
 
+  if (latestTextDocument == nullptr && loadedTextPending &&
+      document.state < DocumentState::Parsed) {
+    // Created by fromUriUnparsed: the attached text is the file content read
+    // then, so parse it rather than reading the file a second time.
+    parse(document, services, cancelToken);
+    document.state = DocumentState::Parsed;
+    return document;
+  }
+
+  std::optional<FileSystemNode> file;
   if (latestTextDocument == nullptr) {
+    file = statSourceFile(document.uri);
     const auto content =
         shared.workspace.fileSystemProvider->readFile(document.uri);
     latestTextDocument = createTextDocument(
@@ -101,6 +161,9 @@ Document &DefaultDocumentFactory::update(
       document.state < DocumentState::Parsed || textChanged;
 
   attachTextDocument(document, latestTextDocument);
+  if (file.has_value()) {
+    recordSourceFile(document, *file);
+  }
 
   if (needsParse) {
     resetAnalysisState(document);
@@ -111,6 +174,97 @@ Document &DefaultDocumentFactory::update(
   return document;
 }
 
+std::shared_ptr<Document>
+DefaultDocumentFactory::createSuccessor(const Document &document) const {
+  assert(!document.uri.empty());
+  return makeSuccessor(document);
+}
+
+bool DefaultDocumentFactory::isUnchangedOnDisk(
+    Document &document, const utils::CancellationToken &cancelToken) const {
+  utils::throw_if_cancelled(cancelToken);
+  if (document.uri.empty() || !hasSourceFile(document)) {
+    return false;
+  }
+  // A parsed document holding newer text than it was analyzed from (kept by
+  // an earlier call whose rebuild did not happen) is stale whatever the file
+  // holds now.
+  if (document.state >= DocumentState::Parsed &&
+      hasLoadedTextPending(document)) {
+    return false;
+  }
+  if (const auto provider = shared.workspace.textDocuments;
+      provider != nullptr && provider->getNormalized(document.uri) != nullptr) {
+    return false;
+  }
+
+  const auto file = statSourceFile(document.uri);
+  if (matchesSourceFile(document, file)) {
+    return true;
+  }
+  const auto &analyzed = document.textDocument();
+  if (file.modifiedTime != 0 && file.size != analyzed.getText().size()) {
+    return false;
+  }
+
+  std::string content;
+  try {
+    content = shared.workspace.fileSystemProvider->readFile(document.uri);
+  } catch (const std::exception &) {
+    return false;
+  }
+  if (content.size() == analyzed.getText().size() &&
+      utils::content_hash(content) == analyzed.contentHash()) {
+    recordSourceFile(document, file);
+    return true;
+  }
+
+  // Keep what was read so the rebuild does not read the file a second time.
+  const auto &languageId = analyzed.languageId();
+  attachTextDocument(document,
+                     createTextDocument(std::move(content), document.uri,
+                                        languageId, 0));
+  recordSourceFile(document, file);
+  markLoadedTextPending(document);
+  return false;
+}
+
+bool DefaultDocumentFactory::isParsedFromCurrentText(
+    const Document &document) const {
+  if (document.uri.empty() || document.state < DocumentState::Parsed ||
+      hasLoadedTextPending(document)) {
+    return false;
+  }
+  const auto provider = shared.workspace.textDocuments;
+  if (provider == nullptr) {
+    return false;
+  }
+  const auto latest = provider->getNormalized(document.uri);
+  if (latest == nullptr) {
+    return false;
+  }
+  const auto &analyzed = document.textDocument();
+  if (latest.get() == &analyzed) {
+    return true;
+  }
+  // The parser may have been given a normalized copy of the provider text:
+  // compare contents, the hash first to reject most edits cheaply.
+  return latest->languageId() == analyzed.languageId() &&
+         latest->contentHash() == analyzed.contentHash() &&
+         previous_analyzed_text(document) == latest->getText();
+}
+
+FileSystemNode
+DefaultDocumentFactory::statSourceFile(std::string_view uri) const {
+  // Metadata only speeds up change detection; a provider that cannot stat a
+  // readable file simply leaves it unknown.
+  try {
+    return shared.workspace.fileSystemProvider->stat(uri);
+  } catch (const std::exception &) {
+    return {};
+  }
+}
+
 std::shared_ptr<Document> DefaultDocumentFactory::createDocument(
     std::shared_ptr<TextDocument> textDocument,
     const pegium::CoreServices &services,
@@ -122,6 +276,8 @@ std::shared_ptr<Document> DefaultDocumentFactory::createDocument(
 
   auto document =
       std::make_shared<Document>(textDocument, textDocument->uri());
+  // Bind the services once; the build phases reuse the cached binding.
+  (void)shared.serviceRegistry->getServices(*document);
   parse(*document, services, cancelToken);
   document->state = DocumentState::Parsed;
   return document;
@@ -158,6 +314,7 @@ void DefaultDocumentFactory::parse(
   utils::throw_if_cancelled(cancelToken);
   document.parseResult = services.parser->parse(snapshot(document.textDocument()),
                                                 cancelToken);
+  startRevision(document);
   if (document.parseResult.cst != nullptr) {
     document.parseResult.cst->attachDocument(document);
   }
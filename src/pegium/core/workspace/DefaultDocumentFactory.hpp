@@ -29,11 +29,27 @@ public:
   fromUri(std::string_view uri,
           const utils::CancellationToken &cancelToken = {}) const override;
 
+  [[nodiscard]] std::shared_ptr<Document>
+  fromUriUnparsed(std::string_view uri,
+                  const utils::CancellationToken &cancelToken = {}) const override;
+
   Document &update(
       Document &document,
       const utils::CancellationToken &cancelToken = {}) const override;
 
+  [[nodiscard]] std::shared_ptr<Document>
+  createSuccessor(const Document &document) const override;
+
+  [[nodiscard]] bool
+  isUnchangedOnDisk(Document &document,
+                    const utils::CancellationToken &cancelToken = {}) const override;
+
+  [[nodiscard]] bool
+  isParsedFromCurrentText(const Document &document) const override;
+
 private:
+  [[nodiscard]] FileSystemNode statSourceFile(std::string_view uri) const;
+
   [[nodiscard]] std::shared_ptr<Document>
   createDocument(std::shared_ptr<TextDocument> textDocument,
                  const pegium::CoreServices &services,
@@ -0,0 +1,174 @@
+#include <pegium/core/workspace/DefaultDocumentResidency.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <pegium/core/services/CoreServices.hpp>
+#include <pegium/core/services/ServiceRegistry.hpp>
+#include <pegium/core/services/SharedCoreServices.hpp>
+#include <pegium/core/utils/Disposable.hpp>
+#include <pegium/core/workspace/Documents.hpp>
+#include <pegium/core/workspace/IndexManager.hpp>
+#include <pegium/core/workspace/TextDocumentProvider.hpp>
+
+namespace pegium::workspace {
+
+void DefaultDocumentResidency::setMemoryBudget(std::size_t bytes) {
+  _memoryBudget.store(bytes, std::memory_order_relaxed);
+}
+
+std::size_t DefaultDocumentResidency::memoryBudget() const noexcept {
+  return _memoryBudget.load(std::memory_order_relaxed);
+}
+
+std::size_t
+DefaultDocumentResidency::residentBytes(const Document &document) const {
+  if (document.isEvicted()) {
+    return 0;
+  }
+  const auto &parseResult = document.parseResult;
+  std::size_t bytes = 0;
+  if (parseResult.cst != nullptr) {
+    bytes += parseResult.cst->allocatedBytes();
+  }
+  bytes += parseResult.references.capacity() * sizeof(ReferenceHandle);
+  bytes += document.localSymbols.allocatedBytes();
+  return bytes;
+}
+
+std::size_t DefaultDocumentResidency::residentBytes() const {
+  std::size_t bytes = 0;
+  for (const auto &document : shared.workspace.documents->all()) {
+    bytes += residentBytes(*document);
+  }
+  return bytes;
+}
+
+void DefaultDocumentResidency::touch(const Document &document) {
+  std::scoped_lock lock(_useMutex);
+  _lastUse.insert_or_assign(document.id, ++_clock);
+}
+
+bool DefaultDocumentResidency::isEvictable(const Document &document) const {
+  if (document.state < DocumentState::IndexedReferences ||
+      document.parseResult.cst == nullptr) {
+    return false;
+  }
+  const auto *textDocuments = shared.workspace.textDocuments.get();
+  return textDocuments == nullptr ||
+         textDocuments->getNormalized(document.uri) == nullptr;
+}
+
+void DefaultDocumentResidency::enforceBudget() {
+  const auto budget = memoryBudget();
+  if (budget == 0) {
+    return;
+  }
+  auto documents = shared.workspace.documents->all();
+  std::size_t total = 0;
+  std::vector<std::pair<std::uint64_t, std::shared_ptr<Document>>> candidates;
+  {
+    std::scoped_lock lock(_useMutex);
+    std::unordered_map<DocumentId, std::uint64_t> lastUse;
+    lastUse.reserve(documents.size());
+    for (const auto &document : documents) {
+      total += residentBytes(*document);
+      const auto use = _lastUse.find(document->id);
+      const auto tick = use == _lastUse.end() ? 0 : use->second;
+      if (use != _lastUse.end()) {
+        lastUse.emplace(document->id, tick);
+      }
+      if (!document->isEvicted() && isEvictable(*document)) {
+        candidates.emplace_back(tick, document);
+      }
+    }
+    // Forget deleted documents.
+    _lastUse = std::move(lastUse);
+  }
+  if (total <= budget) {
+    return;
+  }
+  std::ranges::stable_sort(candidates, {}, [](const auto &candidate) {
+    return candidate.first;
+  });
+
+  std::unordered_set<DocumentId> evictedIds;
+  for (const auto &[tick, document] : candidates) {
+    if (total <= budget) {
+      break;
+    }
+    total -= residentBytes(*document);
+    evict(*document);
+    evictedIds.insert(document->id);
+  }
+  if (evictedIds.empty()) {
+    return;
+  }
+
+  // Resolved references into an evicted AST would dangle: reset them so that
+  // they resolve again, restoring their target, on their next access.
+  auto &documentStore = *shared.workspace.documents;
+  const auto reload = [&documentStore, &evictedIds](
+                          const AstNodeDescription &description)
+      -> ResolvedAstNodeDescription {
+    if (evictedIds.contains(description.documentId)) {
+      return {};
+    }
+    const auto target = documentStore.getDocument(description.documentId);
+    if (target == nullptr || target->isEvicted()) {
+      return {};
+    }
+    return {.node = target->findAstNode(description.symbolId)};
+  };
+  for (const auto &document : documents) {
+    if (document->isEvicted() ||
+        !shared.workspace.indexManager->isAffected(*document, evictedIds)) {
+      continue;
+    }
+    for (const auto &handle : document->parseResult.references) {
+      const auto *reference = handle.getConst();
+      if (!reference->rebindTargets(
+              utils::function_ref<ResolvedAstNodeDescription(
+                  const AstNodeDescription &)>(reload))) {
+        reference->clearLinkState();
+      }
+    }
+  }
+}
+
+void DefaultDocumentResidency::restore(const Document &document) const {
+  if (!document.isEvicted()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(_restoreMutex);
+    if (!document.isEvicted() || !_restoring.insert(&document).second) {
+      return;
+    }
+    const utils::ScopedDisposable restoring(
+        [this, &document] { _restoring.erase(&document); });
+    // Readers of `document` may run meanwhile: everything is built on a staged
+    // copy and only published once complete.
+    const auto staged = stage(document);
+    const auto &services = shared.serviceRegistry->getServices(*staged);
+    staged->parseResult =
+        services.parser->parse(snapshot(staged->textDocument()), {});
+    if (staged->parseResult.cst != nullptr) {
+      staged->parseResult.cst->attachDocument(*staged);
+    }
+    if (staged->parseResult.astArena != nullptr) {
+      staged->parseResult.astArena->attachDocument(
+          *staged, services.shared.astReflection.get());
+    }
+    staged->localSymbols =
+        services.references.scopeComputation->collectLocalSymbols(*staged, {});
+    publishRestored(document, *staged);
+  }
+  std::scoped_lock lock(_useMutex);
+  _lastUse.insert_or_assign(document.id, ++_clock);
+}
+
+} // namespace pegium::workspace
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <pegium/core/services/DefaultSharedCoreService.hpp>
+#include <pegium/core/workspace/DocumentResidency.hpp>
+
+namespace pegium::workspace {
+
+/// Default residency: evicts built documents without an open text document,
+/// least recently used first, once the workspace exceeds the memory budget.
+///
+/// Resident bytes are the bytes of the CST pool (which also holds the AST
+/// nodes), the bytes of the local symbols and an estimate of the reference
+/// handles.
+class DefaultDocumentResidency : public DocumentResidency,
+                                 protected pegium::DefaultSharedCoreService {
+public:
+  using pegium::DefaultSharedCoreService::DefaultSharedCoreService;
+
+  void setMemoryBudget(std::size_t bytes) override;
+  [[nodiscard]] std::size_t memoryBudget() const noexcept override;
+
+  [[nodiscard]] std::size_t
+  residentBytes(const Document &document) const override;
+  [[nodiscard]] std::size_t residentBytes() const override;
+
+  void touch(const Document &document) override;
+  void enforceBudget() override;
+  void restore(const Document &document) const override;
+
+protected:
+  /// Returns whether `document` may be evicted: built past its references
+  /// index and not opened in the text document provider.
+  [[nodiscard]] virtual bool isEvictable(const Document &document) const;
+
+private:
+  std::atomic<std::size_t> _memoryBudget = 0;
+  // Serializes restores. Recursive: computing the local symbols of a restored
+  // document may look up nodes of another evicted document.
+  mutable std::recursive_mutex _restoreMutex;
+  mutable std::unordered_set<const Document *> _restoring;
+  // Guards the use clock and ticks; never held while parsing.
+  mutable std::mutex _useMutex;
+  mutable std::uint64_t _clock = 0;
+  mutable std::unordered_map<DocumentId, std::uint64_t> _lastUse;
+};
+
+} // namespace pegium::workspace
@@ -8,6 +8,7 @@
 #include <pegium/core/services/SharedCoreServices.hpp>
 #include <pegium/core/utils/Errors.hpp>
 #include <pegium/core/utils/UriUtils.hpp>
+#include <pegium/core/workspace/WorkspaceSnapshot.hpp>
 
 namespace pegium::workspace {
 
@@ -48,11 +49,35 @@ void DefaultDocuments::addDocument(std::shared_ptr<Document> document) {
   (void)addDocumentLocked(std::move(document));
 }
 
+std::shared_ptr<Document>
+DefaultDocuments::replaceDocument(std::shared_ptr<Document> document) {
+  assert(document != nullptr);
+  if (document->uri.empty()) {
+    throw utils::DocumentStoreError("Cannot add a document without URI.");
+  }
+  if (document->uri != utils::normalize_uri(document->uri)) {
+    throw utils::DocumentStoreError(
+        "Cannot add a document with a non-normalized URI.");
+  }
+
+  std::scoped_lock lock(_mutex);
+  std::shared_ptr<Document> replaced;
+  if (const auto *existing = _documents.find(document->uri);
+      existing != nullptr) {
+    replaced = *existing;
+  }
+  (void)addDocumentLocked(std::move(document));
+  return replaced;
+}
+
 bool DefaultDocuments::hasDocument(std::string_view uri) const {
   const auto normalizedUri = utils::normalize_uri(uri);
   if (normalizedUri.empty()) {
     return false;
   }
+  if (const auto *snapshot = WorkspaceSnapshot::active(); snapshot != nullptr) {
+    return snapshot->findDocument(normalizedUri) != nullptr;
+  }
   std::scoped_lock lock(_mutex);
   return _documents.has(normalizedUri);
 }
@@ -63,6 +88,9 @@ std::shared_ptr<Document> DefaultDocuments::getDocument(
   if (normalizedUri.empty()) {
     return nullptr;
   }
+  if (const auto *snapshot = WorkspaceSnapshot::active(); snapshot != nullptr) {
+    return snapshot->findDocument(normalizedUri);
+  }
   std::scoped_lock lock(_mutex);
   const auto *document = _documents.find(normalizedUri);
   return document != nullptr ? *document : nullptr;
@@ -72,6 +100,9 @@ std::shared_ptr<Document> DefaultDocuments::getDocument(DocumentId id) const {
   if (id == InvalidDocumentId) {
     return nullptr;
   }
+  if (const auto *snapshot = WorkspaceSnapshot::active(); snapshot != nullptr) {
+    return snapshot->findDocument(id);
+  }
   std::scoped_lock lock(_mutex);
   const auto it = _documentsById.find(id);
   return it == _documentsById.end() ? nullptr : it->second;
@@ -180,6 +211,10 @@ std::vector<std::shared_ptr<Document>> DefaultDocuments::deleteDocuments(
 }
 
 std::vector<std::shared_ptr<Document>> DefaultDocuments::all() const {
+  if (const auto *snapshot = WorkspaceSnapshot::active(); snapshot != nullptr) {
+    const auto documents = snapshot->documents();
+    return {documents.begin(), documents.end()};
+  }
   std::scoped_lock lock(_mutex);
   return _documents.all();
 }
@@ -20,6 +20,9 @@ public:
 
   void addDocument(std::shared_ptr<Document> document) override;
 
+  std::shared_ptr<Document>
+  replaceDocument(std::shared_ptr<Document> document) override;
+
   [[nodiscard]] DocumentId getDocumentId(std::string_view uri) const override;
 
   [[nodiscard]] DocumentId getOrCreateDocumentId(std::string_view uri) override;
@@ -1,14 +1,86 @@
 #include <pegium/core/workspace/DefaultIndexManager.hpp>
 
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
 #include <ranges>
+#include <string_view>
+#include <utility>
 
+#include <pegium/core/references/ScopeProvider.hpp>
 #include <pegium/core/services/ServiceRegistry.hpp>
 #include <pegium/core/syntax-tree/AstReflection.hpp>
+#include <pegium/core/utils/TypeIndexHash.hpp>
 #include <pegium/core/workspace/Document.hpp>
 
 namespace pegium::workspace {
 
+namespace {
+
+template <typename Keys>
+void add_symbol_key(Keys &keys, std::string_view name, std::type_index type) {
+  auto it = keys.find(name);
+  if (it == keys.end()) {
+    it = keys.try_emplace(std::string(name)).first;
+  }
+  if (std::ranges::find(it->second, type) == it->second.end()) {
+    it->second.push_back(type);
+  }
+}
+
+using ExportedEntries =
+    std::unordered_map<utils::InternedString, std::vector<std::type_index>>;
+
+// Groups the types of the exports by name, in export order: the first entry of
+// a name wins in the global scope, so reordering matters too. Symbol ids are
+// left out, as they shift with any node added or removed before an export.
+ExportedEntries group_by_name(const std::vector<AstNodeDescription> &exports) {
+  ExportedEntries grouped;
+  for (const auto &description : exports) {
+    grouped[description.name].push_back(description.type);
+  }
+  return grouped;
+}
+
+// splitmix64 finalizer: cheap, and good enough avalanche that combining
+// fingerprints by addition stays collision-resistant.
+constexpr std::uint64_t mix(std::uint64_t value) noexcept {
+  value ^= value >> 30U;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27U;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31U;
+  return value;
+}
+
+// Order-sensitive: the first export of a name wins in the global scope.
+// `names` covers what dependants resolve by, `symbols` the nodes the
+// descriptions point at and the parse they belong to.
+DefaultIndexManager::ExportsFingerprint
+exports_fingerprint(const std::vector<AstNodeDescription> &exports) {
+  DefaultIndexManager::ExportsFingerprint fingerprint{
+      .names = mix(exports.size()), .symbols = mix(exports.size())};
+  for (const auto &description : exports) {
+    fingerprint.names = mix(fingerprint.names ^ std::hash<utils::InternedString>{}(
+                                                    description.name));
+    fingerprint.names =
+        mix(fingerprint.names ^ utils::FastTypeIndexHash{}(description.type));
+    fingerprint.symbols = mix(fingerprint.symbols ^ description.symbolId);
+    fingerprint.symbols =
+        mix(fingerprint.symbols ^ description.documentRevision);
+  }
+  return fingerprint;
+}
+
+std::uint64_t workspace_contribution(
+    DocumentId documentId,
+    const DefaultIndexManager::ExportsFingerprint &fingerprint) noexcept {
+  return mix(fingerprint.names ^ mix(fingerprint.symbols ^ mix(documentId)));
+}
+
+} // namespace
+
 DefaultIndexManager::DefaultIndexManager(
     pegium::SharedCoreServices &sharedServices)
     : pegium::DefaultSharedCoreService(sharedServices) {}
@@ -16,19 +88,53 @@ DefaultIndexManager::DefaultIndexManager(
 void DefaultIndexManager::updateContent(Document &document,
                                         utils::CancellationToken cancelToken) {
   const auto &services =
-      shared.serviceRegistry->getServices(document.uri);
+      shared.serviceRegistry->getServices(document);
   auto exports = services.references.scopeComputation->collectExportedSymbols(
       document, cancelToken);
+  for (auto &description : exports) {
+    description.documentRevision = document.revision();
+  }
+
+  const auto fingerprint = exports_fingerprint(exports);
 
   std::scoped_lock lock(_mutex);
+  const auto baseline = _exportsFingerprintByDocument.find(document.id);
+  const auto current = _exportsByDocument.find(document.id);
+  // Most edits leave the exported names untouched: no delta to record, and
+  // dependants only need rebinding. The reparse still gives the exports a new
+  // revision, and edits before an export move its symbol id, both of which the
+  // typed views cached for this document copy.
+  const bool known = baseline != _exportsFingerprintByDocument.end();
+  if (!known || baseline->second.names != fingerprint.names) {
+    static const std::vector<AstNodeDescription> noExports;
+    const auto *previous = std::addressof(noExports);
+    if (const auto it = _previousExportsByDocument.find(document.id);
+        it != _previousExportsByDocument.end()) {
+      previous = std::addressof(it->second);
+    } else if (current != _exportsByDocument.end()) {
+      previous = std::addressof(current->second);
+    }
+    recordExportChangesLocked(document.id, *previous, exports);
+  }
+  if (!known || baseline->second != fingerprint) {
+    _exportsByTypeCache.clear(document.id);
+  }
+  _previousExportsByDocument.erase(document.id);
+
+  if (current != _exportsByDocument.end()) {
+    assert(baseline != _exportsFingerprintByDocument.end());
+    _workspaceExportsFingerprint -=
+        workspace_contribution(document.id, baseline->second);
+  }
+  _workspaceExportsFingerprint += workspace_contribution(document.id, fingerprint);
+  _exportsFingerprintByDocument.insert_or_assign(document.id, fingerprint);
   _exportsByDocument.insert_or_assign(document.id, std::move(exports));
-  _exportsByTypeCache.clear(document.id);
 }
 
 void DefaultIndexManager::updateReferences(
     Document &document, utils::CancellationToken cancelToken) {
   const auto &services =
-      shared.serviceRegistry->getServices(document.uri);
+      shared.serviceRegistry->getServices(document);
   auto descriptions =
       services.workspace.referenceDescriptionProvider->createDescriptions(
           document, cancelToken);
@@ -37,8 +143,38 @@ void DefaultIndexManager::updateReferences(
     reference.sourceDocumentId = document.id;
   }
 
+  // Record every name this document looks up, resolved or not: a later export
+  // change under one of these keys is what can change its linking result.
+  const auto *scopeProvider = services.references.scopeProvider.get();
+  SymbolKeys lookupKeys;
+  bool unkeyedLookups = false;
+  for (const auto &handle : document.parseResult.references) {
+    const auto &reference = *handle.getConst();
+    if (reference.getRefText().empty()) {
+      continue;
+    }
+    const auto type = reference.getReferenceType();
+    if (scopeProvider == nullptr) {
+      add_symbol_key(lookupKeys, reference.getRefText(), type);
+      continue;
+    }
+    const auto addLookupKey = [&lookupKeys, type](std::string_view name) {
+      add_symbol_key(lookupKeys, name, type);
+    };
+    const auto told = scopeProvider->visitLookupNames(
+        makeReferenceInfo(reference),
+        utils::function_ref<void(std::string_view)>(addLookupKey));
+    unkeyedLookups = unkeyedLookups || (!told && reference.hasError());
+  }
+
   std::scoped_lock lock(_mutex);
   _referencesByDocument.insert_or_assign(document.id, std::move(descriptions));
+  _lookupKeysByDocument.insert_or_assign(document.id, std::move(lookupKeys));
+  if (unkeyedLookups) {
+    _unkeyedLookupDocuments.insert(document.id);
+  } else {
+    _unkeyedLookupDocuments.erase(document.id);
+  }
   _referenceTargetCacheDirty = true;
 }
 
@@ -48,11 +184,19 @@ bool DefaultIndexManager::removeContent(DocumentId documentId) {
     return false;
   }
 
-  const bool removed = _exportsByDocument.erase(documentId) > 0;
-  if (removed) {
-    _exportsByTypeCache.clear(documentId);
+  const auto exportsIt = _exportsByDocument.find(documentId);
+  if (exportsIt == _exportsByDocument.end()) {
+    return false;
   }
-  return removed;
+  // Keep the oldest baseline when the document is removed again before being
+  // re-indexed: dependants were linked against that one. Its fingerprint and
+  // typed views are kept too; updateContent drops them if the exports change.
+  _previousExportsByDocument.try_emplace(documentId,
+                                         std::move(exportsIt->second));
+  _exportsByDocument.erase(exportsIt);
+  _workspaceExportsFingerprint -= workspace_contribution(
+      documentId, _exportsFingerprintByDocument.at(documentId));
+  return true;
 }
 
 bool DefaultIndexManager::removeReferences(DocumentId documentId) {
@@ -61,6 +205,8 @@ bool DefaultIndexManager::removeReferences(DocumentId documentId) {
     return false;
   }
 
+  _lookupKeysByDocument.erase(documentId);
+  _unkeyedLookupDocuments.erase(documentId);
   const bool removed = _referencesByDocument.erase(documentId) > 0;
   if (removed) {
     _referenceTargetCacheDirty = true;
@@ -74,11 +220,31 @@ bool DefaultIndexManager::remove(DocumentId documentId) {
     return false;
   }
 
+  // Every symbol the document exported (or exported when dependants were last
+  // linked) disappears from the global scope.
+  static const std::vector<AstNodeDescription> noExports;
+  if (const auto it = _previousExportsByDocument.find(documentId);
+      it != _previousExportsByDocument.end()) {
+    recordExportChangesLocked(documentId, it->second, noExports);
+    _previousExportsByDocument.erase(it);
+  } else if (const auto current = _exportsByDocument.find(documentId);
+             current != _exportsByDocument.end()) {
+    recordExportChangesLocked(documentId, current->second, noExports);
+  }
+
   const bool removedContent = _exportsByDocument.erase(documentId) > 0;
   const bool removedReferences = _referencesByDocument.erase(documentId) > 0;
-  if (removedContent) {
-    _exportsByTypeCache.clear(documentId);
+  _lookupKeysByDocument.erase(documentId);
+  _unkeyedLookupDocuments.erase(documentId);
+  if (const auto fingerprint = _exportsFingerprintByDocument.find(documentId);
+      fingerprint != _exportsFingerprintByDocument.end()) {
+    if (removedContent) {
+      _workspaceExportsFingerprint -=
+          workspace_contribution(documentId, fingerprint->second);
+    }
+    _exportsFingerprintByDocument.erase(fingerprint);
   }
+  _exportsByTypeCache.clear(documentId);
   if (removedReferences) {
     _referenceTargetCacheDirty = true;
   }
@@ -116,13 +282,21 @@ DefaultIndexManager::findByName(std::string_view name,
   // Scan in the same order allElements() produces (documents ordered by id, then
   // each document's export order) and stop at the first name match, copying out
   // a single description under the lock — avoids materializing the whole index.
+  // A name never interned is exported by no document.
+  const auto interned = utils::InternedString::find(name);
+  if (!interned.has_value()) {
+    return std::nullopt;
+  }
+  const auto &reflection = *shared.astReflection;
+  const auto typeId = type.has_value() ? reflection.typeId(*type) : kNoAstType;
   for (const auto &exports : std::views::values(_exportsByDocument)) {
     for (const auto &description : exports) {
-      if (description.name != name) {
+      if (description.name != *interned) {
         continue;
       }
       if (type.has_value() &&
-          !type_is_assignable(description.type, *type, *shared.astReflection)) {
+          !type_is_assignable(description.typeId, description.type, typeId,
+                              *type, reflection)) {
         continue;
       }
       return description;
@@ -156,16 +330,99 @@ bool DefaultIndexManager::isAffected(
   }
 
   std::scoped_lock lock(_mutex);
-  const auto referencesIt = _referencesByDocument.find(document.id);
-  if (referencesIt == _referencesByDocument.end()) {
+  if (const auto referencesIt = _referencesByDocument.find(document.id);
+      referencesIt != _referencesByDocument.end() &&
+      std::ranges::any_of(referencesIt->second, [&changedDocumentIds](
+                                                    const auto &reference) {
+        return !reference.local && reference.targetDocumentId.has_value() &&
+               changedDocumentIds.contains(*reference.targetDocumentId);
+      })) {
+    return true;
+  }
+
+  if (_unkeyedLookupDocuments.contains(document.id) &&
+      std::ranges::any_of(changedDocumentIds, [this](DocumentId documentId) {
+        const auto changesIt = _exportChangesByDocument.find(documentId);
+        return changesIt != _exportChangesByDocument.end() &&
+               !changesIt->second.empty();
+      })) {
+    return true;
+  }
+
+  const auto keysIt = _lookupKeysByDocument.find(document.id);
+  if (keysIt == _lookupKeysByDocument.end() || keysIt->second.empty()) {
     return false;
   }
+  const auto &lookupKeys = keysIt->second;
+  const auto &reflection = *shared.astReflection;
+  for (const auto documentId : changedDocumentIds) {
+    const auto changesIt = _exportChangesByDocument.find(documentId);
+    if (changesIt == _exportChangesByDocument.end()) {
+      continue;
+    }
+    for (const auto &[name, exportedTypes] : changesIt->second) {
+      const auto lookupIt = lookupKeys.find(name);
+      if (lookupIt == lookupKeys.end()) {
+        continue;
+      }
+      for (const auto exportedType : exportedTypes) {
+        if (std::ranges::any_of(lookupIt->second, [&](std::type_index type) {
+              return type_is_assignable(exportedType, type, reflection);
+            })) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
 
-  return std::ranges::any_of(referencesIt->second, [&changedDocumentIds](
-                                                      const auto &reference) {
-    return !reference.local && reference.targetDocumentId.has_value() &&
-           changedDocumentIds.contains(*reference.targetDocumentId);
-  });
+bool DefaultIndexManager::hasExportChanges(DocumentId documentId) const {
+  std::scoped_lock lock(_mutex);
+  const auto it = _exportChangesByDocument.find(documentId);
+  return it != _exportChangesByDocument.end() && !it->second.empty();
+}
+
+std::uint64_t DefaultIndexManager::exportsFingerprint() const {
+  std::scoped_lock lock(_mutex);
+  return _workspaceExportsFingerprint;
+}
+
+void DefaultIndexManager::clearExportChanges(
+    std::span<const DocumentId> documentIds) {
+  std::scoped_lock lock(_mutex);
+  for (const auto documentId : documentIds) {
+    _exportChangesByDocument.erase(documentId);
+  }
+}
+
+void DefaultIndexManager::recordExportChangesLocked(
+    DocumentId documentId, const std::vector<AstNodeDescription> &previous,
+    const std::vector<AstNodeDescription> &next) {
+  const auto previousByName = group_by_name(previous);
+  const auto nextByName = group_by_name(next);
+
+  auto &changes = _exportChangesByDocument[documentId];
+  const auto addChanged = [&changes](std::string_view name,
+                                     const auto &types) {
+    for (const auto type : types) {
+      add_symbol_key(changes, name, type);
+    }
+  };
+  for (const auto &[name, entries] : previousByName) {
+    const auto nextIt = nextByName.find(name);
+    if (nextIt == nextByName.end()) {
+      addChanged(name, entries);
+    } else if (nextIt->second != entries) {
+      addChanged(name, entries);
+      addChanged(name, nextIt->second);
+    }
+  }
+  for (const auto &[name, entries] : nextByName) {
+    if (!previousByName.contains(name)) {
+      addChanged(name, entries);
+    }
+  }
 }
 
 std::vector<AstNodeDescription> DefaultIndexManager::getFileDescriptionsLocked(
@@ -187,8 +444,10 @@ DefaultIndexManager::filterDescriptionsByTypeLocked(
     const std::vector<AstNodeDescription> &exports, std::type_index type) const {
   std::vector<AstNodeDescription> filtered;
   const auto &reflection = *shared.astReflection;
+  const auto typeId = reflection.typeId(type);
   for (const auto &description : exports) {
-    if (type_is_assignable(description.type, type, reflection)) {
+    if (type_is_assignable(description.typeId, description.type, typeId, type,
+                           reflection)) {
       filtered.push_back(description);
     }
   }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <optional>
@@ -11,6 +12,7 @@
 
 #include <pegium/core/services/DefaultSharedCoreService.hpp>
 #include <pegium/core/utils/Caching.hpp>
+#include <pegium/core/utils/TransparentStringHash.hpp>
 #include <pegium/core/workspace/IndexManager.hpp>
 
 namespace pegium::workspace {
@@ -21,6 +23,18 @@ class DefaultIndexManager : public IndexManager,
 public:
   explicit DefaultIndexManager(pegium::SharedCoreServices &sharedServices);
 
+  /// Fingerprint of the exports of one document: `names` hashes their names
+  /// and types in export order, which is what dependants resolve by, and
+  /// `symbols` the symbol ids they point at, which shift with any node added
+  /// or removed before them, and the document revision they belong to.
+  struct ExportsFingerprint {
+    std::uint64_t names = 0;
+    std::uint64_t symbols = 0;
+
+    friend bool operator==(const ExportsFingerprint &,
+                           const ExportsFingerprint &) = default;
+  };
+
   void updateContent(Document &document,
                      utils::CancellationToken cancelToken) override;
 
@@ -46,7 +60,18 @@ public:
       const Document &document,
       const std::unordered_set<DocumentId> &changedDocumentIds) const override;
 
+  [[nodiscard]] bool hasExportChanges(DocumentId documentId) const override;
+  void clearExportChanges(std::span<const DocumentId> documentIds) override;
+  [[nodiscard]] std::uint64_t exportsFingerprint() const override;
+
 private:
+  /// Symbol types recorded per symbol name, used both for the lookup keys of a
+  /// document's references and for the exported-symbol delta of a document.
+  using SymbolKeys = utils::TransparentStringMap<std::vector<std::type_index>>;
+
+  void recordExportChangesLocked(
+      DocumentId documentId, const std::vector<AstNodeDescription> &previous,
+      const std::vector<AstNodeDescription> &next);
   void rebuildReferenceTargetCacheLocked() const;
   [[nodiscard]] std::vector<AstNodeDescription>
   getFileDescriptionsLocked(DocumentId documentId,
@@ -63,6 +88,27 @@ private:
   std::map<DocumentId, std::vector<AstNodeDescription>> _exportsByDocument;
   std::unordered_map<DocumentId, std::vector<ReferenceDescription>>
       _referencesByDocument;
+  // Exports dropped by removeContent, kept as the baseline the next
+  // updateContent diffs against (the state dependants were last linked with).
+  std::unordered_map<DocumentId, std::vector<AstNodeDescription>>
+      _previousExportsByDocument;
+  // Names whose exported entries changed, per document, until
+  // clearExportChanges is called.
+  std::unordered_map<DocumentId, SymbolKeys> _exportChangesByDocument;
+  // (name, reference type) keys looked up by each linked document, as told by
+  // ScopeProvider::visitLookupNames.
+  std::unordered_map<DocumentId, SymbolKeys> _lookupKeysByDocument;
+  // Linked documents with an unresolved reference whose scope provider did
+  // not tell its lookup names: any export change may resolve it.
+  std::unordered_set<DocumentId> _unkeyedLookupDocuments;
+  // Fingerprint of the exports each document was last indexed with. Kept
+  // across removeContent so the next updateContent can detect unchanged
+  // exports without diffing them.
+  std::unordered_map<DocumentId, ExportsFingerprint>
+      _exportsFingerprintByDocument;
+  // Order-independent combination of the fingerprints of the documents
+  // currently present in _exportsByDocument.
+  std::uint64_t _workspaceExportsFingerprint = 0;
 
   mutable bool _referenceTargetCacheDirty = true;
   mutable utils::ContextCache<DocumentId, std::type_index,
@@ -4,6 +4,7 @@
 #include <exception>
 #include <filesystem>
 #include <future>
+#include <ranges>
 #include <stdexcept>
 #include <string>
 #include <unordered_set>
@@ -146,12 +147,42 @@ void DefaultWorkspaceManager::loadWorkspaceDocuments(
     utils::CancellationToken cancelToken) {
   assert(shared.workspace.documents != nullptr);
   auto &documentStore = *shared.workspace.documents;
+  std::vector<std::string_view> missingUris;
+  missingUris.reserve(workspaceFileUris.size());
   for (const auto &fileUri : workspaceFileUris) {
     utils::throw_if_cancelled(cancelToken);
-    if (documentStore.getDocument(fileUri) != nullptr) {
-      continue;
+    if (documentStore.getDocument(fileUri) == nullptr) {
+      missingUris.push_back(fileUri);
+    }
+  }
+
+  // Files are read concurrently, at most one per scheduler worker, and left
+  // unparsed: the initial build parses them in its parallel Parsed phase.
+  // Documents are then handed to the collector serially and in URI order.
+  std::vector<std::shared_ptr<Document>> documents(missingUris.size());
+  const auto load = [&](std::size_t index) {
+    documents[index] = shared.workspace.documentFactory->fromUriUnparsed(
+        missingUris[index], cancelToken);
+  };
+  if (auto *taskScheduler = shared.execution.taskScheduler.get();
+      taskScheduler != nullptr) {
+    taskScheduler->parallelFor(
+        cancelToken, std::views::iota(std::size_t{0}, missingUris.size()),
+        load);
+  } else {
+    for (std::size_t index = 0; index < missingUris.size(); ++index) {
+      utils::throw_if_cancelled(cancelToken);
+      load(index);
+    }
+  }
+
+  for (auto &document : documents) {
+    utils::throw_if_cancelled(cancelToken);
+    // getOrCreateDocument semantics: a document added meanwhile wins.
+    if (auto existing = documentStore.getDocument(document->uri);
+        existing != nullptr) {
+      document = std::move(existing);
     }
-    auto document = documentStore.getOrCreateDocument(fileUri, cancelToken);
     collector(std::move(document));
   }
 }
@@ -217,23 +248,16 @@ std::vector<std::shared_ptr<Document>> DefaultWorkspaceManager::performStartup(
   }
 }
 
-void DefaultWorkspaceManager::traverseFolder(
+std::vector<FileSystemNode> DefaultWorkspaceManager::readFolder(
     const FileSystemProvider &fileSystem, std::string_view folderUri,
-    std::vector<std::string> &workspaceFileUris,
     utils::CancellationToken cancelToken) const {
   utils::throw_if_cancelled(cancelToken);
+  std::vector<FileSystemNode> entries;
   try {
-    for (const auto &entry : fileSystem.readDirectory(folderUri)) {
+    for (auto &entry : fileSystem.readDirectory(folderUri)) {
       utils::throw_if_cancelled(cancelToken);
-      if (!shouldIncludeEntry(entry)) {
-        continue;
-      }
-      if (entry.isDirectory) {
-        traverseFolder(fileSystem, entry.uri, workspaceFileUris, cancelToken);
-        continue;
-      }
-      if (entry.isFile) {
-        workspaceFileUris.push_back(entry.uri);
+      if (shouldIncludeEntry(entry) && (entry.isDirectory || entry.isFile)) {
+        entries.push_back(std::move(entry));
       }
     }
   } catch (const utils::OperationCancelled &) {
@@ -245,7 +269,65 @@ void DefaultWorkspaceManager::traverseFolder(
         .message = "Failure to read directory content of " +
                    std::string(folderUri) + ": " + error.what(),
         .uri = std::string(folderUri)});
+    return {};
+  }
+  return entries;
+}
+
+void DefaultWorkspaceManager::traverseFolder(
+    const FileSystemProvider &fileSystem, std::string_view folderUri,
+    std::vector<std::string> &workspaceFileUris,
+    utils::CancellationToken cancelToken) const {
+  utils::throw_if_cancelled(cancelToken);
+
+  // Every folder of one depth level is listed concurrently before descending
+  // to the next level. Files are then collected depth-first in listing order,
+  // the order a serial recursive walk would produce.
+  struct Folder {
+    std::string uri;
+    std::vector<FileSystemNode> entries;
+    // Index in `folders` of the listing of each directory entry, in order.
+    std::vector<std::size_t> subfolders;
+  };
+  std::vector<Folder> folders;
+  folders.push_back({.uri = std::string(folderUri)});
+  auto *taskScheduler = shared.execution.taskScheduler.get();
+  for (std::size_t levelBegin = 0; levelBegin < folders.size();) {
+    const auto levelEnd = folders.size();
+    const auto list = [&](std::size_t index) {
+      folders[index].entries =
+          readFolder(fileSystem, folders[index].uri, cancelToken);
+    };
+    if (taskScheduler != nullptr) {
+      taskScheduler->parallelFor(cancelToken,
+                                 std::views::iota(levelBegin, levelEnd), list);
+    } else {
+      for (auto index = levelBegin; index < levelEnd; ++index) {
+        list(index);
+      }
+    }
+    for (auto index = levelBegin; index < levelEnd; ++index) {
+      for (const auto &entry : folders[index].entries) {
+        if (entry.isDirectory) {
+          folders[index].subfolders.push_back(folders.size());
+          folders.push_back({.uri = entry.uri});
+        }
+      }
+    }
+    levelBegin = levelEnd;
   }
+
+  const auto collect = [&](const auto &self, std::size_t index) -> void {
+    std::size_t subfolder = 0;
+    for (const auto &entry : folders[index].entries) {
+      if (entry.isDirectory) {
+        self(self, folders[index].subfolders[subfolder++]);
+      } else {
+        workspaceFileUris.push_back(entry.uri);
+      }
+    }
+  };
+  collect(collect, 0);
 }
 
 std::vector<std::string>
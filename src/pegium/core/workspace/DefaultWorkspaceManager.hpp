@@ -50,7 +50,8 @@ protected:
       utils::CancellationToken cancelToken);
 
   /// `collector` must only receive non-null managed documents with a
-  /// normalized non-empty URI.
+  /// normalized non-empty URI. The default implementation reads the files
+  /// concurrently and collects them unparsed (`DocumentState::Changed`).
   virtual void loadWorkspaceDocuments(
       std::span<const std::string> workspaceFileUris,
       utils::function_ref<void(std::shared_ptr<Document>)> collector,
@@ -66,6 +67,11 @@ private:
                       std::string_view folderUri,
                       std::vector<std::string> &workspaceFileUris,
                       utils::CancellationToken cancelToken) const;
+  // Lists the included files and directories of one folder. A folder that
+  // cannot be read is reported and treated as empty.
+  [[nodiscard]] std::vector<FileSystemNode>
+  readFolder(const FileSystemProvider &fileSystem, std::string_view folderUri,
+             utils::CancellationToken cancelToken) const;
   void resolveReady();
   void rejectReady(std::exception_ptr error);
 
@@ -6,6 +6,8 @@
 
 #include <pegium/core/syntax-tree/AstArena.hpp>
 #include <pegium/core/utils/Errors.hpp>
+#include <pegium/core/validation/ValidationMemo.hpp>
+#include <pegium/core/workspace/DocumentResidency.hpp>
 
 namespace pegium::workspace {
 namespace {
@@ -21,12 +23,14 @@ std::string resolve_document_uri(
 Document::Document(std::shared_ptr<TextDocument> textDocument,
                    const std::string &uri)
     : uri(resolve_document_uri(textDocument, uri)),
+      validationMemo(std::make_shared<validation::ValidationMemo>()),
       _textDocument(std::move(textDocument)) {
   assert(_textDocument != nullptr);
 }
 Document::~Document() = default;
 
 void Document::resetAnalysisState() noexcept {
+  _residency.store(nullptr, std::memory_order_release);
   state = DocumentState::Changed;
   parseResult = {};
   localSymbols.clear();
@@ -41,22 +45,41 @@ void Document::attachTextDocument(std::shared_ptr<TextDocument> textDocument) {
   assert(textDocument != nullptr);
   assert(textDocument->uri().empty() || textDocument->uri() == uri);
 
+  if (_textDocument != nullptr &&
+      _textDocument->languageId() != textDocument->languageId()) {
+    cacheServicesBinding(0);
+  }
   _textDocument = std::move(textDocument);
+  _hasSourceFile = false;
 }
 
 SymbolId Document::makeSymbolId(const AstNode &node) const noexcept {
   return static_cast<SymbolId>(node.symbolId());
 }
 
+void Document::restoreIfEvicted() const noexcept {
+  if (const auto *residency = _residency.load(std::memory_order_acquire);
+      residency != nullptr) [[unlikely]] {
+    try {
+      residency->restore(*this);
+    } catch (...) {
+      // Left evicted: lookups report the node as absent, like for a document
+      // without AST, and the next lookup tries again.
+    }
+  }
+}
+
 const AstNode &Document::getAstNode(SymbolId symbolId) const {
   assert(symbolId != InvalidSymbolId);
-  const auto *node = parseResult.astArena != nullptr
+  restoreIfEvicted();
+  const auto *node = !isEvicted() && parseResult.astArena != nullptr
                          ? parseResult.astArena->getNode(symbolId)
                          : nullptr;
   if (node == nullptr) {
-    // The build relinks every dependent of a changed/deleted document
-    // (DefaultDocumentBuilder::shouldRelink -> IndexManager::isAffected), so a
-    // resolved description always points at a live node. If that invariant is
+    // The build relinks or rebinds every dependent of a changed/deleted
+    // document (DefaultDocumentBuilder::relinkAffectedDocuments ->
+    // IndexManager::isAffected), so a resolved description always points at a
+    // live node. If that invariant is
     // ever violated, throw a catchable error rather than dereferencing null (a
     // release-mode UAF); the linker turns it into a LinkingError.
     throw utils::MissingAstDocumentError(
@@ -67,7 +90,13 @@ const AstNode &Document::getAstNode(SymbolId symbolId) const {
 }
 
 const AstNode *Document::findAstNode(SymbolId symbolId) const noexcept {
-  if (symbolId == InvalidSymbolId || parseResult.astArena == nullptr) {
+  if (symbolId == InvalidSymbolId) {
+    return nullptr;
+  }
+  restoreIfEvicted();
+  // Still evicted when the restore failed: another reader may be publishing
+  // the parse result meanwhile.
+  if (isEvicted() || parseResult.astArena == nullptr) {
     return nullptr;
   }
   return parseResult.astArena->getNode(symbolId);
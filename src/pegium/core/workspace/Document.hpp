@@ -2,11 +2,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <pegium/core/parser/Parser.hpp>
+#include <pegium/core/services/CompactDiagnostic.hpp>
 #include <pegium/core/services/Diagnostic.hpp>
 #include <pegium/core/syntax-tree/AstNode.hpp>
 #include <pegium/core/syntax-tree/RootCstNode.hpp>
@@ -16,9 +18,14 @@
 #include <pegium/core/workspace/Symbol.hpp>
 #include <pegium/core/workspace/TextDocument.hpp>
 
+namespace pegium::validation {
+class ValidationMemo;
+} // namespace pegium::validation
+
 namespace pegium::workspace {
 
 class DocumentFactory;
+class DocumentResidency;
 
 /// Progressive analysis phase reached by a managed document.
 enum class DocumentState : std::uint8_t {
@@ -34,6 +41,7 @@ enum class DocumentState : std::uint8_t {
 /// In-memory document state shared by parsing, indexing, linking, and validation.
 struct Document {
   friend class DocumentFactory;
+  friend class DocumentResidency;
 
   DocumentId id = InvalidDocumentId;
   /// Canonical document URI. Managed workspace documents keep it stable for
@@ -49,20 +57,51 @@ struct Document {
   parser::ParseResult parseResult;
   LocalSymbols localSymbols;
 
-  std::vector<pegium::Diagnostic> diagnostics;
+  /// Diagnostics of the last validation, rendered on demand (see
+  /// `CompactDiagnostic::materialize()`).
+  std::vector<pegium::CompactDiagnostic> diagnostics;
+
+  /// Diagnostics of subtree-local validation checks kept from the last
+  /// validation, for the next one to reuse. Never null; survives reparses and
+  /// is shared with successors.
+  std::shared_ptr<validation::ValidationMemo> validationMemo;
 
   /// Returns whether parsing reached a full grammar match.
   [[nodiscard]] bool parseSucceeded() const noexcept {
-    return parseResult.fullMatch;
+    return !isEvicted() && parseResult.fullMatch;
   }
 
   /// Returns whether parsing produced an AST root.
   [[nodiscard]] bool hasAst() const noexcept {
-    return parseResult.value != nullptr;
+    return !isEvicted() && parseResult.value != nullptr;
+  }
+
+  /// Returns whether a `DocumentResidency` evicted the parse result and local
+  /// symbols of this document. `getAstNode(...)` and `findAstNode(...)` restore
+  /// them transparently; other accessors see an empty parse result until then.
+  ///
+  /// Readers may restore the document concurrently, so code reading
+  /// `parseResult` or `localSymbols` directly without exclusive access to the
+  /// workspace must first see it resident, e.g. through `ensureResident()`.
+  [[nodiscard]] bool isEvicted() const noexcept {
+    return _residency.load(std::memory_order_acquire) != nullptr;
+  }
+
+  /// Restores the parse result and local symbols if they were evicted, and
+  /// returns whether they are resident. Call it before reading `parseResult`
+  /// or `localSymbols` of a document not reached through one of its nodes,
+  /// e.g. the source document of an indexed reference. `false` when the
+  /// restore failed: the document then reads as if it had no parse result.
+  bool ensureResident() const noexcept {
+    restoreIfEvicted();
+    return !isEvicted();
   }
 
   /// Returns whether parsing used recovery or reported syntax diagnostics.
   [[nodiscard]] bool parseRecovered() const noexcept {
+    if (isEvicted()) {
+      return false;
+    }
     if (parseResult.recoveryReport.hasRecovered) {
       return true;
     }
@@ -74,12 +113,18 @@ struct Document {
 
   /// Returns the number of source bytes consumed by the parse result.
   [[nodiscard]] TextOffset parsedLength() const noexcept {
-    return parseResult.parsedLength;
+    return isEvicted() ? 0 : parseResult.parsedLength;
   }
 
   /// Returns the backing text document. Never null by design.
   [[nodiscard]] const TextDocument &textDocument() const noexcept;
 
+  /// Identifies the parse result the document holds: a reparse gives it a new
+  /// revision (successors included), restoring an evicted one does not. `0`
+  /// when the document factory does not assign revisions. Symbol ids are only
+  /// meaningful within one revision.
+  [[nodiscard]] std::uint32_t revision() const noexcept { return _revision; }
+
   /// Returns the symbol identifier of `node` inside this document.
   [[nodiscard]] SymbolId makeSymbolId(const AstNode &node) const noexcept;
   /// Resolves a symbol identifier previously created by `makeSymbolId(...)` to
@@ -95,6 +140,16 @@ struct Document {
   /// instead of returning null.
   [[nodiscard]] const AstNode *findAstNode(SymbolId symbolId) const noexcept;
 
+  /// Returns the language-service binding cached by the service registry, or
+  /// `0` when none is cached. The encoding belongs to the registry.
+  [[nodiscard]] std::uint64_t servicesBinding() const noexcept {
+    return _servicesBinding.load(std::memory_order_acquire);
+  }
+  /// Caches the language-service binding resolved by the service registry.
+  void cacheServicesBinding(std::uint64_t binding) const noexcept {
+    _servicesBinding.store(binding, std::memory_order_release);
+  }
+
   /// Creates a document backed by `textDocument`.
   ///
   /// When `uri` is empty, the attached text-document URI becomes the document
@@ -110,7 +165,25 @@ struct Document {
 private:
   void attachTextDocument(std::shared_ptr<TextDocument> textDocument);
   void resetAnalysisState() noexcept;
+  void restoreIfEvicted() const noexcept;
   std::shared_ptr<TextDocument> _textDocument;
+  // Residency that evicted the parse result, published last on eviction and
+  // cleared once it is restored (or replaced by a new parse).
+  mutable std::atomic<const DocumentResidency *> _residency = nullptr;
+  // Assigned by the document factory on every parse.
+  std::uint32_t _revision = 0;
+  // Set while the attached text was loaded for this document but not parsed
+  // yet, so the next factory update can parse it without loading it again.
+  bool _loadedTextPending = false;
+  // Registry-owned cache of the resolved CoreServices. One word so concurrent
+  // readers always see a consistent value; cleared when a text document of
+  // another language is attached.
+  mutable std::atomic<std::uint64_t> _servicesBinding = 0;
+  // Size and modification time of the file the attached text was read from,
+  // so an unchanged file can be recognized without reading it again.
+  bool _hasSourceFile = false;
+  std::uint64_t _sourceFileSize = 0;
+  std::int64_t _sourceFileModifiedTime = 0;
 };
 
 } // namespace pegium::workspace
@@ -10,11 +10,13 @@
 #include <variant>
 #include <vector>
 
+#include <pegium/core/services/CompactDiagnostic.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/utils/Event.hpp>
 #include <pegium/core/validation/ValidationOptions.hpp>
 #include <pegium/core/workspace/Documents.hpp>
 #include <pegium/core/workspace/IndexManager.hpp>
+#include <pegium/core/workspace/WorkspaceSnapshot.hpp>
 
 namespace pegium {
 class ServiceRegistry;
@@ -26,6 +28,21 @@ namespace pegium::workspace {
 struct BuildOptions {
   std::optional<bool> eagerLinking;
   validation::BuildValidationOption validation;
+  /// Lets each document go on to validation as soon as it is linked instead of
+  /// waiting for the whole batch. Per-document phase listeners then fire as
+  /// documents reach each state (still serially, and in phase order for any one
+  /// document) rather than in document order after each phase. Linking still
+  /// waits until every document indexed its content, as the global scope needs
+  /// all of it, and `downgradeLock` is invoked from a worker thread once the
+  /// last document is linked.
+  bool pipelined = false;
+  /// Builder-wide, read from `DocumentBuilder::updateBuildOptions()`: rebuilds
+  /// parsed documents as new versions (`DocumentFactory::createSuccessor`)
+  /// instead of resetting them in place, and publishes a `WorkspaceSnapshot`
+  /// after every completed build, so that readers of the last snapshot neither
+  /// wait for nor observe the next build. Dependants of changed exports are
+  /// then reparsed rather than only relinked.
+  bool isolateSnapshots = false;
 };
 
 /// Summary of one document update cycle.
@@ -75,8 +92,9 @@ public:
   /// `documents` must only contain non-null managed documents with a
   /// normalized non-empty URI.
   /// `downgradeLock`, when set, is invoked once the document model is fully
-  /// linked and before validation runs, so callers holding an exclusive lock
-  /// can release it for the validation phase.
+  /// linked and before validation runs (or, for `BuildOptions::pipelined`
+  /// builds, while it runs), so callers holding an exclusive lock can release
+  /// it for the validation phase.
   virtual void build(std::span<const std::shared_ptr<Document>> documents,
                      const BuildOptions &options = {},
                      utils::CancellationToken cancelToken = {},
@@ -109,6 +127,24 @@ public:
                                      utils::CancellationToken cancelToken)>
                       listener) const = 0;
 
+  /// Subscribes to the diagnostics of validations still running.
+  ///
+  /// Listeners receive the document being validated and a prefix of the
+  /// diagnostics its validation will append to `Document::diagnostics`, which
+  /// still holds those of categories validated by earlier builds. They are
+  /// invoked each time the document validator reports progress (see
+  /// `validation::DocumentValidator::validateDocumentCompact`), from the
+  /// validating thread and possibly concurrently for different documents, and
+  /// always before the document reaches `DocumentState::Validated`. Builders
+  /// that do not report progress ignore `listener`, the default.
+  virtual utils::ScopedDisposable onValidationProgress(
+      std::function<void(const std::shared_ptr<Document> &,
+                         std::span<const pegium::CompactDiagnostic> pending,
+                         utils::CancellationToken cancelToken)>
+      /*listener*/) const {
+    return {};
+  }
+
   /// Waits until the workspace has reached `state`.
   ///
   /// This is the synchronization primitive for callers that require a stable
@@ -126,6 +162,17 @@ public:
   waitUntil(DocumentState state, DocumentId documentId,
             utils::CancellationToken cancelToken = {}) const = 0;
 
+  /// Returns the workspace as left by the last completed build, or `nullptr`
+  /// when none was published (see `BuildOptions::isolateSnapshots`), as always
+  /// by default.
+  ///
+  /// Requests that must see the latest version of the workspace instead wait
+  /// for it with `waitUntil(...)` and read under the workspace read lock.
+  [[nodiscard]] virtual std::shared_ptr<const WorkspaceSnapshot>
+  snapshot() const {
+    return nullptr;
+  }
+
   /// Invalidates `document` back to `state` so later phases can be recomputed.
   virtual void resetToState(Document &document, DocumentState state) const = 0;
 };
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <utility>
 
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/workspace/Document.hpp>
+#include <pegium/core/workspace/FileSystemProvider.hpp>
 #include <pegium/core/workspace/TextDocument.hpp>
 
 namespace pegium::workspace {
@@ -44,10 +48,69 @@ public:
   fromUri(std::string_view uri,
           const utils::CancellationToken &cancelToken = {}) const = 0;
 
+  /// Same as `fromUri(...)`, but leaves the returned document in
+  /// `DocumentState::Changed` without parsing it, so that parsing can happen in
+  /// the document builder's parallel Parsed phase. The next `update(...)` parses
+  /// the text loaded here instead of loading it again.
+  ///
+  /// Defaults to `fromUri(...)`, which parses the document right away.
+  [[nodiscard]] virtual std::shared_ptr<Document>
+  fromUriUnparsed(std::string_view uri,
+                  const utils::CancellationToken &cancelToken = {}) const {
+    return fromUri(uri, cancelToken);
+  }
+
   virtual Document &update(
       Document &document,
       const utils::CancellationToken &cancelToken = {}) const = 0;
 
+  /// Creates the next version of `document`: a document with the same URI and
+  /// identifier, attached to the same text and left in
+  /// `DocumentState::Changed`, so that it can be rebuilt while `document`
+  /// itself stays untouched.
+  ///
+  /// The next `update(...)` prefers the text of the text document provider as
+  /// usual; otherwise it parses the attached text (or the newer text kept by
+  /// `isUnchangedOnDisk(...)`) without loading the file again.
+  ///
+  /// Only called when the document builder isolates snapshots (see
+  /// `BuildOptions::isolateSnapshots`); the default throws
+  /// `std::logic_error`.
+  [[nodiscard]] virtual std::shared_ptr<Document>
+  createSuccessor(const Document & /*document*/) const {
+    throw std::logic_error(
+        "DocumentFactory::createSuccessor is required to isolate snapshots.");
+  }
+
+  /// Returns whether the file backing `document` still holds the text the
+  /// document was analyzed from, so that a file change notification can leave
+  /// its analysis untouched.
+  ///
+  /// Only documents whose attached text was read from the file system qualify;
+  /// documents opened in a text document provider, and parsed documents whose
+  /// newer text is still waiting to be parsed, always return `false`. When the
+  /// content did change, the text read here may be kept for the next
+  /// `update(...)`, which the caller is expected to trigger. The default
+  /// returns `false`, so that every file change rebuilds the document.
+  [[nodiscard]] virtual bool
+  isUnchangedOnDisk(Document & /*document*/,
+                    const utils::CancellationToken & /*cancelToken*/ = {}) const {
+    return false;
+  }
+
+  /// Returns whether `document` is parsed from the text the text document
+  /// provider currently holds for its URI, so that a change notification can
+  /// keep what a cancelled build already computed for it.
+  ///
+  /// Documents not opened in a text document provider, not parsed yet or whose
+  /// newer text is still waiting to be parsed return `false`; see
+  /// `isUnchangedOnDisk(...)` for documents backed by files. The default
+  /// returns `false`, so that every change notification rebuilds the document.
+  [[nodiscard]] virtual bool
+  isParsedFromCurrentText(const Document & /*document*/) const {
+    return false;
+  }
+
 protected:
   /// Replaces the attached text snapshot while preserving document identity.
   ///
@@ -58,6 +121,75 @@ protected:
     document.attachTextDocument(std::move(textDocument));
   }
 
+  /// Gives `document` a new `Document::revision()`, for a parse result that
+  /// was just installed. Restoring an evicted parse result of the same text
+  /// keeps the revision.
+  void startRevision(Document &document) const noexcept {
+    // Skips 0, which stands for an unknown revision.
+    static std::atomic<std::uint32_t> nextRevision = 1;
+    auto revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+    if (revision == 0) [[unlikely]] {
+      revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+    }
+    document._revision = revision;
+  }
+
+  /// Marks the attached text of `document` as loaded but not parsed yet.
+  void markLoadedTextPending(Document &document) const noexcept {
+    document._loadedTextPending = true;
+  }
+
+  /// Clears the mark set by `markLoadedTextPending(...)` and returns whether it
+  /// was set.
+  [[nodiscard]] bool takeLoadedTextPending(Document &document) const noexcept {
+    return std::exchange(document._loadedTextPending, false);
+  }
+
+  /// Returns whether the attached text of `document` is marked as loaded but
+  /// not parsed yet.
+  [[nodiscard]] bool hasLoadedTextPending(const Document &document) const noexcept {
+    return document._loadedTextPending;
+  }
+
+  /// Returns a new document with the identity, attached text and source-file
+  /// record of `document`, the text marked as loaded but not parsed yet.
+  [[nodiscard]] std::shared_ptr<Document>
+  makeSuccessor(const Document &document) const {
+    auto successor =
+        std::make_shared<Document>(document._textDocument, document.uri);
+    successor->id = document.id;
+    successor->cacheServicesBinding(document.servicesBinding());
+    successor->validationMemo = document.validationMemo;
+    successor->_loadedTextPending = true;
+    successor->_hasSourceFile = document._hasSourceFile;
+    successor->_sourceFileSize = document._sourceFileSize;
+    successor->_sourceFileModifiedTime = document._sourceFileModifiedTime;
+    return successor;
+  }
+
+  /// Records the file metadata the attached text of `document` was read with.
+  /// Cleared whenever another text document is attached.
+  void recordSourceFile(Document &document,
+                        const FileSystemNode &file) const noexcept {
+    document._hasSourceFile = true;
+    document._sourceFileSize = file.size;
+    document._sourceFileModifiedTime = file.modifiedTime;
+  }
+
+  /// Returns whether the attached text of `document` was read from a file.
+  [[nodiscard]] bool hasSourceFile(const Document &document) const noexcept {
+    return document._hasSourceFile;
+  }
+
+  /// Returns whether `file` reports the known size and modification time
+  /// recorded by `recordSourceFile(...)`.
+  [[nodiscard]] bool matchesSourceFile(const Document &document,
+                                       const FileSystemNode &file) const noexcept {
+    return document._hasSourceFile && file.modifiedTime != 0 &&
+           document._sourceFileModifiedTime == file.modifiedTime &&
+           document._sourceFileSize == file.size;
+  }
+
   /// Resets the derived analysis state of `document`.
   void resetAnalysisState(Document &document) const noexcept {
     document.resetAnalysisState();
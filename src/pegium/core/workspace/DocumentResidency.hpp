@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/workspace/Document.hpp>
+
+namespace pegium::workspace {
+
+/// Keeps the memory held by analyzed documents within a budget.
+///
+/// Documents that are not opened in a text document provider can have their
+/// parse result (CST and AST) and local symbols evicted once built, while their
+/// index entries, references index and diagnostics stay in place. An evicted
+/// document is parsed again from its attached text, which yields the same
+/// symbol identifiers, the next time one of its nodes is looked up
+/// (`Document::getAstNode(...)` / `Document::findAstNode(...)`).
+class DocumentResidency {
+public:
+  virtual ~DocumentResidency() noexcept = default;
+
+  /// Sets the budget, in bytes, for the memory held by resident documents.
+  /// `0` disables eviction.
+  virtual void setMemoryBudget(std::size_t bytes) = 0;
+  /// Returns the budget set by `setMemoryBudget(...)`.
+  [[nodiscard]] virtual std::size_t memoryBudget() const noexcept = 0;
+
+  /// Returns the bytes held by the parse result and local symbols of
+  /// `document`, or `0` when they are evicted.
+  [[nodiscard]] virtual std::size_t
+  residentBytes(const Document &document) const = 0;
+  /// Returns the bytes held by all documents of the workspace.
+  [[nodiscard]] virtual std::size_t residentBytes() const = 0;
+
+  /// Records a use of `document`: documents are evicted least recently used
+  /// first.
+  virtual void touch(const Document &document) = 0;
+
+  /// Evicts least recently used documents until the resident documents fit the
+  /// budget. References of resident documents into evicted ones are reset, to
+  /// be resolved again on their next access.
+  ///
+  /// The caller must hold exclusive access to the workspace documents.
+  virtual void enforceBudget() = 0;
+
+  /// Parses `document` again if it is evicted. Safe to call from readers: the
+  /// parse result and local symbols are built apart from `document`, and only
+  /// published into it once complete, right before it is marked resident.
+  /// Concurrent calls for `document` return once it is resident again.
+  virtual void restore(const Document &document) const = 0;
+
+protected:
+  /// Drops the parse result and local symbols of `document` and marks it as
+  /// evicted by this residency.
+  void evict(Document &document) const noexcept {
+    document.parseResult = {};
+    document.localSymbols.clear();
+    document._residency.store(this, std::memory_order_release);
+  }
+  /// Returns a document detached from the workspace, backed by the text of
+  /// `document`, to restore its parse result and local symbols into.
+  [[nodiscard]] static std::unique_ptr<Document>
+  stage(const Document &document) {
+    auto staged = std::make_unique<Document>(document._textDocument,
+                                             document.uri);
+    staged->id = document.id;
+    staged->cacheServicesBinding(document.servicesBinding());
+    return staged;
+  }
+  /// Moves the parse result and local symbols of `staged` into `document`,
+  /// then marks `document` as resident again. Readers only access them once
+  /// it is.
+  static void publishRestored(const Document &document,
+                              Document &staged) noexcept {
+    // Workspace documents are never created const: the residency only
+    // restores what it evicted from a mutable document.
+    auto &restored = const_cast<Document &>(document);
+    restored.parseResult = std::move(staged.parseResult);
+    restored.localSymbols = std::move(staged.localSymbols);
+    if (restored.parseResult.cst != nullptr) {
+      restored.parseResult.cst->attachDocument(restored);
+    }
+    if (auto *arena = restored.parseResult.astArena.get(); arena != nullptr) {
+      arena->attachDocument(restored, arena->reflection());
+    }
+    document._residency.store(nullptr, std::memory_order_release);
+  }
+  /// Returns the immutable snapshot backing `textDocument`.
+  [[nodiscard]] static text::TextSnapshot
+  snapshot(const TextDocument &textDocument) noexcept {
+    return textDocument.snapshot();
+  }
+};
+
+} // namespace pegium::workspace
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
@@ -10,6 +11,9 @@
 namespace pegium::workspace {
 
 /// Registry of managed workspace documents indexed by URI and identifier.
+///
+/// Document lookups (`hasDocument`, `getDocument`, `all`) made while the
+/// calling thread reads a `WorkspaceSnapshot` answer from that snapshot.
 class Documents {
 public:
   virtual ~Documents() noexcept = default;
@@ -17,6 +21,19 @@ public:
   /// Stores a managed document. `document` must be non-null.
   virtual void addDocument(std::shared_ptr<Document> document) = 0;
 
+  /// Stores `document` in place of the document with the same URI, which keeps
+  /// its identifier, and returns the replaced document (`nullptr` when none was
+  /// stored). `document` must be non-null.
+  ///
+  /// Used to install a new version of a document while readers of the previous
+  /// one keep it, only when the document builder isolates snapshots (see
+  /// `BuildOptions::isolateSnapshots`); the default throws `std::logic_error`.
+  virtual std::shared_ptr<Document>
+  replaceDocument(std::shared_ptr<Document> /*document*/) {
+    throw std::logic_error(
+        "Documents::replaceDocument is required to isolate snapshots.");
+  }
+
   [[nodiscard]] virtual DocumentId
   getDocumentId(std::string_view uri) const = 0;
 
@@ -81,7 +81,19 @@ FileSystemNode LocalFileSystemProvider::stat(std::string_view uri) const {
              !std::filesystem::is_directory(status))) {
     throw missing_file_system_node("stat", uri);
   }
-  return make_file_system_node(path);
+  auto node = make_file_system_node(path);
+  if (node.isFile) {
+    std::error_code sizeError;
+    std::error_code timeError;
+    const auto size = std::filesystem::file_size(path, sizeError);
+    const auto modifiedTime = std::filesystem::last_write_time(path, timeError);
+    if (!sizeError && !timeError) {
+      node.size = static_cast<std::uint64_t>(size);
+      node.modifiedTime =
+          static_cast<std::int64_t>(modifiedTime.time_since_epoch().count());
+    }
+  }
+  return node;
 }
 
 bool LocalFileSystemProvider::exists(std::string_view uri) const {
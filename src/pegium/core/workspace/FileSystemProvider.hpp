@@ -12,6 +12,11 @@ struct FileSystemNode {
   bool isFile = false;
   bool isDirectory = false;
   std::string uri;
+  /// File size in bytes, reported by `stat(...)` for files.
+  std::uint64_t size = 0;
+  /// Opaque last-write time, only meaningful when compared with another value
+  /// for the same file. `0` when unknown; `size` is then unknown as well.
+  std::int64_t modifiedTime = 0;
 };
 
 /// Abstract file-system access used during workspace discovery and loading.
@@ -19,6 +24,8 @@ class FileSystemProvider {
 public:
   virtual ~FileSystemProvider() noexcept = default;
 
+  /// Returns the metadata of `uri`, including size and modification time
+  /// when the provider knows them. `readDirectory(...)` entries may omit them.
   [[nodiscard]] virtual FileSystemNode stat(std::string_view uri) const = 0;
   [[nodiscard]] virtual bool exists(std::string_view uri) const = 0;
   [[nodiscard]] virtual std::vector<std::uint8_t>
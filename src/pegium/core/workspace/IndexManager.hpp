@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <optional>
 #include <span>
@@ -47,9 +48,41 @@ public:
   findAllReferences(const NodeKey &targetKey) const = 0;
 
   /// Returns whether `document` may need relinking after the given changes.
+  ///
+  /// A document is affected when one of its resolved references targets a
+  /// changed document (the resolved node is replaced by the reparse), or when
+  /// one of the `(name, type)` lookup keys recorded for it by
+  /// `updateReferences` matches an exported symbol that was added, removed or
+  /// changed in a changed document since `clearExportChanges` last forgot it.
+  /// Lookup names come from `references::ScopeProvider::visitLookupNames`; a
+  /// document with an unresolved reference whose provider does not tell them
+  /// is affected by any such export change.
   [[nodiscard]] virtual bool isAffected(
       const Document &document,
       const std::unordered_set<DocumentId> &changedDocumentIds) const = 0;
+  /// Returns whether exported symbols of `documentId` were added, removed or
+  /// changed since `clearExportChanges` last forgot them. A reindexed document
+  /// whose exports kept the same names, types and order reports `false`, even
+  /// when their symbol ids moved: dependants then only need rebinding by name
+  /// and type. Always `true` by default, which skips no downstream work.
+  [[nodiscard]] virtual bool
+  hasExportChanges(DocumentId /*documentId*/) const {
+    return true;
+  }
+  /// Forgets the exported-symbol changes recorded for `documentIds`, once
+  /// every dependant affected by them has been reset. Does nothing by default,
+  /// for index managers that record no such changes.
+  virtual void
+  clearExportChanges(std::span<const DocumentId> /*documentIds*/) {}
+  /// Returns an order-independent fingerprint of every indexed export. It only
+  /// changes when some document's exported descriptions change, symbol ids
+  /// and document revisions included, so caches of descriptions from the
+  /// global scope can stay warm until the next reindex.
+  /// By default it changes on every call, which keeps no cache warm.
+  [[nodiscard]] virtual std::uint64_t exportsFingerprint() const {
+    static std::atomic<std::uint64_t> calls = 0;
+    return calls.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
 };
 
 } // namespace pegium::workspace
@@ -1,36 +1,442 @@
 #include <pegium/core/workspace/LocalSymbols.hpp>
 
+#include <algorithm>
+#include <iterator>
 #include <utility>
 
+#include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/syntax-tree/AstNode.hpp>
+#include <pegium/core/syntax-tree/AstReflection.hpp>
+
 namespace pegium::workspace {
 
-const AstNodeDescription &
-LocalSymbols::emplace(const AstNode *container,
-                      AstNodeDescription description) {
-  auto &buckets = _byContainer[container];
-  const auto type = description.type;
-
-  // Linear scan: containers typically hold ≤2-3 distinct symbol types, so an
-  // unrolled equality check is faster than a side hash map.
-  ScopeEntryBucket *bucket = nullptr;
-  for (auto &candidate : buckets) {
-    if (candidate.type == type) {
-      bucket = std::addressof(candidate);
+std::span<const std::uint32_t>
+LocalScopeBucket::named(utils::InternedString name) const noexcept {
+  const std::span<const std::uint32_t> byName{_byName, _size};
+  const auto nameOf = [this](std::uint32_t position) {
+    return _entries[position].name.id();
+  };
+  const auto [first, last] =
+      std::ranges::equal_range(byName, name.id(), {}, nameOf);
+  return {first, last};
+}
+
+void LocalScopeChain::iterator::advance() {
+  while (_scope == LocalSymbols::kNoScope && _walk != nullptr) {
+    if (const auto nearest = _symbols->nearestScope(_walk)) {
+      // From here on, the scope tree links the declaring levels.
+      _scope = *nearest;
+      _walk = nullptr;
+      break;
+    }
+    const auto level = _symbols->forContainer(_walk);
+    _walk = _walk->getContainer();
+    if (!level.empty()) {
+      _level = level;
+      return;
+    }
+  }
+  if (_scope == LocalSymbols::kNoScope) {
+    _level = {};
+    return;
+  }
+  _level = _symbols->bucketsOf(_scope);
+  _scope = _symbols->_scopes[_scope].parent;
+}
+
+LocalScopeChain::iterator LocalScopeChain::begin() const {
+  iterator it;
+  it._symbols = _symbols;
+  it._walk = _container;
+  it.advance();
+  return it;
+}
+
+LocalSymbols::LocalSymbols(LocalSymbols &&other) noexcept
+    : _pending(std::move(other._pending)), _entries(std::move(other._entries)),
+      _byName(std::move(other._byName)), _buckets(std::move(other._buckets)),
+      _scopes(std::move(other._scopes)), _detachedBegin(other._detachedBegin),
+      _scopeOf(std::move(other._scopeOf)),
+      _arena(std::exchange(other._arena, nullptr)),
+      _types(std::move(other._types)),
+      _reflection(std::exchange(other._reflection, nullptr)),
+      _referenceTypes(std::move(other._referenceTypes)),
+      _acceptedTypes(std::move(other._acceptedTypes)),
+      _staged(other._staged.exchange(false, std::memory_order_relaxed)) {
+  other._detachedBegin = 0;
+}
+
+LocalSymbols &LocalSymbols::operator=(LocalSymbols &&other) noexcept {
+  if (this != &other) {
+    _pending = std::move(other._pending);
+    _entries = std::move(other._entries);
+    _byName = std::move(other._byName);
+    _buckets = std::move(other._buckets);
+    _scopes = std::move(other._scopes);
+    _detachedBegin = other._detachedBegin;
+    _scopeOf = std::move(other._scopeOf);
+    _arena = other._arena;
+    _types = std::move(other._types);
+    _reflection = other._reflection;
+    _referenceTypes = std::move(other._referenceTypes);
+    _acceptedTypes = std::move(other._acceptedTypes);
+    _staged.store(other._staged.exchange(false, std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+    other.clear();
+  }
+  return *this;
+}
+
+void LocalSymbols::emplace(const AstNode *container,
+                           AstNodeDescription description) {
+  _pending.push_back(
+      {.container = container, .description = std::move(description)});
+  _staged.store(true, std::memory_order_relaxed);
+}
+
+void LocalSymbols::finalize() {
+  if (_staged.load(std::memory_order_acquire)) {
+    std::scoped_lock lock(_finalizeMutex);
+    finalizeLocked();
+  }
+}
+
+void LocalSymbols::finalize(const AstReflection &reflection,
+                            std::span<const std::type_index> referenceTypes) {
+  std::scoped_lock lock(_finalizeMutex);
+  _reflection = &reflection;
+  _referenceTypes.clear();
+  constexpr utils::FastTypeIndexEqual eq{};
+  for (const auto type : referenceTypes) {
+    if (std::ranges::none_of(_referenceTypes, [&eq, type](const auto known) {
+          return eq(known, type);
+        })) {
+      _referenceTypes.push_back(type);
+    }
+  }
+  if (_staged.load(std::memory_order_relaxed)) {
+    finalizeLocked();
+  } else {
+    computeAcceptedTypes();
+  }
+}
+
+void LocalSymbols::ensureFinalized() const {
+  if (_staged.load(std::memory_order_acquire)) [[unlikely]] {
+    std::scoped_lock lock(_finalizeMutex);
+    // Staging and querying never overlap, so only concurrent queries race to
+    // finalize: the layout belongs to whichever wins.
+    const_cast<LocalSymbols *>(this)->finalizeLocked();
+  }
+}
+
+std::size_t LocalSymbols::allocatedBytes() const noexcept {
+  return _pending.capacity() * sizeof(PendingEntry) +
+         _entries.capacity() * sizeof(AstNodeDescription) +
+         _byName.capacity() * sizeof(std::uint32_t) +
+         _buckets.capacity() * sizeof(LocalScopeBucket) +
+         _scopes.capacity() * sizeof(Scope) +
+         _scopeOf.capacity() * sizeof(std::uint32_t) +
+         (_types.capacity() + _referenceTypes.capacity()) *
+             sizeof(std::type_index) +
+         _acceptedTypes.capacity() * sizeof(std::uint64_t);
+}
+
+void LocalSymbols::clear() noexcept {
+  _pending.clear();
+  _entries.clear();
+  _byName.clear();
+  _buckets.clear();
+  _scopes.clear();
+  _detachedBegin = 0;
+  _scopeOf.clear();
+  _arena = nullptr;
+  _types.clear();
+  _reflection = nullptr;
+  _referenceTypes.clear();
+  _acceptedTypes.clear();
+  _staged.store(false, std::memory_order_relaxed);
+}
+
+std::span<const LocalScopeBucket>
+LocalSymbols::forContainer(const AstNode *container) const {
+  ensureFinalized();
+  if (const auto nearest = nearestScope(container)) {
+    if (*nearest != kNoScope && _scopes[*nearest].container == container) {
+      return bucketsOf(*nearest);
+    }
+    return {};
+  }
+  for (auto scope = _detachedBegin; scope < _scopes.size(); ++scope) {
+    if (_scopes[scope].container == container) {
+      return bucketsOf(scope);
+    }
+  }
+  return {};
+}
+
+std::span<const LocalScopeBucket> LocalSymbols::buckets() const {
+  ensureFinalized();
+  return _buckets;
+}
+
+LocalScopeChain LocalSymbols::scopeChain(const AstNode *container) const {
+  ensureFinalized();
+  return {*this, container};
+}
+
+const void *LocalSymbols::scopeKey(const AstNode *container) const {
+  // A chain is determined by its nearest level; every level has its own
+  // buckets, so their address identifies it.
+  const auto chain = scopeChain(container);
+  const auto nearest = chain.begin();
+  if (nearest == chain.end()) {
+    return this;
+  }
+  return (*nearest).data();
+}
+
+std::optional<std::uint64_t>
+LocalSymbols::acceptedTypes(std::type_index referenceType) const {
+  ensureFinalized();
+  if (_acceptedTypes.size() != _referenceTypes.size()) {
+    return std::nullopt;
+  }
+  constexpr utils::FastTypeIndexEqual eq{};
+  for (std::size_t index = 0; index < _referenceTypes.size(); ++index) {
+    if (eq(_referenceTypes[index], referenceType)) {
+      return _acceptedTypes[index];
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::uint32_t>
+LocalSymbols::nearestScope(const AstNode *container) const noexcept {
+  if (container == nullptr || _arena == nullptr ||
+      container->arena() != _arena) {
+    return std::nullopt;
+  }
+  const auto id = container->symbolId();
+  if (id >= _scopeOf.size()) {
+    return std::nullopt;
+  }
+  return _scopeOf[id];
+}
+
+void LocalSymbols::unpackInto(std::vector<PendingEntry> &entries) {
+  for (std::uint32_t scope = 0; scope < _scopes.size(); ++scope) {
+    for (const auto &bucket : bucketsOf(scope)) {
+      for (const auto &description : bucket.entries()) {
+        entries.push_back({.container = _scopes[scope].container,
+                           .description = description});
+      }
+    }
+  }
+}
+
+void LocalSymbols::linkScopes() {
+  _scopeOf.clear();
+  if (_arena == nullptr || _detachedBegin == 0) {
+    _arena = nullptr;
+    return;
+  }
+  // Every node of the arena resolves to its nearest declaring ancestor-or-self;
+  // each node is walked once, ancestors already resolved end the walk.
+  constexpr auto kUnresolved = kNoScope - 1;
+  _scopeOf.assign(_arena->size(), kUnresolved);
+  for (std::uint32_t scope = 0; scope < _detachedBegin; ++scope) {
+    _scopeOf[_scopes[scope].container->symbolId()] = scope;
+  }
+  std::vector<std::uint32_t> path;
+  for (std::uint32_t id = 0; id < _scopeOf.size(); ++id) {
+    if (_scopeOf[id] != kUnresolved) {
+      continue;
+    }
+    path.clear();
+    auto nearest = kNoScope;
+    for (const AstNode *node = _arena->getNode(id);
+         node != nullptr && node->arena() == _arena;
+         node = node->getContainer()) {
+      const auto resolved = _scopeOf[node->symbolId()];
+      if (resolved != kUnresolved) {
+        nearest = resolved;
+        break;
+      }
+      path.push_back(node->symbolId());
+    }
+    for (const auto at : path) {
+      _scopeOf[at] = nearest;
+    }
+  }
+  for (std::uint32_t scope = 0; scope < _detachedBegin; ++scope) {
+    _scopes[scope].parent =
+        nearestScope(_scopes[scope].container->getContainer())
+            .value_or(kNoScope);
+  }
+}
+
+void LocalSymbols::computeAcceptedTypes() {
+  _acceptedTypes.clear();
+  // Type slots beyond the mask width fall back to per-bucket subtype queries.
+  if (_reflection == nullptr || _types.size() > 64U) {
+    return;
+  }
+  std::vector<AstTypeId> typeIds;
+  typeIds.reserve(_types.size());
+  for (const auto type : _types) {
+    typeIds.push_back(_reflection->typeId(type));
+  }
+  _acceptedTypes.reserve(_referenceTypes.size());
+  for (const auto referenceType : _referenceTypes) {
+    const auto referenceTypeId = _reflection->typeId(referenceType);
+    std::uint64_t accepted = 0;
+    for (std::size_t slot = 0; slot < _types.size(); ++slot) {
+      if (type_is_assignable(typeIds[slot], _types[slot], referenceTypeId,
+                             referenceType, *_reflection)) {
+        accepted |= std::uint64_t{1} << slot;
+      }
+    }
+    _acceptedTypes.push_back(accepted);
+  }
+}
+
+void LocalSymbols::finalizeLocked() {
+  if (!_staged.load(std::memory_order_relaxed)) {
+    return;
+  }
+  // Descriptions laid out earlier keep their position ahead of staged ones.
+  std::vector<PendingEntry> pending;
+  pending.reserve(_entries.size() + _pending.size());
+  unpackInto(pending);
+  std::ranges::move(_pending, std::back_inserter(pending));
+  _pending.clear();
+  _pending.shrink_to_fit();
+
+  // The scope tree covers the arena of the first container that has one.
+  _arena = nullptr;
+  for (const auto &entry : pending) {
+    if (entry.container != nullptr && entry.container->arena() != nullptr) {
+      _arena = entry.container->arena();
       break;
     }
   }
-  if (bucket == nullptr) {
-    auto &fresh = buckets.emplace_back();
-    fresh.type = type;
-    bucket = std::addressof(fresh);
+  const auto inArena = [this](const AstNode *container) {
+    return container != nullptr && _arena != nullptr &&
+           container->arena() == _arena;
+  };
+
+  // Detached containers sort after arena ones, in first-use order.
+  std::vector<const AstNode *> detachedOrder;
+  const auto detachedRank = [&detachedOrder](const AstNode *container) {
+    const auto it = std::ranges::find(detachedOrder, container);
+    if (it != detachedOrder.end()) {
+      return static_cast<std::uint32_t>(it - detachedOrder.begin());
+    }
+    detachedOrder.push_back(container);
+    return static_cast<std::uint32_t>(detachedOrder.size() - 1);
+  };
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> order;
+  order.reserve(pending.size());
+  for (std::uint32_t index = 0; index < pending.size(); ++index) {
+    const auto *container = pending[index].container;
+    const std::uint64_t key =
+        inArena(container)
+            ? container->symbolId()
+            : (std::uint64_t{1} << 32U) + detachedRank(container);
+    order.emplace_back(key, index);
   }
+  std::ranges::stable_sort(order, {}, &std::pair<std::uint64_t,
+                                                 std::uint32_t>::first);
+
+  _entries.clear();
+  _entries.reserve(pending.size());
+  _byName.clear();
+  _byName.reserve(pending.size());
+  _buckets.clear();
+  _scopes.clear();
+  _types.clear();
 
-  // `std::deque::push_back` is element-stable, so the address pushed into the
-  // name index stays valid for the entire lifetime of this `LocalSymbols`.
-  const auto &stored = bucket->ownedEntries.emplace_back(std::move(description));
-  bucket->entriesByName.try_emplace(stored.name).first->second.add(stored);
-  ++_totalSize;
-  return stored;
+  // Offsets are recorded first and turned into pointers once `_entries` and
+  // `_byName` stop growing.
+  struct BucketRange {
+    std::type_index type;
+    std::uint32_t typeSlot;
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+  constexpr utils::FastTypeIndexEqual eq{};
+  const auto typeSlot = [this, &eq](std::type_index type) {
+    const auto it = std::ranges::find_if(
+        _types, [&eq, type](const auto known) { return eq(known, type); });
+    if (it != _types.end()) {
+      return static_cast<std::uint32_t>(it - _types.begin());
+    }
+    _types.push_back(type);
+    return static_cast<std::uint32_t>(_types.size() - 1);
+  };
+  std::vector<BucketRange> ranges;
+  std::vector<std::type_index> types;
+  std::vector<std::uint32_t> group;
+  _detachedBegin = 0;
+  for (std::size_t begin = 0; begin < order.size();) {
+    const auto key = order[begin].first;
+    auto end = begin;
+    while (end < order.size() && order[end].first == key) {
+      ++end;
+    }
+    // Buckets of a container follow the first use of their type.
+    types.clear();
+    group.clear();
+    for (auto position = begin; position < end; ++position) {
+      const auto type = pending[order[position].second].description.type;
+      if (std::ranges::find(types, type) == types.end()) {
+        types.push_back(type);
+      }
+      group.push_back(order[position].second);
+    }
+    const auto bucketsBegin = static_cast<std::uint32_t>(ranges.size());
+    for (const auto type : types) {
+      const auto entriesBegin = static_cast<std::uint32_t>(_entries.size());
+      for (const auto index : group) {
+        if (pending[index].description.type == type) {
+          _entries.push_back(std::move(pending[index].description));
+        }
+      }
+      const auto entriesEnd = static_cast<std::uint32_t>(_entries.size());
+      for (auto position = entriesBegin; position < entriesEnd; ++position) {
+        _byName.push_back(position - entriesBegin);
+      }
+      const std::span<std::uint32_t> byName{_byName.data() + entriesBegin,
+                                            entriesEnd - entriesBegin};
+      const auto *bucketEntries = _entries.data() + entriesBegin;
+      std::ranges::stable_sort(byName, {}, [bucketEntries](std::uint32_t at) {
+        return bucketEntries[at].name.id();
+      });
+      ranges.push_back({type, typeSlot(type), entriesBegin, entriesEnd});
+    }
+    _scopes.push_back({.container = pending[group.front()].container,
+                       .bucketsBegin = bucketsBegin,
+                       .bucketsEnd = static_cast<std::uint32_t>(ranges.size()),
+                       .parent = kNoScope});
+    if (key < (std::uint64_t{1} << 32U)) {
+      _detachedBegin = static_cast<std::uint32_t>(_scopes.size());
+    }
+    begin = end;
+  }
+
+  _buckets.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    auto &bucket = _buckets.emplace_back();
+    bucket._type = range.type;
+    bucket._typeSlot = range.typeSlot;
+    bucket._entries = _entries.data() + range.begin;
+    bucket._byName = _byName.data() + range.begin;
+    bucket._size = range.end - range.begin;
+  }
+  linkScopes();
+  computeAcceptedTypes();
+  _staged.store(false, std::memory_order_release);
 }
 
 } // namespace pegium::workspace
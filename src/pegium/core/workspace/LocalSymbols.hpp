@@ -1,77 +1,262 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
-#include <memory>
-#include <unordered_map>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
 #include <pegium/core/workspace/AstDescriptions.hpp>
 
 namespace pegium {
 struct AstNode;
-}
+class AstArena;
+class AstReflection;
+} // namespace pegium
 
 namespace pegium::workspace {
 
-/// Local scope entries of a document, bucketed by container AST node and
-/// indexed by symbol type and name.
+/// Local scope entries of one symbol type bound to one container, viewed in a
+/// `LocalSymbols`.
+class LocalScopeBucket {
+public:
+  /// The symbol type shared by the entries.
+  [[nodiscard]] std::type_index type() const noexcept { return _type; }
+
+  /// Dense id of `type()` in the workspace `AstReflection`, or `kNoAstType`.
+  [[nodiscard]] AstTypeId typeId() const noexcept {
+    return _size == 0 ? kNoAstType : _entries->typeId;
+  }
+
+  /// Index of `type()` among the distinct bucket types of the owning
+  /// `LocalSymbols`.
+  [[nodiscard]] std::uint32_t typeSlot() const noexcept { return _typeSlot; }
+
+  /// Returns whether `type()` is in `acceptedTypes`, a mask returned by
+  /// `LocalSymbols::acceptedTypes(...)`.
+  [[nodiscard]] bool acceptedBy(std::uint64_t acceptedTypes) const noexcept {
+    return _typeSlot < 64U && ((acceptedTypes >> _typeSlot) & 1U) != 0U;
+  }
+
+  /// The entries, in declaration order.
+  [[nodiscard]] std::span<const AstNodeDescription> entries() const noexcept {
+    return {_entries, _size};
+  }
+
+  /// Returns the first entry declared with `name`, or nullptr.
+  [[nodiscard]] const AstNodeDescription *
+  find(utils::InternedString name) const noexcept {
+    const auto positions = named(name);
+    return positions.empty() ? nullptr : _entries + positions.front();
+  }
+
+  /// Visits the entries declared with `name`, in declaration order, until
+  /// `visitor` returns false. Returns false when it stopped early.
+  template <typename Visitor>
+  bool visitNamed(utils::InternedString name, Visitor &&visitor) const {
+    for (const auto position : named(name)) {
+      if (!visitor(_entries[position])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  friend class LocalSymbols;
+
+  // Positions of the entries named `name`, in declaration order.
+  [[nodiscard]] std::span<const std::uint32_t>
+  named(utils::InternedString name) const noexcept;
+
+  std::type_index _type = std::type_index(typeid(void));
+  const AstNodeDescription *_entries = nullptr;
+  // Positions into `_entries` sorted by name id, then declaration order.
+  const std::uint32_t *_byName = nullptr;
+  std::uint32_t _size = 0;
+  std::uint32_t _typeSlot = 0;
+};
+
+class LocalSymbols;
+
+/// Scope levels visible from a container in a `LocalSymbols`, nearest first:
+/// the buckets of each ancestor-or-self container that declares symbols.
+/// Containers declaring nothing are not visited.
+class LocalScopeChain {
+public:
+  class iterator {
+  public:
+    using value_type = std::span<const LocalScopeBucket>;
+    using difference_type = std::ptrdiff_t;
+
+    [[nodiscard]] value_type operator*() const noexcept { return _level; }
+    iterator &operator++() {
+      advance();
+      return *this;
+    }
+    void operator++(int) { advance(); }
+    [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {
+      return _level.empty();
+    }
+
+  private:
+    friend class LocalScopeChain;
+
+    void advance();
+
+    const LocalSymbols *_symbols = nullptr;
+    // Next scope of the precomputed tree, or `LocalSymbols::kNoScope`.
+    std::uint32_t _scope = ~std::uint32_t{0};
+    // Next container to look up when the tree does not cover it.
+    const AstNode *_walk = nullptr;
+    value_type _level;
+  };
+
+  [[nodiscard]] iterator begin() const;
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  friend class LocalSymbols;
+
+  LocalScopeChain(const LocalSymbols &symbols, const AstNode *container) noexcept
+      : _symbols(&symbols), _container(container) {}
+
+  const LocalSymbols *_symbols;
+  const AstNode *_container;
+};
+
+/// Local scope entries of a document, grouped by container AST node, then by
+/// symbol type, and indexed by interned name.
+///
+/// `emplace(...)` stages descriptions; `finalize()` then lays them out flat:
+/// one contiguous array of descriptions, the buckets of each container stored
+/// contiguously, and a compact scope tree linking only the containers that
+/// declare symbols to their nearest declaring ancestor. A dense table indexed
+/// by arena id (`AstNode::symbolId()`) maps every node of the containers' arena
+/// to its nearest declaring ancestor-or-self, so `scopeChain(...)` jumps
+/// straight between declaring levels instead of testing every ancestor, and a
+/// name is found by binary search over integer ids.
+///
+/// Given the reference types of the document, `finalize(reflection, types)`
+/// also precomputes which bucket types each reference type accepts, so that
+/// resolution filters buckets with a bit test instead of a subtype query.
 ///
-/// Descriptions are stored once, in a `BucketedScopeEntries` per container.
-/// The `ScopeProvider` consumes the bucketed view directly via `forContainer`.
-/// The per-bucket name index is populated eagerly during `emplace`, so once
-/// the build phase completes the structure is fully immutable and safe to
-/// query from multiple reader threads concurrently.
+/// `ScopeComputation::collectLocalSymbols(...)` finalizes the symbols it
+/// returns. Queries finalize staged descriptions themselves, once, under a lock,
+/// so that a finalized instance is safe to query from multiple reader threads
+/// concurrently.
 ///
-/// Copy is disabled because the per-bucket name index holds raw pointers and
-/// `string_view`s into the owned descriptions — duplicating the storage would
-/// silently leave the indexes pointing at the original deque elements. Move
-/// is safe because both the outer `unordered_map` and inner `std::deque`s
-/// preserve element addresses on transfer.
+/// Copy is disabled because the buckets hold pointers into the owned arrays;
+/// moving keeps those arrays, and the pointers, in place.
 class LocalSymbols {
 public:
-  using map_type =
-      std::unordered_map<const AstNode *, BucketedScopeEntries>;
-  using const_iterator = map_type::const_iterator;
-
   LocalSymbols() = default;
   LocalSymbols(const LocalSymbols &) = delete;
   LocalSymbols &operator=(const LocalSymbols &) = delete;
-  LocalSymbols(LocalSymbols &&) noexcept = default;
-  LocalSymbols &operator=(LocalSymbols &&) noexcept = default;
+  LocalSymbols(LocalSymbols &&other) noexcept;
+  LocalSymbols &operator=(LocalSymbols &&other) noexcept;
+  ~LocalSymbols() noexcept = default;
+
+  /// Stages `description` under `container`, in the bucket of
+  /// `description.type`. Must not run concurrently with queries.
+  void emplace(const AstNode *container, AstNodeDescription description);
 
-  /// Adds `description` under `container`, dispatched to the bucket whose
-  /// type matches `description.type`. The returned reference is stable for
-  /// the lifetime of this `LocalSymbols` instance.
-  const AstNodeDescription &emplace(const AstNode *container,
-                                    AstNodeDescription description);
+  /// Lays staged descriptions out for lookup. Idempotent.
+  void finalize();
+  /// Lays staged descriptions out for lookup and precomputes, for each of
+  /// `referenceTypes`, the bucket types assignable to it under `reflection`.
+  /// `reflection` must outlive this instance.
+  void finalize(const AstReflection &reflection,
+                std::span<const std::type_index> referenceTypes);
 
-  [[nodiscard]] bool empty() const noexcept { return _byContainer.empty(); }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
   /// Total number of descriptions held across all containers (not the number
-  /// of containers). Tests rely on this entry-count semantic.
-  [[nodiscard]] std::size_t size() const noexcept { return _totalSize; }
-  void clear() noexcept {
-    _byContainer.clear();
-    _totalSize = 0;
+  /// of containers).
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _entries.size() + _pending.size();
   }
+  /// Returns the bytes allocated by this instance.
+  [[nodiscard]] std::size_t allocatedBytes() const noexcept;
+  void clear() noexcept;
 
-  /// Returns the bucketed entries for `container`, or nullptr if no symbol is
-  /// bound to it. After the build phase completes, this is a pure const
-  /// lookup: no mutation, safe under concurrent reads.
-  [[nodiscard]] const BucketedScopeEntries *
-  forContainer(const AstNode *container) const {
-    const auto it = _byContainer.find(container);
-    return it == _byContainer.end() ? nullptr : std::addressof(it->second);
-  }
+  /// Returns the buckets bound to `container`, empty if no symbol is bound to
+  /// it.
+  [[nodiscard]] std::span<const LocalScopeBucket>
+  forContainer(const AstNode *container) const;
+  /// Returns the buckets of every container.
+  [[nodiscard]] std::span<const LocalScopeBucket> buckets() const;
 
-  [[nodiscard]] const_iterator begin() const noexcept {
-    return _byContainer.begin();
-  }
-  [[nodiscard]] const_iterator end() const noexcept {
-    return _byContainer.end();
-  }
+  /// Returns the scope levels visible from `container`, nearest first.
+  [[nodiscard]] LocalScopeChain scopeChain(const AstNode *container) const;
+
+  /// Returns an identity of the scope levels visible from `container`: two
+  /// containers get the same key exactly when their scope chains are the same.
+  [[nodiscard]] const void *scopeKey(const AstNode *container) const;
+
+  /// Returns the mask of bucket type slots (`LocalScopeBucket::typeSlot()`)
+  /// assignable to `referenceType`, or nothing when it was not precomputed.
+  [[nodiscard]] std::optional<std::uint64_t>
+  acceptedTypes(std::type_index referenceType) const;
 
 private:
-  map_type _byContainer;
-  std::size_t _totalSize = 0;
+  friend class LocalScopeChain;
+
+  struct PendingEntry {
+    const AstNode *container;
+    AstNodeDescription description;
+  };
+  struct Scope {
+    const AstNode *container;
+    std::uint32_t bucketsBegin;
+    std::uint32_t bucketsEnd;
+    // Nearest declaring ancestor, or `kNoScope`.
+    std::uint32_t parent;
+  };
+  static constexpr std::uint32_t kNoScope = ~std::uint32_t{0};
+
+  void ensureFinalized() const;
+  void finalizeLocked();
+  void unpackInto(std::vector<PendingEntry> &entries);
+  void linkScopes();
+  void computeAcceptedTypes();
+  // Nearest declaring ancestor-or-self of `container` (possibly `kNoScope`),
+  // or nothing when the scope tree does not cover `container`.
+  [[nodiscard]] std::optional<std::uint32_t>
+  nearestScope(const AstNode *container) const noexcept;
+  [[nodiscard]] std::span<const LocalScopeBucket>
+  bucketsOf(std::uint32_t scope) const noexcept {
+    return {_buckets.data() + _scopes[scope].bucketsBegin,
+            _buckets.data() + _scopes[scope].bucketsEnd};
+  }
+
+  std::vector<PendingEntry> _pending;
+  std::vector<AstNodeDescription> _entries;
+  std::vector<std::uint32_t> _byName;
+  std::vector<LocalScopeBucket> _buckets;
+  // Declaring containers: those of `_arena` by arena id, then the others
+  // (standalone nodes, nullptr) in first-use order.
+  std::vector<Scope> _scopes;
+  // Index of the first scope outside `_arena`.
+  std::uint32_t _detachedBegin = 0;
+  // `_scopeOf[id]` is the nearest declaring ancestor-or-self of the node whose
+  // arena id in `_arena` is `id`, or `kNoScope`.
+  std::vector<std::uint32_t> _scopeOf;
+  // Only compared against, never dereferenced.
+  const AstArena *_arena = nullptr;
+  // Distinct bucket types, indexed by type slot.
+  std::vector<std::type_index> _types;
+  const AstReflection *_reflection = nullptr;
+  std::vector<std::type_index> _referenceTypes;
+  // Accepted type slots per entry of `_referenceTypes`.
+  std::vector<std::uint64_t> _acceptedTypes;
+  std::atomic<bool> _staged = false;
+  mutable std::mutex _finalizeMutex;
 };
 
 } // namespace pegium::workspace
@@ -3,7 +3,6 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
-#include <deque>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -15,7 +14,8 @@
 #include <variant>
 #include <vector>
 
-#include <pegium/core/utils/TransparentStringHash.hpp>
+#include <pegium/core/utils/StringInterner.hpp>
+#include <pegium/core/syntax-tree/AstReflection.hpp>
 #include <pegium/core/syntax-tree/CstNode.hpp>
 #include <pegium/core/syntax-tree/ReferenceInfo.hpp>
 
@@ -36,8 +36,17 @@ inline constexpr SymbolId InvalidSymbolId =
 
 /// Stable exported symbol description stored in workspace indexes: the name,
 /// the type, and the (documentId, symbolId) identity for re-resolving the node.
+///
+/// The name is interned: copies of a description share its characters, and
+/// name indexes compare it as an integer. `typeId` is the dense id of `type` in
+/// the workspace `AstReflection` when known, letting type filters test a bit
+/// instead of querying the subtype sets. `documentRevision` is the
+/// `Document::revision()` the index took the description from, or `0` when
+/// unknown: symbol ids only identify a node within that parse.
 struct AstNodeDescription {
-  std::string name;
+  utils::InternedString name;
+  AstTypeId typeId = kNoAstType;
+  std::uint32_t documentRevision = 0;
   std::type_index type = std::type_index(typeid(void));
   DocumentId documentId = InvalidDocumentId;
   SymbolId symbolId = InvalidSymbolId;
@@ -65,32 +74,11 @@ struct NamedScopeEntries {
   }
 };
 
-/// Name index mapping a symbol name to its scope entries. The key caches its
-/// hash (`utils::HashedStringView`) so a reference name hashed once can be probed
-/// across every bucket and ancestor scope level without re-hashing.
-using NamedScopeEntryIndex = utils::HashedStringViewMap<NamedScopeEntries>;
-
-/// Scope entries grouped by assignable target type.
-///
-/// `ownedEntries` provides stable storage for the descriptions; `entriesByName`
-/// indexes them by name. `std::deque` is used so that adding a new description
-/// never invalidates the pointers held by the name index.
-struct ScopeEntryBucket {
-  using NameIndex = NamedScopeEntryIndex;
-
-  std::type_index type = std::type_index(typeid(void));
-  std::deque<AstNodeDescription> ownedEntries;
-  NameIndex entriesByName;
-};
-
-/// Collection of typed scope entry buckets.
-///
-/// `std::deque` keeps existing buckets at stable addresses when a new one is
-/// appended, so the description pointers held by `ScopeEntryBucket::entriesByName`
-/// remain valid. In practice each container has only a handful of distinct
-/// symbol types, so a linear scan over the buckets is faster than maintaining a
-/// side index.
-using BucketedScopeEntries = std::deque<ScopeEntryBucket>;
+/// Name index mapping an interned symbol name to its scope entries. A reference
+/// name is looked up in the interner once (`utils::InternedString::find`), then
+/// probed across every bucket and ancestor scope level as an integer.
+using NamedScopeEntryIndex =
+    std::unordered_map<utils::InternedString, NamedScopeEntries>;
 
 /// Stable key identifying one AST node across workspace indexes.
 struct NodeKey {
@@ -187,7 +175,7 @@ struct LinkingError {
 /// Fully resolved AST node together with its stable description.
 ///
 /// `description` is a non-owning pointer into stable scope storage (the
-/// `std::deque<AstNodeDescription>` inside `ScopeEntryBucket::ownedEntries`).
+/// finalized entries of `LocalSymbols`, or the global index entries).
 /// Pointer stability is guaranteed for the lifetime of the source document's
 /// `LocalSymbols` / global index entries — which is the same lifetime callers
 /// already assume for `Reference` resolutions.
@@ -17,6 +17,7 @@
 namespace pegium::workspace {
 
 class DocumentFactory;
+class DocumentResidency;
 
 /// One full-text or ranged text document change.
 struct TextDocumentContentChangeEvent {
@@ -43,6 +44,7 @@ struct TextEdit {
 /// lock-free `getText()`.
 class TextDocument {
   friend class DocumentFactory;
+  friend class DocumentResidency;
 
 public:
   TextDocument() = delete;
@@ -88,6 +90,10 @@ public:
   }
   /// Returns the current document text restricted to `range`.
   [[nodiscard]] std::string getText(const text::Range &range) const;
+  /// Returns the content hash of the current text, computed once per snapshot.
+  [[nodiscard]] std::uint64_t contentHash() const noexcept {
+    return _snapshot.hash();
+  }
 
   /// Converts the zero-based position to a zero-based offset.
   [[nodiscard]] TextOffset offsetAt(const text::Position &position) const;
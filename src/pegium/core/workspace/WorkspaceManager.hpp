@@ -57,6 +57,8 @@ public:
   [[nodiscard]] virtual std::vector<std::string>
   searchFolder(std::string_view workspaceUri) const = 0;
   /// Returns whether one file-system entry should participate in workspace discovery.
+  /// Discovery lists folders concurrently, so this may be called from several
+  /// threads at once.
   [[nodiscard]] virtual bool
   shouldIncludeEntry(const FileSystemNode &entry) const = 0;
 };
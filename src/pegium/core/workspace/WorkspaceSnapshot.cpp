@@ -0,0 +1,79 @@
+#include <pegium/core/workspace/WorkspaceSnapshot.hpp>
+
+#include <cassert>
+#include <utility>
+
+#include <pegium/core/utils/UriUtils.hpp>
+
+namespace pegium::workspace {
+
+namespace {
+
+thread_local const WorkspaceSnapshot *t_activeSnapshot = nullptr;
+// Gate held by the outermost reader of this thread: shared_mutex ownership is
+// not recursive, so nested readers of the same builder do not lock it again.
+thread_local const std::shared_mutex *t_heldGate = nullptr;
+
+} // namespace
+
+WorkspaceSnapshot::WorkspaceSnapshot(
+    std::uint64_t version, std::vector<std::shared_ptr<Document>> documents,
+    std::shared_ptr<std::shared_mutex> gate,
+    std::shared_ptr<Retirement> retirement)
+    : _version(version), _documents(std::move(documents)),
+      _gate(std::move(gate)), _retirement(std::move(retirement)) {
+  assert(_gate != nullptr);
+  _indexById.reserve(_documents.size());
+  _indexByUri.reserve(_documents.size());
+  for (std::size_t index = 0; index < _documents.size(); ++index) {
+    const auto &document = _documents[index];
+    assert(document != nullptr);
+    _indexById.try_emplace(document->id, index);
+    _indexByUri.try_emplace(document->uri, index);
+  }
+}
+
+std::shared_ptr<const Document>
+WorkspaceSnapshot::getDocument(DocumentId id) const noexcept {
+  return findDocument(id);
+}
+
+std::shared_ptr<const Document>
+WorkspaceSnapshot::getDocument(std::string_view uri) const {
+  return findDocument(utils::normalize_uri(uri));
+}
+
+std::shared_ptr<Document>
+WorkspaceSnapshot::findDocument(DocumentId id) const noexcept {
+  const auto it = _indexById.find(id);
+  return it == _indexById.end() ? nullptr : _documents[it->second];
+}
+
+std::shared_ptr<Document>
+WorkspaceSnapshot::findDocument(std::string_view normalizedUri) const {
+  const auto it = _indexByUri.find(normalizedUri);
+  return it == _indexByUri.end() ? nullptr : _documents[it->second];
+}
+
+const WorkspaceSnapshot *WorkspaceSnapshot::active() noexcept {
+  return t_activeSnapshot;
+}
+
+WorkspaceSnapshot::Reader::Reader(const WorkspaceSnapshot &snapshot)
+    : _lock(*snapshot._gate, std::defer_lock), _previous(t_activeSnapshot) {
+  if (t_heldGate != snapshot._gate.get()) {
+    assert(t_heldGate == nullptr);
+    _lock.lock();
+    t_heldGate = snapshot._gate.get();
+  }
+  t_activeSnapshot = &snapshot;
+}
+
+WorkspaceSnapshot::Reader::~Reader() {
+  t_activeSnapshot = _previous;
+  if (_lock.owns_lock()) {
+    t_heldGate = nullptr;
+  }
+}
+
+} // namespace pegium::workspace
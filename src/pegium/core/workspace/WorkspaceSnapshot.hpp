@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <pegium/core/utils/TransparentStringHash.hpp>
+#include <pegium/core/workspace/Document.hpp>
+
+namespace pegium::workspace {
+
+/// Immutable view of the workspace as left by one completed build.
+///
+/// Published by the document builder when `BuildOptions::isolateSnapshots` is
+/// enabled (see `DocumentBuilder::snapshot()`). Documents of a snapshot are
+/// never reset or rebuilt in place: later builds work on new versions of them,
+/// so requests can keep reading a snapshot, diagnostics included, while the
+/// next version builds. The only in-place change a snapshot document still
+/// receives is the move of its resolved references onto the new version of
+/// their target document, which a `Reader` excludes.
+///
+/// The index is not versioned: global scope lookups made while reading a
+/// snapshot see the exports of the workspace being built, but every document
+/// lookup through `Documents` resolves to the version in the snapshot. Indexed
+/// descriptions carry the document revision they were taken from, so readers
+/// skip those of another version (see `find_ast_node(...)`), as well as the
+/// targets of references moved onto one.
+class WorkspaceSnapshot {
+public:
+  /// Keeps replaced document versions alive for the readers of older
+  /// snapshots, whose documents may still point into them. Each link holds the
+  /// versions replaced while building one snapshot and the next link.
+  struct Retirement {
+    std::vector<std::shared_ptr<const Document>> documents;
+    std::shared_ptr<Retirement> next;
+  };
+
+  WorkspaceSnapshot(std::uint64_t version,
+                    std::vector<std::shared_ptr<Document>> documents,
+                    std::shared_ptr<std::shared_mutex> gate,
+                    std::shared_ptr<Retirement> retirement);
+
+  WorkspaceSnapshot(const WorkspaceSnapshot &) = delete;
+  WorkspaceSnapshot &operator=(const WorkspaceSnapshot &) = delete;
+
+  /// Increases with every snapshot published by the same builder.
+  [[nodiscard]] std::uint64_t version() const noexcept { return _version; }
+
+  [[nodiscard]] std::span<const std::shared_ptr<Document>>
+  documents() const noexcept {
+    return _documents;
+  }
+
+  /// Returns the version of the document `id` in this snapshot, or `nullptr`.
+  [[nodiscard]] std::shared_ptr<const Document>
+  getDocument(DocumentId id) const noexcept;
+  /// Returns the version of the document `uri` in this snapshot, or `nullptr`.
+  [[nodiscard]] std::shared_ptr<const Document>
+  getDocument(std::string_view uri) const;
+
+  /// Returns the snapshot the calling thread currently reads, or `nullptr`.
+  [[nodiscard]] static const WorkspaceSnapshot *active() noexcept;
+
+  /// Read access to a snapshot for the lifetime of the object.
+  ///
+  /// While alive, the builder does not move references of snapshot documents,
+  /// and `Documents` lookups made on the calling thread return the versions in
+  /// the snapshot (documents the snapshot does not hold are reported absent).
+  /// A reader must not wait for a build to progress: the build may be waiting
+  /// for it.
+  class Reader {
+  public:
+    explicit Reader(const WorkspaceSnapshot &snapshot);
+    ~Reader();
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+  private:
+    std::shared_lock<std::shared_mutex> _lock;
+    const WorkspaceSnapshot *_previous;
+  };
+
+private:
+  friend class DefaultDocuments;
+
+  [[nodiscard]] std::shared_ptr<Document>
+  findDocument(DocumentId id) const noexcept;
+  [[nodiscard]] std::shared_ptr<Document>
+  findDocument(std::string_view normalizedUri) const;
+
+  std::uint64_t _version;
+  std::vector<std::shared_ptr<Document>> _documents;
+  std::unordered_map<DocumentId, std::size_t> _indexById;
+  utils::TransparentStringMap<std::size_t> _indexByUri;
+  std::shared_ptr<std::shared_mutex> _gate;
+  std::shared_ptr<Retirement> _retirement;
+};
+
+} // namespace pegium::workspace
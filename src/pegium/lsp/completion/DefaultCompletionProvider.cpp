@@ -289,7 +289,7 @@ DefaultCompletionProvider::createReferenceCompletionItem(
   assert(!candidate.name.empty());
 
   CompletionValue value;
-  value.label = candidate.name;
+  value.label = candidate.name.str();
   value.description = &candidate;
   value.sortText = "0";
   return value;
@@ -407,9 +407,12 @@ bool DefaultCompletionProvider::fillCompletionItem(
 
   if (value.documentation.has_value()) {
     item.documentation = *value.documentation;
-  } else if (description != nullptr) {
-    const auto &node = workspace::resolve_ast_node(documents, *description);
-    if (auto documentation = documentationProvider.getDocumentation(node);
+  } else if (const auto *node =
+                 description != nullptr
+                     ? workspace::find_ast_node(documents, *description)
+                     : nullptr;
+             node != nullptr) {
+    if (auto documentation = documentationProvider.getDocumentation(*node);
         documentation.has_value() && !documentation->empty()) {
       ::lsp::MarkupContent markup{};
       markup.kind = ::lsp::MarkupKind::Markdown;
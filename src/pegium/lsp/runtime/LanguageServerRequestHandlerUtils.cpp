@@ -106,6 +106,18 @@ void wait_until_phase(pegium::SharedServices &sharedServices,
   utils::throw_if_cancelled(cancelToken);
   ready.get();
 
+  // A snapshot version holding the latest text answers the request as the
+  // build in progress would, without waiting for it.
+  if (uri.has_value() &&
+      requiredState.consistency == ServiceRequirement::Consistency::Snapshot) {
+    if (const auto current =
+            find_current_snapshot_document(sharedServices, *uri);
+        current.has_value() &&
+        current->document->state >= requiredState.state) {
+      return;
+    }
+  }
+
   try {
     std::shared_ptr<workspace::Document> document;
     if (uri.has_value()) {
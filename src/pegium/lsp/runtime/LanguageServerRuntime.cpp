@@ -170,10 +170,39 @@ void addDiagnosticsHandler(::lsp::MessageHandler &messageHandler,
                                 .uri = document->uri,
                                 .text = std::string(document->textDocument().getText()),
                                 .version = document->textDocument().version(),
-                                .diagnostics = document->diagnostics,
+                                .diagnostics =
+                                    pegium::materialize(document->diagnostics),
                             },
                             textDocuments.get());
       }));
+
+  // Open documents also get the diagnostics of a validation still running, so
+  // that syntax errors show up without waiting for slow semantic checks; the
+  // Validated listener above publishes the complete set. Validators report
+  // at stage boundaries only, so this publishes at most a couple of times per
+  // document and build, straight from the document's text.
+  disposables.add(sharedServices.workspace.documentBuilder->onValidationProgress(
+      [&messageHandler, textDocuments = sharedServices.lsp.textDocuments](
+          const std::shared_ptr<workspace::Document> &document,
+          std::span<const pegium::CompactDiagnostic> pending,
+          utils::CancellationToken) {
+        assert(document != nullptr);
+        if (textDocuments == nullptr) {
+          return;
+        }
+        const auto &textDocument = document->textDocument();
+        if (const auto latest = textDocuments->getNormalized(document->uri);
+            latest == nullptr || latest->version() != textDocument.version()) {
+          return;
+        }
+        auto diagnostics = pegium::materialize(document->diagnostics);
+        diagnostics.reserve(diagnostics.size() + pending.size());
+        for (const auto &diagnostic : pending) {
+          diagnostics.push_back(diagnostic.materialize());
+        }
+        publish_diagnostics(&messageHandler, textDocument, diagnostics,
+                            textDocuments.get());
+      }));
 }
 
 void addDocumentUpdateHandler(::lsp::MessageHandler &messageHandler,
@@ -79,12 +79,15 @@ void addLanguageServerTextDocumentHandlers(
   const auto documentHighlightRequirement =
       serviceRequirements.DocumentHighlightProvider.value_or(
       WorkspaceState::IndexedReferences);
-  const auto renameRequirement =
-      serviceRequirements.RenameProvider.value_or(
+  // Rename and code actions produce edits against the latest text of every
+  // document they touch: they never answer from a snapshot.
+  auto renameRequirement = serviceRequirements.RenameProvider.value_or(
       WorkspaceState::IndexedReferences);
-  const auto codeActionRequirement =
+  renameRequirement.consistency = ServiceRequirement::Consistency::Latest;
+  auto codeActionRequirement =
       serviceRequirements.CodeActionProvider.value_or(
       workspace::DocumentState::Validated);
+  codeActionRequirement.consistency = ServiceRequirement::Consistency::Latest;
   const auto selectionRangeRequirement =
       serviceRequirements.SelectionRangeProvider.value_or(
       workspace::DocumentState::Parsed);
@@ -93,9 +96,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_Completion>(
           server, sharedServices, completionRequirement,
-          [&sharedServices](const ::lsp::CompletionParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getCompletion(sharedServices, params, cancelToken);
+          [&sharedServices, completionRequirement](
+              const ::lsp::CompletionParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getCompletion(sharedServices, params, cancelToken,
+                                 completionRequirement);
           },
           wrap_optional_payload<::lsp::TextDocument_CompletionResult>{}));
 
@@ -103,9 +108,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_SignatureHelp>(
           server, sharedServices, signatureHelpRequirement,
-          [&sharedServices](const ::lsp::SignatureHelpParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getSignatureHelp(sharedServices, params, cancelToken);
+          [&sharedServices, signatureHelpRequirement](
+              const ::lsp::SignatureHelpParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getSignatureHelp(sharedServices, params, cancelToken,
+                                    signatureHelpRequirement);
           },
           wrap_optional_payload<::lsp::TextDocument_SignatureHelpResult>{}));
 
@@ -113,9 +120,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_Hover>(
           server, sharedServices, hoverRequirement,
-          [&sharedServices](const ::lsp::HoverParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getHoverContent(sharedServices, params, cancelToken);
+          [&sharedServices, hoverRequirement](
+              const ::lsp::HoverParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getHoverContent(sharedServices, params, cancelToken,
+                                   hoverRequirement);
           },
           wrap_optional_payload<::lsp::TextDocument_HoverResult>{}));
 
@@ -123,9 +132,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_DocumentSymbol>(
           server, sharedServices, documentSymbolRequirement,
-          [&sharedServices](const ::lsp::DocumentSymbolParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getDocumentSymbols(sharedServices, params, cancelToken);
+          [&sharedServices, documentSymbolRequirement](
+              const ::lsp::DocumentSymbolParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getDocumentSymbols(sharedServices, params, cancelToken,
+                                      documentSymbolRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_DocumentSymbolResult>{}));
 
@@ -133,9 +144,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_CodeLens>(
           server, sharedServices, codeLensRequirement,
-          [&sharedServices](const ::lsp::CodeLensParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getCodeLens(sharedServices, params, cancelToken);
+          [&sharedServices, codeLensRequirement](
+              const ::lsp::CodeLensParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getCodeLens(sharedServices, params, cancelToken,
+                               codeLensRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_CodeLensResult>{}));
 
@@ -162,9 +175,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_DocumentLink>(
           server, sharedServices, documentLinkRequirement,
-          [&sharedServices](const ::lsp::DocumentLinkParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getDocumentLinks(sharedServices, params, cancelToken);
+          [&sharedServices, documentLinkRequirement](
+              const ::lsp::DocumentLinkParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getDocumentLinks(sharedServices, params, cancelToken,
+                                    documentLinkRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_DocumentLinkResult>{}));
 
@@ -172,9 +187,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_SelectionRange>(
           server, sharedServices, selectionRangeRequirement,
-          [&sharedServices](const ::lsp::SelectionRangeParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getSelectionRanges(sharedServices, params, cancelToken);
+          [&sharedServices, selectionRangeRequirement](
+              const ::lsp::SelectionRangeParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getSelectionRanges(sharedServices, params, cancelToken,
+                                      selectionRangeRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_SelectionRangeResult>{}));
 
@@ -182,9 +199,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_Formatting>(
           server, sharedServices, formatterRequirement,
-          [&sharedServices](const ::lsp::DocumentFormattingParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return formatDocument(sharedServices, params, cancelToken);
+          [&sharedServices, formatterRequirement](
+              const ::lsp::DocumentFormattingParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return formatDocument(sharedServices, params, cancelToken,
+                                  formatterRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_FormattingResult>{}));
 
@@ -192,10 +211,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_RangeFormatting>(
           server, sharedServices, formatterRequirement,
-          [&sharedServices](
+          [&sharedServices, formatterRequirement](
               const ::lsp::DocumentRangeFormattingParams &params,
               const utils::CancellationToken &cancelToken) {
-            return formatDocumentRange(sharedServices, params, cancelToken);
+            return formatDocumentRange(sharedServices, params, cancelToken,
+                                       formatterRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_RangeFormattingResult>{}));
 
@@ -203,10 +223,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_OnTypeFormatting>(
           server, sharedServices, formatterRequirement,
-          [&sharedServices](
+          [&sharedServices, formatterRequirement](
               const ::lsp::DocumentOnTypeFormattingParams &params,
               const utils::CancellationToken &cancelToken) {
-            return formatDocumentOnType(sharedServices, params, cancelToken);
+            return formatDocumentOnType(sharedServices, params, cancelToken,
+                                        formatterRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_OnTypeFormattingResult>{}));
 
@@ -214,9 +235,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_InlayHint>(
           server, sharedServices, inlayHintRequirement,
-          [&sharedServices](const ::lsp::InlayHintParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getInlayHints(sharedServices, params, cancelToken);
+          [&sharedServices, inlayHintRequirement](
+              const ::lsp::InlayHintParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getInlayHints(sharedServices, params, cancelToken,
+                                 inlayHintRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_InlayHintResult>{}));
 
@@ -224,9 +247,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_SemanticTokens_Full>(
           server, sharedServices, semanticTokenRequirement,
-          [&sharedServices](const ::lsp::SemanticTokensParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getSemanticTokensFull(sharedServices, params, cancelToken);
+          [&sharedServices, semanticTokenRequirement](
+              const ::lsp::SemanticTokensParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getSemanticTokensFull(sharedServices, params, cancelToken,
+                                         semanticTokenRequirement);
           },
           wrap_optional_payload<::lsp::TextDocument_SemanticTokens_FullResult>{}));
 
@@ -235,9 +260,11 @@ void addLanguageServerTextDocumentHandlers(
       create_request_handler<
           ::lsp::requests::TextDocument_SemanticTokens_Full_Delta>(
           server, sharedServices, semanticTokenRequirement,
-          [&sharedServices](const ::lsp::SemanticTokensDeltaParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getSemanticTokensDelta(sharedServices, params, cancelToken);
+          [&sharedServices, semanticTokenRequirement](
+              const ::lsp::SemanticTokensDeltaParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getSemanticTokensDelta(sharedServices, params, cancelToken,
+                                          semanticTokenRequirement);
           },
           wrap_optional_payload<
               ::lsp::TextDocument_SemanticTokens_Full_DeltaResult>{}));
@@ -247,9 +274,11 @@ void addLanguageServerTextDocumentHandlers(
       create_request_handler<
           ::lsp::requests::TextDocument_SemanticTokens_Range>(
           server, sharedServices, semanticTokenRequirement,
-          [&sharedServices](const ::lsp::SemanticTokensRangeParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getSemanticTokensRange(sharedServices, params, cancelToken);
+          [&sharedServices, semanticTokenRequirement](
+              const ::lsp::SemanticTokensRangeParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getSemanticTokensRange(sharedServices, params, cancelToken,
+                                          semanticTokenRequirement);
           },
           wrap_optional_payload<
               ::lsp::TextDocument_SemanticTokens_RangeResult>{}));
@@ -259,9 +288,11 @@ void addLanguageServerTextDocumentHandlers(
       create_request_handler<
           ::lsp::requests::TextDocument_PrepareCallHierarchy>(
           server, sharedServices, callHierarchyRequirement,
-          [&sharedServices](const ::lsp::CallHierarchyPrepareParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return prepareCallHierarchy(sharedServices, params, cancelToken);
+          [&sharedServices, callHierarchyRequirement](
+              const ::lsp::CallHierarchyPrepareParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return prepareCallHierarchy(sharedServices, params, cancelToken,
+                                        callHierarchyRequirement);
           },
           wrap_empty_vector_as_null<
               ::lsp::TextDocument_PrepareCallHierarchyResult>{}));
@@ -293,9 +324,11 @@ void addLanguageServerTextDocumentHandlers(
       create_request_handler<
           ::lsp::requests::TextDocument_PrepareTypeHierarchy>(
           server, sharedServices, typeHierarchyRequirement,
-          [&sharedServices](const ::lsp::TypeHierarchyPrepareParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return prepareTypeHierarchy(sharedServices, params, cancelToken);
+          [&sharedServices, typeHierarchyRequirement](
+              const ::lsp::TypeHierarchyPrepareParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return prepareTypeHierarchy(sharedServices, params, cancelToken,
+                                        typeHierarchyRequirement);
           },
           wrap_empty_vector_as_null<
               ::lsp::TextDocument_PrepareTypeHierarchyResult>{}));
@@ -326,9 +359,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_FoldingRange>(
           server, sharedServices, foldingRangeRequirement,
-          [&sharedServices](const ::lsp::FoldingRangeParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getFoldingRanges(sharedServices, params, cancelToken);
+          [&sharedServices, foldingRangeRequirement](
+              const ::lsp::FoldingRangeParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getFoldingRanges(sharedServices, params, cancelToken,
+                                    foldingRangeRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_FoldingRangeResult>{}));
 
@@ -336,9 +371,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_Declaration>(
           server, sharedServices, declarationRequirement,
-          [&sharedServices](const ::lsp::DeclarationParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getDeclaration(sharedServices, params, cancelToken);
+          [&sharedServices, declarationRequirement](
+              const ::lsp::DeclarationParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getDeclaration(sharedServices, params, cancelToken,
+                                  declarationRequirement);
           },
           wrap_optional_links<::lsp::TextDocument_DeclarationResult,
                               ::lsp::Declaration>{
@@ -348,9 +385,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_Definition>(
           server, sharedServices, definitionRequirement,
-          [&sharedServices](const ::lsp::DefinitionParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getDefinition(sharedServices, params, cancelToken);
+          [&sharedServices, definitionRequirement](
+              const ::lsp::DefinitionParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getDefinition(sharedServices, params, cancelToken,
+                                 definitionRequirement);
           },
           wrap_optional_links<::lsp::TextDocument_DefinitionResult,
                               ::lsp::Definition>{
@@ -360,9 +399,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_TypeDefinition>(
           server, sharedServices, typeDefinitionRequirement,
-          [&sharedServices](const ::lsp::TypeDefinitionParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getTypeDefinition(sharedServices, params, cancelToken);
+          [&sharedServices, typeDefinitionRequirement](
+              const ::lsp::TypeDefinitionParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getTypeDefinition(sharedServices, params, cancelToken,
+                                     typeDefinitionRequirement);
           },
           wrap_optional_links<::lsp::TextDocument_TypeDefinitionResult,
                               ::lsp::Definition>{
@@ -372,9 +413,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_Implementation>(
           server, sharedServices, implementationRequirement,
-          [&sharedServices](const ::lsp::ImplementationParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getImplementation(sharedServices, params, cancelToken);
+          [&sharedServices, implementationRequirement](
+              const ::lsp::ImplementationParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getImplementation(sharedServices, params, cancelToken,
+                                     implementationRequirement);
           },
           wrap_optional_links<::lsp::TextDocument_ImplementationResult,
                               ::lsp::Definition>{
@@ -384,9 +427,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_References>(
           server, sharedServices, referencesRequirement,
-          [&sharedServices](const ::lsp::ReferenceParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getReferences(sharedServices, params, cancelToken);
+          [&sharedServices, referencesRequirement](
+              const ::lsp::ReferenceParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getReferences(sharedServices, params, cancelToken,
+                                 referencesRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_ReferencesResult>{}));
 
@@ -394,9 +439,11 @@ void addLanguageServerTextDocumentHandlers(
       handler,
       create_request_handler<::lsp::requests::TextDocument_DocumentHighlight>(
           server, sharedServices, documentHighlightRequirement,
-          [&sharedServices](const ::lsp::DocumentHighlightParams &params,
-                            const utils::CancellationToken &cancelToken) {
-            return getDocumentHighlights(sharedServices, params, cancelToken);
+          [&sharedServices, documentHighlightRequirement](
+              const ::lsp::DocumentHighlightParams &params,
+              const utils::CancellationToken &cancelToken) {
+            return getDocumentHighlights(sharedServices, params, cancelToken,
+                                         documentHighlightRequirement);
           },
           wrap_vector_payload<::lsp::TextDocument_DocumentHighlightResult>{}));
 
@@ -9,6 +9,7 @@
 
 #include <pegium/lsp/runtime/internal/WorkspaceReadLock.hpp>
 #include <pegium/lsp/services/ServiceAccess.hpp>
+#include <pegium/lsp/services/ServiceRequirements.hpp>
 #include <pegium/lsp/support/JsonValue.hpp>
 
 namespace pegium {
@@ -19,15 +20,43 @@ constexpr std::string_view kCodeLensMetadataKey = "__pegiumCodeLens";
 constexpr std::string_view kCodeLensUriKey = "uri";
 constexpr std::string_view kCodeLensDataKey = "data";
 
+// Rename and code actions edit the latest text: never answered from a snapshot.
+constexpr ServiceRequirement kLatestRequirement{
+    ServiceRequirement::Type::Document, workspace::DocumentState::Changed,
+    ServiceRequirement::Consistency::Latest};
+
 struct WrappedCodeLens {
   std::string uri;
   ::lsp::CodeLens codeLens;
 };
 
+// Answers from the snapshot published by the last completed build when the
+// feature accepts one and the snapshot holds the latest text of the document
+// at the required state, as `wait_until_phase` does; otherwise reads the
+// workspace being built.
 template <typename Result, typename Accessor, typename Invoker>
 Result with_document_provider(const pegium::SharedServices &sharedServices,
-                              std::string uri, Accessor accessor,
-                              Invoker invoker) {
+                              std::string uri, ServiceRequirement requirement,
+                              Accessor accessor, Invoker invoker) {
+  if (requirement.consistency == ServiceRequirement::Consistency::Snapshot) {
+    if (const auto current =
+            find_current_snapshot_document(sharedServices, uri);
+        current.has_value() &&
+        current->document->state >= requirement.state) {
+      const workspace::WorkspaceSnapshot::Reader reader(*current->snapshot);
+      const auto *services =
+          get_services(*sharedServices.serviceRegistry, current->document->uri);
+      assert(services != nullptr);
+      const auto *provider = accessor(*services);
+      if (provider == nullptr) {
+        return Result{};
+      }
+      // Features read the parse result directly: restore it if a document
+      // not opened in the editor was evicted.
+      current->document->ensureResident();
+      return invoker(*provider, *current->document);
+    }
+  }
   return with_workspace_read_lock(
       sharedServices,
       [&sharedServices, uri = std::move(uri), &accessor,
@@ -43,6 +72,7 @@ Result with_document_provider(const pegium::SharedServices &sharedServices,
         if (provider == nullptr) {
           return Result{};
         }
+        document->ensureResident();
         return invoker(*provider, *document);
       });
 }
@@ -118,9 +148,10 @@ std::optional<WrappedCodeLens> unwrap_code_lens(const ::lsp::CodeLens &codeLens)
 std::optional<::lsp::CompletionList>
 getCompletion(const pegium::SharedServices &sharedServices,
               const ::lsp::CompletionParams &params,
-              const utils::CancellationToken &cancelToken) {
+              const utils::CancellationToken &cancelToken,
+              ServiceRequirement requirement) {
   return with_document_provider<std::optional<::lsp::CompletionList>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.completionProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -131,9 +162,10 @@ getCompletion(const pegium::SharedServices &sharedServices,
 std::optional<::lsp::SignatureHelp>
 getSignatureHelp(const pegium::SharedServices &sharedServices,
                  const ::lsp::SignatureHelpParams &params,
-                 const utils::CancellationToken &cancelToken) {
+                 const utils::CancellationToken &cancelToken,
+                 ServiceRequirement requirement) {
   return with_document_provider<std::optional<::lsp::SignatureHelp>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.signatureHelp.get();
       },
@@ -146,9 +178,10 @@ getSignatureHelp(const pegium::SharedServices &sharedServices,
 std::optional<::lsp::Hover>
 getHoverContent(const pegium::SharedServices &sharedServices,
                 const ::lsp::HoverParams &params,
-                const utils::CancellationToken &cancelToken) {
+                const utils::CancellationToken &cancelToken,
+                ServiceRequirement requirement) {
   return with_document_provider<std::optional<::lsp::Hover>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.hoverProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -159,9 +192,10 @@ getHoverContent(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::CodeLens>
 getCodeLens(const pegium::SharedServices &sharedServices,
             const ::lsp::CodeLensParams &params,
-            const utils::CancellationToken &cancelToken) {
+            const utils::CancellationToken &cancelToken,
+            ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::CodeLens>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.codeLensProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -220,9 +254,10 @@ resolveCodeLens(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::DocumentSymbol>
 getDocumentSymbols(const pegium::SharedServices &sharedServices,
                    const ::lsp::DocumentSymbolParams &params,
-                   const utils::CancellationToken &cancelToken) {
+                   const utils::CancellationToken &cancelToken,
+                   ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::DocumentSymbol>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.documentSymbolProvider.get();
       },
@@ -235,9 +270,10 @@ getDocumentSymbols(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::DocumentHighlight>
 getDocumentHighlights(const pegium::SharedServices &sharedServices,
                       const ::lsp::DocumentHighlightParams &params,
-                      const utils::CancellationToken &cancelToken) {
+                      const utils::CancellationToken &cancelToken,
+                      ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::DocumentHighlight>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.documentHighlightProvider.get();
       },
@@ -250,9 +286,10 @@ getDocumentHighlights(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::FoldingRange>
 getFoldingRanges(const pegium::SharedServices &sharedServices,
                  const ::lsp::FoldingRangeParams &params,
-                 const utils::CancellationToken &cancelToken) {
+                 const utils::CancellationToken &cancelToken,
+                 ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::FoldingRange>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.foldingRangeProvider.get();
       },
@@ -265,9 +302,10 @@ getFoldingRanges(const pegium::SharedServices &sharedServices,
 std::optional<std::vector<::lsp::LocationLink>>
 getDeclaration(const pegium::SharedServices &sharedServices,
                const ::lsp::DeclarationParams &params,
-               const utils::CancellationToken &cancelToken) {
+               const utils::CancellationToken &cancelToken,
+               ServiceRequirement requirement) {
   return with_document_provider<std::optional<std::vector<::lsp::LocationLink>>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.declarationProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -278,9 +316,10 @@ getDeclaration(const pegium::SharedServices &sharedServices,
 std::optional<std::vector<::lsp::LocationLink>>
 getDefinition(const pegium::SharedServices &sharedServices,
               const ::lsp::DefinitionParams &params,
-              const utils::CancellationToken &cancelToken) {
+              const utils::CancellationToken &cancelToken,
+              ServiceRequirement requirement) {
   return with_document_provider<std::optional<std::vector<::lsp::LocationLink>>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.definitionProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -291,9 +330,10 @@ getDefinition(const pegium::SharedServices &sharedServices,
 std::optional<std::vector<::lsp::LocationLink>>
 getTypeDefinition(const pegium::SharedServices &sharedServices,
                   const ::lsp::TypeDefinitionParams &params,
-                  const utils::CancellationToken &cancelToken) {
+                  const utils::CancellationToken &cancelToken,
+                  ServiceRequirement requirement) {
   return with_document_provider<std::optional<std::vector<::lsp::LocationLink>>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.typeProvider.get();
       },
@@ -306,9 +346,10 @@ getTypeDefinition(const pegium::SharedServices &sharedServices,
 std::optional<std::vector<::lsp::LocationLink>>
 getImplementation(const pegium::SharedServices &sharedServices,
                   const ::lsp::ImplementationParams &params,
-                  const utils::CancellationToken &cancelToken) {
+                  const utils::CancellationToken &cancelToken,
+                  ServiceRequirement requirement) {
   return with_document_provider<std::optional<std::vector<::lsp::LocationLink>>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.implementationProvider.get();
       },
@@ -321,9 +362,10 @@ getImplementation(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::Location>
 getReferences(const pegium::SharedServices &sharedServices,
               const ::lsp::ReferenceParams &params,
-              const utils::CancellationToken &cancelToken) {
+              const utils::CancellationToken &cancelToken,
+              ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::Location>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.referencesProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -336,7 +378,7 @@ rename(const pegium::SharedServices &sharedServices,
        const ::lsp::RenameParams &params,
        const utils::CancellationToken &cancelToken) {
   return with_document_provider<std::optional<::lsp::WorkspaceEdit>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), kLatestRequirement,
       [](const auto &services) { return services.lsp.renameProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -347,9 +389,10 @@ rename(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::TextEdit>
 formatDocument(const pegium::SharedServices &sharedServices,
                const ::lsp::DocumentFormattingParams &params,
-               const utils::CancellationToken &cancelToken) {
+               const utils::CancellationToken &cancelToken,
+               ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::TextEdit>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.formatter.get();
       },
@@ -362,9 +405,10 @@ formatDocument(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::TextEdit>
 formatDocumentRange(const pegium::SharedServices &sharedServices,
                     const ::lsp::DocumentRangeFormattingParams &params,
-                    const utils::CancellationToken &cancelToken) {
+                    const utils::CancellationToken &cancelToken,
+                    ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::TextEdit>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.formatter.get();
       },
@@ -377,9 +421,10 @@ formatDocumentRange(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::TextEdit>
 formatDocumentOnType(const pegium::SharedServices &sharedServices,
                      const ::lsp::DocumentOnTypeFormattingParams &params,
-                     const utils::CancellationToken &cancelToken) {
+                     const utils::CancellationToken &cancelToken,
+                     ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::TextEdit>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.formatter.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -390,9 +435,10 @@ formatDocumentOnType(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::InlayHint>
 getInlayHints(const pegium::SharedServices &sharedServices,
               const ::lsp::InlayHintParams &params,
-              const utils::CancellationToken &cancelToken) {
+              const utils::CancellationToken &cancelToken,
+              ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::InlayHint>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.inlayHintProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -403,9 +449,10 @@ getInlayHints(const pegium::SharedServices &sharedServices,
 std::optional<::lsp::SemanticTokens>
 getSemanticTokensFull(const pegium::SharedServices &sharedServices,
                       const ::lsp::SemanticTokensParams &params,
-                      const utils::CancellationToken &cancelToken) {
+                      const utils::CancellationToken &cancelToken,
+                      ServiceRequirement requirement) {
   return with_document_provider<std::optional<::lsp::SemanticTokens>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.semanticTokenProvider.get();
       },
@@ -418,9 +465,10 @@ getSemanticTokensFull(const pegium::SharedServices &sharedServices,
 std::optional<::lsp::SemanticTokens>
 getSemanticTokensRange(const pegium::SharedServices &sharedServices,
                        const ::lsp::SemanticTokensRangeParams &params,
-                       const utils::CancellationToken &cancelToken) {
+                       const utils::CancellationToken &cancelToken,
+                       ServiceRequirement requirement) {
   return with_document_provider<std::optional<::lsp::SemanticTokens>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.semanticTokenProvider.get();
       },
@@ -433,10 +481,11 @@ getSemanticTokensRange(const pegium::SharedServices &sharedServices,
 std::optional<::lsp::OneOf<::lsp::SemanticTokens, ::lsp::SemanticTokensDelta>>
 getSemanticTokensDelta(const pegium::SharedServices &sharedServices,
                        const ::lsp::SemanticTokensDeltaParams &params,
-                       const utils::CancellationToken &cancelToken) {
+                       const utils::CancellationToken &cancelToken,
+                       ServiceRequirement requirement) {
   return with_document_provider<
       std::optional<::lsp::OneOf<::lsp::SemanticTokens, ::lsp::SemanticTokensDelta>>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) { return services.lsp.semanticTokenProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -466,9 +515,10 @@ executeCommand(pegium::SharedServices &sharedServices,
 std::vector<::lsp::CallHierarchyItem>
 prepareCallHierarchy(const pegium::SharedServices &sharedServices,
                      const ::lsp::CallHierarchyPrepareParams &params,
-                     const utils::CancellationToken &cancelToken) {
+                     const utils::CancellationToken &cancelToken,
+                     ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::CallHierarchyItem>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.callHierarchyProvider.get();
       },
@@ -509,9 +559,10 @@ getOutgoingCalls(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::TypeHierarchyItem>
 prepareTypeHierarchy(const pegium::SharedServices &sharedServices,
                      const ::lsp::TypeHierarchyPrepareParams &params,
-                     const utils::CancellationToken &cancelToken) {
+                     const utils::CancellationToken &cancelToken,
+                     ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::TypeHierarchyItem>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.typeHierarchyProvider.get();
       },
@@ -555,7 +606,7 @@ getCodeActions(const pegium::SharedServices &sharedServices,
                const utils::CancellationToken &cancelToken) {
   return with_document_provider<
       std::optional<std::vector<::lsp::OneOf<::lsp::Command, ::lsp::CodeAction>>>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), kLatestRequirement,
       [](const auto &services) { return services.lsp.codeActionProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -566,9 +617,10 @@ getCodeActions(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::DocumentLink>
 getDocumentLinks(const pegium::SharedServices &sharedServices,
                  const ::lsp::DocumentLinkParams &params,
-                 const utils::CancellationToken &cancelToken) {
+                 const utils::CancellationToken &cancelToken,
+                 ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::DocumentLink>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.documentLinkProvider.get();
       },
@@ -581,9 +633,10 @@ getDocumentLinks(const pegium::SharedServices &sharedServices,
 std::vector<::lsp::SelectionRange>
 getSelectionRanges(const pegium::SharedServices &sharedServices,
                    const ::lsp::SelectionRangeParams &params,
-                   const utils::CancellationToken &cancelToken) {
+                   const utils::CancellationToken &cancelToken,
+                   ServiceRequirement requirement) {
   return with_document_provider<std::vector<::lsp::SelectionRange>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), requirement,
       [](const auto &services) {
         return services.lsp.selectionRangeProvider.get();
       },
@@ -598,7 +651,7 @@ prepareRename(const pegium::SharedServices &sharedServices,
               const ::lsp::PrepareRenameParams &params,
               const utils::CancellationToken &cancelToken) {
   return with_document_provider<std::optional<::lsp::PrepareRenameResult>>(
-      sharedServices, params.textDocument.uri.toString(),
+      sharedServices, params.textDocument.uri.toString(), kLatestRequirement,
       [](const auto &services) { return services.lsp.renameProvider.get(); },
       [&params, &cancelToken](const auto &provider,
                               const workspace::Document &document) {
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 #include <optional>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
 #include <pegium/core/workspace/WorkspaceLock.hpp>
+#include <pegium/core/workspace/WorkspaceSnapshot.hpp>
 #include <pegium/lsp/services/SharedServices.hpp>
 
 namespace pegium {
@@ -33,4 +36,42 @@ with_workspace_read_lock(const pegium::SharedServices &sharedServices,
   }
 }
 
+/// Document version a request can read from the last published snapshot.
+struct SnapshotDocument {
+  std::shared_ptr<const workspace::WorkspaceSnapshot> snapshot;
+  std::shared_ptr<const workspace::Document> document;
+};
+
+/// Returns the snapshot version of `uri` when it still holds the latest text of
+/// the document: the open text when the client manages it, the stored version
+/// otherwise. Requests on such a version need neither the workspace lock nor
+/// the build in progress.
+inline std::optional<SnapshotDocument>
+find_current_snapshot_document(const pegium::SharedServices &sharedServices,
+                               std::string_view uri) {
+  auto snapshot = sharedServices.workspace.documentBuilder->snapshot();
+  if (snapshot == nullptr) {
+    return std::nullopt;
+  }
+  auto document = snapshot->getDocument(uri);
+  if (document == nullptr) {
+    return std::nullopt;
+  }
+  if (const auto *textDocuments = sharedServices.workspace.textDocuments.get();
+      textDocuments != nullptr) {
+    if (const auto openText = textDocuments->getNormalized(document->uri);
+        openText != nullptr) {
+      if (openText->contentHash() != document->textDocument().contentHash()) {
+        return std::nullopt;
+      }
+      return SnapshotDocument{std::move(snapshot), std::move(document)};
+    }
+  }
+  if (sharedServices.workspace.documents->getDocument(document->id) !=
+      document) {
+    return std::nullopt;
+  }
+  return SnapshotDocument{std::move(snapshot), std::move(document)};
+}
+
 } // namespace pegium
@@ -252,6 +252,11 @@ AbstractSemanticTokenProvider::AbstractSemanticTokenProvider(
       });
 }
 
+void AbstractSemanticTokenProvider::disposeSubscriptions() noexcept {
+  _languageServerInitializeSubscription.dispose();
+  _textDocumentCloseSubscription.dispose();
+}
+
 AbstractSemanticTokenProvider::StringIndexMap
 AbstractSemanticTokenProvider::tokenTypes() const {
   return semantic_token_types();
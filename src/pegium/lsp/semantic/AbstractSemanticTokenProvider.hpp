@@ -58,6 +58,8 @@ public:
                          const ::lsp::SemanticTokensDeltaParams &params,
                          const utils::CancellationToken &cancelToken) const override;
 
+  void disposeSubscriptions() noexcept override;
+
 protected:
   /// Emits semantic tokens for `node`.
   virtual void highlightElement(const AstNode &node,
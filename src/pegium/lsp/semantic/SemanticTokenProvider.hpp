@@ -65,6 +65,10 @@ public:
     (void)cancelToken;
     return std::nullopt;
   }
+
+  /// Stops observing language-server and text-document events. Called when
+  /// the language services owning this provider are replaced.
+  virtual void disposeSubscriptions() noexcept {}
 };
 
 } // namespace pegium
@@ -16,6 +16,12 @@
 /// each other or with in-flight builds. The query functions take a
 /// `const SharedServices&` (they only read language state); `executeCommand`
 /// takes a non-const reference, since running a command may change it.
+///
+/// Features that take a `ServiceRequirement` may answer from the snapshot
+/// published by the last completed build, if the requirement accepts a snapshot
+/// and that snapshot holds the latest text of the document at the required
+/// state; otherwise they read the workspace being built. Rename, prepare rename
+/// and code actions always read the latest text.
 
 #include <optional>
 #include <string>
@@ -23,6 +29,7 @@
 
 #include <lsp/types.h>
 
+#include <pegium/lsp/services/ServiceRequirements.hpp>
 #include <pegium/lsp/services/Services.hpp>
 #include <pegium/lsp/services/SharedServices.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
@@ -34,28 +41,32 @@ namespace pegium {
 getCompletion(const pegium::SharedServices &sharedServices,
               const ::lsp::CompletionParams &params,
               const utils::CancellationToken &cancelToken =
-                  utils::default_cancel_token);
+                  utils::default_cancel_token,
+              ServiceRequirement requirement = {});
 
 /// Resolves signature help for one cursor position.
 [[nodiscard]] std::optional<::lsp::SignatureHelp>
 getSignatureHelp(const pegium::SharedServices &sharedServices,
                  const ::lsp::SignatureHelpParams &params,
                  const utils::CancellationToken &cancelToken =
-                     utils::default_cancel_token);
+                     utils::default_cancel_token,
+                 ServiceRequirement requirement = {});
 
 /// Resolves hover content for one cursor position.
 [[nodiscard]] std::optional<::lsp::Hover>
 getHoverContent(const pegium::SharedServices &sharedServices,
                 const ::lsp::HoverParams &params,
                 const utils::CancellationToken &cancelToken =
-                    utils::default_cancel_token);
+                    utils::default_cancel_token,
+                ServiceRequirement requirement = {});
 
 /// Computes code lenses for one document.
 [[nodiscard]] std::vector<::lsp::CodeLens>
 getCodeLens(const pegium::SharedServices &sharedServices,
             const ::lsp::CodeLensParams &params,
             const utils::CancellationToken &cancelToken =
-                utils::default_cancel_token);
+                utils::default_cancel_token,
+            ServiceRequirement requirement = {});
 
 /// Resolves deferred metadata for one code lens.
 [[nodiscard]] std::optional<::lsp::CodeLens>
@@ -69,56 +80,64 @@ resolveCodeLens(const pegium::SharedServices &sharedServices,
 getDocumentSymbols(const pegium::SharedServices &sharedServices,
                    const ::lsp::DocumentSymbolParams &params,
                    const utils::CancellationToken &cancelToken =
-                       utils::default_cancel_token);
+                       utils::default_cancel_token,
+                   ServiceRequirement requirement = {});
 
 /// Computes highlight ranges at one cursor position.
 [[nodiscard]] std::vector<::lsp::DocumentHighlight>
 getDocumentHighlights(const pegium::SharedServices &sharedServices,
                       const ::lsp::DocumentHighlightParams &params,
                       const utils::CancellationToken &cancelToken =
-                          utils::default_cancel_token);
+                          utils::default_cancel_token,
+                      ServiceRequirement requirement = {});
 
 /// Computes folding ranges for one document.
 [[nodiscard]] std::vector<::lsp::FoldingRange>
 getFoldingRanges(const pegium::SharedServices &sharedServices,
                  const ::lsp::FoldingRangeParams &params,
                  const utils::CancellationToken &cancelToken =
-                     utils::default_cancel_token);
+                     utils::default_cancel_token,
+                 ServiceRequirement requirement = {});
 
 /// Resolves declaration targets for one cursor position.
 [[nodiscard]] std::optional<std::vector<::lsp::LocationLink>>
 getDeclaration(const pegium::SharedServices &sharedServices,
                const ::lsp::DeclarationParams &params,
                const utils::CancellationToken &cancelToken =
-                   utils::default_cancel_token);
+                   utils::default_cancel_token,
+               ServiceRequirement requirement = {});
 
 /// Resolves definition targets for one cursor position.
 [[nodiscard]] std::optional<std::vector<::lsp::LocationLink>>
 getDefinition(const pegium::SharedServices &sharedServices,
               const ::lsp::DefinitionParams &params,
               const utils::CancellationToken &cancelToken =
-                  utils::default_cancel_token);
+                  utils::default_cancel_token,
+              ServiceRequirement requirement = {});
 
 /// Resolves type-definition targets for one cursor position.
 [[nodiscard]] std::optional<std::vector<::lsp::LocationLink>>
 getTypeDefinition(const pegium::SharedServices &sharedServices,
                   const ::lsp::TypeDefinitionParams &params,
                   const utils::CancellationToken &cancelToken =
-                      utils::default_cancel_token);
+                      utils::default_cancel_token,
+                  ServiceRequirement requirement = {});
 
 /// Resolves implementation targets for one cursor position.
 [[nodiscard]] std::optional<std::vector<::lsp::LocationLink>>
 getImplementation(const pegium::SharedServices &sharedServices,
                   const ::lsp::ImplementationParams &params,
                   const utils::CancellationToken &cancelToken =
-                      utils::default_cancel_token);
+                      utils::default_cancel_token,
+                  ServiceRequirement requirement = {});
 
 /// Resolves all references reachable from one cursor position.
 [[nodiscard]] std::vector<::lsp::Location>
 getReferences(const pegium::SharedServices &sharedServices,
               const ::lsp::ReferenceParams &params,
               const utils::CancellationToken &cancelToken =
-                  utils::default_cancel_token);
+                  utils::default_cancel_token,
+              ServiceRequirement requirement = {});
 
 /// Computes the workspace edit for a rename request.
 [[nodiscard]] std::optional<::lsp::WorkspaceEdit>
@@ -132,49 +151,56 @@ rename(const pegium::SharedServices &sharedServices,
 formatDocument(const pegium::SharedServices &sharedServices,
                const ::lsp::DocumentFormattingParams &params,
                const utils::CancellationToken &cancelToken =
-                   utils::default_cancel_token);
+                   utils::default_cancel_token,
+               ServiceRequirement requirement = {});
 
 /// Formats one document range.
 [[nodiscard]] std::vector<::lsp::TextEdit>
 formatDocumentRange(const pegium::SharedServices &sharedServices,
                     const ::lsp::DocumentRangeFormattingParams &params,
                     const utils::CancellationToken &cancelToken =
-                        utils::default_cancel_token);
+                        utils::default_cancel_token,
+                    ServiceRequirement requirement = {});
 
 /// Formats one document after a trigger character was typed.
 [[nodiscard]] std::vector<::lsp::TextEdit>
 formatDocumentOnType(const pegium::SharedServices &sharedServices,
                      const ::lsp::DocumentOnTypeFormattingParams &params,
                      const utils::CancellationToken &cancelToken =
-                         utils::default_cancel_token);
+                         utils::default_cancel_token,
+                     ServiceRequirement requirement = {});
 
 /// Computes inlay hints for one document range.
 [[nodiscard]] std::vector<::lsp::InlayHint>
 getInlayHints(const pegium::SharedServices &sharedServices,
               const ::lsp::InlayHintParams &params,
               const utils::CancellationToken &cancelToken =
-                  utils::default_cancel_token);
+                  utils::default_cancel_token,
+              ServiceRequirement requirement = {});
 
 /// Computes a full semantic-token snapshot.
 [[nodiscard]] std::optional<::lsp::SemanticTokens>
 getSemanticTokensFull(const pegium::SharedServices &sharedServices,
                       const ::lsp::SemanticTokensParams &params,
                       const utils::CancellationToken &cancelToken =
-                          utils::default_cancel_token);
+                          utils::default_cancel_token,
+                      ServiceRequirement requirement = {});
 
 /// Computes semantic tokens for one document range.
 [[nodiscard]] std::optional<::lsp::SemanticTokens>
 getSemanticTokensRange(const pegium::SharedServices &sharedServices,
                        const ::lsp::SemanticTokensRangeParams &params,
                        const utils::CancellationToken &cancelToken =
-                           utils::default_cancel_token);
+                           utils::default_cancel_token,
+                       ServiceRequirement requirement = {});
 
 /// Computes a semantic-token delta from a previous result id.
 [[nodiscard]] std::optional<::lsp::OneOf<::lsp::SemanticTokens, ::lsp::SemanticTokensDelta>>
 getSemanticTokensDelta(const pegium::SharedServices &sharedServices,
                        const ::lsp::SemanticTokensDeltaParams &params,
                        const utils::CancellationToken &cancelToken =
-                           utils::default_cancel_token);
+                           utils::default_cancel_token,
+                       ServiceRequirement requirement = {});
 
 /// Lists executable command identifiers exposed by the language.
 [[nodiscard]] std::vector<std::string>
@@ -192,7 +218,8 @@ executeCommand(pegium::SharedServices &sharedServices,
 prepareCallHierarchy(const pegium::SharedServices &sharedServices,
                      const ::lsp::CallHierarchyPrepareParams &params,
                      const utils::CancellationToken &cancelToken =
-                         utils::default_cancel_token);
+                         utils::default_cancel_token,
+                     ServiceRequirement requirement = {});
 
 /// Resolves incoming calls for one call-hierarchy item.
 [[nodiscard]] std::vector<::lsp::CallHierarchyIncomingCall>
@@ -213,7 +240,8 @@ getOutgoingCalls(const pegium::SharedServices &sharedServices,
 prepareTypeHierarchy(const pegium::SharedServices &sharedServices,
                      const ::lsp::TypeHierarchyPrepareParams &params,
                      const utils::CancellationToken &cancelToken =
-                         utils::default_cancel_token);
+                         utils::default_cancel_token,
+                     ServiceRequirement requirement = {});
 
 /// Resolves direct supertypes for one type-hierarchy item.
 [[nodiscard]] std::vector<::lsp::TypeHierarchyItem>
@@ -242,14 +270,16 @@ getCodeActions(const pegium::SharedServices &sharedServices,
 getDocumentLinks(const pegium::SharedServices &sharedServices,
                  const ::lsp::DocumentLinkParams &params,
                  const utils::CancellationToken &cancelToken =
-                     utils::default_cancel_token);
+                     utils::default_cancel_token,
+                 ServiceRequirement requirement = {});
 
 /// Computes selection ranges for one or more cursor positions.
 [[nodiscard]] std::vector<::lsp::SelectionRange>
 getSelectionRanges(const pegium::SharedServices &sharedServices,
                    const ::lsp::SelectionRangeParams &params,
                    const utils::CancellationToken &cancelToken =
-                       utils::default_cancel_token);
+                       utils::default_cancel_token,
+                   ServiceRequirement requirement = {});
 
 /// Checks whether the symbol at the cursor can be renamed.
 [[nodiscard]] std::optional<::lsp::PrepareRenameResult>
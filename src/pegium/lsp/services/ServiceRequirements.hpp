@@ -9,6 +9,11 @@ namespace pegium {
 /// Minimum analysis phase required before invoking one LSP feature.
 struct ServiceRequirement {
   enum class Type { Document, Workspace };
+  /// Whether a request may be answered from the snapshot published by the
+  /// last completed build (see `BuildOptions::isolateSnapshots`) when that
+  /// snapshot still holds the latest text of the requested document, instead
+  /// of waiting for the build in progress.
+  enum class Consistency { Snapshot, Latest };
 
   constexpr ServiceRequirement() noexcept = default;
   constexpr ServiceRequirement(workspace::DocumentState state) noexcept
@@ -16,9 +21,13 @@ struct ServiceRequirement {
   constexpr ServiceRequirement(Type type,
                                workspace::DocumentState state) noexcept
       : type(type), state(state) {}
+  constexpr ServiceRequirement(Type type, workspace::DocumentState state,
+                               Consistency consistency) noexcept
+      : type(type), state(state), consistency(consistency) {}
 
   Type type = Type::Document;
   workspace::DocumentState state = workspace::DocumentState::Changed;
+  Consistency consistency = Consistency::Snapshot;
 };
 
 namespace WorkspaceState {
@@ -9,4 +9,11 @@ Services::Services(const SharedServices &sharedServices)
 
 Services::~Services() noexcept = default;
 
+void Services::retire() noexcept {
+  CoreServices::retire();
+  if (lsp.semanticTokenProvider != nullptr) {
+    lsp.semanticTokenProvider->disposeSubscriptions();
+  }
+}
+
 } // namespace pegium
@@ -91,6 +91,8 @@ struct Services : pegium::CoreServices {
   Services &operator=(const Services &) = delete;
   ~Services() noexcept override;
 
+  void retire() noexcept override;
+
   const SharedServices &shared;
   LspFeatureServices lsp;
 };
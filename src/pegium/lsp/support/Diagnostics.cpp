@@ -1,6 +1,7 @@
 #include <pegium/lsp/support/Diagnostics.hpp>
 
 #include <limits>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -36,6 +37,28 @@ constexpr int clamp_to_lsp_integer(std::int64_t value) noexcept {
   return ::lsp::DiagnosticTag::Unnecessary;
 }
 
+void send_diagnostics(::lsp::MessageHandler &messageHandler,
+                      const std::string &uri,
+                      std::optional<std::int64_t> version,
+                      const workspace::TextDocument &positionDocument,
+                      std::span<const Diagnostic> diagnostics,
+                      const workspace::TextDocumentProvider *crossFileProvider) {
+  ::lsp::notifications::TextDocument_PublishDiagnostics::Params params{};
+  params.uri = ::lsp::Uri::parse(uri);
+  params.diagnostics.reserve(diagnostics.size());
+  if (version.has_value()) {
+    params.version = clamp_to_lsp_integer(*version);
+  }
+  for (const auto &diagnostic : diagnostics) {
+    params.diagnostics.push_back(
+        to_lsp_diagnostic(positionDocument, diagnostic, crossFileProvider));
+  }
+
+  messageHandler
+      .sendNotification<::lsp::notifications::TextDocument_PublishDiagnostics>(
+          std::move(params));
+}
+
 } // namespace
 
 ::lsp::Diagnostic
@@ -119,24 +142,22 @@ void publish_diagnostics(
   if (messageHandler == nullptr) {
     return;
   }
-
-  ::lsp::notifications::TextDocument_PublishDiagnostics::Params params{};
-  params.uri = ::lsp::Uri::parse(snapshot.uri);
-  params.diagnostics.reserve(snapshot.diagnostics.size());
-  if (snapshot.version.has_value()) {
-    params.version = clamp_to_lsp_integer(*snapshot.version);
-  }
-  auto positionDocument =
+  const auto positionDocument =
       workspace::TextDocument::create(snapshot.uri, "", 0, snapshot.text);
+  send_diagnostics(*messageHandler, snapshot.uri, snapshot.version,
+                   positionDocument, snapshot.diagnostics, crossFileProvider);
+}
 
-  for (const auto &diagnostic : snapshot.diagnostics) {
-    params.diagnostics.push_back(
-        to_lsp_diagnostic(positionDocument, diagnostic, crossFileProvider));
+void publish_diagnostics(
+    ::lsp::MessageHandler *messageHandler,
+    const workspace::TextDocument &document,
+    std::span<const Diagnostic> diagnostics,
+    const workspace::TextDocumentProvider *crossFileProvider) {
+  if (messageHandler == nullptr) {
+    return;
   }
-
-  messageHandler
-      ->sendNotification<::lsp::notifications::TextDocument_PublishDiagnostics>(
-          std::move(params));
+  send_diagnostics(*messageHandler, document.uri(), document.version(),
+                   document, diagnostics, crossFileProvider);
 }
 
 } // namespace pegium
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include <lsp/types.h>
 
 #include <pegium/core/workspace/DocumentUpdate.hpp>
@@ -33,4 +35,12 @@ void publish_diagnostics(
     const workspace::DocumentDiagnosticsSnapshot &snapshot,
     const workspace::TextDocumentProvider *crossFileProvider = nullptr);
 
+/// Publishes `diagnostics` for `document` at its version, converting their
+/// positions against `document` itself rather than a copy of its text.
+void publish_diagnostics(
+    ::lsp::MessageHandler *messageHandler,
+    const workspace::TextDocument &document,
+    std::span<const Diagnostic> diagnostics,
+    const workspace::TextDocumentProvider *crossFileProvider = nullptr);
+
 } // namespace pegium
@@ -7,6 +7,7 @@
 #include <pegium/core/references/NameProvider.hpp>
 #include <pegium/core/services/CoreServices.hpp>
 #include <pegium/core/services/ServiceRegistry.hpp>
+#include <pegium/core/workspace/AstDescriptions.hpp>
 #include <pegium/core/workspace/Document.hpp>
 #include <pegium/lsp/services/SharedServices.hpp>
 
@@ -21,9 +22,12 @@ symbol_location(const pegium::SharedServices &sharedServices,
   // hands back a value copy, so a reader (especially one calling this read API
   // outside the workspace lock) can hold an entry whose document was deleted
   // since. Skip it rather than dereferencing a null document.
+  // Likewise, the entry may come from a newer revision of the document than
+  // the snapshot being read holds.
   const auto document =
       sharedServices.workspace.documents->getDocument(entry.documentId);
-  if (document == nullptr) {
+  if (document == nullptr ||
+      !workspace::describes_revision_of(*document, entry)) {
     return std::nullopt;
   }
 
@@ -75,7 +79,7 @@ DefaultWorkspaceSymbolProvider::getSymbols(
     }
 
     ::lsp::WorkspaceSymbol workspaceSymbol{};
-    workspaceSymbol.name = entry.name;
+    workspaceSymbol.name = entry.name.str();
     workspaceSymbol.kind = nodeKindProvider.getSymbolKind(entry);
     workspaceSymbol.location = std::move(*location);
     symbols.push_back(std::move(workspaceSymbol));
@@ -1,5 +1,6 @@
 #include <pegium/lsp/workspace/DefaultDocumentUpdateHandler.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <future>
 #include <mutex>
@@ -189,8 +190,14 @@ void DefaultDocumentUpdateHandler::quiesce() {
   // since those listeners run on these dispatch threads. The WorkspaceLock
   // requires owners to quiesce their handlers before destruction; a dispatch
   // resuming from write()/ready() on destroyed state would be a use-after-free.
-  // Cancel any pending/in-progress write so a dispatch blocked in write()
-  // unblocks, then wait for every dispatch to finish. Idempotent.
+  // Drop the update still waiting for its delay, cancel any pending/in-progress
+  // write so a dispatch blocked in write() unblocks, then wait for every
+  // dispatch to finish. Idempotent.
+  {
+    std::scoped_lock lock(_queueMutex);
+    _quiescing = true;
+  }
+  _queueChanged.notify_all();
   if (shared.workspace.workspaceLock != nullptr) {
     shared.workspace.workspaceLock->cancelWrite();
   }
@@ -204,6 +211,8 @@ void DefaultDocumentUpdateHandler::quiesce() {
       dispatch.wait();
     }
   }
+  std::scoped_lock lock(_queueMutex);
+  _quiescing = false;
 }
 
 DefaultDocumentUpdateHandler::~DefaultDocumentUpdateHandler() { quiesce(); }
@@ -243,62 +252,73 @@ void DefaultDocumentUpdateHandler::didChangeContent(
                      event.document);
 }
 
+void DefaultDocumentUpdateHandler::PendingUpdate::change(
+    workspace::DocumentId documentId,
+    std::shared_ptr<const workspace::TextDocument> redundantWhenUnchanged) {
+  if (deletedDocumentIdSet.erase(documentId) != 0) {
+    std::erase(deletedDocumentIds, documentId);
+  }
+  if (changedDocumentIdSet.insert(documentId).second) {
+    changedDocumentIds.push_back(documentId);
+    this->redundantWhenUnchanged[documentId] =
+        std::move(redundantWhenUnchanged);
+    return;
+  }
+  // A forced rebuild stays forced; otherwise the newest text decides.
+  if (auto &current = this->redundantWhenUnchanged[documentId];
+      current != nullptr) {
+    current = std::move(redundantWhenUnchanged);
+  }
+}
+
+void DefaultDocumentUpdateHandler::PendingUpdate::remove(
+    workspace::DocumentId documentId) {
+  if (changedDocumentIdSet.erase(documentId) != 0) {
+    std::erase(changedDocumentIds, documentId);
+    redundantWhenUnchanged.erase(documentId);
+  }
+  if (deletedDocumentIdSet.insert(documentId).second) {
+    deletedDocumentIds.push_back(documentId);
+  }
+}
+
+void DefaultDocumentUpdateHandler::PendingUpdate::merge(
+    const PendingUpdate &newer) {
+  for (const auto documentId : newer.deletedDocumentIds) {
+    remove(documentId);
+  }
+  for (const auto documentId : newer.changedDocumentIds) {
+    const auto it = newer.redundantWhenUnchanged.find(documentId);
+    change(documentId,
+           it == newer.redundantWhenUnchanged.end() ? nullptr : it->second);
+  }
+}
+
 void DefaultDocumentUpdateHandler::fireDocumentUpdate(
     std::vector<workspace::DocumentId> changedDocumentIds,
     std::vector<workspace::DocumentId> deletedDocumentIds,
     std::shared_ptr<const workspace::TextDocument> redundantWhenUnchanged) {
-  // Capture the reporting document id before the id vectors are moved into the
-  // worker (and then the write action), so a failure can still identify the
-  // document instead of reporting on moved-from (empty) vectors.
-  const auto reportDocumentId =
-      select_update_document_id(changedDocumentIds, deletedDocumentIds);
-  auto future = std::async(
-      std::launch::async,
-      [this, reportDocumentId,
-       changedDocumentIds = std::move(changedDocumentIds),
-       deletedDocumentIds = std::move(deletedDocumentIds),
-       redundantWhenUnchanged = std::move(redundantWhenUnchanged)]() mutable {
-        try {
-          // `ready()` only guarantees that startup documents were discovered
-          // and materialized. The tail of the initial build may still be
-          // running here and can be superseded by this newer workspace write.
-          auto ready = shared.workspace.workspaceManager->ready();
-          ready.get();
-          auto writeFuture = shared.workspace.workspaceLock->write(
-              [this, changedDocumentIds = std::move(changedDocumentIds),
-               deletedDocumentIds = std::move(deletedDocumentIds),
-               redundantWhenUnchanged = std::move(redundantWhenUnchanged)](
-                  const utils::CancellationToken &cancelToken,
-                  const workspace::WorkspaceLock::Downgrade &downgrade) mutable {
-                // Under the write lock the workspace Document is exclusive, so
-                // this redundancy check cannot race the build. It runs here —
-                // after this write supersedes any in-flight build — rather than
-                // before the write, which would deadlock behind a build that
-                // only this write supersedes.
-                if (redundantWhenUnchanged != nullptr &&
-                    is_redundant_text_snapshot(*shared.workspace.documents,
-                                               *redundantWhenUnchanged)) {
-                  return;
-                }
-                applyDocumentUpdate(std::move(changedDocumentIds),
-                                    std::move(deletedDocumentIds), cancelToken,
-                                    downgrade);
-              });
-          writeFuture.get();
-        } catch (const utils::OperationCancelled &) {
-        } catch (const std::exception &error) {
-          publish_document_update_dispatch_failed(
-              shared, reportDocumentId,
-              "Workspace initialization failed. Could not perform document "
-              "update: " +
-                  std::string(error.what()));
-        } catch (...) {
-          publish_document_update_dispatch_failed(
-              shared, reportDocumentId,
-              "Workspace initialization failed. Could not perform document "
-              "update.");
-        }
-      });
+  {
+    std::scoped_lock lock(_queueMutex);
+    for (const auto documentId : deletedDocumentIds) {
+      _pending.remove(documentId);
+    }
+    for (const auto documentId : changedDocumentIds) {
+      _pending.change(documentId, redundantWhenUnchanged);
+    }
+    _lastNotification = Clock::now();
+    if (_dispatchScheduled) {
+      // The scheduled dispatch takes these documents with the others; it only
+      // has to re-evaluate its delay.
+      _queueChanged.notify_all();
+      return;
+    }
+    _dispatchScheduled = true;
+    _dispatchScheduledAt = _lastNotification;
+  }
+
+  auto future = std::async(std::launch::async,
+                           [this]() { dispatchPendingUpdate(); });
   // Keep the dispatch future so the destructor can wait for it; prune the
   // already-finished ones. The task reports its own failures internally, so it
   // does not need observe_background_task here.
@@ -310,6 +330,176 @@ void DefaultDocumentUpdateHandler::fireDocumentUpdate(
   _dispatches.push_back(std::move(future));
 }
 
+void DefaultDocumentUpdateHandler::dispatchPendingUpdate() {
+  PendingUpdate update;
+  std::uint64_t generation = 0;
+  try {
+    // `ready()` only guarantees that startup documents were discovered
+    // and materialized. The tail of the initial build may still be
+    // running here and can be superseded by this newer workspace write.
+    auto ready = shared.workspace.workspaceManager->ready();
+    ready.get();
+
+    std::unique_lock lock(_queueMutex);
+    // Wait until no notification arrived for the adaptive delay, but no longer
+    // than the maximum delay since this dispatch was scheduled.
+    while (!_quiescing) {
+      const auto options = debounceOptions(_pending);
+      const auto wakeAt =
+          std::min(_lastNotification + updateDelayLocked(_pending, options),
+                   _dispatchScheduledAt + options.maxDelay);
+      if (Clock::now() >= wakeAt) {
+        break;
+      }
+      _queueChanged.wait_until(lock, wakeAt);
+    }
+    _dispatchScheduled = false;
+    if (_quiescing || _pending.empty()) {
+      _pending = {};
+      return;
+    }
+    // The write below cancels the previous update if it is still running:
+    // take its documents over so none of its changes is lost.
+    update = std::move(_inFlight);
+    update.supersedes = !update.empty();
+    update.merge(_pending);
+    _pending = {};
+    _inFlight = update;
+    generation = ++_inFlightGeneration;
+  } catch (const std::exception &error) {
+    {
+      std::scoped_lock lock(_queueMutex);
+      update = std::move(_pending);
+      _pending = {};
+      _dispatchScheduled = false;
+    }
+    publish_document_update_dispatch_failed(
+        shared,
+        select_update_document_id(update.changedDocumentIds,
+                                  update.deletedDocumentIds),
+        "Workspace initialization failed. Could not perform document "
+        "update: " +
+            std::string(error.what()));
+    return;
+  }
+
+  // Capture the reporting document id before the update is moved into the
+  // write action, so a failure can still identify the document instead of
+  // reporting on moved-from (empty) vectors.
+  const auto reportDocumentId = select_update_document_id(
+      update.changedDocumentIds, update.deletedDocumentIds);
+  try {
+    auto writeFuture = shared.workspace.workspaceLock->write(
+        [this, generation, update = std::move(update)](
+            const utils::CancellationToken &cancelToken,
+            const workspace::WorkspaceLock::Downgrade &downgrade) mutable {
+          // Under the write lock the workspace Document is exclusive, so
+          // this redundancy check cannot race the build. It runs here —
+          // after this write supersedes any in-flight build — rather than
+          // before the write, which would deadlock behind a build that
+          // only this write supersedes.
+          std::vector<workspace::DocumentId> changedDocumentIds;
+          changedDocumentIds.reserve(update.changedDocumentIds.size());
+          for (const auto documentId : update.changedDocumentIds) {
+            if (const auto it = update.redundantWhenUnchanged.find(documentId);
+                it != update.redundantWhenUnchanged.end() &&
+                it->second != nullptr &&
+                is_redundant_text_snapshot(*shared.workspace.documents,
+                                           *it->second)) {
+              continue;
+            }
+            changedDocumentIds.push_back(documentId);
+          }
+          // A superseded update may have left documents half built: update
+          // anyway so that the builder completes them.
+          if (changedDocumentIds.empty() &&
+              update.deletedDocumentIds.empty() && !update.supersedes) {
+            settleUpdate(generation, {}, {});
+            return;
+          }
+          const auto start = Clock::now();
+          const auto builtDocumentIds = changedDocumentIds;
+          const auto deletedDocumentIds = update.deletedDocumentIds;
+          applyDocumentUpdate(std::move(changedDocumentIds),
+                              std::move(update.deletedDocumentIds),
+                              cancelToken, downgrade);
+          settleUpdate(generation, builtDocumentIds, Clock::now() - start,
+                       deletedDocumentIds);
+        });
+    writeFuture.get();
+  } catch (const utils::OperationCancelled &) {
+  } catch (const std::exception &error) {
+    publish_document_update_dispatch_failed(
+        shared, reportDocumentId,
+        "Workspace initialization failed. Could not perform document "
+        "update: " +
+            std::string(error.what()));
+  } catch (...) {
+    publish_document_update_dispatch_failed(
+        shared, reportDocumentId,
+        "Workspace initialization failed. Could not perform document "
+        "update.");
+  }
+  // Completed, failed or cancelled without a newer update taking it over
+  // (e.g. cancelWrite()): either way its documents are no longer in flight.
+  settleUpdate(generation, {}, {});
+}
+
+workspace::UpdateDebounceOptions
+DefaultDocumentUpdateHandler::debounceOptions(
+    const PendingUpdate &update) const {
+  std::string_view languageId;
+  for (const auto &[documentId, textDocument] : update.redundantWhenUnchanged) {
+    if (textDocument != nullptr && !textDocument->languageId().empty()) {
+      languageId = textDocument->languageId();
+      break;
+    }
+  }
+  return shared.workspace.configurationProvider
+      ->getWorkspaceConfigurationForLanguage(languageId)
+      .updateDebounce;
+}
+
+std::chrono::milliseconds DefaultDocumentUpdateHandler::updateDelayLocked(
+    const PendingUpdate &update,
+    const workspace::UpdateDebounceOptions &options) const {
+  std::chrono::nanoseconds cost{0};
+  for (const auto documentId : update.changedDocumentIds) {
+    if (const auto it = _lastBuildCost.find(documentId);
+        it != _lastBuildCost.end()) {
+      cost = std::max(cost, it->second);
+    }
+  }
+  const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::duration<double, std::nano>(
+          static_cast<double>(cost.count()) * options.costFactor));
+  return std::clamp(delay, options.minDelay,
+                    std::max(options.minDelay, options.maxDelay));
+}
+
+void DefaultDocumentUpdateHandler::settleUpdate(
+    std::uint64_t generation,
+    std::span<const workspace::DocumentId> builtDocumentIds,
+    std::chrono::nanoseconds buildCost,
+    std::span<const workspace::DocumentId> deletedDocumentIds) {
+  std::scoped_lock lock(_queueMutex);
+  // A batch costs what its documents cost together: each one is charged its
+  // share, so that editing one of them alone is not debounced as the batch.
+  if (!builtDocumentIds.empty()) {
+    const auto share =
+        buildCost / static_cast<std::int64_t>(builtDocumentIds.size());
+    for (const auto documentId : builtDocumentIds) {
+      _lastBuildCost[documentId] = share;
+    }
+  }
+  for (const auto documentId : deletedDocumentIds) {
+    _lastBuildCost.erase(documentId);
+  }
+  if (_inFlightGeneration == generation) {
+    _inFlight = {};
+  }
+}
+
 void DefaultDocumentUpdateHandler::applyDocumentUpdate(
     std::vector<workspace::DocumentId> changedDocumentIds,
     std::vector<workspace::DocumentId> deletedDocumentIds,
@@ -4,16 +4,28 @@
 #include <pegium/lsp/services/DefaultSharedLspService.hpp>
 #include <pegium/core/utils/Cancellation.hpp>
 #include <pegium/core/utils/Event.hpp>
+#include <pegium/core/workspace/Configuration.hpp>
 
 #include <lsp/types.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace pegium {
 
 /// Default bridge between text-document events and workspace rebuilds.
+///
+/// Notifications are merged into one pending update, dispatched after a delay
+/// adapted to the measured cost of the last build of its documents (see
+/// `workspace::UpdateDebounceOptions`). Documents of an update superseded
+/// before it completed are carried over into the next one.
 class DefaultDocumentUpdateHandler : public DocumentUpdateHandler,
                                      protected DefaultSharedLspService {
 public:
@@ -50,12 +62,50 @@ protected:
   getWatchers() const;
 
 private:
+  using Clock = std::chrono::steady_clock;
+
+  // Document ids waiting for one update, in notification order.
+  struct PendingUpdate {
+    std::vector<workspace::DocumentId> changedDocumentIds;
+    std::vector<workspace::DocumentId> deletedDocumentIds;
+    std::unordered_set<workspace::DocumentId> changedDocumentIdSet;
+    std::unordered_set<workspace::DocumentId> deletedDocumentIdSet;
+    // Client text each changed document was last notified with: the document
+    // is left out of the update when it already holds that text. `nullptr`
+    // forces the rebuild.
+    std::unordered_map<workspace::DocumentId,
+                       std::shared_ptr<const workspace::TextDocument>>
+        redundantWhenUnchanged;
+    // Set when the update carries documents of an unfinished earlier one.
+    bool supersedes = false;
+
+    [[nodiscard]] bool empty() const noexcept {
+      return changedDocumentIds.empty() && deletedDocumentIds.empty();
+    }
+    void change(workspace::DocumentId documentId,
+                std::shared_ptr<const workspace::TextDocument>
+                    redundantWhenUnchanged);
+    void remove(workspace::DocumentId documentId);
+    void merge(const PendingUpdate &newer);
+  };
+
   void registerFileWatcher();
   void fireDocumentUpdate(
       std::vector<workspace::DocumentId> changedDocumentIds,
       std::vector<workspace::DocumentId> deletedDocumentIds,
       std::shared_ptr<const workspace::TextDocument> redundantWhenUnchanged =
           nullptr);
+  void dispatchPendingUpdate();
+  [[nodiscard]] workspace::UpdateDebounceOptions
+  debounceOptions(const PendingUpdate &update) const;
+  [[nodiscard]] std::chrono::milliseconds
+  updateDelayLocked(const PendingUpdate &update,
+                    const workspace::UpdateDebounceOptions &options) const;
+  void settleUpdate(
+      std::uint64_t generation,
+      std::span<const workspace::DocumentId> builtDocumentIds,
+      std::chrono::nanoseconds buildCost,
+      std::span<const workspace::DocumentId> deletedDocumentIds = {});
   void applyDocumentUpdate(
       std::vector<workspace::DocumentId> changedDocumentIds,
       std::vector<workspace::DocumentId> deletedDocumentIds,
@@ -72,6 +122,22 @@ private:
   // handler or workspace lock.
   std::mutex _dispatchMutex;
   std::vector<std::future<void>> _dispatches;
+
+  // Update queue. `_inFlight` is the update last handed to the workspace lock,
+  // until it completes or a newer update takes its documents over.
+  std::mutex _queueMutex;
+  std::condition_variable _queueChanged;
+  PendingUpdate _pending;
+  PendingUpdate _inFlight;
+  std::uint64_t _inFlightGeneration = 0;
+  bool _dispatchScheduled = false;
+  bool _quiescing = false;
+  Clock::time_point _dispatchScheduledAt;
+  Clock::time_point _lastNotification;
+  // Share of each document in the duration of the last completed update that
+  // rebuilt it; dropped once the document is deleted.
+  std::unordered_map<workspace::DocumentId, std::chrono::nanoseconds>
+      _lastBuildCost;
 };
 
 } // namespace pegium
@@ -130,7 +130,7 @@ expectValidation(TestWorkspace &ws, std::string_view languageId,
   if (document == nullptr) {
     return nullptr;
   }
-  const auto &diagnostics = document->diagnostics;
+  const auto diagnostics = pegium::materialize(document->diagnostics);
   if (expected.check) {
     expected.check(diagnostics);
     return document;
@@ -246,7 +246,7 @@ ValidationResult validate(TestWorkspace &ws, std::string_view languageId,
   result.document =
       build_document(ws.shared(), languageId, std::move(text), documentUri);
   if (result.document != nullptr) {
-    result.diagnostics = result.document->diagnostics;
+    result.diagnostics = pegium::materialize(result.document->diagnostics);
   }
   return result;
 }
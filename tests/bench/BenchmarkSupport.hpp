@@ -62,12 +62,16 @@ inline std::size_t benchmark_target_bytes() {
 // The builder runs three merged phases, each publishing its constituent document
 // states in one post-barrier burst. Timing the individual sub-states would report
 // ~0 for every state but the last of each phase, so the benchmark reports the
-// three real phases instead, each at its boundary state.
+// three real phases instead, each at its boundary state. Benchmarks that care
+// about tail latency also report percentiles of the per-document time from the
+// start of the build until the document reached Validated.
 enum class BenchmarkStep : std::size_t {
   ParseIndex,  // phase A: parse + index exported content (-> IndexedContent)
   ScopeLink,   // phase B: local scopes + link + index references (-> IndexedReferences)
   Validation,  // phase C: validate (-> Validated)
   FullBuild,
+  LatencyP50,  // median per-document time to Validated
+  LatencyP99,  // 99th percentile per-document time to Validated
   Count,
 };
 
@@ -85,12 +89,20 @@ inline std::string_view benchmark_step_name(BenchmarkStep step) {
     return "validate";
   case BenchmarkStep::FullBuild:
     return "full-build";
+  case BenchmarkStep::LatencyP50:
+    return "doc-latency-p50";
+  case BenchmarkStep::LatencyP99:
+    return "doc-latency-p99";
   case BenchmarkStep::Count:
     break;
   }
   return "unknown";
 }
 
+constexpr bool benchmark_step_is_latency(BenchmarkStep step) {
+  return step == BenchmarkStep::LatencyP50 || step == BenchmarkStep::LatencyP99;
+}
+
 using BenchmarkTimings = std::array<double, benchmark_step_count()>;
 using BenchmarkIteration = std::function<BenchmarkTimings()>;
 
@@ -100,16 +112,19 @@ struct BenchmarkCase {
   BenchmarkIteration run;
   // Workspace benchmarks only report the full build (time + throughput).
   bool fullBuildOnly = false;
+  // Also report the per-document latency percentiles (time only).
+  bool reportsLatency = false;
 };
 
 class BenchmarkRegistry {
 public:
   void add(std::string name, std::size_t bytes, BenchmarkIteration run,
-           bool fullBuildOnly = false) {
+           bool fullBuildOnly = false, bool reportsLatency = false) {
     _cases.push_back({.name = std::move(name),
                       .bytes = bytes,
                       .run = std::move(run),
-                      .fullBuildOnly = fullBuildOnly});
+                      .fullBuildOnly = fullBuildOnly,
+                      .reportsLatency = reportsLatency});
   }
 
   int runAll(std::string_view filter = {}) const {
@@ -142,8 +157,17 @@ public:
       std::cout << "[bench] " << benchCase.name << " size=" << benchCase.bytes
                 << "B iterations=" << iterations << '\n';
       for (std::size_t step = 0; step < benchmark_step_count(); ++step) {
-        if (benchCase.fullBuildOnly &&
-            static_cast<BenchmarkStep>(step) != BenchmarkStep::FullBuild) {
+        const auto benchStep = static_cast<BenchmarkStep>(step);
+        if (benchmark_step_is_latency(benchStep)) {
+          if (benchCase.reportsLatency) {
+            std::cout << "  " << std::setw(18) << std::left
+                      << benchmark_step_name(benchStep) << std::fixed
+                      << std::setprecision(2) << std::setw(10) << totals[step]
+                      << "ms\n";
+          }
+          continue;
+        }
+        if (benchCase.fullBuildOnly && benchStep != BenchmarkStep::FullBuild) {
           continue;
         }
         const auto averageMs = totals[step];
@@ -154,10 +178,9 @@ public:
                                             averageSeconds
                                       : 0.0;
         std::cout << "  " << std::setw(18) << std::left
-                  << benchmark_step_name(static_cast<BenchmarkStep>(step))
-                  << std::fixed << std::setprecision(2) << std::setw(10)
-                  << averageMs << "ms  " << std::setw(10) << mibPerSecond
-                  << "MiB/s\n";
+                  << benchmark_step_name(benchStep) << std::fixed
+                  << std::setprecision(2) << std::setw(10) << averageMs
+                  << "ms  " << std::setw(10) << mibPerSecond << "MiB/s\n";
       }
     }
 
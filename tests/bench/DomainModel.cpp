@@ -53,6 +53,72 @@ std::string make_polymorphic_source(std::size_t targetBytes) {
   return source;
 }
 
+// Chains of nested packages: each entity refers, by simple name, to the
+// entity of the enclosing package, so every reference walks up the local scope
+// levels of its container chain.
+std::string make_deep_nesting_source(std::size_t targetBytes) {
+  constexpr std::size_t kDepth = 64;
+  std::string source;
+  source.reserve(targetBytes + 1024);
+  source += "datatype String\n";
+
+  std::size_t chain = 0;
+  while (source.size() < targetBytes) {
+    for (std::size_t level = 0; level < kDepth; ++level) {
+      const std::string indent(level * 2, ' ');
+      const auto suffix = std::to_string(chain) + "_" + std::to_string(level);
+      source += indent + "package p" + suffix + " {\n";
+      source += indent + "  entity E" + suffix;
+      if (level > 0) {
+        const auto outer =
+            "E" + std::to_string(chain) + "_" + std::to_string(level - 1);
+        source += " extends " + outer + " {\n";
+        source += indent + "    parent: " + outer + "\n";
+      } else {
+        source += " {\n";
+      }
+      source += indent + "    name: String\n";
+      source += indent + "  }\n";
+    }
+    for (std::size_t level = kDepth; level > 0; --level) {
+      source += std::string((level - 1) * 2, ' ') + "}\n";
+    }
+    ++chain;
+  }
+  return source;
+}
+
+// Entities with many features typed by the same few names, so that most
+// references repeat the scope, reference type and text of another one.
+std::string make_high_fan_in_source(std::size_t targetBytes) {
+  constexpr std::size_t kFeatures = 32;
+  std::string source;
+  source.reserve(targetBytes + 1024);
+  source += "datatype String\n";
+  source += "datatype Number\n";
+  source += "package bench {\n";
+  source += "  entity Shared {\n";
+  source += "    label: String\n";
+  source += "  }\n";
+
+  std::size_t index = 0;
+  while (source.size() < targetBytes) {
+    source += "  entity Entity" + std::to_string(index) + " {\n";
+    for (std::size_t feature = 0; feature < kFeatures; ++feature) {
+      static constexpr std::string_view kTypes[] = {"String", "Number",
+                                                    "Shared"};
+      source += "    f" + std::to_string(feature) + ": ";
+      source += kTypes[feature % std::size(kTypes)];
+      source += "\n";
+    }
+    source += "  }\n";
+    ++index;
+  }
+
+  source += "}\n";
+  return source;
+}
+
 } // namespace
 
 void register_domainmodel_benchmarks(BenchmarkRegistry &registry) {
@@ -70,6 +136,20 @@ void register_domainmodel_benchmarks(BenchmarkRegistry &registry) {
        .extension = ".dmodel",
        .registerLanguages = domainmodel::registerDomainModelCoreServices,
        .makeSource = make_polymorphic_source});
+  register_full_build_benchmark(
+      registry,
+      {.name = "domainmodel-deep-nesting",
+       .languageId = "domain-model",
+       .extension = ".dmodel",
+       .registerLanguages = domainmodel::registerDomainModelCoreServices,
+       .makeSource = make_deep_nesting_source});
+  register_full_build_benchmark(
+      registry,
+      {.name = "domainmodel-high-fan-in",
+       .languageId = "domain-model",
+       .extension = ".dmodel",
+       .registerLanguages = domainmodel::registerDomainModelCoreServices,
+       .makeSource = make_high_fan_in_source});
 }
 
 } // namespace pegium::bench
@@ -38,6 +38,40 @@ std::string make_source(std::size_t targetBytes) {
   return source;
 }
 
+// Few states, each with many transitions: validation checks and local symbols
+// only concern the top-level declarations, so their traversals skip the
+// transitions.
+std::string make_wide_states_source(std::size_t targetBytes) {
+  constexpr std::size_t kEventCount = 64;
+  constexpr std::size_t kTransitionsPerState = 512;
+
+  std::string source;
+  source.reserve(targetBytes + 1024);
+  source += "statemachine Bench\n";
+  source += "events";
+  for (std::size_t index = 0; index < kEventCount; ++index) {
+    source += " Event" + std::to_string(index);
+  }
+  source += "\ncommands Command0\ninitialState State0\n";
+
+  std::size_t stateIndex = 0;
+  while (source.size() < targetBytes) {
+    source += "state State" + std::to_string(stateIndex) + "\n";
+    for (std::size_t transition = 0; transition < kTransitionsPerState;
+         ++transition) {
+      source += "Event" + std::to_string(transition % kEventCount) +
+                " => State" + std::to_string(stateIndex + 1) + "\n";
+    }
+    source += "end\n";
+    ++stateIndex;
+  }
+
+  source += "state State" + std::to_string(stateIndex) + "\n";
+  source += "Event0 => State0\n";
+  source += "end\n";
+  return source;
+}
+
 } // namespace
 
 void register_statemachine_benchmarks(BenchmarkRegistry &registry) {
@@ -48,6 +82,13 @@ void register_statemachine_benchmarks(BenchmarkRegistry &registry) {
        .extension = ".statemachine",
        .registerLanguages = statemachine::registerStatemachineCoreServices,
        .makeSource = make_source});
+  register_full_build_benchmark(
+      registry,
+      {.name = "statemachine-wide-states",
+       .languageId = "statemachine",
+       .extension = ".statemachine",
+       .registerLanguages = statemachine::registerStatemachineCoreServices,
+       .makeSource = make_wide_states_source});
 }
 
 } // namespace pegium::bench
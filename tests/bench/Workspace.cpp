@@ -1,16 +1,51 @@
 #include "BenchmarkSupport.hpp"
 
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
 #include <arithmetics/core/CoreModule.hpp>
 #include <domainmodel/core/CoreModule.hpp>
 #include <requirements/core/CoreModule.hpp>
 #include <statemachine/core/CoreModule.hpp>
 
+#include <pegium/core/workspace/DocumentFactory.hpp>
+#include <pegium/core/workspace/FileSystemProvider.hpp>
+#include <pegium/lsp/services/LanguageServerFeatures.hpp>
+
 // Per-language workspace benchmarks: build many self-contained files of one
 // language simultaneously at startup (a small ~250 KB workspace and a large
 // ~12 MB one), like the fastbelt / language-tool-benchmark setup. Each file is a
 // complete, valid program with unique top-level names so the workspace has no
 // duplicate-symbol diagnostics. The generators produce byte-identical input
 // to the external comparison bench harness.
+//
+// The skewed workspaces mix a few very large files into many small ones and
+// report per-document latency (build start to Validated) next to the full
+// build, once with the default phase barriers and once pipelined. The
+// heavy-tailed workspace draws file sizes from a Pareto distribution instead,
+// with the large files wherever the draw puts them, to exercise how the
+// builder orders work across files of very different cost.
+//
+// The branch-switch workspace loads many small files from an in-memory file
+// system, builds them, then rewrites every file (new modification time) with
+// only one in kBranchSwitchEditPeriod getting new content, and times the
+// resulting update: the cost of a git checkout that touches the whole tree.
+//
+// The typing workspaces rebuild one open file per keystroke while another
+// thread keeps hovering a different file, and report the hover latency
+// percentiles in the latency slots: once with the builder resetting documents
+// in place (hovers wait for the workspace lock) and once isolating snapshots
+// (hovers read the last published version).
+//
+// The typing-replay workspaces feed a recorded-like typing session (bursts of
+// keystrokes separated by pauses, from a fixed seed) through the document
+// update handler, once with the adaptive debounce and once dispatching every
+// keystroke immediately. They time the session until the last version is
+// validated and print how many builds were started and how many completed.
 namespace pegium::bench {
 namespace {
 
@@ -18,6 +53,28 @@ using FileGenerator = std::string (*)(std::size_t fileIndex,
                                       std::size_t perFileBytes);
 
 constexpr std::size_t kPerFileBytes = 8 * 1024;
+// Skewed workspaces: one file in every kSkewPeriod is kSkewFactor times larger.
+constexpr std::size_t kSkewPeriod = 32;
+constexpr std::size_t kSkewFactor = 64;
+// Heavy-tailed workspaces: Pareto(kParetoShape) multiples of kPerFileBytes,
+// capped at kParetoCap, from a fixed seed so every run builds the same input.
+constexpr double kParetoShape = 1.1;
+constexpr double kParetoCap = 256.0;
+constexpr std::uint32_t kParetoSeed = 0x5eed;
+// Branch-switch workspaces: one file in every kBranchSwitchEditPeriod changes.
+constexpr std::size_t kBranchSwitchFileBytes = 1024;
+constexpr std::size_t kBranchSwitchEditPeriod = 16;
+// Typing workspaces: keystrokes applied to the edited file, and the pause
+// between two hovers.
+constexpr std::size_t kTypingKeystrokes = 200;
+constexpr auto kTypingHoverPause = std::chrono::microseconds(200);
+// Typing-replay workspaces: keystrokes per burst, the gap range between two
+// keystrokes of a burst and the pause between bursts.
+constexpr std::size_t kReplayBurstKeystrokes = 15;
+constexpr int kReplayMinGapMs = 10;
+constexpr int kReplayMaxGapMs = 60;
+constexpr auto kReplayBurstPause = std::chrono::milliseconds(300);
+constexpr std::uint32_t kReplaySeed = 0x7e57;
 
 std::string arithmetics_file(std::size_t fileIndex, std::size_t perFileBytes) {
   std::string source = "module Bench" + std::to_string(fileIndex) + "\n\n";
@@ -121,11 +178,66 @@ std::vector<std::string> generate_files(FileGenerator fileGen,
   return files;
 }
 
+// Same as generate_files, except that each block of kSkewPeriod files starts
+// with a large one, so the large files are listed ahead of the small ones they
+// would otherwise hold back.
+std::vector<std::string> generate_skewed_files(FileGenerator fileGen,
+                                               std::size_t targetBytes) {
+  std::vector<std::string> files;
+  std::size_t total = 0;
+  std::size_t index = 0;
+  while (total < targetBytes) {
+    const auto perFileBytes = index % kSkewPeriod == 0
+                                  ? kPerFileBytes * kSkewFactor
+                                  : kPerFileBytes;
+    auto text = fileGen(index, perFileBytes);
+    total += text.size();
+    files.push_back(std::move(text));
+    ++index;
+  }
+  return files;
+}
+
+std::vector<std::string> generate_heavy_tailed_files(FileGenerator fileGen,
+                                                     std::size_t targetBytes) {
+  std::mt19937 random(kParetoSeed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<std::string> files;
+  std::size_t total = 0;
+  std::size_t index = 0;
+  while (total < targetBytes) {
+    // Inverse transform sampling; 1 - u keeps the base strictly positive.
+    const auto scale = std::min(
+        kParetoCap, std::pow(1.0 - uniform(random), -1.0 / kParetoShape));
+    auto text = fileGen(
+        index, static_cast<std::size_t>(static_cast<double>(kPerFileBytes) *
+                                        scale));
+    total += text.size();
+    files.push_back(std::move(text));
+    ++index;
+  }
+  return files;
+}
+
+double latency_percentile(std::vector<double> &latencies, double percentile) {
+  if (latencies.empty()) {
+    return 0.0;
+  }
+  const auto rank = static_cast<std::size_t>(
+      percentile * static_cast<double>(latencies.size() - 1) + 0.5);
+  std::nth_element(latencies.begin(),
+                   latencies.begin() + static_cast<std::ptrdiff_t>(rank),
+                   latencies.end());
+  return latencies[rank];
+}
+
 BenchmarkTimings
 measure_workspace_iteration(bool (*registerLanguages)(SharedCoreServices &),
                             const std::string &languageId,
                             const std::string &extension,
-                            const std::vector<std::string> &files) {
+                            const std::vector<std::string> &files,
+                            bool pipelined = false,
+                            bool recordLatency = false) {
   auto shared = make_empty_shared_services();
   pegium::installDefaultSharedCoreServices(*shared);
   pegium::installDefaultSharedLspServices(*shared);
@@ -155,9 +267,23 @@ measure_workspace_iteration(bool (*registerLanguages)(SharedCoreServices &),
   // Hand the whole document set to the framework's DocumentBuilder and time the
   // full build — it parallelizes each phase across the workspace internally.
   using Clock = std::chrono::steady_clock;
+  // Document phase listeners run one at a time, so no locking is needed here.
+  std::vector<Clock::time_point> validatedTimes;
+  utils::DisposableStore disposables;
+  if (recordLatency) {
+    validatedTimes.reserve(documents.size());
+    disposables.add(shared->workspace.documentBuilder->onDocumentPhase(
+        workspace::DocumentState::Validated,
+        [&validatedTimes](const std::shared_ptr<workspace::Document> &,
+                          const utils::CancellationToken &) {
+          validatedTimes.push_back(Clock::now());
+        }));
+  }
+
   const auto start = Clock::now();
   workspace::BuildOptions options;
   options.validation = true;
+  options.pipelined = pipelined;
   shared->workspace.documentBuilder->build(documents, options);
   const auto end = Clock::now();
 
@@ -167,6 +293,331 @@ measure_workspace_iteration(bool (*registerLanguages)(SharedCoreServices &),
     }
   }
 
+  BenchmarkTimings timings{};
+  timings[static_cast<std::size_t>(BenchmarkStep::FullBuild)] =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  if (recordLatency) {
+    if (validatedTimes.size() != documents.size()) {
+      throw std::runtime_error("Missing per-document Validated events.");
+    }
+    std::vector<double> latencies;
+    latencies.reserve(validatedTimes.size());
+    for (const auto time : validatedTimes) {
+      latencies.push_back(
+          std::chrono::duration<double, std::milli>(time - start).count());
+    }
+    timings[static_cast<std::size_t>(BenchmarkStep::LatencyP50)] =
+        latency_percentile(latencies, 0.50);
+    timings[static_cast<std::size_t>(BenchmarkStep::LatencyP99)] =
+        latency_percentile(latencies, 0.99);
+  }
+  return timings;
+}
+
+// In-memory file system whose files carry a modification time, like a
+// checkout on disk.
+class BranchFileSystemProvider final : public workspace::FileSystemProvider {
+public:
+  void write(const std::string &uri, std::string content) {
+    std::scoped_lock lock(_mutex);
+    auto &file = _files[uri];
+    file.content = std::move(content);
+    file.modifiedTime = ++_clock;
+  }
+
+  [[nodiscard]] workspace::FileSystemNode
+  stat(std::string_view uri) const override {
+    std::scoped_lock lock(_mutex);
+    const auto &file = find(uri);
+    return {.isFile = true,
+            .uri = std::string(uri),
+            .size = file.content.size(),
+            .modifiedTime = file.modifiedTime};
+  }
+  [[nodiscard]] bool exists(std::string_view uri) const override {
+    std::scoped_lock lock(_mutex);
+    return _files.contains(std::string(uri));
+  }
+  [[nodiscard]] std::vector<std::uint8_t>
+  readBinary(std::string_view uri) const override {
+    const auto content = readFile(uri);
+    return {content.begin(), content.end()};
+  }
+  [[nodiscard]] std::string readFile(std::string_view uri) const override {
+    std::scoped_lock lock(_mutex);
+    return find(uri).content;
+  }
+  [[nodiscard]] std::vector<workspace::FileSystemNode>
+  readDirectory(std::string_view) const override {
+    return {};
+  }
+
+private:
+  struct File {
+    std::string content;
+    std::int64_t modifiedTime = 0;
+  };
+
+  [[nodiscard]] const File &find(std::string_view uri) const {
+    const auto it = _files.find(std::string(uri));
+    if (it == _files.end()) {
+      throw std::runtime_error("Missing file: " + std::string(uri));
+    }
+    return it->second;
+  }
+
+  mutable std::mutex _mutex;
+  std::unordered_map<std::string, File> _files;
+  std::int64_t _clock = 0;
+};
+
+BenchmarkTimings
+measure_branch_switch_iteration(bool (*registerLanguages)(SharedCoreServices &),
+                                const std::string &languageId,
+                                const std::string &extension,
+                                FileGenerator fileGen, std::size_t fileCount) {
+  auto shared = make_empty_shared_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  pegium::installDefaultSharedLspServices(*shared);
+  if (!registerLanguages(*shared)) {
+    throw std::runtime_error("Failed to register services for " + languageId);
+  }
+  auto fileSystem = std::make_shared<BranchFileSystemProvider>();
+  shared->workspace.fileSystemProvider = fileSystem;
+
+  std::vector<std::string> uris;
+  uris.reserve(fileCount);
+  for (std::size_t index = 0; index < fileCount; ++index) {
+    uris.push_back(utils::path_to_file_uri(
+        "/tmp/pegium-bench/branch/" + languageId + "/" +
+        std::to_string(index) + extension));
+    fileSystem->write(uris.back(), fileGen(index, kBranchSwitchFileBytes));
+  }
+
+  std::vector<std::shared_ptr<workspace::Document>> documents;
+  std::vector<workspace::DocumentId> documentIds;
+  documents.reserve(fileCount);
+  documentIds.reserve(fileCount);
+  for (const auto &uri : uris) {
+    auto document = shared->workspace.documentFactory->fromUri(uri);
+    shared->workspace.documents->addDocument(document);
+    documentIds.push_back(document->id);
+    documents.push_back(std::move(document));
+  }
+  workspace::BuildOptions options;
+  options.validation = true;
+  shared->workspace.documentBuilder->build(documents, options);
+
+  // The checkout rewrites every file; generator indexes past fileCount give
+  // the edited files fresh content with names unique in the workspace.
+  for (std::size_t index = 0; index < fileCount; ++index) {
+    fileSystem->write(uris[index],
+                      index % kBranchSwitchEditPeriod == 0
+                          ? fileGen(fileCount + index, kBranchSwitchFileBytes)
+                          : fileSystem->readFile(uris[index]));
+  }
+
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  shared->workspace.documentBuilder->update(documentIds, {});
+  const auto end = Clock::now();
+
+  for (const auto &document : documents) {
+    if (document->state < workspace::DocumentState::IndexedReferences) {
+      throw std::runtime_error("Branch switch update left a document unbuilt.");
+    }
+  }
+
+  BenchmarkTimings timings{};
+  timings[static_cast<std::size_t>(BenchmarkStep::FullBuild)] =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  return timings;
+}
+
+BenchmarkTimings
+measure_typing_hover_iteration(bool (*registerLanguages)(SharedCoreServices &),
+                               const std::string &languageId,
+                               const std::string &extension,
+                               const std::vector<std::string> &files,
+                               bool isolateSnapshots) {
+  auto shared = make_empty_shared_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  pegium::installDefaultSharedLspServices(*shared);
+  if (!registerLanguages(*shared)) {
+    throw std::runtime_error("Failed to register services for " + languageId);
+  }
+  auto &builder = *shared->workspace.documentBuilder;
+  builder.updateBuildOptions().validation = true;
+  builder.updateBuildOptions().isolateSnapshots = isolateSnapshots;
+
+  const auto textDocuments = shared->lsp.textDocuments;
+  std::vector<std::string> uris;
+  std::vector<workspace::DocumentId> documentIds;
+  uris.reserve(files.size());
+  documentIds.reserve(files.size());
+  for (std::size_t index = 0; index < files.size(); ++index) {
+    uris.push_back(utils::path_to_file_uri(
+        "/tmp/pegium-bench/typing/" + languageId + "/" +
+        std::to_string(index) + extension));
+    (void)textDocuments->set(std::make_shared<workspace::TextDocument>(
+        workspace::TextDocument::create(uris.back(), languageId, 1,
+                                        files[index])));
+    documentIds.push_back(
+        shared->workspace.documents->getOrCreateDocumentId(uris.back()));
+  }
+  builder.update(documentIds, {});
+
+  // Document 0 is typed into, document 1 is hovered.
+  ::lsp::HoverParams params{};
+  params.textDocument.uri = ::lsp::DocumentUri(::lsp::Uri::parse(uris[1]));
+  params.position.line = 0;
+  params.position.character = 1;
+
+  using Clock = std::chrono::steady_clock;
+  std::atomic<bool> typing = true;
+  std::vector<double> latencies;
+  std::thread hovering([&] {
+    while (typing.load(std::memory_order_relaxed)) {
+      const auto start = Clock::now();
+      (void)getHoverContent(*shared, params, utils::default_cancel_token);
+      latencies.push_back(
+          std::chrono::duration<double, std::milli>(Clock::now() - start)
+              .count());
+      std::this_thread::sleep_for(kTypingHoverPause);
+    }
+  });
+
+  const auto start = Clock::now();
+  const std::array<workspace::DocumentId, 1> editedIds{documentIds[0]};
+  std::string edited = files[0];
+  for (std::size_t keystroke = 0; keystroke < kTypingKeystrokes; ++keystroke) {
+    // Keystrokes inside a trailing comment keep every version valid.
+    edited += keystroke == 0 ? "\n//" : "x";
+    (void)textDocuments->set(std::make_shared<workspace::TextDocument>(
+        workspace::TextDocument::create(
+            uris[0], languageId, static_cast<std::int64_t>(keystroke) + 2,
+            edited)));
+    shared->workspace.workspaceLock
+        ->write([&](const utils::CancellationToken &cancelToken,
+                    const workspace::WorkspaceLock::Downgrade &downgrade) {
+          builder.update(editedIds, {}, cancelToken, downgrade);
+        })
+        .get();
+  }
+  const auto end = Clock::now();
+  typing = false;
+  hovering.join();
+
+  BenchmarkTimings timings{};
+  timings[static_cast<std::size_t>(BenchmarkStep::FullBuild)] =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  timings[static_cast<std::size_t>(BenchmarkStep::LatencyP50)] =
+      latency_percentile(latencies, 0.50);
+  timings[static_cast<std::size_t>(BenchmarkStep::LatencyP99)] =
+      latency_percentile(latencies, 0.99);
+  return timings;
+}
+
+BenchmarkTimings
+measure_typing_replay_iteration(bool (*registerLanguages)(SharedCoreServices &),
+                                const std::string &languageId,
+                                const std::string &extension,
+                                const std::vector<std::string> &files,
+                                std::size_t keystrokes, bool debounce) {
+  auto shared = make_empty_shared_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  pegium::installDefaultSharedLspServices(*shared);
+  if (!registerLanguages(*shared)) {
+    throw std::runtime_error("Failed to register services for " + languageId);
+  }
+  auto &builder = *shared->workspace.documentBuilder;
+  builder.updateBuildOptions().validation = true;
+  if (!debounce) {
+    workspace::ConfigurationChangeParams params;
+    params.settings = pegium::JsonValue(pegium::JsonValue::Object{
+        {languageId,
+         pegium::JsonValue(pegium::JsonValue::Object{
+             {"updateDebounce",
+              pegium::JsonValue(pegium::JsonValue::Object{
+                  {"minDelay", pegium::JsonValue(0)},
+                  {"maxDelay", pegium::JsonValue(0)},
+              })},
+         })},
+    });
+    shared->workspace.configurationProvider->updateConfiguration(params);
+  }
+  shared->workspace.workspaceManager->initialize(workspace::InitializeParams{});
+  if (auto initialized = shared->workspace.workspaceManager->initialized(
+          workspace::InitializedParams{});
+      initialized.valid()) {
+    initialized.get();
+  }
+  shared->workspace.workspaceManager->ready().get();
+
+  const auto textDocuments = shared->lsp.textDocuments;
+  std::vector<std::string> uris;
+  std::vector<workspace::DocumentId> documentIds;
+  uris.reserve(files.size());
+  documentIds.reserve(files.size());
+  for (std::size_t index = 0; index < files.size(); ++index) {
+    uris.push_back(utils::path_to_file_uri(
+        "/tmp/pegium-bench/replay/" + languageId + "/" +
+        std::to_string(index) + extension));
+    (void)textDocuments->set(std::make_shared<workspace::TextDocument>(
+        workspace::TextDocument::create(uris.back(), languageId, 1,
+                                        files[index])));
+    documentIds.push_back(
+        shared->workspace.documents->getOrCreateDocumentId(uris.back()));
+  }
+  builder.update(documentIds, {});
+
+  std::atomic<std::size_t> started = 0;
+  std::atomic<std::size_t> completed = 0;
+  std::atomic<std::int64_t> validatedVersion = 0;
+  auto onUpdate = builder.onUpdate(
+      [&](std::span<const workspace::DocumentId>,
+          std::span<const workspace::DocumentId>) { ++started; });
+  auto onValidated = builder.onBuildPhase(
+      workspace::DocumentState::Validated,
+      [&](std::span<const std::shared_ptr<workspace::Document>>,
+          utils::CancellationToken) { ++completed; });
+  auto onDocumentValidated = builder.onDocumentPhase(
+      workspace::DocumentState::Validated,
+      [&, editedId = documentIds[0]](
+          const std::shared_ptr<workspace::Document> &document,
+          utils::CancellationToken) {
+        if (document->id == editedId) {
+          validatedVersion = document->textDocument().version();
+        }
+      });
+
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 random(kReplaySeed);
+  std::uniform_int_distribution<int> gapMs(kReplayMinGapMs, kReplayMaxGapMs);
+  const auto start = Clock::now();
+  std::string edited = files[0];
+  std::int64_t version = 1;
+  for (std::size_t keystroke = 0; keystroke < keystrokes; ++keystroke) {
+    // Keystrokes inside a trailing comment keep every version valid.
+    edited += keystroke == 0 ? "\n//" : "x";
+    auto textDocument = std::make_shared<workspace::TextDocument>(
+        workspace::TextDocument::create(uris[0], languageId, ++version,
+                                        edited));
+    (void)textDocuments->set(textDocument);
+    shared->lsp.documentUpdateHandler->didChangeContent(
+        {.document = std::move(textDocument)});
+    std::this_thread::sleep_for(
+        (keystroke + 1) % kReplayBurstKeystrokes == 0
+            ? std::chrono::milliseconds(kReplayBurstPause)
+            : std::chrono::milliseconds(gapMs(random)));
+  }
+  while (validatedVersion.load() != version) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const auto end = Clock::now();
+  std::cerr << "    builds started=" << started.load()
+            << " completed=" << completed.load() << '\n';
+
   BenchmarkTimings timings{};
   timings[static_cast<std::size_t>(BenchmarkStep::FullBuild)] =
       std::chrono::duration<double, std::milli>(end - start).count();
@@ -179,31 +630,128 @@ void register_language_workspaces(BenchmarkRegistry &registry,
                                   const std::string &extension,
                                   bool (*registerLanguages)(SharedCoreServices &),
                                   FileGenerator fileGen) {
-  const std::array<std::pair<std::string, std::size_t>, 2> cases{
-      {{"small", get_env_size("PEGIUM_BENCH_WS_SMALL", 256 * 1024, 16 * 1024)},
-       {"large", get_env_size("PEGIUM_BENCH_WS_LARGE", 12 * 1024 * 1024,
-                              16 * 1024)}}};
+  enum class Distribution { Uniform, Skewed, HeavyTailed };
+  struct WorkspaceCase {
+    std::string suffix;
+    std::size_t target = 0;
+    Distribution distribution = Distribution::Uniform;
+    bool pipelined = false;
+  };
+  const auto skewedTarget =
+      get_env_size("PEGIUM_BENCH_WS_SKEWED", 4 * 1024 * 1024, 16 * 1024);
+  const std::array<WorkspaceCase, 5> cases{
+      {{.suffix = "small",
+        .target =
+            get_env_size("PEGIUM_BENCH_WS_SMALL", 256 * 1024, 16 * 1024)},
+       {.suffix = "large",
+        .target = get_env_size("PEGIUM_BENCH_WS_LARGE", 12 * 1024 * 1024,
+                               16 * 1024)},
+       {.suffix = "skewed",
+        .target = skewedTarget,
+        .distribution = Distribution::Skewed},
+       {.suffix = "skewed-pipelined",
+        .target = skewedTarget,
+        .distribution = Distribution::Skewed,
+        .pipelined = true},
+       {.suffix = "heavy-tailed",
+        .target = get_env_size("PEGIUM_BENCH_WS_HEAVY_TAILED",
+                               8 * 1024 * 1024, 16 * 1024),
+        .distribution = Distribution::HeavyTailed}}};
 
   const auto filter = get_env_string("PEGIUM_BENCH_FILTER");
-  for (const auto &[suffix, target] : cases) {
-    const std::string benchName = name + "-workspace-" + suffix;
+  for (const auto &workspaceCase : cases) {
+    const std::string benchName = name + "-workspace-" + workspaceCase.suffix;
     // Skip generating (and holding) the workspaces the filter excludes, so a
     // single-config run's peak RSS reflects only that workspace.
     if (!filter.empty() && benchName.find(filter) == std::string::npos) {
       continue;
     }
-    auto files = generate_files(fileGen, target);
+    auto files = [&] {
+      switch (workspaceCase.distribution) {
+      case Distribution::Skewed:
+        return generate_skewed_files(fileGen, workspaceCase.target);
+      case Distribution::HeavyTailed:
+        return generate_heavy_tailed_files(fileGen, workspaceCase.target);
+      case Distribution::Uniform:
+        break;
+      }
+      return generate_files(fileGen, workspaceCase.target);
+    }();
+    const auto recordLatency =
+        workspaceCase.distribution != Distribution::Uniform;
     std::size_t bytes = 0;
     for (const auto &file : files) {
       bytes += file.size();
     }
     registry.add(
-        name + "-workspace-" + suffix + " files=" + std::to_string(files.size()),
-        bytes,
-        [registerLanguages, languageId, extension,
-         files = std::move(files)] {
+        benchName + " files=" + std::to_string(files.size()), bytes,
+        [registerLanguages, languageId, extension, files = std::move(files),
+         pipelined = workspaceCase.pipelined, recordLatency] {
           return measure_workspace_iteration(registerLanguages, languageId,
-                                              extension, files);
+                                              extension, files, pipelined,
+                                              recordLatency);
+        },
+        /*fullBuildOnly=*/true, /*reportsLatency=*/recordLatency);
+  }
+
+  const std::string branchSwitchName = name + "-workspace-branch-switch";
+  if (filter.empty() || branchSwitchName.find(filter) != std::string::npos) {
+    const auto fileCount =
+        get_env_size("PEGIUM_BENCH_WS_BRANCH_SWITCH_FILES", 10000, 16);
+    registry.add(
+        branchSwitchName + " files=" + std::to_string(fileCount),
+        fileCount * kBranchSwitchFileBytes,
+        [registerLanguages, languageId, extension, fileGen, fileCount] {
+          return measure_branch_switch_iteration(
+              registerLanguages, languageId, extension, fileGen, fileCount);
+        },
+        /*fullBuildOnly=*/true);
+  }
+
+  for (const auto isolateSnapshots : {false, true}) {
+    const std::string typingName =
+        name + "-workspace-typing" + (isolateSnapshots ? "-isolated" : "");
+    if (!filter.empty() && typingName.find(filter) == std::string::npos) {
+      continue;
+    }
+    auto files = generate_files(
+        fileGen, get_env_size("PEGIUM_BENCH_WS_TYPING", 1024 * 1024, 16 * 1024));
+    std::size_t bytes = 0;
+    for (const auto &file : files) {
+      bytes += file.size();
+    }
+    registry.add(
+        typingName + " files=" + std::to_string(files.size()), bytes,
+        [registerLanguages, languageId, extension, files = std::move(files),
+         isolateSnapshots] {
+          return measure_typing_hover_iteration(registerLanguages, languageId,
+                                                extension, files,
+                                                isolateSnapshots);
+        },
+        /*fullBuildOnly=*/true, /*reportsLatency=*/true);
+  }
+
+  for (const auto debounce : {true, false}) {
+    const std::string replayName =
+        name + "-workspace-typing-replay" + (debounce ? "" : "-immediate");
+    if (!filter.empty() && replayName.find(filter) == std::string::npos) {
+      continue;
+    }
+    auto files = generate_files(
+        fileGen, get_env_size("PEGIUM_BENCH_WS_TYPING", 1024 * 1024, 16 * 1024));
+    std::size_t bytes = 0;
+    for (const auto &file : files) {
+      bytes += file.size();
+    }
+    const auto keystrokes =
+        get_env_size("PEGIUM_BENCH_WS_REPLAY_KEYSTROKES", 90, 1);
+    registry.add(
+        replayName + " files=" + std::to_string(files.size()), bytes,
+        [registerLanguages, languageId, extension, files = std::move(files),
+         keystrokes, debounce] {
+          return measure_typing_replay_iteration(registerLanguages, languageId,
+                                                 extension, files, keystrokes,
+                                                 debounce);
         },
         /*fullBuildOnly=*/true);
   }
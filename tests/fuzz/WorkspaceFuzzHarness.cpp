@@ -786,7 +786,7 @@ void mutate_text(std::string &text, std::string_view mutationProgram) {
 
   std::vector<DiagnosticSnapshot> diagnostics;
   diagnostics.reserve(document.diagnostics.size());
-  for (const auto &diagnostic : document.diagnostics) {
+  for (const auto &diagnostic : pegium::materialize(document.diagnostics)) {
     EXPECT_LE(diagnostic.begin, diagnostic.end);
     EXPECT_LE(diagnostic.begin, textSize);
     EXPECT_LE(diagnostic.end, textSize);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
@@ -112,6 +113,7 @@ public:
   ParseCallback callback;
   mutable std::size_t parseCalls = 0;
   mutable std::vector<std::string> parsedTexts;
+  mutable std::size_t expectCalls = 0;
   mutable std::mutex mutex;
 
   [[nodiscard]] parser::ParseResult
@@ -138,6 +140,10 @@ public:
   expect(std::string_view, TextOffset,
          const utils::CancellationToken &cancelToken) const override {
     utils::throw_if_cancelled(cancelToken);
+    {
+      std::scoped_lock lock(mutex);
+      ++expectCalls;
+    }
     return expectations;
   }
 
@@ -154,6 +160,9 @@ class FakeFileSystemProvider final : public workspace::FileSystemProvider {
 public:
   std::unordered_map<std::string, std::string> files;
   std::unordered_map<std::string, std::vector<std::string>> directories;
+  /// Files listed here report their size and this modification time.
+  std::unordered_map<std::string, std::int64_t> modifiedTimes;
+  mutable std::atomic<std::size_t> readFileCalls = 0;
 
   [[nodiscard]] workspace::FileSystemNode
   stat(std::string_view uri) const override {
@@ -161,9 +170,15 @@ public:
     if (!files.contains(key) && !directories.contains(key)) {
       throw std::runtime_error("Missing file system node: " + key);
     }
-    return workspace::FileSystemNode{.isFile = files.contains(key),
-                                     .isDirectory = directories.contains(key),
-                                     .uri = toFileUri(key)};
+    workspace::FileSystemNode node{.isFile = files.contains(key),
+                                   .isDirectory = directories.contains(key),
+                                   .uri = toFileUri(key)};
+    if (const auto it = modifiedTimes.find(key);
+        node.isFile && it != modifiedTimes.end()) {
+      node.size = files.at(key).size();
+      node.modifiedTime = it->second;
+    }
+    return node;
   }
 
   [[nodiscard]] bool exists(std::string_view uri) const override {
@@ -178,6 +193,7 @@ public:
   }
 
   [[nodiscard]] std::string readFile(std::string_view uri) const override {
+    ++readFileCalls;
     const auto it = files.find(normalizeKey(uri));
     if (it == files.end()) {
       throw std::runtime_error("Missing file: " + normalizeKey(uri));
@@ -238,6 +254,26 @@ public:
     }
     return diagnostics;
   }
+
+  // Reports every prefix of the diagnostics as progress when enabled.
+  bool reportsProgress = false;
+
+  [[nodiscard]] std::vector<pegium::CompactDiagnostic> validateDocumentCompact(
+      const workspace::Document &document,
+      const validation::ValidationOptions &options,
+      const utils::CancellationToken &cancelToken,
+      const Progress &progress = {}) const override {
+    auto rendered = validateDocument(document, options, cancelToken);
+    std::vector<pegium::CompactDiagnostic> compact(
+        std::make_move_iterator(rendered.begin()),
+        std::make_move_iterator(rendered.end()));
+    if (reportsProgress && progress) {
+      for (std::size_t count = 1; count < compact.size(); ++count) {
+        progress(std::span(compact).first(count));
+      }
+    }
+    return compact;
+  }
 };
 
 inline std::shared_ptr<workspace::TextDocument>
@@ -289,6 +325,19 @@ public:
     return document;
   }
 
+  [[nodiscard]] std::shared_ptr<workspace::Document>
+  fromUriUnparsed(std::string_view uri,
+                  const utils::CancellationToken &cancelToken = {}) const override {
+    utils::throw_if_cancelled(cancelToken);
+    const auto it = contentsByUri.find(std::string(uri));
+    if (it == contentsByUri.end()) {
+      throw std::runtime_error("No content registered for URI: " +
+                               std::string(uri));
+    }
+    return std::make_shared<workspace::Document>(
+        make_text_document(std::string(uri), {}, it->second));
+  }
+
   workspace::Document &
   update(workspace::Document &document,
          const utils::CancellationToken &cancelToken = {}) const override {
@@ -302,6 +351,15 @@ public:
     }
     return document;
   }
+
+  [[nodiscard]] std::shared_ptr<workspace::Document>
+  createSuccessor(const workspace::Document &document) const override {
+    auto successor = std::make_shared<workspace::Document>(
+        make_text_document(document.uri, {},
+                           std::string(document.textDocument().getText())));
+    successor->id = document.id;
+    return successor;
+  }
 };
 
 class InMemoryTextDocuments final : public workspace::TextDocumentProvider {
@@ -2,8 +2,13 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
+#include <latch>
+#include <mutex>
+#include <ranges>
 #include <stdexcept>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <pegium/core/execution/TaskScheduler.hpp>
@@ -80,5 +85,121 @@ TEST(TaskSchedulerTest, ParallelForPropagatesTaskExceptions) {
       std::runtime_error);
 }
 
+TEST(TaskSchedulerTest, CostHintedParallelForStartsMostCostlyItemsFirst) {
+  // A single worker takes the items one at a time in dispatch order, which
+  // must be by decreasing cost (ties keep their range order).
+  TaskScheduler scheduler(1);
+  const std::vector<int> values{3, 9, 1, 9, 4};
+  std::mutex mutex;
+  std::vector<int> visited;
+
+  scheduler.parallelFor(
+      {}, std::views::iota(std::size_t{0}, values.size()),
+      [&](std::size_t index) {
+        std::scoped_lock lock(mutex);
+        visited.push_back(static_cast<int>(index));
+      },
+      [&values](std::size_t index) {
+        return static_cast<std::uint64_t>(values[index]);
+      });
+
+  EXPECT_EQ(visited, (std::vector<int>{1, 3, 4, 0, 2}));
+}
+
+TEST(TaskSchedulerTest, CostHintedParallelForPropagatesTaskExceptions) {
+  TaskScheduler scheduler(4);
+  std::vector<int> values(1000);
+  for (int i = 0; i < 1000; ++i) {
+    values[i] = i;
+  }
+
+  EXPECT_THROW(
+      scheduler.parallelFor(
+          {}, values,
+          [](int value) {
+            if (value == 500) {
+              throw std::runtime_error("boom");
+            }
+          },
+          [](int value) { return static_cast<std::uint64_t>(value % 7); }),
+      std::runtime_error);
+}
+
+TEST(TaskSchedulerTest, PrioritizedParallelForDispatchesByPriorityThenCost) {
+  TaskScheduler scheduler(1);
+  const std::vector<std::pair<TaskPriority, int>> items{
+      {TaskPriority::Background, 9},
+      {TaskPriority::Interactive, 1},
+      {TaskPriority::OpenDocument, 5},
+      {TaskPriority::Interactive, 3},
+      {TaskPriority::Background, 2}};
+  std::mutex mutex;
+  std::vector<int> visited;
+
+  scheduler.parallelFor(
+      {}, std::views::iota(std::size_t{0}, items.size()),
+      [&](std::size_t index) {
+        std::scoped_lock lock(mutex);
+        visited.push_back(static_cast<int>(index));
+      },
+      [&items](std::size_t index) {
+        return static_cast<std::uint64_t>(items[index].second);
+      },
+      [&items](std::size_t index) { return items[index].first; });
+
+  EXPECT_EQ(visited, (std::vector<int>{3, 1, 2, 0, 4}));
+}
+
+TEST(TaskSchedulerTest, InteractiveWorkIsNotQueuedBehindBackgroundWork) {
+  // The first background item submits an interactive batch from its worker;
+  // every other background item that starts before the first interactive item
+  // waits on `gate`. Once the gate opens, the queued background items must
+  // yield until the whole interactive batch has started. Two races are
+  // tolerated: one interactive item may still be between leaving the queue and
+  // entering its body on the other worker (hence the `+ 1`), and that worker
+  // may have dequeued one background item before the batch was submitted.
+  TaskScheduler scheduler(2);
+  constexpr std::size_t kBackgroundCount = 1000;
+  constexpr std::size_t kInteractiveCount = 8;
+  std::latch gate(1);
+  std::atomic<bool> gateOpen{false};
+  std::atomic<bool> submitted{false};
+  std::atomic<std::size_t> interactiveStarted{0};
+  std::atomic<std::size_t> backgroundDone{0};
+  std::atomic<std::size_t> startedAheadOfInteractive{0};
+
+  const auto runInteractive = [&] {
+    scheduler.parallelFor(
+        {}, std::views::iota(std::size_t{0}, kInteractiveCount),
+        [&](std::size_t) {
+          interactiveStarted.fetch_add(1);
+          if (!gateOpen.exchange(true)) {
+            gate.count_down();
+          }
+        },
+        [](std::size_t) { return std::uint64_t{1}; },
+        [](std::size_t) { return TaskPriority::Interactive; });
+  };
+
+  scheduler.parallelFor(
+      {}, std::views::iota(std::size_t{0}, kBackgroundCount),
+      [&](std::size_t) {
+        if (!submitted.exchange(true)) {
+          runInteractive();
+        } else if (!gateOpen.load()) {
+          gate.wait();
+        } else if (interactiveStarted.load() + 1 < kInteractiveCount) {
+          startedAheadOfInteractive.fetch_add(1);
+        }
+        backgroundDone.fetch_add(1);
+      },
+      [](std::size_t) { return std::uint64_t{1}; },
+      [](std::size_t) { return TaskPriority::Background; });
+
+  EXPECT_EQ(interactiveStarted.load(), kInteractiveCount);
+  EXPECT_EQ(backgroundDone.load(), kBackgroundCount);
+  EXPECT_LE(startedAheadOfInteractive.load(), 1u);
+}
+
 } // namespace
 } // namespace pegium::execution
@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
 #include <pegium/core/CoreTestSupport.hpp>
+#include <latch>
 #include <stdexcept>
+#include <thread>
 
+#include <pegium/core/execution/TaskScheduler.hpp>
 #include <pegium/core/grammar/Assignment.hpp>
 #include <pegium/core/grammar/FeatureValue.hpp>
 #include <pegium/core/grammar/Literal.hpp>
+#include <pegium/core/references/DefaultScopeProvider.hpp>
 #include <pegium/core/references/ScopeProvider.hpp>
 #include <pegium/core/syntax-tree/CstBuilder.hpp>
 #include <pegium/core/syntax-tree/RootCstNode.hpp>
@@ -185,6 +189,85 @@ private:
   std::vector<workspace::AstNodeDescription> _entries;
 };
 
+class CountingScopeProvider final : public ScopeProvider {
+public:
+  CountingScopeProvider(std::vector<workspace::AstNodeDescription> entries,
+                        bool sharedScope)
+      : _entries(std::move(entries)), _sharedScope(sharedScope) {}
+
+  const workspace::AstNodeDescription *
+  getScopeEntry(const ReferenceInfo &context) const override {
+    ++lookups;
+    for (const auto &entry : _entries) {
+      if (entry.name == context.referenceText) {
+        return std::addressof(entry);
+      }
+    }
+    return nullptr;
+  }
+
+  bool visitScopeEntries(
+      const ReferenceInfo &,
+      utils::function_ref<bool(const workspace::AstNodeDescription &)>)
+      const override {
+    return true;
+  }
+
+  const void *scopeKey(const ReferenceInfo &) const override {
+    return _sharedScope ? this : nullptr;
+  }
+
+  mutable std::size_t lookups = 0;
+
+private:
+  std::vector<workspace::AstNodeDescription> _entries;
+  bool _sharedScope;
+};
+
+// Default scope provider overriding how entries are looked up, as providers
+// with imports or aliases do.
+class OverridingDefaultScopeProvider final : public DefaultScopeProvider {
+public:
+  using DefaultScopeProvider::DefaultScopeProvider;
+
+  const workspace::AstNodeDescription *
+  getScopeEntry(const ReferenceInfo &context) const override {
+    ++lookups;
+    return DefaultScopeProvider::getScopeEntry(context);
+  }
+
+  mutable std::size_t lookups = 0;
+};
+
+// Makes the resolution of each of two references wait for the other one, once
+// both are being resolved.
+class CrossingScopeProvider final : public ScopeProvider {
+public:
+  const workspace::AstNodeDescription *
+  getScopeEntry(const ReferenceInfo &context) const override {
+    if (synchronized) {
+      _bothResolving.arrive_and_wait();
+    }
+    (void)(context.container == first ? second : first)->node.get();
+    return nullptr;
+  }
+
+  bool visitScopeEntries(
+      const ReferenceInfo &,
+      utils::function_ref<bool(const workspace::AstNodeDescription &)>)
+      const override {
+    return true;
+  }
+
+  const LinkerReferrer *first = nullptr;
+  const LinkerReferrer *second = nullptr;
+  // Whether both references must start resolving before either goes on.
+  bool synchronized = true;
+
+private:
+  mutable std::latch _bothResolving{2};
+};
+
 struct DummyLiteral final : grammar::Literal {
   [[nodiscard]] bool isNullable() const noexcept override { return false; }
 
@@ -346,10 +429,29 @@ make_attached_referrer(pegium::SharedCoreServices &shared,
   return {.document = std::move(document), .referrer = referrer};
 }
 
+// Adds a referrer naming `refText` to the root of `document`.
+LinkerReferrer *add_referrer(workspace::Document &document,
+                             const references::Linker &linker,
+                             std::string_view refText) {
+  static const TestReferenceAssignment<LinkerReferrer, LinkerNode> assignment(
+      "node");
+  auto *root = static_cast<LinkerRoot *>(document.parseResult.value);
+  const auto cstNode = root->referrers.front()->getCstNode();
+  auto *referrer = document.parseResult.astArena->create<LinkerReferrer>();
+  referrer->setCstNode(cstNode);
+  referrer->node.initialize(*referrer, std::string(refText), cstNode,
+                            assignment, linker);
+  root->referrers.push_back(referrer);
+  referrer->setContainer(*root);
+  document.parseResult.references.push_back(
+      ReferenceHandle::direct(&referrer->node));
+  return referrer;
+}
+
 bool has_diagnostic_message(const workspace::Document &document,
                             std::string_view needle) {
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(needle) != std::string::npos) {
+    if (diagnostic.message().find(needle) != std::string::npos) {
       return true;
     }
   }
@@ -691,5 +793,192 @@ TEST(DefaultLinkerTest, ReinitializingReferenceResetsCachedResolution) {
   EXPECT_EQ(reference.get()->name, "b");
 }
 
+TEST(DefaultLinkerTest, LinkResolvesReferencesSharingAScopeKeyOnce) {
+  for (const bool sharedScope : {true, false}) {
+    auto shared = test::make_empty_shared_core_services();
+    pegium::installDefaultSharedCoreServices(*shared);
+    auto services = test::make_uninstalled_core_services(*shared, "linker");
+    pegium::installDefaultCoreServices(*services);
+    auto target =
+        make_target_document(*shared, test::make_file_uri("shared-target.link"));
+    auto provider = std::make_unique<CountingScopeProvider>(
+        std::vector<workspace::AstNodeDescription>{
+            {.name = "a",
+             .type = std::type_index(typeid(LinkerNode)),
+             .documentId = target.document->id,
+             .symbolId = target.document->makeSymbolId(*target.target)}},
+        sharedScope);
+    const auto &lookups = provider->lookups;
+    services->references.scopeProvider = std::move(provider);
+
+    auto *linker = services->references.linker.get();
+    ASSERT_NE(linker, nullptr);
+
+    auto fixture = make_reference_document(
+        *shared, *linker, test::make_file_uri("shared-referrers.link"), "a");
+    auto &document = *fixture.document;
+    std::vector<LinkerReferrer *> found{fixture.referrer};
+    std::vector<LinkerReferrer *> missing;
+    for (int index = 0; index < 3; ++index) {
+      found.push_back(add_referrer(document, *linker, "a"));
+      missing.push_back(add_referrer(document, *linker, "missing"));
+    }
+    document.state = workspace::DocumentState::ComputedScopes;
+
+    linker->link(document, {});
+
+    // One lookup per distinct name when the scope is shared, one per
+    // reference otherwise; the outcome is the same.
+    EXPECT_EQ(lookups, sharedScope ? 2u : 7u);
+    for (const auto *referrer : found) {
+      EXPECT_EQ(referrer->node.get(), target.target);
+    }
+    for (const auto *referrer : missing) {
+      EXPECT_EQ(referrer->node.state(), ReferenceState::ErrorNotFound);
+      EXPECT_EQ(referrer->node.getErrorMessage(),
+                "Could not resolve reference to LinkerNode named 'missing'.");
+    }
+  }
+}
+
+TEST(DefaultLinkerTest,
+     OverridingDefaultScopeProviderOnlySharesResolutionsWhenEnabled) {
+  for (const bool sharedResolution : {false, true}) {
+    auto shared = test::make_empty_shared_core_services();
+    pegium::installDefaultSharedCoreServices(*shared);
+    auto services = test::make_uninstalled_core_services(*shared, "linker");
+    pegium::installDefaultCoreServices(*services);
+    auto provider = std::make_unique<OverridingDefaultScopeProvider>(*services);
+    provider->setSharedResolution(sharedResolution);
+    const auto &lookups = provider->lookups;
+    services->references.scopeProvider = std::move(provider);
+
+    auto *linker = services->references.linker.get();
+    ASSERT_NE(linker, nullptr);
+
+    auto fixture = make_reference_document(
+        *shared, *linker, test::make_file_uri("overriding-referrers.link"),
+        "a");
+    auto &document = *fixture.document;
+    for (int index = 0; index < 3; ++index) {
+      (void)add_referrer(document, *linker, "a");
+    }
+    document.state = workspace::DocumentState::ComputedScopes;
+
+    linker->link(document, {});
+
+    // Every reference goes through the override unless sharing was enabled.
+    EXPECT_EQ(lookups, sharedResolution ? 1u : 4u);
+  }
+}
+
+TEST(DefaultLinkerTest, LinksLargeDocumentsInChunksReportingProblemsInOrder) {
+  auto shared = test::make_empty_shared_core_services();
+  shared->execution.taskScheduler =
+      std::make_shared<execution::TaskScheduler>(3);
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto recordingSink = std::make_shared<test::RecordingObservabilitySink>();
+  shared->observabilitySink = recordingSink;
+  auto services = test::make_uninstalled_core_services(*shared, "linker");
+  pegium::installDefaultCoreServices(*services);
+  services->references.scopeProvider =
+      std::make_unique<ThrowingScopeProvider>();
+
+  auto *linker = services->references.linker.get();
+  ASSERT_NE(linker, nullptr);
+
+  constexpr std::size_t kReferences = 5000;
+  auto fixture = make_reference_document(
+      *shared, *linker, test::make_file_uri("large.link"), "r0");
+  std::vector<LinkerReferrer *> referrers{fixture.referrer};
+  for (std::size_t index = 1; index < kReferences; ++index) {
+    referrers.push_back(add_referrer(*fixture.document, *linker,
+                                     "r" + std::to_string(index)));
+  }
+  fixture.document->state = workspace::DocumentState::ComputedScopes;
+
+  EXPECT_NO_THROW(linker->link(*fixture.document, {}));
+  for (const auto *referrer : referrers) {
+    EXPECT_EQ(referrer->node.state(), ReferenceState::ErrorException);
+  }
+  const auto observations = recordingSink->observations();
+  ASSERT_EQ(observations.size(), kReferences);
+  for (std::size_t index = 0; index < kReferences; ++index) {
+    EXPECT_NE(observations[index].message.find(
+                  "'r" + std::to_string(index) + "'"),
+              std::string::npos);
+  }
+}
+
+TEST(DefaultLinkerTest, DetectsCyclicResolutionAcrossThreads) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto services = test::make_uninstalled_core_services(*shared, "linker");
+  pegium::installDefaultCoreServices(*services);
+  auto provider = std::make_unique<CrossingScopeProvider>();
+  auto &crossing = *provider;
+  services->references.scopeProvider = std::move(provider);
+
+  auto *linker = services->references.linker.get();
+  ASSERT_NE(linker, nullptr);
+
+  auto fixture = make_reference_document(
+      *shared, *linker, test::make_file_uri("crossing.link"), "a");
+  crossing.first = fixture.referrer;
+  crossing.second = add_referrer(*fixture.document, *linker, "b");
+  fixture.document->state = workspace::DocumentState::ComputedScopes;
+
+  // Each thread ends up waiting on the reference the other one resolves; one
+  // of them must report the cycle instead of waiting forever.
+  std::thread other([&crossing] { (void)crossing.second->node.get(); });
+  (void)crossing.first->node.get();
+  other.join();
+
+  const auto firstState = crossing.first->node.state();
+  const auto secondState = crossing.second->node.state();
+  EXPECT_EQ((firstState == ReferenceState::ErrorCycle) +
+                (secondState == ReferenceState::ErrorCycle),
+            1);
+  EXPECT_TRUE(firstState == ReferenceState::ErrorNotFound ||
+              secondState == ReferenceState::ErrorNotFound);
+}
+
+TEST(DefaultLinkerTest, DefersCyclicResolutionAcrossThreadsToTheCaller) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto services = test::make_uninstalled_core_services(*shared, "linker");
+  pegium::installDefaultCoreServices(*services);
+  auto provider = std::make_unique<CrossingScopeProvider>();
+  auto &crossing = *provider;
+  services->references.scopeProvider = std::move(provider);
+
+  auto *linker = services->references.linker.get();
+  ASSERT_NE(linker, nullptr);
+
+  auto fixture = make_reference_document(
+      *shared, *linker, test::make_file_uri("deferred.link"), "a");
+  crossing.first = fixture.referrer;
+  crossing.second = add_referrer(*fixture.document, *linker, "b");
+  fixture.document->state = workspace::DocumentState::ComputedScopes;
+
+  // Whichever thread closes the cycle, both back off and leave their
+  // reference unresolved.
+  const auto resolveDeferred = [](const LinkerReferrer &referrer) {
+    const DeferCyclicResolutions defer;
+    EXPECT_THROW((void)referrer.node.get(), CyclicReferenceResolution);
+  };
+  std::thread other([&] { resolveDeferred(*crossing.second); });
+  resolveDeferred(*crossing.first);
+  other.join();
+  EXPECT_EQ(crossing.first->node.state(), ReferenceState::Unresolved);
+  EXPECT_EQ(crossing.second->node.state(), ReferenceState::Unresolved);
+
+  // Resolving them again in order reports the cycle on the second one.
+  crossing.synchronized = false;
+  EXPECT_EQ(crossing.first->node.get(), nullptr);
+  EXPECT_EQ(crossing.first->node.state(), ReferenceState::ErrorNotFound);
+  EXPECT_EQ(crossing.second->node.state(), ReferenceState::ErrorCycle);
+}
+
 } // namespace
 } // namespace pegium::references
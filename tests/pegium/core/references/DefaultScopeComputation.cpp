@@ -9,6 +9,7 @@
 #include <vector>
 
 #include <pegium/core/CoreTestSupport.hpp>
+#include <pegium/core/references/DefaultNameProvider.hpp>
 #include <pegium/core/references/DefaultScopeComputation.hpp>
 #include <pegium/core/syntax-tree/RootCstNode.hpp>
 #include <pegium/core/text/TextSnapshot.hpp>
@@ -76,6 +77,20 @@ private:
   std::string _prefix;
 };
 
+// Names nodes that do not derive from `NamedAstNode`, overriding only
+// `getName`.
+class OverridingDefaultNameProvider final : public DefaultNameProvider {
+public:
+  [[nodiscard]] std::optional<std::string>
+  getName(const AstNode &node) const override {
+    if (const auto *named = dynamic_cast<const NamedScopeNode *>(&node);
+        named != nullptr && !named->name.empty()) {
+      return named->name;
+    }
+    return std::nullopt;
+  }
+};
+
 class TestDescriptionProvider final : public workspace::AstNodeDescriptionProvider {
 public:
   explicit TestDescriptionProvider(std::string prefix = {})
@@ -141,7 +156,7 @@ collect_names(const std::vector<workspace::AstNodeDescription> &descriptions) {
   std::vector<std::string> names;
   names.reserve(descriptions.size());
   for (const auto &description : descriptions) {
-    names.push_back(description.name);
+    names.emplace_back(description.name);
   }
   std::ranges::sort(names);
   return names;
@@ -150,12 +165,9 @@ collect_names(const std::vector<workspace::AstNodeDescription> &descriptions) {
 std::vector<std::string> collect_local_names(const workspace::LocalSymbols &symbols) {
   std::vector<std::string> names;
   names.reserve(symbols.size());
-  for (const auto &[container, entries] : symbols) {
-    (void)container;
-    for (const auto &bucket : entries) {
-      for (const auto &description : bucket.ownedEntries) {
-        names.push_back(description.name);
-      }
+  for (const auto &bucket : symbols.buckets()) {
+    for (const auto &description : bucket.entries()) {
+      names.emplace_back(description.name);
     }
   }
   std::ranges::sort(names);
@@ -196,6 +208,28 @@ TEST(DefaultScopeComputationTest, CollectsNamedDescendantsIntoLocalSymbols) {
             (std::vector<std::string>{"branch", "leaf", "nested", "nested2"}));
 }
 
+TEST(DefaultScopeComputationTest,
+     DoesNotPruneByNamedAstNodeForSubclassedDefaultNameProvider) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto services = test::make_uninstalled_core_services(*shared, "test");
+  pegium::installDefaultCoreServices(*services);
+  services->references.nameProvider =
+      std::make_unique<OverridingDefaultNameProvider>();
+  services->workspace.astNodeDescriptionProvider =
+      std::make_unique<TestDescriptionProvider>();
+
+  EXPECT_FALSE(services->references.nameProvider->namedTypes().has_value());
+  EXPECT_TRUE(DefaultNameProvider().namedTypes().has_value());
+
+  const auto document = make_scope_document();
+  const auto symbols =
+      services->references.scopeComputation->collectLocalSymbols(*document, {});
+
+  EXPECT_EQ(collect_local_names(symbols),
+            (std::vector<std::string>{"branch", "leaf", "nested", "nested2"}));
+}
+
 TEST(DefaultScopeComputationTest, UsesProvidersFromCoreServicesAtCallTime) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
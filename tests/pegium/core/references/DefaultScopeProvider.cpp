@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <optional>
 #include <span>
 #include <string>
@@ -110,6 +111,7 @@ public:
                         utils::CancellationToken) override {}
 
   bool removeContent(workspace::DocumentId documentId) override {
+    ++_exportsGeneration;
     return _exportsByDocument.erase(documentId) > 0;
   }
 
@@ -126,6 +128,7 @@ public:
   std::vector<workspace::AstNodeDescription>
   allElements(std::optional<std::type_index> type = std::nullopt,
               std::span<const workspace::DocumentId> documentIds = {}) const override {
+    ++allElementsCalls;
     std::vector<workspace::AstNodeDescription> result;
 
     auto append = [&](workspace::DocumentId documentId) {
@@ -176,15 +179,22 @@ public:
     return false;
   }
 
+  std::uint64_t exportsFingerprint() const override {
+    return _exportsGeneration;
+  }
+
   void setExports(
       workspace::DocumentId documentId,
       std::vector<workspace::AstNodeDescription> exports) {
     for (auto &entry : exports) {
       entry.documentId = documentId;
     }
+    ++_exportsGeneration;
     _exportsByDocument.insert_or_assign(documentId, std::move(exports));
   }
 
+  mutable std::size_t allElementsCalls = 0;
+
 private:
   bool matchesType(std::type_index actual, std::type_index expected) const {
     if (actual == expected) {
@@ -194,6 +204,7 @@ private:
   }
 
   const AstReflection *_reflection;
+  std::uint64_t _exportsGeneration = 0;
   std::unordered_map<workspace::DocumentId,
                      std::vector<workspace::AstNodeDescription>>
       _exportsByDocument;
@@ -335,7 +346,7 @@ std::vector<std::string>
 collect_names(const ScopeProvider &scopeProvider, const ReferenceInfo &info) {
   std::vector<std::string> names;
   const auto collectEntry = [&names](const workspace::AstNodeDescription &entry) {
-    names.push_back(entry.name);
+    names.emplace_back(entry.name);
     return true;
   };
   const auto completed = scopeProvider.visitScopeEntries(
@@ -385,6 +396,44 @@ TEST(DefaultScopeProviderTest, InvalidatesGlobalScopeCacheWhenDocumentChanges) {
             (std::vector<std::string>{"second"}));
 }
 
+TEST(DefaultScopeProviderTest,
+     KeepsGlobalScopeCacheWarmWhenExportsAreUnchanged) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto *builder = new test::RecordingEventDocumentBuilder();
+  shared->workspace.documentBuilder.reset(builder);
+  auto *indexManager = new TestIndexManager(shared->astReflection.get());
+  shared->workspace.indexManager.reset(indexManager);
+
+  auto services = test::make_uninstalled_core_services(*shared, "test");
+  pegium::installDefaultCoreServices(*services);
+  auto *scopeProvider = services->references.scopeProvider.get();
+  auto *linker = services->references.linker.get();
+  ASSERT_NE(scopeProvider, nullptr);
+  ASSERT_NE(linker, nullptr);
+
+  auto fixture = make_attached_reference_holder<RefHolder, TargetNode>(
+      *shared, *linker, test::make_file_uri("scope-provider-warm.test"),
+      "value");
+  const auto documentId = fixture.document->id;
+  const auto refType = std::type_index(typeid(TargetNode));
+
+  indexManager->setExports(
+      documentId,
+      {{.name = "value", .type = refType, .documentId = documentId}});
+
+  auto allInfo = makeReferenceInfo(fixture.holder->ref);
+  allInfo.referenceText = {};
+  EXPECT_EQ(collect_names(*scopeProvider, allInfo),
+            (std::vector<std::string>{"value"}));
+  const auto callsAfterFirstLookup = indexManager->allElementsCalls;
+
+  builder->emitUpdate({documentId}, {});
+  EXPECT_EQ(collect_names(*scopeProvider, allInfo),
+            (std::vector<std::string>{"value"}));
+  EXPECT_EQ(indexManager->allElementsCalls, callsAfterFirstLookup);
+}
+
 TEST(DefaultScopeProviderTest, InvalidatesGlobalScopeCacheWhenDocumentIsDeleted) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
@@ -602,7 +651,7 @@ TEST(DefaultScopeProviderTest, StopsVisitingAsSoonAsVisitorReturnsFalse) {
   std::vector<std::string> visited;
   const auto collectEntry =
       [&visited](const workspace::AstNodeDescription &entry) {
-        visited.push_back(entry.name);
+        visited.emplace_back(entry.name);
         return false;
       };
   const auto completed = scopeProvider->visitScopeEntries(
@@ -641,5 +690,36 @@ TEST(DefaultScopeProviderTest, AllowsDerivedProviderToOverrideGlobalEntriesHook)
             (std::vector<std::string>{"hooked"}));
 }
 
+TEST(DefaultScopeProviderTest, OnlyTellsLookupNamesWhenNotSubclassed) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto services = test::make_uninstalled_core_services(*shared, "test");
+  pegium::installDefaultCoreServices(*services);
+  auto *linker = services->references.linker.get();
+  ASSERT_NE(linker, nullptr);
+
+  auto fixture = make_attached_reference_holder<RefHolder, TargetNode>(
+      *shared, *linker, test::make_file_uri("scope-provider-lookup.test"),
+      "wanted");
+  TestReferenceAssignment<RefHolder, TargetNode> assignment("ref");
+  const ReferenceInfo info{fixture.holder, "wanted", assignment};
+  const auto lookupNames = [&info](const ScopeProvider &provider) {
+    std::vector<std::string> names;
+    const auto collect = [&names](std::string_view name) {
+      names.emplace_back(name);
+    };
+    const auto told = provider.visitLookupNames(
+        info, utils::function_ref<void(std::string_view)>(collect));
+    return std::pair{told, names};
+  };
+
+  const DefaultScopeProvider plain(*services);
+  EXPECT_EQ(lookupNames(plain),
+            std::pair(true, std::vector<std::string>{"wanted"}));
+  const OverridingGlobalScopeProvider overriding(*services, {});
+  EXPECT_EQ(lookupNames(overriding),
+            std::pair(false, std::vector<std::string>{}));
+}
+
 } // namespace
 } // namespace pegium::references
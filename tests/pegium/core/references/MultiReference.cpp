@@ -1,12 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <pegium/core/CoreTestSupport.hpp>
 #include <pegium/core/parser/PegiumParser.hpp>
 #include <pegium/core/references/References.hpp>
+#include <pegium/core/workspace/DocumentResidency.hpp>
 
 namespace pegium::references {
 namespace {
@@ -67,7 +69,7 @@ protected:
 bool has_diagnostic_message(const workspace::Document &document,
                             std::string_view needle) {
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(needle) != std::string::npos) {
+    if (diagnostic.message().find(needle) != std::string::npos) {
       return true;
     }
   }
@@ -357,5 +359,48 @@ TEST(MultiReferenceTest,
   EXPECT_TRUE(siblingIncluded);
 }
 
+TEST(MultiReferenceTest,
+     FindReferencesExpandsSiblingsOfAMultiReferenceInAnEvictedDocument) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  ASSERT_TRUE(register_language(*shared));
+
+  auto document = open_and_build(*shared, "declarations.mr",
+                                 "person Alice\n"
+                                 "person Alice\n");
+  ASSERT_NE(document, nullptr);
+  // Not opened, so the residency may evict it once built.
+  auto greeting = shared->workspace.documentFactory->fromString(
+      "hello Alice\n", test::make_file_uri("greeting.mr"));
+  ASSERT_NE(greeting, nullptr);
+  shared->workspace.documents->addDocument(greeting);
+  const std::array<std::shared_ptr<workspace::Document>, 1> built{greeting};
+  shared->workspace.documentBuilder->build(built);
+
+  auto &residency = *shared->workspace.documentResidency;
+  residency.setMemoryBudget(1);
+  residency.enforceBudget();
+  ASSERT_TRUE(greeting->isEvicted());
+  ASSERT_FALSE(document->isEvicted());
+
+  auto *model = dynamic_cast<Model *>(document->parseResult.value);
+  ASSERT_NE(model, nullptr);
+  ASSERT_EQ(model->persons.size(), 2u);
+  const auto &services = shared->serviceRegistry->getServices(document->uri);
+  const auto alice1Id = document->makeSymbolId(*model->persons[1]);
+
+  FindReferencesOptions options{};
+  options.includeDeclaration = true;
+  const auto refs = services.references.references->findReferences(
+      *model->persons[0], options);
+
+  // The multi-reference is found in the source document restored on demand.
+  EXPECT_TRUE(std::ranges::any_of(refs, [&](const auto &r) {
+    return r.local && r.targetSymbolId.has_value() &&
+           *r.targetSymbolId == alice1Id;
+  }));
+  EXPECT_FALSE(greeting->isEvicted());
+}
+
 } // namespace
 } // namespace pegium::references
@@ -2,6 +2,7 @@
 
 #include <ranges>
 #include <typeindex>
+#include <utility>
 
 #include <pegium/core/parser/PegiumParser.hpp>
 #include <pegium/core/parser/AstReflectionBootstrap.hpp>
@@ -61,6 +62,28 @@ protected:
   Rule<BaseType> BaseRule{"Base", MidRule};
 };
 
+struct ContainedLeaf : AstNode {};
+struct HolderBase : AstNode {
+  pointer<ContainedLeaf> inner;
+};
+struct Holder : HolderBase {};
+struct ContainerNode : AstNode {
+  vector<pointer<Holder>> holders;
+};
+
+class ContainmentReflectionParser final : public PegiumParser {
+protected:
+  const grammar::ParserRule &getEntryRule() const noexcept override {
+    return ContainerRule;
+  }
+
+  Rule<ContainedLeaf> LeafRule{"Leaf", "leaf"_kw};
+  Rule<Holder> HolderRule{"Holder",
+                          "holder"_kw + assign<&Holder::inner>(LeafRule)};
+  Rule<ContainerNode> ContainerRule{
+      "Container", some(append<&ContainerNode::holders>(HolderRule))};
+};
+
 TEST(AstReflectionTest, MatchesExactAndTransitiveSubtypes) {
   AstReflection reflection;
   TransitiveReflectionParser parser;
@@ -173,5 +196,31 @@ TEST(AstReflectionTest, PropagatesTransitiveSubtypeOnLaterRegistration) {
                                    std::type_index(typeid(BaseType))));
 }
 
+TEST(AstReflectionTest, RecordsTheContainmentTheGrammarDescribes) {
+  AstReflection reflection;
+  ContainmentReflectionParser parser;
+  bootstrapAstReflection(static_cast<const Parser &>(parser).getEntryRule(),
+                         reflection);
+
+  const auto id = [&reflection](const std::type_info &type) {
+    return reflection.typeId(std::type_index(type));
+  };
+  const auto containments = reflection.containments();
+  const auto contains = [&containments](AstTypeId container, AstTypeId child) {
+    return std::ranges::find(containments, std::pair{container, child}) !=
+           containments.end();
+  };
+  EXPECT_TRUE(contains(id(typeid(ContainerNode)), id(typeid(Holder))));
+  // `Holder::inner` is declared by `HolderBase`, which the grammar never
+  // produces: the produced `Holder` is probed into a subtype of it.
+  EXPECT_TRUE(contains(id(typeid(HolderBase)), id(typeid(ContainedLeaf))));
+  EXPECT_TRUE(reflection.isSubtype(id(typeid(Holder)), id(typeid(HolderBase))));
+
+  EXPECT_TRUE(reflection.isContainmentSealed(id(typeid(ContainerNode))));
+  EXPECT_TRUE(reflection.isContainmentSealed(id(typeid(Holder))));
+  EXPECT_TRUE(reflection.isContainmentSealed(id(typeid(ContainedLeaf))));
+  EXPECT_FALSE(reflection.isContainmentSealed(id(typeid(HolderBase))));
+}
+
 } // namespace
 } // namespace pegium
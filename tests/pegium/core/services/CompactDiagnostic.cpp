@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <pegium/core/services/CompactDiagnostic.hpp>
+
+namespace pegium {
+namespace {
+
+std::size_t renderedMessages = 0;
+
+std::string greeting_message(DiagnosticTemplate::Arguments arguments) {
+  ++renderedMessages;
+  return "Hello " + arguments.interned[0].str() + std::string(arguments.text);
+}
+
+std::optional<JsonValue> greeting_data(DiagnosticTemplate::Arguments arguments) {
+  return JsonValue(JsonValue::Object{{"name", arguments.interned[0].str()}});
+}
+
+constexpr DiagnosticTemplate kGreeting{.message = &greeting_message,
+                                       .data = &greeting_data};
+
+TEST(CompactDiagnosticTest, RoundTripsARenderedDiagnostic) {
+  Diagnostic diagnostic{.severity = DiagnosticSeverity::Warning,
+                        .message = "Unused import.",
+                        .source = "mini",
+                        .code = DiagnosticCode(std::string("unused")),
+                        .codeDescription = "https://example.org/unused",
+                        .tags = {DiagnosticTag::Unnecessary},
+                        .relatedInformation = {{.uri = "file:///other.mini",
+                                                .message = "Declared here",
+                                                .begin = 1,
+                                                .end = 2}},
+                        .data = JsonValue(JsonValue::Object{{"fix", true}}),
+                        .begin = 3,
+                        .end = 9};
+
+  const CompactDiagnostic compact(diagnostic);
+  EXPECT_EQ(compact.source, "mini");
+  ASSERT_TRUE(compact.code.has_value());
+  EXPECT_EQ(std::get<utils::InternedString>(*compact.code), "unused");
+  EXPECT_EQ(compact.message(), "Unused import.");
+
+  const auto materialized = compact.materialize();
+  EXPECT_EQ(materialized.severity, diagnostic.severity);
+  EXPECT_EQ(materialized.message, diagnostic.message);
+  EXPECT_EQ(materialized.source, diagnostic.source);
+  EXPECT_EQ(materialized.code, diagnostic.code);
+  EXPECT_EQ(materialized.codeDescription, diagnostic.codeDescription);
+  EXPECT_EQ(materialized.tags, diagnostic.tags);
+  ASSERT_EQ(materialized.relatedInformation.size(), 1U);
+  EXPECT_EQ(materialized.relatedInformation.front().message, "Declared here");
+  ASSERT_TRUE(materialized.data.has_value());
+  EXPECT_EQ(materialized.data->toJsonString({.pretty = false}),
+            R"({"fix":true})");
+  EXPECT_EQ(materialized.begin, 3U);
+  EXPECT_EQ(materialized.end, 9U);
+
+  const CompactDiagnostic numbered(Diagnostic{.code = DiagnosticCode(42)});
+  EXPECT_EQ(numbered.details, nullptr);
+  EXPECT_EQ(numbered.materialize().code, DiagnosticCode(42));
+}
+
+TEST(CompactDiagnosticTest, RendersTemplatedMessagesOnlyWhenAsked) {
+  renderedMessages = 0;
+  CompactDiagnostic compact;
+  compact.source = "mini";
+  compact.messageTemplate = &kGreeting;
+  compact.arguments = {utils::InternedString("world")};
+  compact.text = ".";
+  EXPECT_EQ(renderedMessages, 0U);
+
+  const auto materialized = materialize(std::span(&compact, 1));
+  EXPECT_EQ(renderedMessages, 1U);
+  ASSERT_EQ(materialized.size(), 1U);
+  EXPECT_EQ(materialized.front().message, "Hello world.");
+  EXPECT_EQ(materialized.front().source, "mini");
+  EXPECT_FALSE(materialized.front().code.has_value());
+  ASSERT_TRUE(materialized.front().data.has_value());
+  EXPECT_EQ(materialized.front().data->toJsonString({.pretty = false}),
+            R"({"name":"world"})");
+}
+
+} // namespace
+} // namespace pegium
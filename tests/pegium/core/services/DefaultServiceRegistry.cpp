@@ -6,6 +6,8 @@
 
 #include <pegium/core/CoreTestSupport.hpp>
 #include <pegium/core/parser/PegiumParser.hpp>
+#include <pegium/core/services/DefaultServiceRegistry.hpp>
+#include <pegium/core/workspace/Document.hpp>
 
 namespace pegium {
 namespace {
@@ -267,6 +269,104 @@ TEST(DefaultServiceRegistryTest,
             "calc");
 }
 
+std::shared_ptr<workspace::Document>
+make_document(std::string uri, std::string languageId) {
+  return std::make_shared<workspace::Document>(
+      std::make_shared<workspace::TextDocument>(workspace::TextDocument::create(
+          std::move(uri), std::move(languageId), 0, "content")));
+}
+
+TEST(DefaultServiceRegistryTest,
+     DocumentBindingIsCachedUntilLanguageMappingsChange) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices =
+      test::make_uninstalled_core_services(*shared, "calc", {".calc"});
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  auto document = make_document(test::make_file_uri("bound.calc"), "calc");
+  EXPECT_EQ(document->servicesBinding(), 0u);
+  const auto &first = shared->serviceRegistry->getServices(*document);
+  EXPECT_EQ(first.languageMetaData.languageId, "calc");
+  const auto binding = document->servicesBinding();
+  EXPECT_NE(binding, 0u);
+  EXPECT_EQ(&shared->serviceRegistry->getServices(*document), &first);
+  EXPECT_EQ(document->servicesBinding(), binding);
+
+  {
+    auto registeredServices =
+      test::make_uninstalled_core_services(*shared, "calc", {".calc"});
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  const auto &replaced = shared->serviceRegistry->getServices(*document);
+  EXPECT_NE(&replaced, &first);
+  EXPECT_EQ(&replaced, &shared->serviceRegistry->getServices(document->uri));
+  EXPECT_NE(document->servicesBinding(), binding);
+}
+
+struct RetireCountingServices final : pegium::CoreServices {
+  RetireCountingServices(const pegium::SharedCoreServices &sharedServices,
+                         int &retired)
+      : pegium::CoreServices(sharedServices), retired(retired) {
+    languageMetaData.languageId = "calc";
+    languageMetaData.fileExtensions = {".calc"};
+    parser = std::make_unique<test::FakeParser>();
+    pegium::installDefaultCoreServices(*this);
+  }
+
+  void retire() noexcept override { ++retired; }
+
+  int &retired;
+};
+
+TEST(DefaultServiceRegistryTest, RetiresReplacedServicesAndKeepsThemAlive) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  DefaultServiceRegistry registry(*shared);
+  int firstRetired = 0;
+  int secondRetired = 0;
+
+  registry.registerServices(
+      std::make_unique<RetireCountingServices>(*shared, firstRetired));
+  const auto &first = registry.getServices(test::make_file_uri("a.calc"));
+  EXPECT_EQ(registry.retiredServicesCount(), 0u);
+
+  registry.registerServices(
+      std::make_unique<RetireCountingServices>(*shared, secondRetired));
+  EXPECT_EQ(firstRetired, 1);
+  EXPECT_EQ(secondRetired, 0);
+  EXPECT_EQ(registry.retiredServicesCount(), 1u);
+  EXPECT_EQ(first.languageMetaData.languageId, "calc");
+  EXPECT_NE(&registry.getServices(test::make_file_uri("a.calc")), &first);
+}
+
+TEST(DefaultServiceRegistryTest,
+     DocumentBindingFollowsTheAttachedTextDocumentLanguage) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto first = test::make_uninstalled_core_services(*shared, "calc", {".calc"});
+  pegium::installDefaultCoreServices(*first);
+  auto second = test::make_uninstalled_core_services(*shared, "req", {".req"});
+  pegium::installDefaultCoreServices(*second);
+  shared->serviceRegistry->registerServices(std::move(first));
+  shared->serviceRegistry->registerServices(std::move(second));
+
+  auto document = make_document(test::make_file_uri("attached.calc"), "req");
+  EXPECT_EQ(shared->serviceRegistry->getServices(*document)
+                .languageMetaData.languageId,
+            "req");
+
+  auto unknown = make_document(test::make_file_uri("fallback.calc"), "none");
+  EXPECT_EQ(shared->serviceRegistry->getServices(*unknown)
+                .languageMetaData.languageId,
+            "calc");
+}
+
 TEST(DefaultServiceRegistryTest, BootstrapsAstReflectionFromParserGrammar) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
@@ -5,6 +5,7 @@
 #include <pegium/core/text/TextSnapshot.hpp>
 
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace pegium {
@@ -146,5 +147,67 @@ TEST_F(AstArenaTest, NodesPreserveTreeStructure) {
   EXPECT_EQ(seen[1], child2);
 }
 
+TEST_F(AstArenaTest, VisitsDescendantsInPreorderSkippingPrunedSubtrees) {
+  auto cst = make_dummy_cst(); AstArena arena(cst);
+  auto *root = arena.create<CountingNode>();
+  auto *first = arena.create<CountingNode>();
+  auto *firstChild = arena.create<CountingNode>();
+  auto *firstGrandChild = arena.create<CountingNode>();
+  auto *second = arena.create<CountingNode>();
+  auto *secondChild = arena.create<CountingNode>();
+  first->setContainer(*root);
+  firstChild->setContainer(*first);
+  firstGrandChild->setContainer(*firstChild);
+  second->setContainer(*root);
+  secondChild->setContainer(*second);
+
+  std::vector<const AstNode *> all;
+  root->visitDescendants([&all](const AstNode &node) {
+    all.push_back(&node);
+    return true;
+  });
+  std::vector<const AstNode *> expected;
+  for (const auto *node : std::as_const(*root).getAllContent()) {
+    expected.push_back(node);
+  }
+  EXPECT_EQ(all, expected);
+
+  std::vector<const AstNode *> pruned;
+  root->visitDescendants([&pruned, first](const AstNode &node) {
+    pruned.push_back(&node);
+    return &node != first;
+  });
+  EXPECT_EQ(pruned,
+            (std::vector<const AstNode *>{first, second, secondChild}));
+
+  // Only the descendants of the node are visited.
+  std::vector<const AstNode *> subtree;
+  firstChild->visitDescendants([&subtree](const AstNode &node) {
+    subtree.push_back(&node);
+    return true;
+  });
+  EXPECT_EQ(subtree, (std::vector<const AstNode *>{firstGrandChild}));
+}
+
+TEST_F(AstArenaTest, RecordsTheTypeIdOfEachNode) {
+  AstReflection reflection;
+  reflection.registerType(typeid(StringHolderNode));
+  reflection.registerType(typeid(VectorHolderNode));
+
+  auto cst = make_dummy_cst(); AstArena arena(cst, &reflection);
+  const auto *strings = arena.create<StringHolderNode>();
+  const auto *vectors = arena.create<VectorHolderNode>();
+  const auto *unknown = arena.create<CountingNode>();
+
+  EXPECT_EQ(strings->typeId(), reflection.typeId(typeid(StringHolderNode)));
+  EXPECT_EQ(vectors->typeId(), reflection.typeId(typeid(VectorHolderNode)));
+  EXPECT_EQ(unknown->typeId(), kNoAstType);
+  EXPECT_EQ(arena.typeId(strings->symbolId()), strings->typeId());
+
+  // Without a reflection, nodes have no type id.
+  auto otherCst = make_dummy_cst(); AstArena bare(otherCst);
+  EXPECT_EQ(bare.create<StringHolderNode>()->typeId(), kNoAstType);
+}
+
 } // namespace
 } // namespace pegium
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <pegium/core/syntax-tree/AstNode.hpp>
+#include <pegium/core/syntax-tree/AstReflection.hpp>
+
+#include <typeindex>
+#include <utility>
+
+namespace pegium {
+namespace {
+
+struct Base : AstNode {};
+struct Middle : Base {};
+struct Leaf : Middle {};
+struct Other : AstNode {};
+
+TEST(AstReflectionTest, AssignsDenseStableTypeIds) {
+  AstReflection reflection;
+  reflection.registerType(typeid(Base));
+  const auto base = reflection.typeId(typeid(Base));
+  reflection.registerSubtype(typeid(Leaf), typeid(Base));
+
+  ASSERT_NE(base, kNoAstType);
+  EXPECT_EQ(reflection.typeId(typeid(Base)), base);
+  EXPECT_LT(reflection.typeId(typeid(Leaf)), reflection.typeCount());
+  EXPECT_EQ(reflection.typeOf(base), std::type_index(typeid(Base)));
+  EXPECT_EQ(reflection.typeId(typeid(Other)), kNoAstType);
+  EXPECT_EQ(reflection.typeId(typeid(void)), kNoAstType);
+}
+
+TEST(AstReflectionTest, SubtypeBitsFollowTheTransitiveRelation) {
+  AstReflection reflection;
+  // Edges registered bottom-up must still close transitively.
+  reflection.registerSubtype(typeid(Leaf), typeid(Middle));
+  reflection.registerSubtype(typeid(Middle), typeid(Base));
+  reflection.registerType(typeid(Other));
+  const auto id = [&reflection](const std::type_info &type) {
+    return reflection.typeId(type);
+  };
+
+  EXPECT_TRUE(reflection.isSubtype(id(typeid(Leaf)), id(typeid(Base))));
+  EXPECT_TRUE(reflection.isSubtype(id(typeid(Middle)), id(typeid(Middle))));
+  EXPECT_FALSE(reflection.isSubtype(id(typeid(Base)), id(typeid(Leaf))));
+  EXPECT_FALSE(reflection.isSubtype(id(typeid(Other)), id(typeid(Base))));
+  EXPECT_FALSE(reflection.isSubtype(kNoAstType, id(typeid(Base))));
+}
+
+template <int N> struct Numbered : Base {};
+
+template <int... N>
+void register_numbered(AstReflection &reflection,
+                       std::integer_sequence<int, N...>) {
+  (reflection.registerSubtype(typeid(Numbered<N>), typeid(Base)), ...);
+}
+
+TEST(AstReflectionTest, SubtypeBitsAgreeWithTypeQueriesBeyondOneWord) {
+  // More than 64 types widen every row of the bit matrix.
+  AstReflection reflection;
+  reflection.registerSubtype(typeid(Leaf), typeid(Middle));
+  register_numbered(reflection, std::make_integer_sequence<int, 80>{});
+  reflection.registerSubtype(typeid(Middle), typeid(Base));
+  reflection.registerType(typeid(Other));
+
+  ASSERT_GT(reflection.typeCount(), 64u);
+  for (const auto subtype : reflection.getAllTypes()) {
+    for (const auto supertype : reflection.getAllTypes()) {
+      EXPECT_EQ(reflection.isSubtype(reflection.typeId(subtype),
+                                     reflection.typeId(supertype)),
+                reflection.isSubtype(subtype, supertype));
+    }
+  }
+}
+
+} // namespace
+} // namespace pegium
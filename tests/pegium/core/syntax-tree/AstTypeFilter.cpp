@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/syntax-tree/AstTypeFilter.hpp>
+#include <pegium/core/syntax-tree/RootCstNode.hpp>
+#include <pegium/core/text/TextSnapshot.hpp>
+
+#include <typeindex>
+#include <vector>
+
+namespace pegium {
+namespace {
+
+struct ModelNode : AstNode {};
+struct DeclarationBase : AstNode {};
+struct Declaration : DeclarationBase {};
+struct Body : AstNode {};
+struct Statement : AstNode {};
+struct Opaque : AstNode {};
+
+// Model -> DeclarationBase -> Body -> Statement, plus Model -> Opaque whose
+// children are not described.
+AstReflection make_reflection() {
+  AstReflection reflection;
+  reflection.registerSubtype(typeid(Declaration), typeid(DeclarationBase));
+  reflection.registerContainment(typeid(ModelNode), typeid(DeclarationBase));
+  reflection.registerContainment(typeid(ModelNode), typeid(Opaque));
+  reflection.registerContainment(typeid(Declaration), typeid(Body));
+  reflection.registerContainment(typeid(Body), typeid(Statement));
+  for (const auto type :
+       {std::type_index(typeid(ModelNode)), std::type_index(typeid(Declaration)),
+        std::type_index(typeid(Body)), std::type_index(typeid(Statement))}) {
+    reflection.sealContainment(type);
+  }
+  return reflection;
+}
+
+struct Tree {
+  explicit Tree(const AstReflection &reflection)
+      : cst(text::TextSnapshot::copy("")), arena(cst, &reflection) {
+    model = arena.create<ModelNode>();
+    declaration = arena.create<Declaration>();
+    body = arena.create<Body>();
+    statement = arena.create<Statement>();
+    opaque = arena.create<Opaque>();
+    declaration->setContainer(*model);
+    body->setContainer(*declaration);
+    statement->setContainer(*body);
+    opaque->setContainer(*model);
+  }
+
+  RootCstNode cst;
+  AstArena arena;
+  ModelNode *model = nullptr;
+  Declaration *declaration = nullptr;
+  Body *body = nullptr;
+  Statement *statement = nullptr;
+  Opaque *opaque = nullptr;
+};
+
+TEST(AstTypeFilterTest, PrunesSubtreesThatCannotHoldATarget) {
+  const auto reflection = make_reflection();
+  const Tree tree(reflection);
+  const std::vector targets{std::type_index(typeid(DeclarationBase))};
+  const AstTypeFilter filter(reflection, targets);
+
+  EXPECT_FALSE(filter.selects(*tree.model));
+  EXPECT_TRUE(filter.mayContainSelected(*tree.model));
+  EXPECT_TRUE(filter.selects(*tree.declaration));
+  EXPECT_FALSE(filter.mayContainSelected(*tree.declaration));
+  EXPECT_FALSE(filter.selects(*tree.body));
+  EXPECT_FALSE(filter.mayContainSelected(*tree.body));
+  // Undescribed children may be anything.
+  EXPECT_FALSE(filter.selects(*tree.opaque));
+  EXPECT_TRUE(filter.mayContainSelected(*tree.opaque));
+}
+
+TEST(AstTypeFilterTest, PropagatesThroughIntermediateContainers) {
+  const auto reflection = make_reflection();
+  const Tree tree(reflection);
+  const std::vector targets{std::type_index(typeid(Statement))};
+  const AstTypeFilter filter(reflection, targets);
+
+  EXPECT_TRUE(filter.mayContainSelected(*tree.model));
+  EXPECT_TRUE(filter.mayContainSelected(*tree.declaration));
+  EXPECT_TRUE(filter.mayContainSelected(*tree.body));
+  EXPECT_TRUE(filter.selects(*tree.statement));
+  EXPECT_FALSE(filter.mayContainSelected(*tree.statement));
+}
+
+TEST(AstTypeFilterTest, SelectsEverythingWhenItCannotTell) {
+  const auto reflection = make_reflection();
+  const Tree tree(reflection);
+
+  const AstTypeFilter everything;
+  EXPECT_TRUE(everything.selects(*tree.body));
+  EXPECT_TRUE(everything.mayContainSelected(*tree.statement));
+
+  struct Unknown : AstNode {};
+  const std::vector unknownTargets{std::type_index(typeid(Unknown))};
+  const AstTypeFilter unknown(reflection, unknownTargets);
+  EXPECT_TRUE(unknown.selects(*tree.body));
+  EXPECT_TRUE(unknown.mayContainSelected(*tree.statement));
+
+  // Nodes of an arena using another reflection are not covered.
+  const auto otherReflection = make_reflection();
+  const Tree other(otherReflection);
+  const std::vector targets{std::type_index(typeid(DeclarationBase))};
+  const AstTypeFilter filter(reflection, targets);
+  EXPECT_TRUE(filter.selects(*other.body));
+  EXPECT_TRUE(filter.mayContainSelected(*other.body));
+}
+
+TEST(AstTypeFilterTest, DrivesAPrunedTraversal) {
+  const auto reflection = make_reflection();
+  const Tree tree(reflection);
+  const std::vector targets{std::type_index(typeid(DeclarationBase))};
+  const AstTypeFilter filter(reflection, targets);
+
+  std::vector<const AstNode *> visited;
+  std::vector<const AstNode *> selected;
+  tree.model->visitDescendants([&](const AstNode &node) {
+    visited.push_back(&node);
+    if (filter.selects(node)) {
+      selected.push_back(&node);
+    }
+    return filter.mayContainSelected(node);
+  });
+
+  EXPECT_EQ(visited, (std::vector<const AstNode *>{tree.declaration,
+                                                   tree.opaque}));
+  EXPECT_EQ(selected, (std::vector<const AstNode *>{tree.declaration}));
+}
+
+} // namespace
+} // namespace pegium
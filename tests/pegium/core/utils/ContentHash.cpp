@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <pegium/core/text/TextSnapshot.hpp>
+#include <pegium/core/utils/ContentHash.hpp>
+
+#include <bit>
+#include <string>
+
+using namespace pegium::utils;
+
+TEST(ContentHashTest, MatchesXxHash64ReferenceValues) {
+  if constexpr (std::endian::native != std::endian::little) {
+    GTEST_SKIP() << "Reference values assume little-endian byte order.";
+  }
+  EXPECT_EQ(content_hash(""), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(content_hash("a"), 0xD24EC4F1A98C6E5BULL);
+  EXPECT_EQ(content_hash("abc"), 0x44BC2CF5AD770999ULL);
+  EXPECT_EQ(content_hash("Nobody inspects the spammish repetition"),
+            0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(ContentHashTest, DistinguishesSingleByteChangesInLongInputs) {
+  std::string text(4096, 'x');
+  const auto original = content_hash(text);
+  text[2048] = 'y';
+  EXPECT_NE(content_hash(text), original);
+  text[2048] = 'x';
+  EXPECT_EQ(content_hash(text), original);
+}
+
+TEST(ContentHashTest, TextSnapshotCarriesTheHashOfItsText) {
+  const auto snapshot = pegium::text::TextSnapshot::own("grammar Test");
+  EXPECT_EQ(snapshot.hash(), content_hash("grammar Test"));
+  const auto copy = snapshot;
+  EXPECT_EQ(copy.hash(), snapshot.hash());
+  EXPECT_EQ(pegium::text::TextSnapshot().hash(), content_hash(""));
+}
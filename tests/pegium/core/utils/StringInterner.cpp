@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <pegium/core/utils/StringInterner.hpp>
+
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace pegium::utils;
+
+TEST(StringInternerTest, InternsEqualStringsToTheSameId) {
+  StringInterner interner;
+  const auto alpha = interner.intern("alpha");
+  const auto beta = interner.intern("beta");
+
+  EXPECT_NE(alpha, beta);
+  EXPECT_EQ(interner.intern(std::string("alpha")), alpha);
+  EXPECT_EQ(interner.view(alpha), "alpha");
+  EXPECT_EQ(interner.view(beta), "beta");
+  EXPECT_EQ(interner.intern(""), 0u);
+  EXPECT_EQ(interner.view(0), "");
+}
+
+TEST(StringInternerTest, FindDoesNotIntern) {
+  StringInterner interner;
+  const auto size = interner.size();
+
+  EXPECT_FALSE(interner.find("missing").has_value());
+  EXPECT_EQ(interner.size(), size);
+
+  const auto id = interner.intern("present");
+  EXPECT_EQ(interner.find("present"), id);
+}
+
+TEST(StringInternerTest, ReportsTheStoredCharacters) {
+  StringInterner interner;
+  EXPECT_EQ(interner.storedBytes(), 0u);
+
+  (void)interner.intern("alpha");
+  (void)interner.intern("al");
+  (void)interner.intern("alpha");
+  (void)interner.intern("");
+
+  EXPECT_EQ(interner.size(), 3u);
+  EXPECT_EQ(interner.storedBytes(), 7u);
+}
+
+TEST(StringInternerTest, KeepsViewsStableAcrossSegments) {
+  StringInterner interner;
+  const auto first = interner.intern("first");
+  const auto firstView = interner.view(first);
+  for (int index = 0; index < 5000; ++index) {
+    (void)interner.intern("name" + std::to_string(index));
+  }
+
+  EXPECT_EQ(interner.view(first).data(), firstView.data());
+  EXPECT_EQ(interner.view(interner.intern("name4999")), "name4999");
+}
+
+TEST(StringInternerTest, InternsConcurrentlyWithoutDuplicates) {
+  StringInterner interner;
+  constexpr int kThreads = 4;
+  constexpr int kNames = 2000;
+  std::vector<std::vector<InternedId>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&interner, &ids, thread] {
+      for (int index = 0; index < kNames; ++index) {
+        ids[thread].push_back(
+            interner.intern("shared" + std::to_string(index)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int thread = 1; thread < kThreads; ++thread) {
+    EXPECT_EQ(ids[thread], ids.front());
+  }
+  EXPECT_EQ(std::unordered_set<InternedId>(ids.front().begin(),
+                                           ids.front().end())
+                .size(),
+            static_cast<std::size_t>(kNames));
+}
+
+TEST(InternedStringTest, ComparesByIdAndReadsAsText) {
+  const InternedString name = "interned-name";
+  const InternedString same = std::string("interned-name");
+
+  EXPECT_EQ(name, same);
+  EXPECT_EQ(name.id(), same.id());
+  EXPECT_EQ(name, "interned-name");
+  EXPECT_EQ(std::string_view(name), "interned-name");
+  EXPECT_EQ(name.str(), "interned-name");
+  EXPECT_TRUE(InternedString().empty());
+  EXPECT_EQ(InternedString::find("interned-name"), name);
+  EXPECT_FALSE(InternedString::find("never-interned-name").has_value());
+}
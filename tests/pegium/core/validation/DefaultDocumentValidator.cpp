@@ -15,6 +15,7 @@
 #include <pegium/core/validation/DefaultDocumentValidator.hpp>
 #include <pegium/core/validation/DefaultValidationRegistry.hpp>
 #include <pegium/core/validation/DocumentValidator.hpp>
+#include <pegium/core/validation/ValidationCache.hpp>
 #include <pegium/core/workspace/Document.hpp>
 
 #include "ValidationTestUtils.hpp"
@@ -278,6 +279,16 @@ TEST(DefaultDocumentValidatorTest, LinkingDiagnosticCarriesStructuredData) {
   EXPECT_EQ(field("containerType"), "ValidationRefNode");
   EXPECT_EQ(field("property"), "ref");
   EXPECT_EQ(field("refText"), "UnknownSymbol");
+
+  // The compact form defers rendering the message and data to publishing.
+  const auto compact =
+      validator.validateDocumentCompact(document, builtInOnly, {});
+  ASSERT_EQ(compact.size(), 1u);
+  EXPECT_NE(compact.front().messageTemplate, nullptr);
+  EXPECT_EQ(compact.front().text, "UnknownSymbol");
+  EXPECT_EQ(compact.front().details, nullptr);
+  EXPECT_EQ(compact.front().source, "mini");
+  EXPECT_EQ(compact.front().message(), diagnostics.front().message);
 }
 
 TEST(DefaultDocumentValidatorTest,
@@ -366,7 +377,7 @@ TEST(DefaultDocumentValidatorTest,
       "Root", some(append<&ValidationRootNode::nodes>(nodeRule))};
 
   workspace::Document document(test::make_text_document(
-      "file:///validation-order.pg", "mini", std::string(260, ',')));
+      "file:///validation-order.pg", "mini", std::string(20000, ',')));
   document.id = 5u;
   pegium::test::parse_rule(rootRule, document, SkipperBuilder().build());
   ASSERT_TRUE(document.parseResult.value != nullptr);
@@ -380,6 +391,7 @@ TEST(DefaultDocumentValidatorTest,
 
   ValidationOptions options;
   options.categories = {"fast"};
+  options.concurrentNodeChecks = true;
   const auto diagnostics = validator.validateDocument(document, options, {});
 
   ASSERT_EQ(diagnostics.size(), expectedMessages.size() + 1U);
@@ -389,5 +401,294 @@ TEST(DefaultDocumentValidatorTest,
   }
 }
 
+TEST(DefaultDocumentValidatorTest,
+     RunsDocumentHooksSeriallyAroundParallelNodeChecks) {
+  auto sharedServices = make_validation_shared_services(3);
+  pegium::CoreServices languageServices(*sharedServices);
+  languageServices.languageMetaData.languageId = "mini";
+  auto registry = std::make_unique<DefaultValidationRegistry>(languageServices);
+  const auto emit = [](const ValidationAcceptor &acceptor, std::string message,
+                       TextOffset begin) {
+    pegium::Diagnostic diagnostic;
+    diagnostic.severity = pegium::DiagnosticSeverity::Information;
+    diagnostic.message = std::move(message);
+    diagnostic.begin = begin;
+    diagnostic.end = begin;
+    acceptor(std::move(diagnostic));
+  };
+  registry->registerBeforeDocument(
+      [&emit](const pegium::AstNode &, const ValidationAcceptor &acceptor,
+              std::span<const std::string>, const utils::CancellationToken &) {
+        emit(acceptor, "before", 0);
+      });
+  registry->registerCheck<ValidationNodeA>(
+      [&emit](const ValidationNodeA &node, const ValidationAcceptor &acceptor) {
+        const auto begin = node.getCstNode().getBegin();
+        emit(acceptor, std::to_string(begin), begin);
+      },
+      "fast");
+  registry->registerAfterDocument(
+      [&emit](const pegium::AstNode &, const ValidationAcceptor &acceptor,
+              std::span<const std::string>, const utils::CancellationToken &) {
+        emit(acceptor, "after", 0);
+      });
+  languageServices.validation.validationRegistry = std::move(registry);
+  DefaultDocumentValidator validator(languageServices);
+
+  ParserRule<ValidationNodeA> nodeRule{"Node", ","_kw};
+  ParserRule<ValidationRootNode> rootRule{
+      "Root", some(append<&ValidationRootNode::nodes>(nodeRule))};
+
+  constexpr std::size_t kNodes = 20000;
+  workspace::Document document(test::make_text_document(
+      "file:///validation-parallel-hooks.pg", "mini", std::string(kNodes, ',')));
+  document.id = 6u;
+  pegium::test::parse_rule(rootRule, document, SkipperBuilder().build());
+  ASSERT_TRUE(document.parseResult.value != nullptr);
+
+  ValidationOptions options;
+  options.categories = {"fast"};
+  options.concurrentNodeChecks = true;
+  const auto diagnostics = validator.validateDocument(document, options, {});
+
+  ASSERT_EQ(diagnostics.size(), kNodes + 2U);
+  EXPECT_EQ(diagnostics.front().message, "before");
+  EXPECT_EQ(diagnostics.back().message, "after");
+  for (std::size_t index = 0; index < kNodes; ++index) {
+    EXPECT_EQ(diagnostics[index + 1U].message, std::to_string(index));
+    EXPECT_EQ(diagnostics[index + 1U].source, "mini");
+  }
+}
+
+TEST(DefaultDocumentValidatorTest,
+     ReplaysSubtreeLocalChecksOnUnchangedSubtreesOfASuccessor) {
+  auto sharedServices = make_validation_shared_services();
+  pegium::CoreServices languageServices(*sharedServices);
+  languageServices.languageMetaData.languageId = "mini";
+  auto registry = std::make_unique<DefaultValidationRegistry>(languageServices);
+  std::size_t localRuns = 0;
+  std::size_t globalRuns = 0;
+  registry->registerCheck<ValidationNodeA>(
+      [&localRuns](const ValidationNodeA &node,
+                   const ValidationAcceptor &acceptor) {
+        ++localRuns;
+        const auto cstNode = node.getCstNode();
+        if (cstNode.getText() == "a") {
+          return;
+        }
+        pegium::Diagnostic diagnostic;
+        diagnostic.severity = pegium::DiagnosticSeverity::Warning;
+        diagnostic.message = std::string(cstNode.getText());
+        diagnostic.begin = cstNode.getBegin();
+        diagnostic.end = cstNode.getEnd();
+        acceptor(std::move(diagnostic));
+      },
+      "fast", ValidationCheckLocality::Subtree);
+  registry->registerCheck<ValidationNodeA>(
+      [&globalRuns](const ValidationNodeA &, const ValidationAcceptor &) {
+        ++globalRuns;
+      },
+      "fast");
+  languageServices.validation.validationRegistry = std::move(registry);
+  DefaultDocumentValidator validator(languageServices);
+
+  ParserRule<ValidationNodeA> nodeRule{"Node", "a"_kw | "b"_kw | "c"_kw};
+  ParserRule<ValidationRootNode> rootRule{
+      "Root", some(append<&ValidationRootNode::nodes>(nodeRule))};
+  const auto parse = [&rootRule](std::string text) {
+    auto document = std::make_unique<workspace::Document>(
+        test::make_text_document("file:///validation-memo.pg", "mini",
+                                 std::move(text)));
+    document->id = 7u;
+    pegium::test::parse_rule(rootRule, *document, SkipperBuilder().build());
+    return document;
+  };
+  const auto summarize = [](const std::vector<pegium::Diagnostic> &diagnostics) {
+    std::vector<std::string> summary;
+    for (const auto &diagnostic : diagnostics) {
+      summary.push_back(diagnostic.message + "@" +
+                        std::to_string(diagnostic.begin) + "-" +
+                        std::to_string(diagnostic.end) + ":" +
+                        diagnostic.source);
+    }
+    return summary;
+  };
+
+  ValidationOptions options;
+  options.categories = {"fast"};
+  const auto original = parse("aab");
+  EXPECT_EQ(summarize(validator.validateDocument(*original, options, {})),
+            (std::vector<std::string>{"b@2-3:mini"}));
+  EXPECT_EQ(localRuns, 3U);
+  EXPECT_EQ(globalRuns, 3U);
+
+  // Nothing changed: only the global check runs again.
+  EXPECT_EQ(summarize(validator.validateDocument(*original, options, {})),
+            (std::vector<std::string>{"b@2-3:mini"}));
+  EXPECT_EQ(localRuns, 3U);
+  EXPECT_EQ(globalRuns, 6U);
+
+  // The successor shares the memo: only its new subtree is checked, and the
+  // replayed diagnostics move along with their nodes.
+  const auto successor = parse("bacab");
+  successor->validationMemo = original->validationMemo;
+  const auto replayed = validator.validateDocument(*successor, options, {});
+  EXPECT_EQ(localRuns, 4U);
+  EXPECT_EQ(globalRuns, 11U);
+
+  const auto fresh = parse("bacab");
+  EXPECT_EQ(summarize(replayed),
+            summarize(validator.validateDocument(*fresh, options, {})));
+  EXPECT_EQ(summarize(replayed),
+            (std::vector<std::string>{"b@0-1:mini", "c@2-3:mini",
+                                      "b@4-5:mini"}));
+}
+
+TEST(DefaultDocumentValidatorTest,
+     SharesSubtreeLocalResultsAcrossDocumentsThroughAValidationCache) {
+  auto sharedServices = make_validation_shared_services();
+  pegium::CoreServices languageServices(*sharedServices);
+  languageServices.languageMetaData.languageId = "mini";
+  auto registry = std::make_unique<DefaultValidationRegistry>(languageServices);
+  std::size_t localRuns = 0;
+  registry->registerCheck<ValidationNodeA>(
+      [&localRuns](const ValidationNodeA &node,
+                   const ValidationAcceptor &acceptor) {
+        ++localRuns;
+        const auto cstNode = node.getCstNode();
+        if (cstNode.getText() == "a") {
+          return;
+        }
+        pegium::Diagnostic diagnostic;
+        diagnostic.message = std::string(cstNode.getText());
+        diagnostic.begin = cstNode.getBegin();
+        diagnostic.end = cstNode.getEnd();
+        acceptor(std::move(diagnostic));
+      },
+      "fast", ValidationCheckLocality::Subtree);
+  languageServices.validation.validationRegistry = std::move(registry);
+  languageServices.validation.validationCache =
+      std::make_unique<ValidationCache>();
+  DefaultDocumentValidator validator(languageServices);
+
+  ParserRule<ValidationNodeA> nodeRule{"Node", "a"_kw | "b"_kw | "c"_kw};
+  ParserRule<ValidationRootNode> rootRule{
+      "Root", some(append<&ValidationRootNode::nodes>(nodeRule))};
+  const auto parse = [&rootRule](std::string uri, std::string text) {
+    auto document = std::make_unique<workspace::Document>(
+        test::make_text_document(std::move(uri), "mini", std::move(text)));
+    document->id = 3u;
+    pegium::test::parse_rule(rootRule, *document, SkipperBuilder().build());
+    return document;
+  };
+  const auto summarize = [](const std::vector<pegium::Diagnostic> &diagnostics) {
+    std::vector<std::string> summary;
+    for (const auto &diagnostic : diagnostics) {
+      summary.push_back(diagnostic.message + "@" +
+                        std::to_string(diagnostic.begin) + "-" +
+                        std::to_string(diagnostic.end));
+    }
+    return summary;
+  };
+
+  ValidationOptions options;
+  options.categories = {"fast"};
+  // The second `a` already replays the results of the first one.
+  const auto first = parse("file:///first.pg", "aab");
+  EXPECT_EQ(summarize(validator.validateDocument(*first, options, {})),
+            (std::vector<std::string>{"b@2-3"}));
+  EXPECT_EQ(localRuns, 2U);
+
+  // Another document only runs the check on subtrees never seen before.
+  const auto second = parse("file:///second.pg", "cba");
+  EXPECT_EQ(summarize(validator.validateDocument(*second, options, {})),
+            (std::vector<std::string>{"c@0-1", "b@1-2"}));
+  EXPECT_EQ(localRuns, 3U);
+  EXPECT_EQ(languageServices.validation.validationCache->size(), 3U);
+}
+
+TEST(DefaultDocumentValidatorTest, ReportsProgressOnlyAtStageBoundaries) {
+  auto sharedServices = make_validation_shared_services();
+  sharedServices->execution.taskScheduler = nullptr;
+  pegium::CoreServices languageServices(*sharedServices);
+  languageServices.languageMetaData.languageId = "mini";
+  auto registry = std::make_unique<DefaultValidationRegistry>(languageServices);
+  registry->registerCheck<ValidationNodeA>(
+      [](const ValidationNodeA &node, const ValidationAcceptor &acceptor) {
+        const auto cstNode = node.getCstNode();
+        pegium::Diagnostic diagnostic;
+        diagnostic.message = "node";
+        diagnostic.begin = cstNode.getBegin();
+        diagnostic.end = cstNode.getEnd();
+        acceptor(std::move(diagnostic));
+      },
+      "fast");
+  languageServices.validation.validationRegistry = std::move(registry);
+  DefaultDocumentValidator validator(languageServices);
+
+  TerminalRule<std::string> id{"ID", "a-zA-Z_"_cr + many(w)};
+  ParserRule<ValidationNodeA> nodeRule{"Node", "a"_kw};
+  ParserRule<ValidationRootNode> rootRule{
+      "Root", some(append<&ValidationRootNode::nodes>(nodeRule))};
+  workspace::Document document(test::make_text_document(
+      "file:///validation-progress.pg", "mini", std::string(600, 'a')));
+  document.id = 1u;
+  pegium::test::parse_rule(rootRule, document, SkipperBuilder().build());
+  parser::ParseDiagnostic insertedDiagnostic;
+  insertedDiagnostic.kind = ParseDiagnosticKind::Inserted;
+  insertedDiagnostic.offset = 0;
+  insertedDiagnostic.element = std::addressof(id);
+  document.parseResult.parseDiagnostics.push_back(insertedDiagnostic);
+
+  ValidationOptions options;
+  options.categories = {std::string(kBuiltInValidationCategory), "fast"};
+  std::vector<std::size_t> reported;
+  const auto diagnostics = validator.validateDocumentCompact(
+      document, options, {},
+      [&reported](std::span<const pegium::CompactDiagnostic> pending) {
+        reported.push_back(pending.size());
+      });
+
+  // The parse error is reported on its own; the linking stage raised nothing
+  // new and the per-node checks are only delivered with the result.
+  ASSERT_EQ(diagnostics.size(), 601U);
+  EXPECT_EQ(reported, (std::vector<std::size_t>{1U}));
+}
+
+TEST(DefaultDocumentValidatorTest,
+     RunsParserExpectationsOncePerOffsetOfUnexplainedSyntaxErrors) {
+  auto sharedServices = make_validation_shared_services();
+  pegium::CoreServices languageServices(*sharedServices);
+  languageServices.languageMetaData.languageId = "mini";
+  pegium::installDefaultCoreServices(languageServices);
+  const auto keyword = "end"_kw;
+  auto parser = std::make_unique<test::FakeParser>();
+  parser->expectations.frontier.push_back(
+      parser::ExpectPath{.elements = {std::addressof(keyword)}});
+  const auto *fakeParser = parser.get();
+  languageServices.parser = std::move(parser);
+  DefaultDocumentValidator validator(languageServices);
+
+  workspace::Document document(test::make_text_document(
+      "file:///validation-expect.pg", "mini", "foo bar"));
+  document.id = 1u;
+  using enum parser::ParseDiagnosticKind;
+  document.parseResult.parseDiagnostics = {
+      {.kind = Inserted, .offset = 3, .beginOffset = 3, .endOffset = 3},
+      {.kind = Incomplete, .offset = 3, .beginOffset = 3, .endOffset = 3},
+      {.kind = Deleted, .offset = 4, .beginOffset = 4, .endOffset = 7},
+      {.kind = Inserted, .offset = 7, .beginOffset = 7, .endOffset = 7},
+  };
+
+  const auto diagnostics = validator.validateDocument(document, {}, {});
+  ASSERT_EQ(diagnostics.size(), 4U);
+  EXPECT_EQ(diagnostics[0].message, "Expecting 'end' but found ` bar`.");
+  EXPECT_EQ(diagnostics[1].message, "Expecting 'end' but found ` bar`.");
+  EXPECT_EQ(diagnostics[2].message, "Unexpected token `bar`.");
+  EXPECT_EQ(diagnostics[3].message, "Expecting 'end'");
+  // Offsets 3 and 7 each need the parser; the deletion does not.
+  EXPECT_EQ(fakeParser->expectCalls, 2U);
+}
+
 } // namespace
 } // namespace pegium::validation
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pegium/core/validation/ValidationCache.hpp>
+
+namespace pegium::validation {
+namespace {
+
+ValidationMemo::Diagnostics make_diagnostics(std::string message) {
+  return std::make_shared<const std::vector<pegium::Diagnostic>>(
+      std::vector{pegium::Diagnostic{.message = std::move(message)}});
+}
+
+TEST(ValidationCacheTest, EvictsTheLeastRecentlyUsedResults) {
+  ValidationCache cache(2);
+  const ValidationMemo::Key first{.fingerprint = 1, .checkId = 0};
+  const ValidationMemo::Key second{.fingerprint = 2, .checkId = 0};
+  const ValidationMemo::Key third{.fingerprint = 2, .checkId = 1};
+
+  cache.insert(first, make_diagnostics("first"));
+  cache.insert(second, make_diagnostics("second"));
+  ASSERT_NE(cache.find(first), nullptr);
+  cache.insert(third, make_diagnostics("third"));
+
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_EQ(cache.find(second), nullptr);
+  ASSERT_NE(cache.find(first), nullptr);
+  EXPECT_EQ(cache.find(first)->front().message, "first");
+  ASSERT_NE(cache.find(third), nullptr);
+  EXPECT_EQ(cache.find(third)->front().message, "third");
+
+  cache.insert(first, make_diagnostics("again"));
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_EQ(cache.find(first)->front().message, "again");
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0U);
+  EXPECT_EQ(cache.find(third), nullptr);
+}
+
+TEST(ValidationCacheTest, KeepsResultsWithoutDiagnosticsOutOfTheLruOrder) {
+  ValidationCache cache(2);
+  const ValidationMemo::Key first{.fingerprint = 1, .checkId = 0};
+  const ValidationMemo::Key second{.fingerprint = 2, .checkId = 0};
+  cache.insert(first, make_diagnostics("first"));
+  cache.insert(second, make_diagnostics("second"));
+  for (std::uint64_t fingerprint = 3; fingerprint < 8; ++fingerprint) {
+    cache.insert({.fingerprint = fingerprint, .checkId = 0}, nullptr);
+  }
+
+  ASSERT_NE(cache.find(first), nullptr);
+  EXPECT_EQ(cache.find(first)->front().message, "first");
+  ASSERT_NE(cache.find(second), nullptr);
+  EXPECT_EQ(cache.find(second)->front().message, "second");
+  // Two generations of clean keys are kept, the older ones dropped at once.
+  EXPECT_EQ(cache.find({.fingerprint = 3, .checkId = 0}), nullptr);
+  ASSERT_NE(cache.find({.fingerprint = 7, .checkId = 0}), nullptr);
+  EXPECT_TRUE(cache.find({.fingerprint = 7, .checkId = 0})->empty());
+  EXPECT_EQ(cache.size(), 5U);
+
+  cache.insert(first, nullptr);
+  ASSERT_NE(cache.find(first), nullptr);
+  EXPECT_TRUE(cache.find(first)->empty());
+}
+
+TEST(ValidationCacheTest, SpreadsLargeCachesOverShards) {
+  ValidationCache cache;
+  for (std::uint64_t fingerprint = 0; fingerprint < 4096; ++fingerprint) {
+    cache.insert({.fingerprint = fingerprint, .checkId = 1},
+                 make_diagnostics(std::to_string(fingerprint)));
+  }
+  EXPECT_EQ(cache.size(), 4096U);
+  for (std::uint64_t fingerprint = 0; fingerprint < 4096; ++fingerprint) {
+    const auto found = cache.find({.fingerprint = fingerprint, .checkId = 1});
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->front().message, std::to_string(fingerprint));
+  }
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST(ValidationCacheTest, StoresNothingWithoutCapacity) {
+  ValidationCache cache(0);
+  cache.insert({.fingerprint = 1, .checkId = 0}, make_diagnostics("ignored"));
+  EXPECT_EQ(cache.size(), 0U);
+  EXPECT_EQ(cache.find({.fingerprint = 1, .checkId = 0}), nullptr);
+}
+
+} // namespace
+} // namespace pegium::validation
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <future>
 #include <memory>
 #include <string>
@@ -215,5 +216,37 @@ TEST(DefaultConfigurationProviderTest,
   EXPECT_EQ(value->string(), "bar2");
 }
 
+TEST(DefaultConfigurationProviderTest,
+     UpdateConfigurationReadsUpdateDebounceOptions) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  DefaultConfigurationProvider provider(*shared);
+
+  const auto defaults =
+      provider.getWorkspaceConfigurationForLanguage("someLang").updateDebounce;
+  EXPECT_EQ(defaults.minDelay, UpdateDebounceOptions{}.minDelay);
+  EXPECT_EQ(defaults.maxDelay, UpdateDebounceOptions{}.maxDelay);
+
+  ConfigurationChangeParams params;
+  params.settings = pegium::JsonValue(pegium::JsonValue::Object{
+      {"someLang",
+       pegium::JsonValue(pegium::JsonValue::Object{
+           {"updateDebounce",
+            pegium::JsonValue(pegium::JsonValue::Object{
+                {"minDelay", pegium::JsonValue(120)},
+                {"maxDelay", pegium::JsonValue(50)},
+                {"costFactor", pegium::JsonValue(2.0)},
+            })},
+       })}});
+  provider.updateConfiguration(params);
+
+  const auto options =
+      provider.getWorkspaceConfigurationForLanguage("someLang").updateDebounce;
+  EXPECT_EQ(options.minDelay, std::chrono::milliseconds(120));
+  // The maximum delay never falls below the minimum delay.
+  EXPECT_EQ(options.maxDelay, std::chrono::milliseconds(120));
+  EXPECT_DOUBLE_EQ(options.costFactor, 2.0);
+}
+
 } // namespace
 } // namespace pegium::workspace
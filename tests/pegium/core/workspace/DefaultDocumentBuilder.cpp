@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <future>
+#include <map>
 #include <mutex>
 #include <optional>
 
@@ -12,6 +13,7 @@
 #include <pegium/core/grammar/FeatureValue.hpp>
 #include <pegium/core/parser/PegiumParser.hpp>
 #include <pegium/core/references/DefaultLinker.hpp>
+#include <pegium/core/references/ScopeComputation.hpp>
 #include <pegium/core/references/ScopeProvider.hpp>
 #include <pegium/core/services/Diagnostic.hpp>
 #include <pegium/core/validation/DefaultValidationRegistry.hpp>
@@ -114,6 +116,38 @@ public:
   }
 };
 
+// Looks references up under `lookupName` instead of their text, as with
+// imports or aliases, or does not tell its lookup names when it has none.
+class LookupNamesScopeProvider final : public references::ScopeProvider {
+public:
+  explicit LookupNamesScopeProvider(std::optional<std::string> lookupName)
+      : _lookupName(std::move(lookupName)) {}
+
+  const workspace::AstNodeDescription *
+  getScopeEntry(const ReferenceInfo &) const override {
+    return nullptr;
+  }
+
+  bool visitScopeEntries(
+      const ReferenceInfo &,
+      utils::function_ref<bool(const workspace::AstNodeDescription &)>) const override {
+    return true;
+  }
+
+  bool visitLookupNames(
+      const ReferenceInfo &,
+      utils::function_ref<void(std::string_view name)> visitor) const override {
+    if (!_lookupName.has_value()) {
+      return false;
+    }
+    visitor(std::string_view(*_lookupName));
+    return true;
+  }
+
+private:
+  std::optional<std::string> _lookupName;
+};
+
 class CountingLinker final : public references::DefaultLinker {
 public:
   using references::DefaultLinker::DefaultLinker;
@@ -127,6 +161,81 @@ public:
   mutable std::size_t linkCalls = 0;
 };
 
+// Exports one RelinkNode named after the whole document text.
+class TextNamedScopeComputation final : public references::ScopeComputation {
+public:
+  std::vector<workspace::AstNodeDescription>
+  collectExportedSymbols(const workspace::Document &document,
+                         const utils::CancellationToken &) const override {
+    return {workspace::AstNodeDescription{
+        .name = std::string(document.textDocument().getText()),
+        .type = std::type_index(typeid(RelinkNode)),
+        .documentId = document.id,
+        .symbolId = 0,
+    }};
+  }
+
+  workspace::LocalSymbols
+  collectLocalSymbols(const workspace::Document &,
+                      const utils::CancellationToken &) const override {
+    return {};
+  }
+};
+
+// Exports the document root under a fixed name when it is a RelinkNode.
+class RootNodeScopeComputation final : public references::ScopeComputation {
+public:
+  explicit RootNodeScopeComputation(std::string name) : _name(std::move(name)) {}
+
+  std::vector<workspace::AstNodeDescription>
+  collectExportedSymbols(const workspace::Document &document,
+                         const utils::CancellationToken &) const override {
+    const auto *root = dynamic_cast<const RelinkNode *>(document.parseResult.value);
+    if (root == nullptr) {
+      return {};
+    }
+    return {workspace::AstNodeDescription{
+        .name = _name,
+        .type = std::type_index(typeid(RelinkNode)),
+        .documentId = document.id,
+        .symbolId = document.makeSymbolId(*root),
+    }};
+  }
+
+  workspace::LocalSymbols
+  collectLocalSymbols(const workspace::Document &,
+                      const utils::CancellationToken &) const override {
+    return {};
+  }
+
+private:
+  std::string _name;
+};
+
+// Each leading '+' allocates a filler node before the root, shifting the
+// root's symbol id without changing what the document exports.
+std::unique_ptr<const parser::Parser> make_relink_target_parser() {
+  auto parser = std::make_unique<test::FakeParser>();
+  parser->callback = [](parser::ParseResult &result, std::string_view text) {
+    static const grammar::Literal &literal = dummy_literal();
+    auto cst = std::make_unique<RootCstNode>(text::TextSnapshot::copy(text));
+    result.astArena = std::make_unique<pegium::AstArena>(*cst);
+    const auto fillers = text.find_first_not_of('+');
+    for (std::size_t index = 0;
+         index < std::min(fillers, text.size()); ++index) {
+      result.astArena->create<RelinkNode>()->name = "filler";
+    }
+    auto *root = result.astArena->create<RelinkNode>();
+    CstBuilder builder(*cst);
+    builder.leaf(0, static_cast<TextOffset>(text.size()), &literal);
+    root->setCstNode(cst->get(0));
+    root->name = std::string(text.substr(std::min(fillers, text.size())));
+    result.value = root;
+    result.cst = std::move(cst);
+  };
+  return parser;
+}
+
 std::unique_ptr<const parser::Parser>
 make_unresolved_reference_parser(const references::Linker *&linkerRef) {
   auto parser = std::make_unique<test::FakeParser>();
@@ -188,8 +297,66 @@ TEST(DefaultDocumentBuilderTest, UpdateBuildsChangedDocumentToValidatedState) {
   EXPECT_TRUE(document->parseSucceeded());
 }
 
+TEST(DefaultDocumentBuilderTest, UpdateDoesNotPublishSnapshotsByDefault) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices =
+        test::make_uninstalled_core_services(*shared, "test");
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  const auto uri = test::make_file_uri("in-place.test");
+  auto first = test::open_and_build_document(*shared, uri, "test", "first");
+  auto second = test::open_and_build_document(*shared, uri, "test", "second");
+
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(shared->workspace.documentBuilder->snapshot(), nullptr);
+}
+
 TEST(DefaultDocumentBuilderTest,
-     UpdateRelinksDocumentsWithExistingLinkingErrors) {
+     UpdateUnderSnapshotIsolationBuildsNewVersionsAndKeepsSnapshotsIntact) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices =
+        test::make_uninstalled_core_services(*shared, "test");
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+  auto &builder = *shared->workspace.documentBuilder;
+  builder.updateBuildOptions().isolateSnapshots = true;
+
+  const auto uri = test::make_file_uri("isolated.test");
+  auto first = test::open_and_build_document(*shared, uri, "test", "first");
+  ASSERT_NE(first, nullptr);
+  const auto firstSnapshot = builder.snapshot();
+  ASSERT_NE(firstSnapshot, nullptr);
+  EXPECT_EQ(firstSnapshot->getDocument(uri), first);
+
+  auto second =
+      test::open_and_build_document(*shared, uri, "test", "second text");
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(second, first);
+  EXPECT_EQ(second->id, first->id);
+  EXPECT_EQ(second->state, DocumentState::Validated);
+  EXPECT_EQ(second->textDocument().getText(), "second text");
+
+  // The published version is left as the first build completed it.
+  EXPECT_EQ(first->state, DocumentState::Validated);
+  EXPECT_EQ(first->textDocument().getText(), "first");
+  EXPECT_EQ(firstSnapshot->getDocument(first->id), first);
+
+  const auto secondSnapshot = builder.snapshot();
+  ASSERT_NE(secondSnapshot, nullptr);
+  EXPECT_EQ(secondSnapshot->version(), firstSnapshot->version() + 1);
+  EXPECT_EQ(secondSnapshot->getDocument(uri), second);
+}
+
+TEST(DefaultDocumentBuilderTest,
+     UpdateRelinksDocumentsWithLinkingErrorsOnlyWhenMatchingExportsChange) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
   const references::Linker *linkerRef = nullptr;
@@ -203,6 +370,13 @@ TEST(DefaultDocumentBuilderTest,
   linkerRef = linkerPtr;
   shared->serviceRegistry->registerServices(std::move(services));
 
+  auto exporterServices =
+      test::make_uninstalled_core_services(*shared, "exporter", {".exporter"});
+  pegium::installDefaultCoreServices(*exporterServices);
+  exporterServices->references.scopeComputation =
+      std::make_unique<TextNamedScopeComputation>();
+  shared->serviceRegistry->registerServices(std::move(exporterServices));
+
   auto document = test::open_and_build_document(
       *shared, test::make_file_uri("relink.relink"), "relink", "content");
 
@@ -213,9 +387,187 @@ TEST(DefaultDocumentBuilderTest,
   ASSERT_TRUE(document->parseResult.references.front().getConst()->hasError());
 
   shared->workspace.documentBuilder->update({}, {});
+  EXPECT_EQ(linkerPtr->linkCalls, 1u);
+
+  const auto exporterUri = test::make_file_uri("symbols.exporter");
+  ASSERT_NE(test::open_and_build_document(*shared, exporterUri, "exporter",
+                                          "unrelated"),
+            nullptr);
+  EXPECT_EQ(linkerPtr->linkCalls, 1u);
 
+  ASSERT_NE(test::open_and_build_document(*shared, exporterUri, "exporter",
+                                          "missing"),
+            nullptr);
   EXPECT_EQ(linkerPtr->linkCalls, 2u);
   EXPECT_EQ(document->state, DocumentState::Validated);
+
+  // Re-exporting the same symbol is not an export change.
+  ASSERT_NE(test::open_and_build_document(*shared, exporterUri, "exporter",
+                                          "missing"),
+            nullptr);
+  EXPECT_EQ(linkerPtr->linkCalls, 2u);
+}
+
+TEST(DefaultDocumentBuilderTest,
+     UpdateRelinksDocumentsByTheLookupNamesOfTheirScopeProvider) {
+  for (const auto &lookupName :
+       {std::optional<std::string>("aliased"), std::optional<std::string>()}) {
+    auto shared = test::make_empty_shared_core_services();
+    pegium::installDefaultSharedCoreServices(*shared);
+    const references::Linker *linkerRef = nullptr;
+    auto services = test::make_uninstalled_core_services(
+        *shared, "relink", {".relink"}, {},
+        make_unresolved_reference_parser(linkerRef));
+    pegium::installDefaultCoreServices(*services);
+    services->references.scopeProvider =
+        std::make_unique<LookupNamesScopeProvider>(lookupName);
+    auto linker = std::make_unique<CountingLinker>(*services);
+    auto *linkerPtr = linker.get();
+    services->references.linker = std::move(linker);
+    linkerRef = linkerPtr;
+    shared->serviceRegistry->registerServices(std::move(services));
+
+    auto exporterServices = test::make_uninstalled_core_services(
+        *shared, "exporter", {".exporter"});
+    pegium::installDefaultCoreServices(*exporterServices);
+    exporterServices->references.scopeComputation =
+        std::make_unique<TextNamedScopeComputation>();
+    shared->serviceRegistry->registerServices(std::move(exporterServices));
+
+    auto document = test::open_and_build_document(
+        *shared, test::make_file_uri("relink.relink"), "relink", "content");
+    ASSERT_NE(document, nullptr);
+    ASSERT_EQ(linkerPtr->linkCalls, 1u);
+
+    // The reference text itself is no lookup name of an aliasing provider;
+    // a provider not telling its names relinks on any export change.
+    const auto exporterUri = test::make_file_uri("symbols.exporter");
+    ASSERT_NE(test::open_and_build_document(*shared, exporterUri, "exporter",
+                                            "missing"),
+              nullptr);
+    EXPECT_EQ(linkerPtr->linkCalls, lookupName.has_value() ? 1u : 2u);
+
+    ASSERT_NE(test::open_and_build_document(*shared, exporterUri, "exporter",
+                                            "aliased"),
+              nullptr);
+    EXPECT_EQ(linkerPtr->linkCalls, lookupName.has_value() ? 2u : 3u);
+    EXPECT_EQ(document->state, DocumentState::Validated);
+  }
+}
+
+TEST(DefaultDocumentBuilderTest,
+     UpdateRebindsDependantsInsteadOfRelinkingWhenExportsAreUnchanged) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  const references::Linker *linkerRef = nullptr;
+  auto services = test::make_uninstalled_core_services(
+      *shared, "relink", {".relink"}, {}, make_unresolved_reference_parser(linkerRef));
+  pegium::installDefaultCoreServices(*services);
+  services->references.scopeComputation =
+      std::make_unique<RootNodeScopeComputation>("unused");
+  auto linker = std::make_unique<CountingLinker>(*services);
+  auto *linkerPtr = linker.get();
+  services->references.linker = std::move(linker);
+  linkerRef = linkerPtr;
+  shared->serviceRegistry->registerServices(std::move(services));
+
+  auto targetServices = test::make_uninstalled_core_services(
+      *shared, "target", {".target"}, {}, make_relink_target_parser());
+  pegium::installDefaultCoreServices(*targetServices);
+  targetServices->references.scopeComputation =
+      std::make_unique<RootNodeScopeComputation>("missing");
+  shared->serviceRegistry->registerServices(std::move(targetServices));
+
+  const auto targetUri = test::make_file_uri("node.target");
+  auto target =
+      test::open_and_build_document(*shared, targetUri, "target", "first");
+  ASSERT_NE(target, nullptr);
+  auto document = test::open_and_build_document(
+      *shared, test::make_file_uri("relink.relink"), "relink", "content");
+  ASSERT_NE(document, nullptr);
+  ASSERT_EQ(linkerPtr->linkCalls, 1u);
+
+  const auto *root = static_cast<const RelinkRoot *>(document->parseResult.value);
+  ASSERT_EQ(root->referrers.size(), 1u);
+  const auto &reference = root->referrers.front()->node;
+  ASSERT_EQ(reference.get(), target->parseResult.value);
+  EXPECT_EQ(reference->name, "first");
+
+  ASSERT_NE(test::open_and_build_document(*shared, targetUri, "target", "second"),
+            nullptr);
+  EXPECT_EQ(linkerPtr->linkCalls, 1u);
+  EXPECT_EQ(document->state, DocumentState::Validated);
+  ASSERT_TRUE(reference.isResolved());
+  EXPECT_EQ(reference.get(), target->parseResult.value);
+  EXPECT_EQ(reference->name, "second");
+
+  // An edit before the exported node moves its symbol id but keeps the
+  // exported name and type: still rebound, onto the moved node.
+  ASSERT_NE(test::open_and_build_document(*shared, targetUri, "target", "++third"),
+            nullptr);
+  EXPECT_EQ(linkerPtr->linkCalls, 1u);
+  EXPECT_EQ(document->state, DocumentState::Validated);
+  ASSERT_TRUE(reference.isResolved());
+  EXPECT_EQ(reference.get(), target->parseResult.value);
+  EXPECT_EQ(reference->name, "third");
+  const auto &description =
+      static_cast<const AbstractSingleReference &>(reference)
+          .resolvedDescription();
+  EXPECT_EQ(description.symbolId, target->makeSymbolId(*reference.get()));
+  EXPECT_EQ(shared->workspace.indexManager
+                ->findAllReferences(workspace::NodeKey::of(description))
+                .size(),
+            1u);
+}
+
+TEST(DefaultDocumentBuilderTest,
+     UpdateAfterBuildRebindsDependantsOfTheChangedDocument) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  const references::Linker *linkerRef = nullptr;
+  auto services = test::make_uninstalled_core_services(
+      *shared, "relink", {".relink"}, {}, make_unresolved_reference_parser(linkerRef));
+  pegium::installDefaultCoreServices(*services);
+  services->references.scopeComputation =
+      std::make_unique<RootNodeScopeComputation>("unused");
+  linkerRef = services->references.linker.get();
+  shared->serviceRegistry->registerServices(std::move(services));
+
+  auto targetServices = test::make_uninstalled_core_services(
+      *shared, "target", {".target"}, {}, make_relink_target_parser());
+  pegium::installDefaultCoreServices(*targetServices);
+  targetServices->references.scopeComputation =
+      std::make_unique<RootNodeScopeComputation>("missing");
+  shared->serviceRegistry->registerServices(std::move(targetServices));
+
+  // Built as a workspace startup does, without going through `update`.
+  const auto targetUri = test::make_file_uri("node.target");
+  auto target = shared->workspace.documentFactory->fromString("first", targetUri);
+  ASSERT_NE(target, nullptr);
+  shared->workspace.documents->addDocument(target);
+  auto document = shared->workspace.documentFactory->fromString(
+      "content", test::make_file_uri("relink.relink"));
+  ASSERT_NE(document, nullptr);
+  shared->workspace.documents->addDocument(document);
+  BuildOptions options;
+  options.validation = true;
+  const std::array<std::shared_ptr<Document>, 2> documents{target, document};
+  shared->workspace.documentBuilder->build(documents, options);
+  ASSERT_EQ(document->state, DocumentState::Validated);
+
+  const auto updated =
+      test::open_and_build_document(*shared, targetUri, "target", "second");
+  ASSERT_NE(updated, nullptr);
+  const auto current =
+      shared->workspace.documents->getDocument(document->uri);
+  ASSERT_NE(current, nullptr);
+  EXPECT_EQ(current->state, DocumentState::Validated);
+  const auto *root = static_cast<const RelinkRoot *>(current->parseResult.value);
+  ASSERT_EQ(root->referrers.size(), 1u);
+  const auto &reference = root->referrers.front()->node;
+  ASSERT_TRUE(reference.isResolved());
+  EXPECT_EQ(reference.get(), updated->parseResult.value);
+  EXPECT_EQ(reference->name, "second");
 }
 
 TEST(DefaultDocumentBuilderTest,
@@ -249,7 +601,7 @@ TEST(DefaultDocumentBuilderTest,
   ASSERT_NE(document, nullptr);
   ASSERT_EQ(document->state, DocumentState::Validated);
   ASSERT_EQ(document->diagnostics.size(), 1u);
-  EXPECT_EQ(document->diagnostics.front().message, "validation");
+  EXPECT_EQ(document->diagnostics.front().message(), "validation");
   EXPECT_EQ(validatedUris, std::vector<std::string>{document->uri});
 }
 
@@ -640,7 +992,7 @@ TEST(DefaultDocumentBuilderTest, ParseDiagnosticRenderingTable) {
       ASSERT_FALSE(document->diagnostics.empty());
     }
 
-    const auto &diagnostic = document->diagnostics.front();
+    const auto diagnostic = document->diagnostics.front().materialize();
     if (c.expectedMessage != nullptr) {
       EXPECT_EQ(diagnostic.message, c.expectedMessage);
     }
@@ -712,7 +1064,7 @@ TEST(DefaultDocumentBuilderTest,
 
   ASSERT_NE(document, nullptr);
   ASSERT_FALSE(document->diagnostics.empty());
-  EXPECT_EQ(document->diagnostics.front().message,
+  EXPECT_EQ(document->diagnostics.front().message(),
             "Expecting MODULE_ID but found `def a`.");
   EXPECT_EQ(document->diagnostics.front().begin, 10u);
   EXPECT_EQ(document->diagnostics.front().end, 10u);
@@ -761,9 +1113,10 @@ TEST(DefaultDocumentBuilderTest,
 
   ASSERT_NE(document, nullptr);
   ASSERT_EQ(document->diagnostics.size(), 1u);
-  EXPECT_EQ(document->diagnostics.front().message, "Expecting ID");
+  EXPECT_EQ(document->diagnostics.front().message(), "Expecting ID");
   ASSERT_TRUE(document->diagnostics.front().code.has_value());
-  EXPECT_EQ(std::get<std::string>(*document->diagnostics.front().code),
+  EXPECT_EQ(std::get<utils::InternedString>(
+                *document->diagnostics.front().code),
             "parse.inserted");
 }
 
@@ -930,6 +1283,110 @@ TEST(DefaultDocumentBuilderTest, UpdatePrioritizesOpenTextDocuments) {
   EXPECT_EQ(validatedUris.back(), closedUri);
 }
 
+TEST(DefaultDocumentBuilderTest,
+     UpdateParsesOpenTextDocumentsBeforeLargerClosedOnes) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  // A single worker runs the documents one at a time in dispatch order.
+  shared->execution.taskScheduler =
+      std::make_shared<execution::TaskScheduler>(1);
+  auto parser = std::make_unique<test::FakeParser>();
+  auto *parserPtr = parser.get();
+  {
+    auto registeredServices = test::make_uninstalled_core_services(
+        *shared, "test", {".test"}, {}, std::move(parser));
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  std::vector<DocumentId> changedDocumentIds;
+  for (std::size_t index = 0; index < 4; ++index) {
+    auto document = shared->workspace.documentFactory->fromString(
+        std::string(4096, 'c'),
+        test::make_file_uri("closed-lane-" + std::to_string(index) + ".test"));
+    ASSERT_NE(document, nullptr);
+    shared->workspace.documents->addDocument(document);
+    changedDocumentIds.push_back(document->id);
+  }
+  const auto openUri = test::make_file_uri("open-lane.test");
+  auto openDocument =
+      shared->workspace.documentFactory->fromString("open", openUri);
+  ASSERT_NE(openDocument, nullptr);
+  shared->workspace.documents->addDocument(openDocument);
+  changedDocumentIds.push_back(openDocument->id);
+  auto textDocuments = test::text_documents(*shared);
+  ASSERT_NE(textDocuments, nullptr);
+  ASSERT_NE(test::set_text_document(*textDocuments, openUri, "test", "open", 2),
+            nullptr);
+
+  {
+    std::scoped_lock lock(parserPtr->mutex);
+    parserPtr->parsedTexts.clear();
+  }
+  (void)shared->workspace.documentBuilder->update(changedDocumentIds, {});
+
+  std::scoped_lock lock(parserPtr->mutex);
+  ASSERT_EQ(parserPtr->parsedTexts.size(), changedDocumentIds.size());
+  EXPECT_EQ(parserPtr->parsedTexts.front(), "open");
+}
+
+TEST(DefaultDocumentBuilderTest,
+     UpdateSkipsChangedFilesWhoseContentIsUnchangedOnDisk) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto parser = std::make_unique<test::FakeParser>();
+  auto *parserPtr = parser.get();
+  {
+    auto registeredServices = test::make_uninstalled_core_services(
+        *shared, "test", {".test"}, {}, std::move(parser));
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+  auto fileSystem = std::make_shared<test::FakeFileSystemProvider>();
+  fileSystem->files["/tmp/pegium-tests/same-stamp.test"] = "stamp";
+  fileSystem->modifiedTimes["/tmp/pegium-tests/same-stamp.test"] = 1;
+  fileSystem->files["/tmp/pegium-tests/same-content.test"] = "content";
+  fileSystem->files["/tmp/pegium-tests/edited.test"] = "before";
+  shared->workspace.fileSystemProvider = fileSystem;
+
+  std::vector<DocumentId> documentIds;
+  for (const auto *name : {"same-stamp.test", "same-content.test", "edited.test"}) {
+    auto document =
+        shared->workspace.documentFactory->fromUri(test::make_file_uri(name));
+    ASSERT_NE(document, nullptr);
+    shared->workspace.documents->addDocument(document);
+    documentIds.push_back(document->id);
+  }
+  (void)shared->workspace.documentBuilder->update(documentIds, {});
+
+  std::vector<DocumentId> changed;
+  auto disposable = shared->workspace.documentBuilder->onUpdate(
+      [&changed](std::span<const DocumentId> changedDocumentIds,
+                 std::span<const DocumentId>) {
+        changed.assign(changedDocumentIds.begin(), changedDocumentIds.end());
+      });
+  fileSystem->files["/tmp/pegium-tests/edited.test"] = "after";
+  {
+    std::scoped_lock lock(parserPtr->mutex);
+    parserPtr->parsedTexts.clear();
+  }
+  const auto readsBefore = fileSystem->readFileCalls.load();
+  (void)shared->workspace.documentBuilder->update(documentIds, {});
+
+  EXPECT_EQ(changed, std::vector<DocumentId>{documentIds[2]});
+  // The stamped file is not read at all; the edited one only once.
+  EXPECT_EQ(fileSystem->readFileCalls.load() - readsBefore, 2u);
+  {
+    std::scoped_lock lock(parserPtr->mutex);
+    EXPECT_EQ(parserPtr->parsedTexts, std::vector<std::string>{"after"});
+  }
+  for (const auto documentId : documentIds) {
+    const auto document = shared->workspace.documents->getDocument(documentId);
+    ASSERT_NE(document, nullptr);
+    EXPECT_EQ(document->state, DocumentState::Validated);
+  }
+}
+
 TEST(DefaultDocumentBuilderTest, BuildDoesNotValidateByDefault) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
@@ -1041,6 +1498,110 @@ TEST(DefaultDocumentBuilderTest, BuildEmitsUpdateAndAllBuildPhasesInOrder) {
   EXPECT_EQ(document->state, DocumentState::Validated);
 }
 
+TEST(DefaultDocumentBuilderTest,
+     ValidationProgressListenersReceivePendingDiagnosticsBeforeValidated) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto services = test::make_uninstalled_core_services(*shared, "test", {".test"});
+  pegium::installDefaultCoreServices(*services);
+
+  auto validator = std::make_unique<test::FakeDocumentValidator>();
+  validator->reportsProgress = true;
+  validator->diagnostics = {{.message = "syntax"},
+                            {.message = "linking"},
+                            {.message = "custom"}};
+  services->validation.documentValidator = std::move(validator);
+  shared->serviceRegistry->registerServices(std::move(services));
+
+  const auto uri = test::make_file_uri("build-validation-progress.test");
+  auto document =
+      shared->workspace.documentFactory->fromString("content", uri);
+  ASSERT_NE(document, nullptr);
+  shared->workspace.documents->addDocument(document);
+
+  std::vector<std::vector<std::string>> reported;
+  auto progressDisposable =
+      shared->workspace.documentBuilder->onValidationProgress(
+          [&reported, &document](
+              const std::shared_ptr<Document> &validated,
+              std::span<const pegium::CompactDiagnostic> pending,
+              utils::CancellationToken) {
+            EXPECT_EQ(validated, document);
+            EXPECT_LT(validated->state, DocumentState::Validated);
+            EXPECT_TRUE(validated->diagnostics.empty());
+            auto &messages = reported.emplace_back();
+            for (const auto &diagnostic : pending) {
+              messages.push_back(diagnostic.message());
+            }
+          });
+
+  BuildOptions options;
+  options.validation = true;
+  const std::array<std::shared_ptr<Document>, 1> documents{document};
+  shared->workspace.documentBuilder->build(documents, options);
+
+  EXPECT_EQ(reported, (std::vector<std::vector<std::string>>{
+                          {"syntax"}, {"syntax", "linking"}}));
+  EXPECT_EQ(document->state, DocumentState::Validated);
+  EXPECT_EQ(document->diagnostics.size(), 3U);
+}
+
+TEST(DefaultDocumentBuilderTest,
+     PipelinedBuildValidatesEveryDocumentWithItsPhasesInOrder) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices =
+        test::make_uninstalled_core_services(*shared, "test", {".test"});
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  std::vector<std::shared_ptr<Document>> documents;
+  for (std::size_t index = 0; index < 8; ++index) {
+    auto document = shared->workspace.documentFactory->fromString(
+        std::string(index % 4 == 0 ? 4096 : 16, 'x'),
+        test::make_file_uri("pipelined-" + std::to_string(index) + ".test"));
+    ASSERT_NE(document, nullptr);
+    shared->workspace.documents->addDocument(document);
+    documents.push_back(std::move(document));
+  }
+
+  std::map<DocumentId, std::vector<DocumentState>> documentPhases;
+  utils::DisposableStore disposables;
+  for (const auto state : {DocumentState::Linked,
+                           DocumentState::IndexedReferences,
+                           DocumentState::Validated}) {
+    disposables.add(shared->workspace.documentBuilder->onDocumentPhase(
+        state, [&documentPhases, state](const std::shared_ptr<Document> &document,
+                                        utils::CancellationToken) {
+          documentPhases[document->id].push_back(state);
+        }));
+  }
+  std::vector<std::size_t> validatedBatchSizes;
+  disposables.add(shared->workspace.documentBuilder->onBuildPhase(
+      DocumentState::Validated,
+      [&validatedBatchSizes](std::span<const std::shared_ptr<Document>> built,
+                             utils::CancellationToken) {
+        validatedBatchSizes.push_back(built.size());
+      }));
+
+  BuildOptions options;
+  options.validation = true;
+  options.pipelined = true;
+  shared->workspace.documentBuilder->build(documents, options);
+
+  EXPECT_EQ(validatedBatchSizes, std::vector<std::size_t>{documents.size()});
+  ASSERT_EQ(documentPhases.size(), documents.size());
+  for (const auto &document : documents) {
+    EXPECT_EQ(document->state, DocumentState::Validated);
+    EXPECT_EQ(documentPhases[document->id],
+              (std::vector<DocumentState>{DocumentState::Linked,
+                                          DocumentState::IndexedReferences,
+                                          DocumentState::Validated}));
+  }
+}
+
 TEST(DefaultDocumentBuilderTest,
      BuildSkipsLinkingPhasesWhenEagerLinkingIsDisabled) {
   auto shared = test::make_empty_shared_core_services();
@@ -1150,7 +1711,7 @@ TEST(DefaultDocumentBuilderTest,
 
   ASSERT_EQ(validatorPtr->validateCalls, 1u);
   ASSERT_EQ(document->diagnostics.size(), 1u);
-  EXPECT_EQ(document->diagnostics.front().message, "fast-diagnostic");
+  EXPECT_EQ(document->diagnostics.front().message(), "fast-diagnostic");
 
   BuildOptions fastAndSlow;
   fastAndSlow.validation =
@@ -1165,8 +1726,8 @@ TEST(DefaultDocumentBuilderTest,
   EXPECT_EQ(validatorPtr->seenOptions[1].categories,
             (std::vector<std::string>{"slow"}));
   ASSERT_EQ(document->diagnostics.size(), 2u);
-  EXPECT_EQ(document->diagnostics[0].message, "fast-diagnostic");
-  EXPECT_EQ(document->diagnostics[1].message, "slow-diagnostic");
+  EXPECT_EQ(document->diagnostics[0].message(), "fast-diagnostic");
+  EXPECT_EQ(document->diagnostics[1].message(), "slow-diagnostic");
 
   // Regression: a third build with the same categories must not re-validate
   // anything. The cumulative validation-check history records that both "fast"
@@ -1607,6 +2168,62 @@ TEST(DefaultDocumentBuilderTest,
   EXPECT_NO_THROW(waiter.get());
 }
 
+TEST(DefaultDocumentBuilderTest,
+     UpdateResumesOpenDocumentLeftByCancelledBuildWhenTextIsUnchanged) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto parser = std::make_unique<test::FakeParser>();
+  auto *parserPtr = parser.get();
+  {
+    auto registeredServices = test::make_uninstalled_core_services(
+        *shared, "test", {".test"}, {}, std::move(parser));
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+  shared->workspace.documentBuilder->updateBuildOptions().validation = true;
+
+  const auto uri = test::make_file_uri("resume-cancelled.test");
+  auto textDocuments = test::text_documents(*shared);
+  ASSERT_NE(textDocuments, nullptr);
+  ASSERT_NE(test::set_text_document(*textDocuments, uri, "test", "content", 1),
+            nullptr);
+  const auto documentId =
+      shared->workspace.documents->getOrCreateDocumentId(uri);
+  const std::array<DocumentId, 1> changed{documentId};
+
+  utils::CancellationTokenSource cancellationSource;
+  bool cancelled = false;
+  auto disposable = shared->workspace.documentBuilder->onBuildPhase(
+      DocumentState::ComputedScopes,
+      [&cancellationSource, &cancelled](std::span<const std::shared_ptr<Document>>,
+                                        utils::CancellationToken) {
+        if (!cancelled) {
+          cancelled = true;
+          cancellationSource.request_stop();
+        }
+      });
+  EXPECT_THROW(shared->workspace.documentBuilder->update(
+                   changed, {}, cancellationSource.get_token()),
+               utils::OperationCancelled);
+  auto document = shared->workspace.documents->getDocument(documentId);
+  ASSERT_NE(document, nullptr);
+  ASSERT_EQ(document->state, DocumentState::IndexedReferences);
+  ASSERT_EQ(parserPtr->parseCalls, 1u);
+
+  // The change is carried over into the next update with the same text: the
+  // document resumes from the phase it reached.
+  shared->workspace.documentBuilder->update(changed, {});
+  EXPECT_EQ(document->state, DocumentState::Validated);
+  EXPECT_EQ(parserPtr->parseCalls, 1u);
+
+  ASSERT_NE(test::set_text_document(*textDocuments, uri, "test", "edited", 2),
+            nullptr);
+  shared->workspace.documentBuilder->update(changed, {});
+  EXPECT_EQ(document->state, DocumentState::Validated);
+  EXPECT_EQ(document->textDocument().getText(), "edited");
+  EXPECT_EQ(parserPtr->parseCalls, 2u);
+}
+
 TEST(DefaultDocumentBuilderTest,
      WaitUntilWorkspaceResolvesWhenValidatedPhaseHasNoDocuments) {
   auto shared = test::make_empty_shared_core_services();
@@ -4,6 +4,7 @@
 
 #include <pegium/core/CoreTestSupport.hpp>
 #include <pegium/core/parser/PegiumParser.hpp>
+#include <pegium/core/utils/ContentHash.hpp>
 #include <pegium/core/utils/UriUtils.hpp>
 #include <pegium/core/workspace/DefaultDocumentFactory.hpp>
 
@@ -194,6 +195,97 @@ TEST(DefaultDocumentFactoryTest, FromUriPropagatesFileSystemErrors) {
                std::runtime_error);
 }
 
+TEST(DefaultDocumentFactoryTest,
+     FromUriUnparsedDefersParsingToUpdateWithoutRereadingTheFile) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto parser = std::make_unique<test::FakeParser>();
+  auto *parserPtr = parser.get();
+  {
+    auto registeredServices =
+      test::make_uninstalled_core_services(*shared, "test", {".test"}, {}, std::move(parser));
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  auto fileSystem = std::make_shared<test::FakeFileSystemProvider>();
+  fileSystem->files["/tmp/pegium-tests/factory-unparsed.test"] = "loaded";
+  shared->workspace.fileSystemProvider = fileSystem;
+
+  DefaultDocumentFactory factory(*shared);
+  auto document =
+      factory.fromUriUnparsed(test::make_file_uri("factory-unparsed.test"));
+
+  ASSERT_NE(document, nullptr);
+  EXPECT_EQ(document->state, DocumentState::Changed);
+  EXPECT_EQ(document->textDocument().getText(), "loaded");
+  EXPECT_EQ(parserPtr->parseCalls, 0u);
+
+  fileSystem->files["/tmp/pegium-tests/factory-unparsed.test"] = "edited";
+  factory.update(*document);
+
+  EXPECT_EQ(document->state, DocumentState::Parsed);
+  EXPECT_EQ(parserPtr->parseCalls, 1u);
+  ASSERT_EQ(parserPtr->parsedTexts.size(), 1u);
+  EXPECT_EQ(parserPtr->parsedTexts.front(), "loaded");
+
+  factory.update(*document);
+
+  EXPECT_EQ(document->textDocument().getText(), "edited");
+  EXPECT_EQ(parserPtr->parseCalls, 2u);
+}
+
+TEST(DefaultDocumentFactoryTest,
+     IsUnchangedOnDiskComparesFileStampThenContentHash) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices =
+      test::make_uninstalled_core_services(*shared, "test", {".test"});
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+  const std::string path = "/tmp/pegium-tests/factory-on-disk.test";
+  auto fileSystem = std::make_shared<test::FakeFileSystemProvider>();
+  fileSystem->files[path] = "content";
+  fileSystem->modifiedTimes[path] = 1;
+  shared->workspace.fileSystemProvider = fileSystem;
+
+  DefaultDocumentFactory factory(*shared);
+  auto document = factory.fromUri(test::make_file_uri("factory-on-disk.test"));
+  ASSERT_NE(document, nullptr);
+  EXPECT_EQ(document->textDocument().contentHash(),
+            utils::content_hash("content"));
+
+  auto reads = fileSystem->readFileCalls.load();
+  EXPECT_TRUE(factory.isUnchangedOnDisk(*document));
+  EXPECT_EQ(fileSystem->readFileCalls.load(), reads);
+
+  // Rewritten with the same content: read once, then recognized by stamp.
+  fileSystem->modifiedTimes[path] = 2;
+  EXPECT_TRUE(factory.isUnchangedOnDisk(*document));
+  EXPECT_EQ(fileSystem->readFileCalls.load(), reads + 1);
+  EXPECT_TRUE(factory.isUnchangedOnDisk(*document));
+  EXPECT_EQ(fileSystem->readFileCalls.load(), reads + 1);
+
+  // Same size, other content: the text read is kept for the next update.
+  fileSystem->files[path] = "CONTENT";
+  fileSystem->modifiedTimes[path] = 3;
+  EXPECT_FALSE(factory.isUnchangedOnDisk(*document));
+  reads = fileSystem->readFileCalls.load();
+  document->state = DocumentState::Changed;
+  factory.update(*document);
+  EXPECT_EQ(fileSystem->readFileCalls.load(), reads);
+  EXPECT_EQ(document->textDocument().getText(), "CONTENT");
+
+  auto documents = test::text_documents(*shared);
+  ASSERT_NE(documents, nullptr);
+  ASSERT_NE(test::set_text_document(*documents, document->uri, "test",
+                                    "CONTENT", 1),
+            nullptr);
+  EXPECT_FALSE(factory.isUnchangedOnDisk(*document));
+}
+
 TEST(DefaultDocumentFactoryTest,
      UpdateUsesLatestTextDocumentSnapshotAndReparsesChangedDocument) {
   auto shared = test::make_empty_shared_core_services();
@@ -419,5 +511,42 @@ TEST(DefaultDocumentFactoryTest,
   EXPECT_EQ(document->parseResult.parsedLength, 17u);
 }
 
+TEST(DefaultDocumentFactoryTest,
+     IsParsedFromCurrentTextComparesWithTheOpenedTextDocument) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices = test::make_uninstalled_core_services(
+        *shared, "test", {".test"}, {}, std::make_unique<test::FakeParser>());
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  DefaultDocumentFactory factory(*shared);
+  const auto uri = test::make_file_uri("factory-current-text.test");
+  auto document =
+      factory.fromTextDocument(make_text_document(uri, "test", "same", 1));
+  ASSERT_NE(document, nullptr);
+  ASSERT_EQ(document->state, DocumentState::Parsed);
+
+  // Not opened: only the file system could tell.
+  EXPECT_FALSE(factory.isParsedFromCurrentText(*document));
+
+  auto documents = test::text_documents(*shared);
+  ASSERT_NE(documents, nullptr);
+  ASSERT_NE(test::set_text_document(*documents, uri, "test", "same", 2),
+            nullptr);
+  EXPECT_TRUE(factory.isParsedFromCurrentText(*document));
+
+  ASSERT_NE(test::set_text_document(*documents, uri, "test", "edited", 3),
+            nullptr);
+  EXPECT_FALSE(factory.isParsedFromCurrentText(*document));
+
+  ASSERT_NE(test::set_text_document(*documents, uri, "test", "same", 4),
+            nullptr);
+  document->state = DocumentState::Changed;
+  EXPECT_FALSE(factory.isParsedFromCurrentText(*document));
+}
+
 } // namespace
 } // namespace pegium::workspace
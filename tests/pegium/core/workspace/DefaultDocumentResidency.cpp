@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pegium/core/CoreTestSupport.hpp>
+#include <pegium/core/parser/PegiumParser.hpp>
+#include <pegium/core/syntax-tree/AstUtils.hpp>
+#include <pegium/core/workspace/DefaultDocumentResidency.hpp>
+
+namespace pegium::workspace {
+namespace {
+
+using namespace pegium::parser;
+
+struct ResidentNode final : AstNode {
+  string value;
+};
+
+class ResidentParser final : public PegiumParser {
+public:
+  using PegiumParser::PegiumParser;
+
+protected:
+  const pegium::grammar::ParserRule &getEntryRule() const noexcept override {
+    return RootRule;
+  }
+
+  const Skipper &getSkipper() const noexcept override { return skipper; }
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wuninitialized"
+  static constexpr auto WS = some(s);
+  Skipper skipper = SkipperBuilder().ignore(WS).build();
+  Terminal<std::string> ID{"ID", "a-zA-Z_"_cr + many(w)};
+  Rule<ResidentNode> RootRule{"Root", assign<&ResidentNode::value>(ID)};
+#pragma clang diagnostic pop
+};
+
+std::unique_ptr<pegium::SharedCoreServices> make_shared_services() {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto services = test::make_uninstalled_core_services<ResidentParser>(
+      *shared, "test", {".test"});
+  pegium::installDefaultCoreServices(*services);
+  shared->serviceRegistry->registerServices(std::move(services));
+  return shared;
+}
+
+std::vector<std::shared_ptr<Document>>
+build_closed_documents(pegium::SharedCoreServices &shared,
+                       const std::vector<std::string> &names) {
+  std::vector<std::shared_ptr<Document>> documents;
+  for (const auto &name : names) {
+    auto document = shared.workspace.documentFactory->fromString(
+        name, test::make_file_uri(name + ".test"));
+    shared.workspace.documents->addDocument(document);
+    documents.push_back(std::move(document));
+  }
+  shared.workspace.documentBuilder->build(documents);
+  return documents;
+}
+
+TEST(DefaultDocumentResidencyTest, ReportsResidentBytesOfBuiltDocuments) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto documents = build_closed_documents(*shared, {"alpha", "beta"});
+
+  const auto alphaBytes = residency.residentBytes(*documents[0]);
+  const auto betaBytes = residency.residentBytes(*documents[1]);
+  EXPECT_GT(alphaBytes, 0u);
+  EXPECT_GT(betaBytes, 0u);
+  EXPECT_EQ(residency.residentBytes(), alphaBytes + betaBytes);
+}
+
+TEST(DefaultDocumentResidencyTest,
+     EnforceBudgetEvictsClosedDocumentsAndRestoresThemOnLookup) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto documents = build_closed_documents(*shared, {"alpha"});
+  const auto &document = *documents.front();
+  ASSERT_TRUE(document.hasAst());
+  const auto rootId = document.makeSymbolId(*document.parseResult.value);
+  const auto symbolCount = document.localSymbols.size();
+
+  residency.setMemoryBudget(1);
+  residency.enforceBudget();
+
+  EXPECT_TRUE(document.isEvicted());
+  EXPECT_FALSE(document.hasAst());
+  EXPECT_EQ(residency.residentBytes(document), 0u);
+  EXPECT_EQ(document.state, DocumentState::Validated);
+
+  const auto *root =
+      dynamic_cast<const ResidentNode *>(document.findAstNode(rootId));
+  ASSERT_NE(root, nullptr);
+  EXPECT_EQ(root->value, "alpha");
+  EXPECT_FALSE(document.isEvicted());
+  EXPECT_EQ(document.localSymbols.size(), symbolCount);
+  EXPECT_GT(residency.residentBytes(document), 0u);
+}
+
+TEST(DefaultDocumentResidencyTest, EnsureResidentRestoresTheParseResult) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto documents = build_closed_documents(*shared, {"alpha"});
+  const auto &document = *documents.front();
+  ASSERT_TRUE(document.ensureResident());
+
+  residency.setMemoryBudget(1);
+  residency.enforceBudget();
+  ASSERT_TRUE(document.isEvicted());
+  ASSERT_EQ(document.parseResult.value, nullptr);
+
+  EXPECT_TRUE(document.ensureResident());
+  EXPECT_TRUE(document.hasAst());
+  const auto *root =
+      dynamic_cast<const ResidentNode *>(document.parseResult.value);
+  ASSERT_NE(root, nullptr);
+  EXPECT_EQ(root->value, "alpha");
+}
+
+TEST(DefaultDocumentResidencyTest, ConcurrentLookupsRestoreADocumentOnce) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto documents = build_closed_documents(*shared, {"alpha"});
+  const auto &document = *documents.front();
+  ASSERT_TRUE(document.hasAst());
+  const auto rootId = document.makeSymbolId(*document.parseResult.value);
+
+  residency.setMemoryBudget(1);
+  residency.enforceBudget();
+  ASSERT_TRUE(document.isEvicted());
+
+  constexpr std::size_t kReaders = 8;
+  std::array<const AstNode *, kReaders> roots{};
+  std::vector<std::thread> readers;
+  for (std::size_t index = 0; index < kReaders; ++index) {
+    readers.emplace_back([&document, &roots, &residency, rootId, index] {
+      residency.touch(document);
+      roots[index] = document.findAstNode(rootId);
+      EXPECT_TRUE(document.hasAst());
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_FALSE(document.isEvicted());
+  for (const auto *root : roots) {
+    EXPECT_NE(root, nullptr);
+    EXPECT_EQ(root, document.findAstNode(rootId));
+  }
+  // Published nodes belong to the workspace document, not the staged one.
+  EXPECT_EQ(&getDocument(*document.parseResult.value), &document);
+}
+
+TEST(DefaultDocumentResidencyTest, EnforceBudgetKeepsOpenDocumentsResident) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto document =
+      test::open_and_build_document(*shared, test::make_file_uri("open.test"),
+                                    "test", "open");
+  ASSERT_NE(document, nullptr);
+  ASSERT_TRUE(document->hasAst());
+
+  residency.setMemoryBudget(1);
+  residency.enforceBudget();
+
+  EXPECT_FALSE(document->isEvicted());
+  EXPECT_TRUE(document->hasAst());
+}
+
+TEST(DefaultDocumentResidencyTest, EnforceBudgetEvictsLeastRecentlyUsedFirst) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto documents = build_closed_documents(*shared, {"alpha", "beta"});
+
+  residency.touch(*documents[0]);
+  residency.setMemoryBudget(residency.residentBytes() - 1);
+  residency.enforceBudget();
+
+  EXPECT_FALSE(documents[0]->isEvicted());
+  EXPECT_TRUE(documents[1]->isEvicted());
+}
+
+TEST(DefaultDocumentResidencyTest, ZeroBudgetDisablesEviction) {
+  auto shared = make_shared_services();
+  auto &residency = *shared->workspace.documentResidency;
+  const auto documents = build_closed_documents(*shared, {"alpha"});
+
+  residency.setMemoryBudget(0);
+  residency.enforceBudget();
+
+  EXPECT_FALSE(documents.front()->isEvicted());
+  EXPECT_TRUE(documents.front()->hasAst());
+}
+
+} // namespace
+} // namespace pegium::workspace
@@ -44,6 +44,25 @@ TEST(DefaultDocumentsTest, CreatesAndDeletesDocumentsViaFactory) {
   EXPECT_FALSE(shared->workspace.documents->hasDocument(created->uri));
 }
 
+TEST(DefaultDocumentsTest, ReplaceDocumentSwapsInTheNewVersionUnderTheSameId) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  register_test_language(*shared);
+  auto &documents = *shared->workspace.documents;
+
+  auto original = shared->workspace.documentFactory->fromString(
+      "original", test::make_file_uri("replaced.test"));
+  documents.addDocument(original);
+  auto successor = shared->workspace.documentFactory->createSuccessor(*original);
+  ASSERT_NE(successor, nullptr);
+  EXPECT_EQ(successor->id, original->id);
+
+  EXPECT_EQ(documents.replaceDocument(successor), original);
+  EXPECT_EQ(documents.getDocument(original->id), successor);
+  EXPECT_EQ(documents.getDocument(original->uri), successor);
+  EXPECT_EQ(documents.all().size(), 1u);
+}
+
 TEST(DefaultDocumentsTest, GetOrCreateDocumentPropagatesFactoryFailures) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
@@ -77,7 +77,7 @@ std::vector<std::string>
 collect_names(const std::vector<AstNodeDescription> &entries) {
   std::vector<std::string> names;
   for (const auto &entry : entries) {
-    names.push_back(entry.name);
+    names.emplace_back(entry.name);
   }
   std::ranges::sort(names);
   return names;
@@ -249,6 +249,64 @@ TEST(DefaultIndexManagerTest, InvalidatesTypedExportCacheOnContentUpdateAndRemov
           .empty());
 }
 
+TEST(DefaultIndexManagerTest,
+     ExportsFingerprintOnlyChangesWithExportedSymbols) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  DefaultIndexManager indexManager(*shared);
+
+  auto services =
+      test::make_uninstalled_core_services(*shared, "test", {".test"});
+  pegium::installDefaultCoreServices(*services);
+  auto scopeComputation = std::make_unique<TestScopeComputation>();
+  auto *scopeComputationPtr = scopeComputation.get();
+  services->references.scopeComputation = std::move(scopeComputation);
+  shared->serviceRegistry->registerServices(std::move(services));
+
+  auto document = make_document(1);
+  scopeComputationPtr->exportsByDocument[1] = {
+      {.name = "entry",
+       .type = std::type_index(typeid(BaseNode)),
+       .documentId = 1,
+       .symbolId = 3},
+  };
+  const auto emptyFingerprint = indexManager.exportsFingerprint();
+  indexManager.updateContent(*document, {});
+  const auto indexedFingerprint = indexManager.exportsFingerprint();
+  EXPECT_NE(indexedFingerprint, emptyFingerprint);
+  EXPECT_TRUE(indexManager.hasExportChanges(1));
+
+  const std::array<DocumentId, 1> documentIds{1};
+  indexManager.clearExportChanges(documentIds);
+  EXPECT_FALSE(indexManager.hasExportChanges(1));
+
+  // Reparsing with identical exports changes neither the delta nor the
+  // fingerprint.
+  EXPECT_TRUE(indexManager.removeContent(1));
+  EXPECT_EQ(indexManager.exportsFingerprint(), emptyFingerprint);
+  indexManager.updateContent(*document, {});
+  EXPECT_EQ(indexManager.exportsFingerprint(), indexedFingerprint);
+  EXPECT_FALSE(indexManager.hasExportChanges(1));
+
+  // A moved symbol id changes the fingerprint, which global scope caches copy,
+  // but not the delta: dependants resolve by name and type.
+  scopeComputationPtr->exportsByDocument[1].front().symbolId = 4;
+  indexManager.updateContent(*document, {});
+  const auto movedFingerprint = indexManager.exportsFingerprint();
+  EXPECT_NE(movedFingerprint, indexedFingerprint);
+  EXPECT_FALSE(indexManager.hasExportChanges(1));
+
+  scopeComputationPtr->exportsByDocument[1].front().name = "renamed";
+  indexManager.updateContent(*document, {});
+  EXPECT_NE(indexManager.exportsFingerprint(), movedFingerprint);
+  EXPECT_TRUE(indexManager.hasExportChanges(1));
+
+  indexManager.clearExportChanges(documentIds);
+  EXPECT_TRUE(indexManager.remove(1));
+  EXPECT_EQ(indexManager.exportsFingerprint(), emptyFingerprint);
+  EXPECT_TRUE(indexManager.hasExportChanges(1));
+}
+
 TEST(DefaultIndexManagerTest, PreservesDocumentIdProvidedByDescriptions) {
   auto shared = test::make_empty_shared_core_services();
   pegium::installDefaultSharedCoreServices(*shared);
@@ -212,6 +212,44 @@ TEST(DefaultWorkspaceManagerTest,
               uris.end());
 }
 
+TEST(DefaultWorkspaceManagerTest,
+     SearchFolderListsNestedFoldersInDepthFirstOrder) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  {
+    auto registeredServices =
+      test::make_uninstalled_core_services(*shared, "test", {".test"});
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  auto fileSystem = std::make_shared<test::FakeFileSystemProvider>();
+  const auto rootPath = std::string("/tmp/pegium-tests/workspace-depth");
+  fileSystem->directories[rootPath] = {rootPath + "/a", rootPath + "/b.test",
+                                       rootPath + "/c"};
+  fileSystem->directories[rootPath + "/a"] = {rootPath + "/a/a1.test",
+                                              rootPath + "/a/deep",
+                                              rootPath + "/a/a2.test"};
+  fileSystem->directories[rootPath + "/a/deep"] = {rootPath +
+                                                   "/a/deep/d.test"};
+  fileSystem->directories[rootPath + "/c"] = {rootPath + "/c/c1.test"};
+  for (const auto *file : {"/b.test", "/a/a1.test", "/a/a2.test",
+                           "/a/deep/d.test", "/c/c1.test"}) {
+    fileSystem->files[rootPath + file] = "alpha";
+  }
+  shared->workspace.fileSystemProvider = fileSystem;
+
+  DefaultWorkspaceManager manager(*shared);
+  const auto uris = manager.searchFolder(utils::path_to_file_uri(rootPath));
+
+  std::vector<std::string> expected;
+  for (const auto *file : {"/a/a1.test", "/a/deep/d.test", "/a/a2.test",
+                           "/b.test", "/c/c1.test"}) {
+    expected.push_back(utils::path_to_file_uri(rootPath + file));
+  }
+  EXPECT_EQ(uris, expected);
+}
+
 TEST(DefaultWorkspaceManagerTest,
      SearchFolderReturnsEmptyWhenRootDirectoryCannotBeRead) {
   auto shared = test::make_empty_shared_core_services();
@@ -379,6 +417,59 @@ TEST(DefaultWorkspaceManagerTest,
   EXPECT_TRUE(blockingBuilderPtr->waitUntilFinished());
 }
 
+TEST(DefaultWorkspaceManagerTest,
+     InitializedLeavesWorkspaceDocumentsUnparsedForTheInitialBuild) {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto parser = std::make_unique<test::FakeParser>();
+  auto *parserPtr = parser.get();
+  {
+    auto registeredServices = test::make_uninstalled_core_services(
+        *shared, "test", {".test"}, {}, std::move(parser));
+    pegium::installDefaultCoreServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+
+  auto blockingBuilder = std::make_unique<BlockingBuildDocumentBuilder>();
+  auto *blockingBuilderPtr = blockingBuilder.get();
+  shared->workspace.documentBuilder = std::move(blockingBuilder);
+
+  auto fileSystem = std::make_shared<test::FakeFileSystemProvider>();
+  const auto rootPath = std::string("/tmp/pegium-tests/workspace-unparsed");
+  std::vector<std::string> filePaths;
+  for (int index = 0; index < 16; ++index) {
+    filePaths.push_back(rootPath + "/file" + std::to_string(index) + ".test");
+    fileSystem->files[filePaths.back()] = "content" + std::to_string(index);
+  }
+  fileSystem->directories[rootPath] = filePaths;
+  shared->workspace.fileSystemProvider = fileSystem;
+
+  DefaultWorkspaceManager manager(*shared);
+  InitializeParams initializeParams{};
+  initializeParams.workspaceFolders.push_back(WorkspaceFolder{
+      .uri = utils::path_to_file_uri(rootPath), .name = "workspace"});
+  manager.initialize(initializeParams);
+
+  auto future = manager.initialized(InitializedParams{});
+  ASSERT_TRUE(blockingBuilderPtr->waitUntilStarted());
+
+  {
+    std::scoped_lock lock(parserPtr->mutex);
+    EXPECT_EQ(parserPtr->parseCalls, 0u);
+  }
+  for (std::size_t index = 0; index < filePaths.size(); ++index) {
+    const auto document = shared->workspace.documents->getDocument(
+        utils::path_to_file_uri(filePaths[index]));
+    ASSERT_NE(document, nullptr);
+    EXPECT_EQ(document->state, DocumentState::Changed);
+    EXPECT_EQ(document->textDocument().getText(),
+              "content" + std::to_string(index));
+  }
+
+  blockingBuilderPtr->release();
+  EXPECT_NO_THROW(future.get());
+}
+
 TEST(DefaultWorkspaceManagerTest,
      InitializedUsesOverriddenRootFolderForWorkspaceTraversal) {
   auto shared = test::make_empty_shared_core_services();
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#include <pegium/core/syntax-tree/AstArena.hpp>
+#include <pegium/core/syntax-tree/AstReflection.hpp>
+#include <pegium/core/syntax-tree/RootCstNode.hpp>
+#include <pegium/core/workspace/LocalSymbols.hpp>
+
+namespace pegium::workspace {
+namespace {
+
+struct BlockNode final : AstNode {};
+struct FirstKind final : AstNode {};
+struct SecondKind final : AstNode {};
+struct BaseKind : AstNode {};
+struct DerivedKind final : BaseKind {};
+
+AstNodeDescription make_description(std::string name, std::type_index type,
+                                    SymbolId symbolId) {
+  return {.name = std::move(name),
+          .type = type,
+          .documentId = 0,
+          .symbolId = symbolId};
+}
+
+std::vector<SymbolId> symbol_ids(std::span<const AstNodeDescription> entries) {
+  std::vector<SymbolId> ids;
+  for (const auto &entry : entries) {
+    ids.push_back(entry.symbolId);
+  }
+  return ids;
+}
+
+struct ArenaFixture {
+  RootCstNode cst{text::TextSnapshot::copy("x")};
+  AstArena arena{cst};
+};
+
+std::vector<SymbolId> chain_ids(const LocalSymbols &symbols,
+                                const AstNode *container) {
+  std::vector<SymbolId> ids;
+  for (const auto buckets : symbols.scopeChain(container)) {
+    for (const auto &bucket : buckets) {
+      for (const auto &entry : bucket.entries()) {
+        ids.push_back(entry.symbolId);
+      }
+    }
+  }
+  return ids;
+}
+
+TEST(LocalSymbolsTest, GroupsEntriesByContainerThenTypeInFirstUseOrder) {
+  ArenaFixture fixture;
+  const auto *outer = fixture.arena.create<BlockNode>();
+  const auto *inner = fixture.arena.create<BlockNode>();
+  const std::type_index first(typeid(FirstKind));
+  const std::type_index second(typeid(SecondKind));
+
+  LocalSymbols symbols;
+  symbols.emplace(inner, make_description("b", second, 1));
+  symbols.emplace(outer, make_description("a", first, 2));
+  symbols.emplace(inner, make_description("a", first, 3));
+  symbols.emplace(inner, make_description("c", second, 4));
+  symbols.finalize();
+
+  EXPECT_EQ(symbols.size(), 4u);
+  const auto innerBuckets = symbols.forContainer(inner);
+  ASSERT_EQ(innerBuckets.size(), 2u);
+  EXPECT_EQ(innerBuckets[0].type(), second);
+  EXPECT_EQ(symbol_ids(innerBuckets[0].entries()),
+            (std::vector<SymbolId>{1, 4}));
+  EXPECT_EQ(innerBuckets[1].type(), first);
+  EXPECT_EQ(symbol_ids(innerBuckets[1].entries()), (std::vector<SymbolId>{3}));
+
+  const auto outerBuckets = symbols.forContainer(outer);
+  ASSERT_EQ(outerBuckets.size(), 1u);
+  EXPECT_EQ(symbol_ids(outerBuckets[0].entries()), (std::vector<SymbolId>{2}));
+
+  const auto *unbound = fixture.arena.create<BlockNode>();
+  EXPECT_TRUE(symbols.forContainer(unbound).empty());
+}
+
+TEST(LocalSymbolsTest, FindsTheFirstDeclarationAndVisitsDuplicatesInOrder) {
+  ArenaFixture fixture;
+  const auto *block = fixture.arena.create<BlockNode>();
+  const std::type_index type(typeid(FirstKind));
+
+  LocalSymbols symbols;
+  symbols.emplace(block, make_description("zeta", type, 1));
+  symbols.emplace(block, make_description("dup", type, 2));
+  symbols.emplace(block, make_description("alpha", type, 3));
+  symbols.emplace(block, make_description("dup", type, 4));
+  symbols.finalize();
+
+  const auto buckets = symbols.forContainer(block);
+  ASSERT_EQ(buckets.size(), 1u);
+  const auto *dup = buckets[0].find("dup");
+  ASSERT_NE(dup, nullptr);
+  EXPECT_EQ(dup->symbolId, 2u);
+  EXPECT_EQ(buckets[0].find("missing"), nullptr);
+
+  std::vector<SymbolId> visited;
+  EXPECT_TRUE(buckets[0].visitNamed(
+      "dup", [&visited](const AstNodeDescription &entry) {
+        visited.push_back(entry.symbolId);
+        return true;
+      }));
+  EXPECT_EQ(visited, (std::vector<SymbolId>{2, 4}));
+  EXPECT_EQ(symbol_ids(buckets[0].entries()),
+            (std::vector<SymbolId>{1, 2, 3, 4}));
+}
+
+TEST(LocalSymbolsTest, KeepsFinalizedEntriesAheadOfLaterOnes) {
+  ArenaFixture fixture;
+  const auto *block = fixture.arena.create<BlockNode>();
+  const std::type_index type(typeid(FirstKind));
+
+  LocalSymbols symbols;
+  symbols.emplace(block, make_description("name", type, 1));
+  symbols.finalize();
+  symbols.emplace(block, make_description("name", type, 2));
+
+  // Queries lay out the staged entry themselves.
+  const auto buckets = symbols.forContainer(block);
+  ASSERT_EQ(buckets.size(), 1u);
+  EXPECT_EQ(symbol_ids(buckets[0].entries()), (std::vector<SymbolId>{1, 2}));
+  EXPECT_EQ(buckets[0].find("name")->symbolId, 1u);
+}
+
+TEST(LocalSymbolsTest, BindsEntriesToContainersOutsideAnArena) {
+  const BlockNode standalone;
+  const std::type_index type(typeid(FirstKind));
+
+  LocalSymbols symbols;
+  symbols.emplace(&standalone, make_description("detached", type, 1));
+  symbols.emplace(nullptr, make_description("orphan", type, 2));
+
+  ASSERT_EQ(symbols.forContainer(&standalone).size(), 1u);
+  EXPECT_NE(symbols.forContainer(&standalone)[0].find("detached"), nullptr);
+  ASSERT_EQ(symbols.forContainer(nullptr).size(), 1u);
+  EXPECT_NE(symbols.forContainer(nullptr)[0].find("orphan"), nullptr);
+  EXPECT_EQ(symbols.buckets().size(), 2u);
+
+  symbols.clear();
+  EXPECT_TRUE(symbols.empty());
+  EXPECT_TRUE(symbols.forContainer(&standalone).empty());
+}
+
+TEST(LocalSymbolsTest, ChainsOnlyTheContainersThatDeclareSymbols) {
+  ArenaFixture fixture;
+  auto *root = fixture.arena.create<BlockNode>();
+  auto *silent = fixture.arena.create<BlockNode>();
+  auto *middle = fixture.arena.create<BlockNode>();
+  auto *leaf = fixture.arena.create<BlockNode>();
+  silent->setContainer(*root);
+  middle->setContainer(*silent);
+  leaf->setContainer(*middle);
+  const std::type_index type(typeid(FirstKind));
+
+  LocalSymbols symbols;
+  symbols.emplace(root, make_description("outer", type, 1));
+  symbols.emplace(middle, make_description("inner", type, 2));
+  symbols.finalize();
+
+  // Nearest level first; `silent` and `leaf` declare nothing.
+  EXPECT_EQ(chain_ids(symbols, leaf), (std::vector<SymbolId>{2, 1}));
+  EXPECT_EQ(chain_ids(symbols, middle), (std::vector<SymbolId>{2, 1}));
+  EXPECT_EQ(chain_ids(symbols, silent), (std::vector<SymbolId>{1}));
+  EXPECT_TRUE(symbols.forContainer(silent).empty());
+  EXPECT_TRUE(symbols.forContainer(leaf).empty());
+
+  // Nodes created after finalization fall back to walking their containers.
+  auto *late = fixture.arena.create<BlockNode>();
+  late->setContainer(*leaf);
+  EXPECT_EQ(chain_ids(symbols, late), (std::vector<SymbolId>{2, 1}));
+  EXPECT_TRUE(chain_ids(symbols, nullptr).empty());
+}
+
+TEST(LocalSymbolsTest, PrecomputesTheBucketTypesEachReferenceTypeAccepts) {
+  ArenaFixture fixture;
+  const auto *block = fixture.arena.create<BlockNode>();
+  const std::type_index base(typeid(BaseKind));
+  const std::type_index derived(typeid(DerivedKind));
+  const std::type_index other(typeid(FirstKind));
+  AstReflection reflection;
+  reflection.registerSubtype(derived, base);
+
+  LocalSymbols symbols;
+  symbols.emplace(block, make_description("d", derived, 1));
+  symbols.emplace(block, make_description("o", other, 2));
+  const std::vector<std::type_index> referenceTypes{base, derived, base};
+  symbols.finalize(reflection, referenceTypes);
+
+  const auto buckets = symbols.forContainer(block);
+  ASSERT_EQ(buckets.size(), 2u);
+  const auto acceptsBase = symbols.acceptedTypes(base);
+  ASSERT_TRUE(acceptsBase.has_value());
+  EXPECT_TRUE(buckets[0].acceptedBy(*acceptsBase));
+  EXPECT_FALSE(buckets[1].acceptedBy(*acceptsBase));
+  const auto acceptsOther = symbols.acceptedTypes(other);
+  EXPECT_FALSE(acceptsOther.has_value());
+
+  // Descriptions staged later are covered once laid out.
+  symbols.emplace(block, make_description("b", base, 3));
+  const auto acceptsDerived = symbols.acceptedTypes(derived);
+  ASSERT_TRUE(acceptsDerived.has_value());
+  const auto relaid = symbols.forContainer(block);
+  ASSERT_EQ(relaid.size(), 3u);
+  EXPECT_TRUE(relaid[0].acceptedBy(*acceptsDerived));
+  EXPECT_FALSE(relaid[2].acceptedBy(*acceptsDerived));
+  EXPECT_TRUE(relaid[2].acceptedBy(*symbols.acceptedTypes(base)));
+}
+
+} // namespace
+} // namespace pegium::workspace
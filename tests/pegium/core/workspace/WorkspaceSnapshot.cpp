@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <span>
+
+#include <pegium/core/CoreTestSupport.hpp>
+#include <pegium/core/workspace/WorkspaceSnapshot.hpp>
+
+namespace pegium::workspace {
+namespace {
+
+std::unique_ptr<pegium::SharedCoreServices> make_isolating_services() {
+  auto shared = test::make_empty_shared_core_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  auto registeredServices =
+      test::make_uninstalled_core_services(*shared, "test", {".test"});
+  pegium::installDefaultCoreServices(*registeredServices);
+  shared->serviceRegistry->registerServices(std::move(registeredServices));
+  shared->workspace.documentBuilder->updateBuildOptions().isolateSnapshots =
+      true;
+  return shared;
+}
+
+TEST(WorkspaceSnapshotTest, ReaderRoutesDocumentLookupsToItsSnapshot) {
+  auto shared = make_isolating_services();
+  auto &documents = *shared->workspace.documents;
+  const auto uri = test::make_file_uri("reader.test");
+  auto first = test::open_and_build_document(*shared, uri, "test", "first");
+  ASSERT_NE(first, nullptr);
+  const auto snapshot = shared->workspace.documentBuilder->snapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  auto second = test::open_and_build_document(*shared, uri, "test", "second");
+  const auto otherUri = test::make_file_uri("other.test");
+  ASSERT_NE(test::open_and_build_document(*shared, otherUri, "test", "other"),
+            nullptr);
+  ASSERT_NE(second, first);
+
+  {
+    const WorkspaceSnapshot::Reader reader(*snapshot);
+    EXPECT_EQ(WorkspaceSnapshot::active(), snapshot.get());
+    EXPECT_EQ(documents.getDocument(uri), first);
+    EXPECT_EQ(documents.getDocument(first->id), first);
+    EXPECT_FALSE(documents.hasDocument(otherUri));
+    EXPECT_EQ(documents.all().size(), 1u);
+
+    // Nested readers of the same builder do not lock its gate again.
+    const auto latest = shared->workspace.documentBuilder->snapshot();
+    const WorkspaceSnapshot::Reader nested(*latest);
+    EXPECT_EQ(documents.getDocument(uri), second);
+    EXPECT_TRUE(documents.hasDocument(otherUri));
+  }
+
+  EXPECT_EQ(WorkspaceSnapshot::active(), nullptr);
+  EXPECT_EQ(documents.getDocument(uri), second);
+}
+
+TEST(WorkspaceSnapshotTest, CancelledUpdateKeepsThePreviousSnapshot) {
+  auto shared = make_isolating_services();
+  auto &builder = *shared->workspace.documentBuilder;
+  const auto uri = test::make_file_uri("cancelled.test");
+  auto built = test::open_and_build_document(*shared, uri, "test", "built");
+  ASSERT_NE(built, nullptr);
+  const auto snapshot = builder.snapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  utils::CancellationTokenSource cancellation;
+  auto disposable = builder.onBuildPhase(
+      DocumentState::Parsed,
+      [&cancellation](std::span<const std::shared_ptr<Document>>,
+                      utils::CancellationToken) { cancellation.request_stop(); });
+  auto textDocuments = test::text_documents(*shared);
+  ASSERT_NE(textDocuments, nullptr);
+  (void)test::set_text_document(*textDocuments, uri, "test", "edited", 2);
+  const std::array<DocumentId, 1> changedDocumentIds{built->id};
+  EXPECT_THROW(builder.update(changedDocumentIds, {}, cancellation.get_token()),
+               utils::OperationCancelled);
+
+  EXPECT_EQ(builder.snapshot(), snapshot);
+  EXPECT_EQ(snapshot->getDocument(uri), built);
+  EXPECT_EQ(built->state, DocumentState::Validated);
+  EXPECT_EQ(built->textDocument().getText(), "built");
+  EXPECT_NE(shared->workspace.documents->getDocument(uri), built);
+}
+
+} // namespace
+} // namespace pegium::workspace
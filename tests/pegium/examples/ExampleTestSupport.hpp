@@ -26,7 +26,7 @@ parse_document(ParserT &parser, std::string text, std::string uri = {},
 inline bool has_diagnostic_message(const workspace::Document &document,
                                    std::string_view needle) {
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(needle) != std::string::npos) {
+    if (diagnostic.message().find(needle) != std::string::npos) {
       return true;
     }
   }
@@ -17,7 +17,7 @@ using namespace pegium::parser;
 bool has_diagnostic_message(const workspace::Document &document,
                             std::string_view needle) {
   for (const auto &diagnostic : document.diagnostics) {
-    if (diagnostic.message.find(needle) != std::string::npos) {
+    if (diagnostic.message().find(needle) != std::string::npos) {
       return true;
     }
   }
@@ -6,6 +6,7 @@
 #include <condition_variable>
 #include <future>
 #include <mutex>
+#include <optional>
 #include <span>
 #include <thread>
 
@@ -47,6 +48,22 @@ void set_validation_configuration(
   configurationProvider.updateConfiguration(params);
 }
 
+void set_update_debounce_configuration(
+    workspace::ConfigurationProvider &configurationProvider,
+    std::string_view languageId, std::int64_t minDelay) {
+  workspace::ConfigurationChangeParams params;
+  params.settings = pegium::JsonValue(pegium::JsonValue::Object{
+      {std::string(languageId),
+       pegium::JsonValue(pegium::JsonValue::Object{
+           {"updateDebounce",
+            pegium::JsonValue(pegium::JsonValue::Object{
+                {"minDelay", pegium::JsonValue(minDelay)},
+            })},
+       })},
+  });
+  configurationProvider.updateConfiguration(params);
+}
+
 void clear_language_configuration(
     workspace::ConfigurationProvider &configurationProvider,
     std::string_view languageId) {
@@ -77,13 +94,15 @@ public:
     utils::throw_if_cancelled(cancelToken);
   }
 
-  void update(std::span<const workspace::DocumentId>,
+  void update(std::span<const workspace::DocumentId> changedDocumentIds,
               std::span<const workspace::DocumentId>,
               utils::CancellationToken cancelToken = {},
               const std::function<void()> & = {}) const override {
     {
       std::scoped_lock lock(_mutex);
       _started = true;
+      _changedDocumentIds.emplace_back(changedDocumentIds.begin(),
+                                       changedDocumentIds.end());
     }
     _cv.notify_all();
 
@@ -156,10 +175,25 @@ public:
     return _observedCancellation.load();
   }
 
+  /// Returns the changed ids of the `count`-th update call, once started.
+  [[nodiscard]] std::optional<std::vector<workspace::DocumentId>>
+  waitForUpdate(std::size_t count,
+                std::chrono::milliseconds timeout =
+                    std::chrono::milliseconds(1000)) const {
+    std::unique_lock lock(_mutex);
+    if (!_cv.wait_for(lock, timeout, [this, count]() {
+          return _changedDocumentIds.size() >= count;
+        })) {
+      return std::nullopt;
+    }
+    return _changedDocumentIds[count - 1];
+  }
+
 private:
   mutable workspace::BuildOptions _options;
   mutable std::mutex _mutex;
   mutable std::condition_variable _cv;
+  mutable std::vector<std::vector<workspace::DocumentId>> _changedDocumentIds;
   mutable bool _started = false;
   mutable bool _finished = false;
   mutable std::atomic<bool> _observedCancellation = false;
@@ -662,6 +696,55 @@ TEST_F(DefaultDocumentUpdateHandlerTest,
             (std::vector<std::string>{"built-in", "fast"}));
 }
 
+TEST_F(DefaultDocumentUpdateHandlerTest,
+       DidChangeContentMergesNotificationsWithinTheUpdateDelay) {
+  set_update_debounce_configuration(*shared->workspace.configurationProvider,
+                                    "test", 100);
+  auto first = makeTextDocument("merged-first.test", "first", "test");
+  auto second = makeTextDocument("merged-second.test", "second", "test");
+
+  handler->didChangeContent({.document = first});
+  handler->didChangeContent({.document = second});
+
+  ASSERT_TRUE(builder->waitForCalls(1));
+  EXPECT_FALSE(builder->waitForCalls(2, std::chrono::milliseconds(200)));
+  const auto call = builder->lastCall();
+  std::vector<workspace::DocumentId> changed = call.changedDocumentIds;
+  std::ranges::sort(changed);
+  std::vector<workspace::DocumentId> expected{
+      shared->workspace.documents->getDocumentId(first->uri()),
+      shared->workspace.documents->getDocumentId(second->uri())};
+  std::ranges::sort(expected);
+  EXPECT_EQ(changed, expected);
+}
+
+TEST_F(DefaultDocumentUpdateHandlerTest,
+       DidChangeContentCarriesSupersededDocumentsIntoTheNextUpdate) {
+  auto blockingBuilder = std::make_unique<BlockingUpdateDocumentBuilder>();
+  auto *blockingBuilderPtr = blockingBuilder.get();
+  shared->workspace.documentBuilder = std::move(blockingBuilder);
+  handler = std::make_unique<DefaultDocumentUpdateHandler>(*shared);
+
+  auto first = makeTextDocument("superseded-first.test", "first");
+  auto second = makeTextDocument("superseded-second.test", "second");
+  handler->didChangeContent({.document = first});
+  ASSERT_TRUE(blockingBuilderPtr->waitForUpdate(1).has_value());
+
+  // The update for `second` cancels the one still building `first`, so it
+  // must rebuild both.
+  handler->didChangeContent({.document = second});
+
+  const auto superseding = blockingBuilderPtr->waitForUpdate(2);
+  ASSERT_TRUE(superseding.has_value());
+  std::vector<workspace::DocumentId> changed = *superseding;
+  std::ranges::sort(changed);
+  std::vector<workspace::DocumentId> expected{
+      shared->workspace.documents->getDocumentId(first->uri()),
+      shared->workspace.documents->getDocumentId(second->uri())};
+  std::ranges::sort(expected);
+  EXPECT_EQ(changed, expected);
+}
+
 TEST_F(DefaultDocumentUpdateHandlerTest,
        DidChangeContentPropagatesWorkspaceLockCancellationToBuilderUpdate) {
   auto blockingBuilder = std::make_unique<BlockingUpdateDocumentBuilder>();
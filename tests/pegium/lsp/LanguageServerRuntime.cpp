@@ -284,7 +284,7 @@ TEST_F(LanguageServerRuntimeTest,
 
   auto staleDocument = std::make_shared<workspace::Document>(
       test::make_text_document(uri, "test", "alpha", 1));
-  staleDocument->diagnostics.push_back({
+  staleDocument->diagnostics.push_back(pegium::Diagnostic{
       .message = "stale",
       .begin = 0,
       .end = 5,
@@ -296,7 +296,7 @@ TEST_F(LanguageServerRuntimeTest,
 
   auto currentDocument = std::make_shared<workspace::Document>(
       test::make_text_document(uri, "test", "beta", 2));
-  currentDocument->diagnostics.push_back({
+  currentDocument->diagnostics.push_back(pegium::Diagnostic{
       .message = "current",
       .begin = 0,
       .end = 4,
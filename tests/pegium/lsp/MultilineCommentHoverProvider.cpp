@@ -7,6 +7,7 @@
 #include <pegium/lsp/services/ServiceAccess.hpp>
 #include <pegium/lsp/services/Services.hpp>
 #include <pegium/core/workspace/AstDescriptions.hpp>
+#include <pegium/core/workspace/WorkspaceSnapshot.hpp>
 
 namespace pegium {
 namespace {
@@ -224,6 +225,76 @@ TEST(MultilineCommentHoverProviderTest,
   EXPECT_NE(content.value.find("Doc A2."), std::string::npos);
 }
 
+TEST(MultilineCommentHoverProviderTest,
+     SnapshotHoverSkipsTargetsRebuiltSinceTheSnapshot) {
+  auto shared = test::make_empty_shared_services();
+  pegium::installDefaultSharedCoreServices(*shared);
+  pegium::installDefaultSharedLspServices(*shared);
+  pegium::test::initialize_shared_workspace_for_tests(*shared);
+  {
+    auto registeredServices =
+      test::make_uninstalled_services<HoverParser>(*shared, "docs", {".docs"});
+    pegium::installDefaultCoreServices(*registeredServices);
+    pegium::installDefaultLspServices(*registeredServices);
+    shared->serviceRegistry->registerServices(std::move(registeredServices));
+  }
+  auto &builder = *shared->workspace.documentBuilder;
+  builder.updateBuildOptions().isolateSnapshots = true;
+
+  const auto targetUri = test::make_file_uri("hover-target.docs");
+  ASSERT_NE(test::open_and_build_document(*shared, targetUri, "docs",
+                                          "/** Doc A. */\n"
+                                          "entry Alpha\n"),
+            nullptr);
+  auto document = test::open_and_build_document(
+      *shared, test::make_file_uri("hover-use.docs"), "docs", "use Alpha\n");
+  ASSERT_NE(document, nullptr);
+  const auto snapshot = builder.snapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  // Same exports, but the inserted node moves the symbol id of `Alpha`: the
+  // reference is rebound onto the new version of the target, which the
+  // snapshot does not hold.
+  ASSERT_NE(test::open_and_build_document(*shared, targetUri, "docs",
+                                          "use Alpha\n"
+                                          "/** Doc A. */\n"
+                                          "entry Alpha\n"),
+            nullptr);
+
+  const auto *services =
+      as_services(&shared->serviceRegistry->getServices(document->uri));
+  ASSERT_NE(services, nullptr);
+  ::lsp::HoverParams params{};
+  params.position.line = 0;
+  params.position.character = 5;
+  const auto hover_text = [&](const workspace::WorkspaceSnapshot &read)
+      -> std::optional<std::string> {
+    const workspace::WorkspaceSnapshot::Reader reader(read);
+    const auto current =
+        shared->workspace.documents->getDocument(document->uri);
+    EXPECT_NE(current, nullptr);
+    const auto hover = services->lsp.hoverProvider->getHoverContent(
+        *current, params, utils::default_cancel_token);
+    if (!hover.has_value()) {
+      return std::nullopt;
+    }
+    EXPECT_TRUE(std::holds_alternative<::lsp::MarkupContent>(hover->contents));
+    return std::get<::lsp::MarkupContent>(hover->contents).value;
+  };
+
+  std::optional<std::string> stale;
+  EXPECT_NO_THROW(stale = hover_text(*snapshot));
+  if (stale.has_value()) {
+    EXPECT_NE(stale->find("Doc A."), std::string::npos);
+  }
+
+  const auto latest = builder.snapshot();
+  ASSERT_NE(latest, nullptr);
+  const auto fresh = hover_text(*latest);
+  ASSERT_TRUE(fresh.has_value());
+  EXPECT_NE(fresh->find("Doc A."), std::string::npos);
+}
+
 TEST(MultilineCommentHoverProviderTest, RendersDocumentedKeyword) {
   auto shared = test::make_empty_shared_services();
   pegium::installDefaultSharedCoreServices(*shared);